@@ -6,13 +6,30 @@
 
 #include <glad/glad.h>
 
+#if defined(LGL_NULL_BACKEND) && defined(LGL_SOFTWARE_BACKEND)
+#error "Only one of LGL_NULL_BACKEND and LGL_SOFTWARE_BACKEND can be defined"
+#endif
+
+#ifdef LGL_NULL_BACKEND
+#include "LGLNullBackend.h"
+#endif
+
+#ifdef LGL_SOFTWARE_BACKEND
+#include "LGLSoftwareBackend.h"
+#endif
+
+#include "LGLCommandRecorder.h"
+
 #include <iostream>
 #include <string>
 #include <functional>
 #include <cassert>
 #include <unordered_map>
+#include <type_traits>
 
 #define GLSafeExecute(glFunc, ...) GLExecutor::SafeExecute(#glFunc, glFunc, __VA_ARGS__)
+// Calls that are too frequent for an error check or return a value, result is returned as is
+#define GLExecute(glFunc, ...) GLExecutor::Execute(#glFunc, glFunc, ##__VA_ARGS__)
 
 class GLExecutor
 {
@@ -23,6 +40,11 @@ public:
 	template<typename GLFunc, typename... Types>
 	static bool SafeExecute(const std::string& annotation, GLFunc glFunc, Types... values)
 	{
+#ifdef LGL_NULL_BACKEND
+		(void)glFunc;
+		LGLNullBackend::Execute(annotation, values...);
+		unsigned int error = GL_NO_ERROR;
+#else
 		unsigned int error;
 
 		glFunc(values...);
@@ -32,14 +54,51 @@ public:
 			std::cerr << "OpenGL ERROR:" + errorMessages[error] + (annotation.size() ? " comment: " + annotation : "") + '\n';
 			assert(!assertOnFailure && "OpenGL ERROR: check cmd");
 		}
+#endif
+
+		if (LGLCommandRecorder::IsRecording())
+		{
+			LGLCommandRecorder::Record(annotation, 0, values...);
+		}
 
 		return !error;
 	}
 
+	template<typename GLFunc, typename... Types>
+	static auto Execute(const char* annotation, GLFunc glFunc, Types... values) -> decltype(glFunc(values...))
+	{
+		return ExecuteCall(annotation, glFunc, std::is_void<decltype(glFunc(values...))>(), values...);
+	}
+
 	static void SetAssertOnFailure(bool value)
 	{
 		assertOnFailure = value;
 	}
+
+private:
+	template<typename GLFunc, typename... Types>
+	static void ExecuteCall(const char* annotation, GLFunc glFunc, std::true_type, Types... values)
+	{
+		glFunc(values...);
+
+		if (LGLCommandRecorder::IsRecording())
+		{
+			LGLCommandRecorder::Record(annotation, 0, values...);
+		}
+	}
+
+	template<typename GLFunc, typename... Types>
+	static auto ExecuteCall(const char* annotation, GLFunc glFunc, std::false_type, Types... values) -> decltype(glFunc(values...))
+	{
+		auto result = glFunc(values...);
+
+		if (LGLCommandRecorder::IsRecording())
+		{
+			LGLCommandRecorder::Record(annotation, LGLCommandRecorder::ToResult(result), values...);
+		}
+
+		return result;
+	}
 };
 
 std::unordered_map<unsigned int, std::string> GLExecutor::errorMessages
@@ -4,6 +4,9 @@
 #include <algorithm>
 #include <cctype>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 
 #define LGL_EXPORT
 #include "LGL.h"
@@ -19,6 +22,13 @@
 std::recursive_mutex ContextManager<GLFWwindow>::rMutex;
 size_t ContextManager<GLFWwindow>::counter = 0;
 
+#ifdef LGL_PROFILER
+// CPU zone and GPU zone of the same name, for code which issues GL commands
+#define ProfileGPUZone(name) ProfileZone(name); ScopedGPUZone LGL_PROFILE_CONCAT(profileGPUZone, __LINE__)(*this, name)
+#else
+#define ProfileGPUZone(name)
+#endif
+
 using namespace LGLStructs;
 
 std::function<void(double, double)> LGL::cursorPositionFunc = nullptr;
@@ -49,17 +59,91 @@ const std::vector<int> LGL::LGLEnumInterpreter::SpecialKeyInter =
 	}
 };
 
+const std::vector<std::array<int, 3>> LGL::LGLEnumInterpreter::RenderResourceFormatInter =
+{
+	{ GL_RGBA8,              GL_RGBA,            GL_UNSIGNED_BYTE },
+	{ GL_RGBA16F,            GL_RGBA,            GL_HALF_FLOAT    },
+	{ GL_R16F,               GL_RED,             GL_HALF_FLOAT    },
+	{ GL_R8,                 GL_RED,             GL_UNSIGNED_BYTE },
+	{ GL_DEPTH_COMPONENT24,  GL_DEPTH_COMPONENT, GL_UNSIGNED_INT  },
+	{ GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT         }
+};
+
 LGL::LGL()
 {
 	background = { 0, 0, 0, 1 };
 	currentVAOToRender = {};
 	window = nullptr;
 
+	fullscreenVAO = 0;
+	frameTimerQueries.fill(0);
+	frameTimerIndex = 0;
+
+	shadowPassActive = false;
+	transparentMeshesPresent = false;
+
+	cullingPlanes.fill(glm::vec4(0.0f));
+	cullingViewProj = glm::mat4(1.0f);
+	cullingViewPos = glm::vec3(0.0f);
+	cullingViewSet = false;
+	frameInstancesSubmitted = 0;
+	frameInstancesVisible = 0;
+	instanceCullLoaded = false;
+	instanceCullProgram = 0;
+	cullPlanesLocation = -1;
+	cullSphereLocation = -1;
+
+	meshletFrustumCulling = true;
+	meshletConeCulling = true;
+	frameMeshletsSubmitted = 0;
+	frameMeshletsVisible = 0;
+	frameInstanceTriangles = 0;
+
+	lodMaxPixelError = 1.0f;
+
+	evictAfterFrames = 600;
+	evictionCount = 0;
+	reuploadCount = 0;
+
+	captureFrameInterval = 1;
+	captureThreadStop = false;
+	commandCaptureFrames = 0;
+	commandCaptureStopRequested = false;
+
+	debugDrawEnabled = false;
+	debugDrawVAO = 0;
+	debugDrawVBO = 0;
+	debugDrawCapacity = 0;
+
+	gpuProfileFrameIndex = 0;
+
+	transformFeedbackVaryings["instanceCull"] = { 
+		"visibleModel0", "visibleModel1", "visibleModel2", "visibleModel3", 
+		"visibleNormal0", "visibleNormal1", "visibleNormal2" 
+	};
+
+	renderGraphAllocator = {
+		[this](const RenderResourceDesc& desc, int width, int height) { return CreateRenderResource(desc, width, height); },
+		[this](const RenderResourceDesc& desc, unsigned int id) { DeleteRenderResource(desc, id); }
+	};
+
+	renderGraph.ImportResource("backbuffer", 0);
+	renderGraph.MarkOutput("backbuffer");
+	renderGraph.AddPass("Shadows", {}, { "shadowMaps" }, [this]() { RenderShadowMaps(); });
+	renderGraph.AddPass("Scene", { "shadowMaps" }, { "sceneColor", "sceneDepth" }, [this]() { RenderScene(); });
+	renderGraph.AddPass("Transparent", { "sceneDepth" }, { "oitAccum", "oitWeight" }, [this]() { RenderTransparent(); });
+	renderGraph.AddPass("TransparentComposite", { "oitAccum", "oitWeight" }, { "sceneColor" }, [this]() { CompositeTransparent(); });
+	renderGraph.AddPass("Upscale", { "sceneColor" }, { "backbuffer" }, [this]() { ResolveSceneTarget(); });
+	renderGraph.AddPass("Capture", { "backbuffer" }, {}, [this]() { CaptureFrame(); }, true);
+	DeclareTransparencyTargets();
+
 	std::cout << "Created LambdaGL instance\n";
 }
 
 LGL::~LGL()
 {
+	StopCaptureWorker();
+
 	for (auto& VAO : VAOCollection)
 	{
 		GLSafeExecute(glDeleteVertexArrays, 1, &VAO.vboId);
@@ -88,6 +172,53 @@ LGL::~LGL()
 		GLSafeExecute(glDeleteTextures, 1, &texture.second);
 	}
 
+	for (auto& instanceBuffers : instanceCollection)
+	{
+		GLSafeExecute(glDeleteBuffers, 1, &instanceBuffers.second.sourceId);
+		GLSafeExecute(glDeleteBuffers, 1, &instanceBuffers.second.visibleId);
+		GLSafeExecute(glDeleteVertexArrays, 1, &instanceBuffers.second.cullVAO);
+
+		for (CullGroup& cullGroup : instanceBuffers.second.cullGroups)
+		{
+			GLSafeExecute(glDeleteQueries, 1, &cullGroup.visibleQuery);
+		}
+	}
+
+	for (auto& shadowMap : shadowMapCollection)
+	{
+		DeleteShadowMapObjects(shadowMap.second);
+	}
+
+	renderGraph.Release(renderGraphAllocator);
+	for (auto& framebuffer : framebufferCache)
+	{
+		GLSafeExecute(glDeleteFramebuffers, 1, &framebuffer.second);
+	}
+
+	DeleteSceneTarget();
+	if (frameTimerQueries[0])
+	{
+		GLSafeExecute(glDeleteQueries, static_cast<int>(frameTimerQueries.size()), frameTimerQueries.data());
+	}
+	if (fullscreenVAO)
+	{
+		GLSafeExecute(glDeleteVertexArrays, 1, &fullscreenVAO);
+	}
+	if (debugDrawVAO)
+	{
+		GLSafeExecute(glDeleteVertexArrays, 1, &debugDrawVAO);
+		GLSafeExecute(glDeleteBuffers, 1, &debugDrawVBO);
+	}
+	for (auto& gpuProfileFrame : gpuProfileFrames)
+	{
+		if (!gpuProfileFrame.queries.empty())
+		{
+			GLSafeExecute(glDeleteQueries, static_cast<int>(gpuProfileFrame.queries.size()), gpuProfileFrame.queries.data());
+		}
+	}
+
+	LGLCommandRecorder::Stop();
+
 	std::cout << "LambdaGL instance destroyed\n";
 }
 
@@ -130,209 +261,3290 @@ void LGL::InitOpenGL(int major, int minor)
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-	std::cout << "OpenGL initialized\n";
+	std::cout << "OpenGL initialized\n";
+}
+
+bool LGL::InitGLAD()
+{
+	ContextLock
+
+#if defined(LGL_NULL_BACKEND)
+	std::cout << "[WARNING] LGL is built with null backend, nothing will be rendered\n";
+#elif defined(LGL_SOFTWARE_BACKEND)
+	std::cout << "LGL is built with software backend, rendering on " << LGLSoftwareBackend::GetThreadAmount() << " thread(s)\n";
+#else
+	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+	{
+		std::cout << "Failed to init GLAD\n";
+		return false;
+	}
+#endif
+
+	SetDepthTest(DepthTestMode::Less);
+
+	std::cout << "GLAD initialized\n";
+
+	return true;
+}
+
+void LGL::InitCallbacks()
+{
+	ContextLock
+
+	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+	glfwSetErrorCallback(GLFWErrorCallback);
+}
+
+void LGL::TerminateOpenGL()
+{
+	glfwTerminate();
+
+	std::cout << "Terminate OpenGL\n";
+}
+
+void LGL::SetDepthTest(DepthTestMode depthTestMode)
+{
+	ContextLock
+
+	if (depthTestMode == DepthTestMode::Disable)
+	{
+		GLSafeExecute(glDisable, GL_DEPTH_TEST);
+	}
+	else
+	{
+		GLSafeExecute(glEnable, GL_DEPTH_TEST);
+		GLSafeExecute(glDepthFunc, static_cast<GLenum>(LGLEnumInterpreter::DepthTestModeInter[static_cast<GLenum>(depthTestMode)]));
+	}
+}
+
+void LGL::CaptureMouse()
+{
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	std::cout << "Mouse has been captured\n";
+}
+
+void LGL::SetCursorPositionCallback(std::function<void(double, double)> callbackFunc)
+{
+	glfwSetCursorPosCallback(window, CursorPositionCallback);
+	cursorPositionFunc = callbackFunc;
+
+	std::cout << "Cursor callback set\n";
+}
+
+void LGL::SetScrollCallback(std::function<void(double, double)> callbackFunc)
+{
+	glfwSetScrollCallback(window, ScrollCallback);
+	scrollCallbackFunc = callbackFunc;
+
+	std::cout << "Scroll callback set\n";
+}
+
+int LGL::GetMaxAmountOfVertexAttr()
+{
+	ContextLock
+
+	int attr;
+	GLSafeExecute(glGetIntegerv, GL_MAX_VERTEX_ATTRIBS, &attr);
+	
+	std::cout << "Max amount of vertex attributes: " << attr << '\n';
+	
+	return attr;
+}
+
+void LGL::ProcessInput()
+{
+	ProfileZone("Input");
+
+	for (auto& interact : interactCollection)
+	{
+		int retCode = glfwGetKey(window, interact.first);
+
+		if (retCode == GLFW_PRESS && interact.second.first)
+		{
+			interact.second.first();
+		}
+		else if (retCode == GLFW_RELEASE && interact.second.second)
+		{
+			interact.second.second();
+		}
+	}
+}
+
+void LGL::FramebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+	GLExecute(glViewport, 0, 0, width, height);
+}
+
+void LGL::Render()
+{
+	if (currentVAOToRender.vboId != 0)
+	{
+		if (!currentVAOToRender.useIndices)
+		{
+			GLSafeExecute(glDrawArrays, GL_TRIANGLES, 0, currentVAOToRender.pointAmount);
+		}
+		else
+		{
+			GLSafeExecute(glDrawElements, GL_TRIANGLES, currentVAOToRender.pointAmount, GL_UNSIGNED_INT, nullptr);
+		}
+
+		uniformLocationTracker.clear();
+	}
+}
+
+void LGL::RenderScene()
+{
+	ProfileGPUZone("Scene");
+
+	transparentMeshesPresent = std::any_of(VAOCollection.begin(), VAOCollection.end(),
+		[](const VAOInfo& vaoInfo) { return vaoInfo.meshInfo->render && vaoInfo.meshInfo->isTransparent; }
+	);
+
+	BeginSceneTarget();
+	renderGraph.ImportResource("sceneColor", sceneTarget.colorId);
+	renderGraph.ImportResource("sceneDepth", sceneTarget.depthId);
+
+	for (auto& shadowMap : shadowMapCollection)
+	{
+		GLSafeExecute(glActiveTexture, GL_TEXTURE0 + shadowMap.second.textureUnit);
+		GLSafeExecute(
+			glBindTexture, 
+			shadowMap.second.isCube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, 
+			shadowMap.second.sampledDepthId
+		);
+	}
+
+	GLSafeExecute(glClearColor, background.r, background.g, background.b, background.a);
+	GLSafeExecute(glClear, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	for (auto& currentVAO : VAOCollection)
+	{
+		if (currentVAO.meshInfo->render && !currentVAO.meshInfo->isTransparent)
+		{
+			DrawMesh(currentVAO, currentVAO.meshInfo->shaderProgram);
+		}
+	}
+	currentVAOToRender = {};
+}
+
+void LGL::DrawMesh(VAOInfo& vaoInfo, const std::string& shaderProgram)
+{
+	std::array<bool, Texture::GetTextureTypeAmount()> textureTypesToUnbind;
+	std::fill(textureTypesToUnbind.begin(), textureTypesToUnbind.end(), false);
+
+	currentVAOToRender = vaoInfo;
+
+	if (lastProgram != shaderProgram)
+	{
+		lastProgram = shaderProgram;
+		GLSafeExecute(glUseProgram, shaderProgramCollection[lastProgram]);
+	}
+
+	if (!memoryBudget.IsResident(LGLMemoryBudget::ObjectType::VertexArray, vaoInfo.vboId))
+	{
+		RestoreMesh(vaoInfo.vboId);
+	}
+	memoryBudget.Touch(LGLMemoryBudget::ObjectType::VertexArray, vaoInfo.vboId, renderStats.frameCount);
+
+	GLSafeExecute(glBindVertexArray, vaoInfo.vboId);
+
+	for (auto& texture : vaoInfo.meshInfo->mesh.textures)
+	{
+		auto currentTextureIter = textureCollection.find(texture.name);
+		if (currentTextureIter != textureCollection.end())
+		{
+			TextureID textureID = (*currentTextureIter).second;
+			int convertedTextureType = static_cast<int>(texture.type);
+			GLSafeExecute(glActiveTexture, GL_TEXTURE0 + convertedTextureType);
+
+			if (!memoryBudget.IsResident(LGLMemoryBudget::ObjectType::Texture, textureID))
+			{
+				RestoreTexture(textureID);
+			}
+			memoryBudget.Touch(LGLMemoryBudget::ObjectType::Texture, textureID, renderStats.frameCount);
+
+			GLSafeExecute(glBindTexture, GL_TEXTURE_2D, textureID);
+
+			textureTypesToUnbind[convertedTextureType] = true;
+		}
+	}
+
+	std::function<void()> behaviourToCheck = vaoInfo.meshInfo->behaviour;
+	if (behaviourToCheck)
+	{
+		behaviourToCheck();
+	}
+
+	Render();
+
+	for (size_t textureType = 0; textureType < textureTypesToUnbind.size(); ++textureType)
+	{
+		if (textureTypesToUnbind[textureType])
+		{
+			GLSafeExecute(glActiveTexture, GL_TEXTURE0 + static_cast<GLenum>(textureType));
+			GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+		}
+	}
+}
+
+void LGL::DrawFullscreenTriangle()
+{
+	// Full screen triangle is generated from gl_VertexID, VAO is required by core profile only
+	if (!fullscreenVAO)
+	{
+		GLSafeExecute(glGenVertexArrays, 1, &fullscreenVAO);
+	}
+	GLSafeExecute(glBindVertexArray, fullscreenVAO);
+	GLSafeExecute(glDrawArrays, GL_TRIANGLES, 0, 3);
+}
+
+void LGL::DeclareTransparencyTargets()
+{
+	// Accumulation keeps weighted premultiplied color in rgb and revealage in alpha,
+	// so both targets are blended with one blend function, as per attachment blending needs 4.0
+	RenderResourceDesc accumDesc;
+	accumDesc.format = RenderResourceDesc::TextureFormat::RGBA16F;
+	accumDesc.outputScale = dynResConfig.enabled ? dynResConfig.maxScale : 1.0f;
+
+	RenderResourceDesc weightDesc = accumDesc;
+	weightDesc.format = RenderResourceDesc::TextureFormat::R16F;
+
+	renderGraph.DeclareTransient("oitAccum", accumDesc);
+	renderGraph.DeclareTransient("oitWeight", weightDesc);
+}
+
+void LGL::RenderTransparent()
+{
+	ProfileGPUZone("Transparent");
+
+	if (!transparentMeshesPresent || !sceneTarget.fboId)
+	{
+		return;
+	}
+
+	if (!BindRenderTargets({ "oitAccum", "oitWeight" }, "sceneDepth"))
+	{
+		return;
+	}
+	GLSafeExecute(glViewport, 0, 0, renderStats.renderWidth, renderStats.renderHeight);
+
+	const float accumClear[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	const float weightClear[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	GLSafeExecute(glClearBufferfv, GL_COLOR, 0, accumClear);
+	GLSafeExecute(glClearBufferfv, GL_COLOR, 1, weightClear);
+
+	// Opaque depth is tested against but not written, so no sorting is needed
+	GLSafeExecute(glDepthMask, GL_FALSE);
+	GLSafeExecute(glEnable, GL_BLEND);
+	GLSafeExecute(glBlendFuncSeparate, GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+
+	for (auto& currentVAO : VAOCollection)
+	{
+		if (!currentVAO.meshInfo->render || !currentVAO.meshInfo->isTransparent)
+		{
+			continue;
+		}
+
+		std::string shaderProgram = currentVAO.meshInfo->shaderProgram;
+
+		auto transparentProgramIter = transparentProgramCollection.find(shaderProgram);
+		if (transparentProgramIter != transparentProgramCollection.end())
+		{
+			shaderProgram = transparentProgramIter->second;
+		}
+
+		if (lastProgram != shaderProgram)
+		{
+			lastProgram = shaderProgram;
+			GLSafeExecute(glUseProgram, shaderProgramCollection[lastProgram]);
+		}
+		GLSafeExecute(
+			glUniform1f, 
+			GLExecute(glGetUniformLocation, shaderProgramCollection[lastProgram], "opacity"), 
+			currentVAO.meshInfo->mesh.opacity
+		);
+
+		DrawMesh(currentVAO, shaderProgram);
+	}
+	currentVAOToRender = {};
+
+	GLSafeExecute(glDisable, GL_BLEND);
+	GLSafeExecute(glDepthMask, GL_TRUE);
+}
+
+void LGL::CompositeTransparent()
+{
+	ProfileGPUZone("TransparentComposite");
+
+	auto compositeProgram = shaderProgramCollection.find("oitComposite");
+
+	if (!transparentMeshesPresent || !sceneTarget.fboId || compositeProgram == shaderProgramCollection.end())
+	{
+		return;
+	}
+
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, sceneTarget.fboId);
+	GLSafeExecute(glViewport, 0, 0, renderStats.renderWidth, renderStats.renderHeight);
+
+	bool depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
+	GLSafeExecute(glDisable, GL_DEPTH_TEST);
+
+	// Result is averaged color over the opaque scene, weighted by revealage
+	GLSafeExecute(glEnable, GL_BLEND);
+	GLSafeExecute(glBlendFunc, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+	ShaderProgram program = compositeProgram->second;
+	lastProgram = compositeProgram->first;
+	GLSafeExecute(glUseProgram, program);
+
+	GLSafeExecute(glActiveTexture, GL_TEXTURE0);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, renderGraph.GetResource("oitAccum"));
+	GLSafeExecute(glActiveTexture, GL_TEXTURE1);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, renderGraph.GetResource("oitWeight"));
+
+	GLSafeExecute(glUniform1i, GLExecute(glGetUniformLocation, program, "accumTexture"), 0);
+	GLSafeExecute(glUniform1i, GLExecute(glGetUniformLocation, program, "weightTexture"), 1);
+
+	DrawFullscreenTriangle();
+
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+	GLSafeExecute(glActiveTexture, GL_TEXTURE0);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+
+	GLSafeExecute(glDisable, GL_BLEND);
+
+	if (depthTestEnabled)
+	{
+		GLSafeExecute(glEnable, GL_DEPTH_TEST);
+	}
+}
+
+void LGL::RenderShadowMaps()
+{
+	ProfileGPUZone("Shadows");
+
+	auto depthProgram = shaderProgramCollection.find("shadowDepth");
+
+	if (shadowMapCollection.empty() || depthProgram == shaderProgramCollection.end())
+	{
+		return;
+	}
+
+	bool hasDynamicCasters = std::any_of(VAOCollection.begin(), VAOCollection.end(),
+		[](const VAOInfo& vaoInfo) { return vaoInfo.meshInfo->render && vaoInfo.meshInfo->isDynamic; }
+	);
+
+	shadowPassActive = true;
+
+	lastProgram = depthProgram->first;
+	GLSafeExecute(glUseProgram, depthProgram->second);
+	int lightSpaceLocation = GLExecute(glGetUniformLocation, depthProgram->second, "lightSpace");
+
+	size_t staticUpdates = 0;
+	size_t dynamicUpdates = 0;
+
+	for (auto& shadowMapPair : shadowMapCollection)
+	{
+		ShadowMapInfo& shadowMap = shadowMapPair.second;
+		size_t faceAmount = shadowMap.isCube ? 6 : 1;
+
+		if (shadowMap.lightSpaceMatrices.size() != faceAmount)
+		{
+			continue;
+		}
+
+		GLSafeExecute(glViewport, 0, 0, shadowMap.size, shadowMap.size);
+
+		if (shadowMap.staticDirty)
+		{
+			for (size_t face = 0; face < faceAmount; ++face)
+			{
+				AttachShadowFace(shadowMap.staticFBOId, shadowMap.staticDepthId, shadowMap.isCube, static_cast<int>(face));
+				GLSafeExecute(glClear, GL_DEPTH_BUFFER_BIT);
+				GLSafeExecute(glUniformMatrix4fv, lightSpaceLocation, 1, GL_FALSE, glm::value_ptr(shadowMap.lightSpaceMatrices[face]));
+
+				DrawShadowCasters(false);
+			}
+
+			shadowMap.staticDirty = false;
+			staticUpdates += faceAmount;
+		}
+
+		// Without dynamic casters the cached static depth is sampled directly
+		shadowMap.sampledDepthId = hasDynamicCasters ? shadowMap.depthId : shadowMap.staticDepthId;
+
+		if (!hasDynamicCasters)
+		{
+			continue;
+		}
+
+		for (size_t face = 0; face < faceAmount; ++face)
+		{
+			AttachShadowFace(shadowMap.staticFBOId, shadowMap.staticDepthId, shadowMap.isCube, static_cast<int>(face));
+			AttachShadowFace(shadowMap.FBOId, shadowMap.depthId, shadowMap.isCube, static_cast<int>(face));
+
+			GLSafeExecute(glBindFramebuffer, GL_READ_FRAMEBUFFER, shadowMap.staticFBOId);
+			GLSafeExecute(glBindFramebuffer, GL_DRAW_FRAMEBUFFER, shadowMap.FBOId);
+			GLSafeExecute(
+				glBlitFramebuffer, 
+				0, 0, shadowMap.size, shadowMap.size, 
+				0, 0, shadowMap.size, shadowMap.size, 
+				GL_DEPTH_BUFFER_BIT, GL_NEAREST
+			);
+			GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, shadowMap.FBOId);
+
+			GLSafeExecute(glUniformMatrix4fv, lightSpaceLocation, 1, GL_FALSE, glm::value_ptr(shadowMap.lightSpaceMatrices[face]));
+
+			DrawShadowCasters(true);
+		}
+
+		dynamicUpdates += faceAmount;
+	}
+
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+
+	shadowPassActive = false;
+
+	std::lock_guard<std::mutex> lock(renderStatsMutex);
+	renderStats.staticShadowUpdates += staticUpdates;
+	renderStats.dynamicShadowUpdates += dynamicUpdates;
+}
+
+void LGL::DrawShadowCasters(bool dynamicCasters)
+{
+	for (auto& currentVAO : VAOCollection)
+	{
+		// Transparent meshes do not cast shadows
+		if (!currentVAO.meshInfo->render || currentVAO.meshInfo->isTransparent || 
+			currentVAO.meshInfo->isDynamic != dynamicCasters)
+		{
+			continue;
+		}
+
+		currentVAOToRender = currentVAO;
+
+		if (!memoryBudget.IsResident(LGLMemoryBudget::ObjectType::VertexArray, currentVAO.vboId))
+		{
+			RestoreMesh(currentVAO.vboId);
+		}
+		memoryBudget.Touch(LGLMemoryBudget::ObjectType::VertexArray, currentVAO.vboId, renderStats.frameCount);
+
+		GLSafeExecute(glBindVertexArray, currentVAO.vboId);
+
+		std::function<void()> behaviourToCheck = currentVAO.meshInfo->behaviour;
+		if (behaviourToCheck)
+		{
+			behaviourToCheck();
+		}
+
+		Render();
+	}
+
+	currentVAOToRender = {};
+}
+
+void LGL::AttachShadowFace(FBO fboId, TextureID textureId, bool isCube, int face)
+{
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, fboId);
+	GLSafeExecute(
+		glFramebufferTexture2D, 
+		GL_FRAMEBUFFER, 
+		GL_DEPTH_ATTACHMENT, 
+		isCube ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D, 
+		textureId, 
+		0
+	);
+}
+
+void LGL::RunRenderingCycle(std::function<void()> additionalSteps)
+{
+#ifdef LGL_PROFILER
+	LGLProfiler::SetThreadName("Render");
+#endif
+
+	while (!glfwWindowShouldClose(window))
+	{
+		// Zones of the previous frame are closed by now
+		LGLProfiler::Collect();
+
+		ContextLock
+
+		ProfileZone("Frame");
+
+		auto frameStart = std::chrono::steady_clock::now();
+
+		UpdateCommandCapture();
+
+#ifdef LGL_PROFILER
+		ResolveGPUZones();
+#endif
+
+		ProcessInput();
+
+		BeginFrameTimer();
+
+		if (additionalSteps)
+		{
+			ProfileZone("AdditionalSteps");
+			additionalSteps();
+		}
+
+		int outputWidth = 0;
+		int outputHeight = 0;
+		glfwGetFramebufferSize(window, &outputWidth, &outputHeight);
+
+		{
+			ProfileGPUZone("RenderGraph");
+			renderGraph.Execute(renderGraphAllocator, outputWidth, outputHeight);
+		}
+
+		EndFrameTimer();
+		UpdateResolutionScale();
+
+		if (memoryBudget.GetBudget())
+		{
+			EvictResources();
+		}
+
+		{
+			std::chrono::duration<float, std::milli> cpuFrameTime = std::chrono::steady_clock::now() - frameStart;
+
+			std::lock_guard<std::mutex> lock(renderStatsMutex);
+			renderStats.cpuFrameTimeMs = cpuFrameTime.count();
+			++renderStats.frameCount;
+			renderStats.instancesSubmitted = frameInstancesSubmitted;
+			renderStats.instancesVisible = frameInstancesVisible;
+			renderStats.meshletsSubmitted = frameMeshletsSubmitted;
+			renderStats.meshletsVisible = frameMeshletsVisible;
+			renderStats.instanceTriangles = frameInstanceTriangles;
+		}
+
+		frameInstancesSubmitted = 0;
+		frameInstancesVisible = 0;
+		frameMeshletsSubmitted = 0;
+		frameMeshletsVisible = 0;
+		frameInstanceTriangles = 0;
+
+		if (LGLCommandRecorder::IsRecording())
+		{
+			LGLCommandRecorder::EndFrame(outputWidth, outputHeight);
+		}
+
+		ProfileZone("Swap");
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+}
+
+void LGL::StopRenderingCycle()
+{
+	ContextLock
+
+	glfwSetWindowShouldClose(window, true);
+}
+
+void LGL::ExecuteBetweenFrames(const std::function<void()>& steps)
+{
+	// Rendering cycle holds the context for the whole frame
+	ContextLock
+
+	steps();
+}
+
+void LGL::SetStaticBackgroundColor(const glm::vec4& rgba)
+{
+	background = rgba;
+}
+
+void LGL::SetDynamicResolution(const DynamicResolutionConfig& config)
+{
+	ContextLock
+
+	dynResConfig = config;
+	dynResConfig.minScale = std::min(std::max(config.minScale, 0.1f), 1.0f);
+	dynResConfig.maxScale = std::min(std::max(config.maxScale, dynResConfig.minScale), 2.0f);
+
+	if (dynResConfig.enabled && dynResConfig.upscaleMode == DynamicResolutionConfig::UpscaleMode::Sharpen)
+	{
+		if (!LoadAndCompileShader("upscaleSharpen"))
+		{
+			std::cout << "Sharpen upscale is unavailable, falling back to bilinear\n";
+			dynResConfig.upscaleMode = DynamicResolutionConfig::UpscaleMode::Bilinear;
+		}
+	}
+
+	if (!dynResConfig.enabled)
+	{
+		DeleteSceneTarget();
+	}
+
+	DeclareTransparencyTargets();
+
+	{
+		std::lock_guard<std::mutex> lock(renderStatsMutex);
+		renderStats.resolutionScale = dynResConfig.enabled ? dynResConfig.maxScale : 1.0f;
+	}
+
+	std::cout << "Dynamic resolution " << (dynResConfig.enabled ? "enabled" : "disabled") << '\n';
+}
+
+RenderStats LGL::GetRenderStats()
+{
+	std::lock_guard<std::mutex> lock(renderStatsMutex);
+
+	return renderStats;
+}
+
+bool LGL::IsNullBackend()
+{
+#ifdef LGL_NULL_BACKEND
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool LGL::IsSoftwareBackend()
+{
+#ifdef LGL_SOFTWARE_BACKEND
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::map<std::string, size_t> LGL::GetBackendCallCounts()
+{
+	ContextLock
+
+#ifdef LGL_NULL_BACKEND
+	auto& callCounts = LGLNullBackend::GetCallCounts();
+
+	return std::map<std::string, size_t>(callCounts.begin(), callCounts.end());
+#else
+	return {};
+#endif
+}
+
+void LGL::ResetBackendCallCounts()
+{
+	ContextLock
+
+#ifdef LGL_NULL_BACKEND
+	LGLNullBackend::GetCallCounts().clear();
+#endif
+}
+
+bool LGL::ResizeSceneTarget(int width, int height)
+{
+	DeleteSceneTarget();
+
+	sceneTarget.width = width;
+	sceneTarget.height = height;
+
+	GLSafeExecute(glGenFramebuffers, 1, &sceneTarget.fboId);
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, sceneTarget.fboId);
+
+	GLSafeExecute(glGenTextures, 1, &sceneTarget.colorId);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, sceneTarget.colorId);
+	GLSafeExecute(glTexImage2D, GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLSafeExecute(glFramebufferTexture2D, GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneTarget.colorId, 0);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+
+	// Depth is a texture so passes after the scene can attach it to their own framebuffers
+	GLSafeExecute(glGenTextures, 1, &sceneTarget.depthId);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, sceneTarget.depthId);
+	GLSafeExecute(
+		glTexImage2D, GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr
+	);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	GLSafeExecute(glFramebufferTexture2D, GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, sceneTarget.depthId, 0);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+
+	size_t targetSize = static_cast<size_t>(width) * height * 4;
+	memoryBudget.Track(LGLMemoryBudget::ObjectType::Texture, sceneTarget.colorId, LGLMemoryBudget::Category::RenderTarget, targetSize);
+	memoryBudget.Track(LGLMemoryBudget::ObjectType::Texture, sceneTarget.depthId, LGLMemoryBudget::Category::RenderTarget, targetSize);
+
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+
+	if (!complete)
+	{
+		std::cout << "Scene target is incomplete\n";
+		DeleteSceneTarget();
+		return false;
+	}
+
+	std::cout << "Scene target " << width << 'x' << height << " created\n";
+
+	return true;
+}
+
+void LGL::DeleteSceneTarget()
+{
+	if (sceneTarget.fboId)
+	{
+		GLSafeExecute(glDeleteFramebuffers, 1, &sceneTarget.fboId);
+	}
+	if (sceneTarget.colorId)
+	{
+		DeleteCachedFramebuffers(sceneTarget.colorId);
+		memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Texture, sceneTarget.colorId);
+		GLSafeExecute(glDeleteTextures, 1, &sceneTarget.colorId);
+	}
+	if (sceneTarget.depthId)
+	{
+		DeleteCachedFramebuffers(sceneTarget.depthId);
+		memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Texture, sceneTarget.depthId);
+		GLSafeExecute(glDeleteTextures, 1, &sceneTarget.depthId);
+	}
+
+	sceneTarget = {};
+}
+
+void LGL::BeginSceneTarget()
+{
+	int outputWidth = 0;
+	int outputHeight = 0;
+	glfwGetFramebufferSize(window, &outputWidth, &outputHeight);
+
+	float scale = dynResConfig.enabled ? renderStats.resolutionScale : 1.0f;
+	int renderWidth = LGLRenderGraph::GetScaledSize(outputWidth, scale);
+	int renderHeight = LGLRenderGraph::GetScaledSize(outputHeight, scale);
+
+	// Transparency needs scene depth as a texture, so it requires the target as well
+	if (dynResConfig.enabled || transparentMeshesPresent)
+	{
+		// Target is allocated once for the biggest scale, so scale changes do not reallocate
+		float targetScale = dynResConfig.enabled ? dynResConfig.maxScale : 1.0f;
+		int targetWidth = LGLRenderGraph::GetScaledSize(outputWidth, targetScale);
+		int targetHeight = LGLRenderGraph::GetScaledSize(outputHeight, targetScale);
+
+		if (targetWidth != sceneTarget.width || targetHeight != sceneTarget.height)
+		{
+			ResizeSceneTarget(targetWidth, targetHeight);
+		}
+
+		renderWidth = std::min(renderWidth, sceneTarget.width);
+		renderHeight = std::min(renderHeight, sceneTarget.height);
+	}
+	else if (sceneTarget.fboId)
+	{
+		DeleteSceneTarget();
+	}
+
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, sceneTarget.fboId);
+	GLSafeExecute(glViewport, 0, 0, sceneTarget.fboId ? renderWidth : outputWidth, sceneTarget.fboId ? renderHeight : outputHeight);
+
+	std::lock_guard<std::mutex> lock(renderStatsMutex);
+	renderStats.renderWidth = sceneTarget.fboId ? renderWidth : outputWidth;
+	renderStats.renderHeight = sceneTarget.fboId ? renderHeight : outputHeight;
+	renderStats.outputWidth = outputWidth;
+	renderStats.outputHeight = outputHeight;
+}
+
+void LGL::ResolveSceneTarget()
+{
+	ProfileGPUZone("Upscale");
+
+	if (!sceneTarget.fboId)
+	{
+		return;
+	}
+
+	int renderWidth = renderStats.renderWidth;
+	int renderHeight = renderStats.renderHeight;
+	int outputWidth = renderStats.outputWidth;
+	int outputHeight = renderStats.outputHeight;
+
+	auto sharpenProgram = shaderProgramCollection.find("upscaleSharpen");
+
+	if (dynResConfig.upscaleMode == DynamicResolutionConfig::UpscaleMode::Sharpen && 
+		sharpenProgram != shaderProgramCollection.end())
+	{
+		GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+		GLSafeExecute(glViewport, 0, 0, outputWidth, outputHeight);
+
+		bool depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
+		GLSafeExecute(glDisable, GL_DEPTH_TEST);
+
+		ShaderProgram program = sharpenProgram->second;
+		lastProgram = sharpenProgram->first;
+		GLSafeExecute(glUseProgram, program);
+
+		GLSafeExecute(glActiveTexture, GL_TEXTURE0);
+		GLSafeExecute(glBindTexture, GL_TEXTURE_2D, sceneTarget.colorId);
+
+		GLSafeExecute(glUniform1i, GLExecute(glGetUniformLocation, program, "sceneColor"), 0);
+		GLSafeExecute(
+			glUniform2f, 
+			GLExecute(glGetUniformLocation, program, "uvScale"), 
+			static_cast<float>(renderWidth) / sceneTarget.width, 
+			static_cast<float>(renderHeight) / sceneTarget.height
+		);
+		GLSafeExecute(
+			glUniform2f, 
+			GLExecute(glGetUniformLocation, program, "texelSize"), 
+			1.0f / sceneTarget.width, 
+			1.0f / sceneTarget.height
+		);
+		GLSafeExecute(glUniform1f, GLExecute(glGetUniformLocation, program, "sharpness"), dynResConfig.sharpness);
+
+		DrawFullscreenTriangle();
+
+		GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+
+		if (depthTestEnabled)
+		{
+			GLSafeExecute(glEnable, GL_DEPTH_TEST);
+		}
+	}
+	else
+	{
+		GLSafeExecute(glBindFramebuffer, GL_READ_FRAMEBUFFER, sceneTarget.fboId);
+		GLSafeExecute(glBindFramebuffer, GL_DRAW_FRAMEBUFFER, 0);
+		GLSafeExecute(
+			glBlitFramebuffer, 
+			0, 0, renderWidth, renderHeight, 
+			0, 0, outputWidth, outputHeight, 
+			GL_COLOR_BUFFER_BIT, GL_LINEAR
+		);
+		GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+		GLSafeExecute(glViewport, 0, 0, outputWidth, outputHeight);
+	}
+}
+
+void LGL::BeginFrameTimer()
+{
+	if (!frameTimerQueries[0])
+	{
+		GLSafeExecute(glGenQueries, static_cast<int>(frameTimerQueries.size()), frameTimerQueries.data());
+	}
+
+	Query query = frameTimerQueries[frameTimerIndex % frameTimerQueryAmount];
+
+	// The slot is reused, so the result it holds was issued frameTimerQueryAmount frames ago
+	if (frameTimerIndex >= frameTimerQueryAmount)
+	{
+		int available = 0;
+		GLSafeExecute(glGetQueryObjectiv, query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available)
+		{
+			GLuint64 elapsed = 0;
+			GLSafeExecute(glGetQueryObjectui64v, query, GL_QUERY_RESULT, &elapsed);
+
+			float gpuFrameTimeMs = static_cast<float>(elapsed) / 1000000.0f;
+
+			std::lock_guard<std::mutex> lock(renderStatsMutex);
+			renderStats.gpuFrameTimeMs = renderStats.gpuFrameTimeMs > 0.0f ?
+				renderStats.gpuFrameTimeMs + (gpuFrameTimeMs - renderStats.gpuFrameTimeMs) * frameTimeSmoothing :
+				gpuFrameTimeMs;
+		}
+	}
+
+	GLSafeExecute(glBeginQuery, GL_TIME_ELAPSED, query);
+}
+
+void LGL::EndFrameTimer()
+{
+	GLSafeExecute(glEndQuery, GL_TIME_ELAPSED);
+	++frameTimerIndex;
+}
+
+LGL::ScopedGPUZone::ScopedGPUZone(LGL& lgl, const char* name) : lgl(lgl), zoneIndex(lgl.BeginGPUZone(name)) {}
+
+LGL::ScopedGPUZone::~ScopedGPUZone()
+{
+	lgl.EndGPUZone(zoneIndex);
+}
+
+size_t LGL::BeginGPUZone(const char* name)
+{
+	if (!LGLProfiler::IsCapturing())
+	{
+		return static_cast<size_t>(-1);
+	}
+
+	GPUProfileFrame& frame = gpuProfileFrames[gpuProfileFrameIndex % gpuProfileLatency];
+
+	if (frame.usedQueries + 2 > frame.queries.size())
+	{
+		frame.queries.resize(frame.queries.size() + 2);
+		GLSafeExecute(glGenQueries, 2, &frame.queries[frame.queries.size() - 2]);
+	}
+
+	GPUZone zone = { name, frame.queries[frame.usedQueries], frame.queries[frame.usedQueries + 1] };
+	frame.usedQueries += 2;
+	frame.zones.push_back(zone);
+
+	GLSafeExecute(glQueryCounter, zone.start, GL_TIMESTAMP);
+
+	return frame.zones.size() - 1;
+}
+
+void LGL::EndGPUZone(size_t zoneIndex)
+{
+	if (zoneIndex == static_cast<size_t>(-1))
+	{
+		return;
+	}
+
+	GLSafeExecute(glQueryCounter, gpuProfileFrames[gpuProfileFrameIndex % gpuProfileLatency].zones[zoneIndex].end, GL_TIMESTAMP);
+}
+
+void LGL::ResolveGPUZones()
+{
+	++gpuProfileFrameIndex;
+
+	// The slot is reused, so its zones were issued gpuProfileLatency frames ago
+	GPUProfileFrame& frame = gpuProfileFrames[gpuProfileFrameIndex % gpuProfileLatency];
+
+	if (frame.zones.empty())
+	{
+		return;
+	}
+
+	// GPU clock has its own origin, current GL time is taken as current CPU time
+	GLint64 gpuNow = 0;
+	GLSafeExecute(glGetInteger64v, GL_TIMESTAMP, &gpuNow);
+	int64_t clockOffset = static_cast<int64_t>(LGLProfiler::Now()) - gpuNow;
+
+	for (const GPUZone& zone : frame.zones)
+	{
+		int available = 0;
+		GLSafeExecute(glGetQueryObjectiv, zone.end, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available || !LGLProfiler::IsCapturing())
+		{
+			continue;
+		}
+
+		GLuint64 start = 0;
+		GLuint64 end = 0;
+		GLSafeExecute(glGetQueryObjectui64v, zone.start, GL_QUERY_RESULT, &start);
+		GLSafeExecute(glGetQueryObjectui64v, zone.end, GL_QUERY_RESULT, &end);
+
+		LGLProfiler::WriteGPUZone(
+			zone.name, 
+			static_cast<uint64_t>(static_cast<int64_t>(start) + clockOffset), 
+			static_cast<uint64_t>(static_cast<int64_t>(std::max(start, end)) + clockOffset)
+		);
+	}
+
+	frame.zones.clear();
+	frame.usedQueries = 0;
+}
+
+void LGL::UpdateResolutionScale()
+{
+	std::lock_guard<std::mutex> lock(renderStatsMutex);
+
+	if (!dynResConfig.enabled || renderStats.gpuFrameTimeMs <= 0.0f)
+	{
+		return;
+	}
+
+	// Pixel amount grows with the square of the scale, so the correction is a square root
+	float correction = std::sqrt(dynResConfig.targetFrameTimeMs / renderStats.gpuFrameTimeMs);
+
+	if (std::abs(1.0f - correction) < dynResDeadZone)
+	{
+		return;
+	}
+
+	// Only part of the way per frame, GPU time arrives a few frames late and would overshoot
+	float scale = renderStats.resolutionScale * (1.0f + (correction - 1.0f) * dynResAdjustRate);
+	renderStats.resolutionScale = std::min(std::max(scale, dynResConfig.minScale), dynResConfig.maxScale);
+}
+
+void LGL::AddRenderPass(
+	const std::string& name,
+	const std::vector<std::string>& reads,
+	const std::vector<std::string>& writes,
+	std::function<void()> execute,
+	bool hasSideEffects
+)
+{
+	ContextLock
+
+	renderGraph.AddPass(name, reads, writes, execute, hasSideEffects);
+
+	std::cout << "Render pass " << name << " added\n";
+}
+
+bool LGL::RemoveRenderPass(const std::string& name)
+{
+	ContextLock
+
+	return renderGraph.RemovePass(name);
+}
+
+void LGL::DeclareRenderTarget(const std::string& name, const RenderResourceDesc& desc)
+{
+	ContextLock
+
+	renderGraph.DeclareTransient(name, desc);
+}
+
+unsigned int LGL::GetRenderResource(const std::string& name)
+{
+	return renderGraph.GetResource(name);
+}
+
+bool LGL::BindRenderTargets(const std::vector<std::string>& colorNames, const std::string& depthName)
+{
+	ContextLock
+
+	std::vector<TextureID> attachments;
+	for (auto& colorName : colorNames)
+	{
+		attachments.push_back(renderGraph.GetResource(colorName));
+	}
+	attachments.push_back(depthName.empty() ? 0 : renderGraph.GetResource(depthName));
+
+	auto framebufferIter = framebufferCache.find(attachments);
+
+	if (framebufferIter == framebufferCache.end())
+	{
+		FBO newFBO = 0;
+		GLSafeExecute(glGenFramebuffers, 1, &newFBO);
+		GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, newFBO);
+
+		std::vector<GLenum> drawBuffers;
+		for (size_t i = 0; i < colorNames.size(); ++i)
+		{
+			drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+			GLSafeExecute(glFramebufferTexture2D, GL_FRAMEBUFFER, drawBuffers.back(), GL_TEXTURE_2D, attachments[i], 0);
+		}
+		if (attachments.back())
+		{
+			GLSafeExecute(glFramebufferTexture2D, GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, attachments.back(), 0);
+		}
+
+		if (drawBuffers.empty())
+		{
+			GLSafeExecute(glDrawBuffer, GL_NONE);
+			GLSafeExecute(glReadBuffer, GL_NONE);
+		}
+		else
+		{
+			GLSafeExecute(glDrawBuffers, static_cast<int>(drawBuffers.size()), drawBuffers.data());
+		}
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "[ERROR] Render targets could not be bound, framebuffer is incomplete\n";
+			GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+			GLSafeExecute(glDeleteFramebuffers, 1, &newFBO);
+			return false;
+		}
+
+		framebufferIter = framebufferCache.emplace(attachments, newFBO).first;
+	}
+	else
+	{
+		GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, framebufferIter->second);
+	}
+
+	int width = 0;
+	int height = 0;
+	renderGraph.GetResourceSize(colorNames.empty() ? depthName : colorNames.front(), width, height);
+	GLSafeExecute(glViewport, 0, 0, width, height);
+
+	return true;
+}
+
+LGLRenderGraph::Stats LGL::GetRenderGraphStats()
+{
+	ContextLock
+
+	return renderGraph.GetStats();
+}
+
+bool LGL::CreateShadowMap(const std::string& name, int size, bool isCube)
+{
+	ContextLock
+
+	if (shadowMapCollection.find(name) != shadowMapCollection.end())
+	{
+		return true;
+	}
+
+	if (!LoadAndCompileShader("shadowDepth"))
+	{
+		std::cout << "[ERROR] shadowDepth shader program is required for shadow maps\n";
+		return false;
+	}
+
+	// Units of deleted shadow maps are reused, lowest first
+	int textureUnit = static_cast<int>(Texture::GetTextureTypeAmount());
+	while (std::any_of(shadowMapCollection.begin(), shadowMapCollection.end(),
+		[textureUnit](const auto& shadowMapPair) { return shadowMapPair.second.textureUnit == textureUnit; }))
+	{
+		++textureUnit;
+	}
+
+	ShadowMapInfo& shadowMap = shadowMapCollection[name];
+	shadowMap.size = size;
+	shadowMap.isCube = isCube;
+	shadowMap.textureUnit = textureUnit;
+
+	GLenum target = isCube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+
+	for (TextureID* depthId : { &shadowMap.staticDepthId, &shadowMap.depthId })
+	{
+		GLSafeExecute(glGenTextures, 1, depthId);
+		GLSafeExecute(glBindTexture, target, *depthId);
+
+		for (int face = 0; face < (isCube ? 6 : 1); ++face)
+		{
+			GLSafeExecute(
+				glTexImage2D,
+				isCube ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D,
+				0,
+				GL_DEPTH_COMPONENT24,
+				size,
+				size,
+				0,
+				GL_DEPTH_COMPONENT,
+				GL_UNSIGNED_INT,
+				nullptr
+			);
+		}
+
+		// Compare mode gives hardware filtered lookups through shadow samplers
+		GLSafeExecute(glTexParameteri, target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		GLSafeExecute(glTexParameteri, target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		GLSafeExecute(glTexParameteri, target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		GLSafeExecute(glTexParameteri, target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GLSafeExecute(glTexParameteri, target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		GLSafeExecute(glTexParameteri, target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		GLSafeExecute(glTexParameteri, target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+		memoryBudget.Track(
+			LGLMemoryBudget::ObjectType::Texture, 
+			*depthId, 
+			LGLMemoryBudget::Category::RenderTarget, 
+			static_cast<size_t>(size) * size * 4 * (isCube ? 6 : 1)
+		);
+	}
+	GLSafeExecute(glBindTexture, target, 0);
+
+	shadowMap.sampledDepthId = shadowMap.staticDepthId;
+
+	for (FBO* fboId : { &shadowMap.staticFBOId, &shadowMap.FBOId })
+	{
+		GLSafeExecute(glGenFramebuffers, 1, fboId);
+		GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, *fboId);
+		GLSafeExecute(glDrawBuffer, GL_NONE);
+		GLSafeExecute(glReadBuffer, GL_NONE);
+	}
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+
+	std::cout << "Shadow map " << name << ' ' << size << 'x' << size << (isCube ? " cube" : "") << " created\n";
+
+	return true;
+}
+
+void LGL::DeleteShadowMap(const std::string& name)
+{
+	ContextLock
+
+	auto shadowMapIter = shadowMapCollection.find(name);
+
+	if (shadowMapIter == shadowMapCollection.end())
+	{
+		return;
+	}
+
+	DeleteShadowMapObjects(shadowMapIter->second);
+	shadowMapCollection.erase(shadowMapIter);
+
+	std::cout << "Shadow map " << name << " deleted\n";
+}
+
+void LGL::DeleteShadowMapObjects(ShadowMapInfo& shadowMap)
+{
+	GLSafeExecute(glDeleteFramebuffers, 1, &shadowMap.staticFBOId);
+	GLSafeExecute(glDeleteFramebuffers, 1, &shadowMap.FBOId);
+
+	for (TextureID depthId : { shadowMap.staticDepthId, shadowMap.depthId })
+	{
+		memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Texture, depthId);
+		GLSafeExecute(glDeleteTextures, 1, &depthId);
+	}
+
+	shadowMap = {};
+}
+
+void LGL::SetShadowMapView(const std::string& name, const std::vector<glm::mat4>& lightSpaceMatrices)
+{
+	ContextLock
+
+	auto shadowMapIter = shadowMapCollection.find(name);
+
+	if (shadowMapIter == shadowMapCollection.end())
+	{
+		return;
+	}
+
+	ShadowMapInfo& shadowMap = shadowMapIter->second;
+
+	if (shadowMap.lightSpaceMatrices != lightSpaceMatrices)
+	{
+		shadowMap.lightSpaceMatrices = lightSpaceMatrices;
+		shadowMap.staticDirty = true;
+	}
+}
+
+void LGL::InvalidateShadowMaps()
+{
+	ContextLock
+
+	for (auto& shadowMap : shadowMapCollection)
+	{
+		shadowMap.second.staticDirty = true;
+	}
+}
+
+void LGL::InvalidateShadowMap(const std::string& name)
+{
+	ContextLock
+
+	auto shadowMapIter = shadowMapCollection.find(name);
+
+	if (shadowMapIter != shadowMapCollection.end())
+	{
+		shadowMapIter->second.staticDirty = true;
+	}
+}
+
+void LGL::InvalidateShadowMaps(const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	ContextLock
+
+	for (auto& shadowMapPair : shadowMapCollection)
+	{
+		ShadowMapInfo& shadowMap = shadowMapPair.second;
+
+		if (shadowMap.staticDirty)
+		{
+			continue;
+		}
+
+		for (const glm::mat4& lightSpace : shadowMap.lightSpaceMatrices)
+		{
+			std::array<glm::vec4, 6> planes = ExtractFrustumPlanes(lightSpace);
+
+			// Box is outside if its corner furthest along the plane normal is behind the plane
+			bool outside = std::any_of(planes.begin(), planes.end(),
+				[&boxMin, &boxMax](const glm::vec4& plane)
+				{
+					glm::vec3 corner = glm::mix(boxMin, boxMax, glm::greaterThan(glm::vec3(plane), glm::vec3(0.0f)));
+					return glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f;
+				}
+			);
+
+			if (!outside)
+			{
+				shadowMap.staticDirty = true;
+				break;
+			}
+		}
+	}
+}
+
+int LGL::GetShadowMapTextureUnit(const std::string& name)
+{
+	ContextLock
+
+	auto shadowMapIter = shadowMapCollection.find(name);
+
+	return shadowMapIter != shadowMapCollection.end() ? 
+		shadowMapIter->second.textureUnit : 
+		static_cast<int>(Texture::GetTextureTypeAmount());
+}
+
+bool LGL::IsShadowPass()
+{
+	return shadowPassActive;
+}
+
+void LGL::RenderInstances(const std::vector<glm::mat4>& modelMatrices, LGLStructs::InstanceCulling culling)
+{
+	instanceTransforms.resize(modelMatrices.size());
+
+	for (size_t instance = 0; instance < modelMatrices.size(); ++instance)
+	{
+		const glm::mat4& model = modelMatrices[instance];
+		instanceTransforms[instance] = { model, glm::transpose(glm::inverse(glm::mat3(model))) };
+	}
+
+	RenderInstanceTransforms(culling);
+}
+
+void LGL::RenderInstances(
+	const std::vector<glm::mat4>& modelMatrices, 
+	const std::vector<glm::mat3>& normalMatrices, 
+	LGLStructs::InstanceCulling culling
+)
+{
+	if (modelMatrices.size() != normalMatrices.size())
+	{
+		std::cout << "[ERROR] RenderInstances needs a normal matrix for every model matrix\n";
+		return;
+	}
+
+	instanceTransforms.resize(modelMatrices.size());
+
+	for (size_t instance = 0; instance < modelMatrices.size(); ++instance)
+	{
+		instanceTransforms[instance] = { modelMatrices[instance], normalMatrices[instance] };
+	}
+
+	RenderInstanceTransforms(culling);
+}
+
+void LGL::RenderInstanceTransforms(LGLStructs::InstanceCulling culling)
+{
+	ProfileGPUZone("RenderInstances");
+
+	if (!currentVAOToRender.vboId)
+	{
+		std::cout << "[ERROR] RenderInstances has to be called inside of a behaviour\n";
+		return;
+	}
+
+	VAOInfo vaoInfo = currentVAOToRender;
+
+	// Mesh is drawn here, Render after the behaviour has nothing left to do
+	currentVAOToRender = {};
+
+	if (instanceTransforms.empty())
+	{
+		return;
+	}
+
+	size_t instanceAmount = instanceTransforms.size();
+	InstanceBuffers& instanceBuffers = GetInstanceBuffers(vaoInfo.vboId, instanceAmount);
+
+	// Instances are uploaded grouped by LOD, each group is culled and drawn as a range of them
+	auto lodIter = lodCollection.find(vaoInfo.vboId);
+	const InstanceTransform* sourceInstances = instanceTransforms.data();
+
+	// LODs are picked for the camera, shadow casters keep the base mesh
+	if (lodIter != lodCollection.end() && cullingViewSet && lodMaxPixelError > 0.0f && !shadowPassActive)
+	{
+		SortInstancesByLOD(vaoInfo, lodIter->second, instanceTransforms);
+		sourceInstances = lodSortedInstances.data();
+	}
+	else
+	{
+		lodInstanceAmounts.assign(1, instanceAmount);
+	}
+
+	// Orphaning the previous storage, so upload does not wait for the last frame draws
+	GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, instanceBuffers.sourceId);
+	GLSafeExecute(glBufferData, GL_ARRAY_BUFFER, instanceBuffers.capacity * sizeof(InstanceTransform), nullptr, GL_STREAM_DRAW);
+	GLSafeExecute(glBufferSubData, GL_ARRAY_BUFFER, 0, instanceAmount * sizeof(InstanceTransform), sourceInstances);
+
+	int instancedLocation = GLExecute(glGetUniformLocation, shaderProgramCollection[lastProgram], "instanced");
+	GLSafeExecute(glUniform1i, instancedLocation, 1);
+
+	bool cullMeshlets = culling != LGLStructs::InstanceCulling::None && cullingViewSet;
+	bool cullInstances = culling == LGLStructs::InstanceCulling::All && cullingViewSet && 
+		vaoInfo.boundingSphere.w > 0.0f && PrepareInstanceCulling();
+
+	// Few instances of the base mesh are drawn one by one with meshlet culling instead
+	auto meshletIter = meshletCollection.find(vaoInfo.vboId);
+	bool meshletInstances = meshletIter != meshletCollection.end() && cullMeshlets && 
+		(meshletFrustumCulling || meshletConeCulling) && lodInstanceAmounts[0] <= meshletInstanceLimit;
+
+	// All LOD groups are culled in one pass before any of them is drawn
+	if (cullInstances)
+	{
+		CullInstances(instanceBuffers, meshletInstances ? 1 : 0, vaoInfo.boundingSphere);
+	}
+
+	size_t firstInstance = 0;
+
+	for (size_t lod = 0; lod < lodInstanceAmounts.size(); firstInstance += lodInstanceAmounts[lod++])
+	{
+		size_t lodInstanceAmount = lodInstanceAmounts[lod];
+
+		if (!lodInstanceAmount)
+		{
+			continue;
+		}
+
+		if (!lod && meshletInstances)
+		{
+			RenderMeshletInstances(vaoInfo, meshletIter->second, sourceInstances, lodInstanceAmount, instanceBuffers.sourceId);
+			continue;
+		}
+
+		VBO instanceSource = instanceBuffers.sourceId;
+		size_t sourceOffset = firstInstance;
+		size_t visibleAmount = lodInstanceAmount;
+		size_t drawAmount = lodInstanceAmount;
+
+		if (cullInstances)
+		{
+			const CullGroup& cullGroup = instanceBuffers.cullGroups[lod];
+			visibleAmount = cullGroup.visibleAmountKnown ? std::min(cullGroup.visibleAmount, lodInstanceAmount) : lodInstanceAmount;
+			drawAmount = cullGroup.drawAmount;
+			instanceSource = instanceBuffers.visibleId;
+		}
+
+		size_t indexOffset = lod ? lodIter->second[lod - 1].indexOffset : 0;
+		size_t pointAmount = lod ? lodIter->second[lod - 1].indexAmount : vaoInfo.pointAmount;
+
+		frameInstancesSubmitted += lodInstanceAmount;
+		frameInstancesVisible += visibleAmount;
+		frameInstanceTriangles += visibleAmount * (pointAmount / 3);
+
+		if (!drawAmount)
+		{
+			continue;
+		}
+
+		GLSafeExecute(glBindVertexArray, vaoInfo.vboId);
+		BindInstanceAttributes(instanceSource, sourceOffset);
+
+		if (!vaoInfo.useIndices)
+		{
+			GLSafeExecute(glDrawArraysInstanced, GL_TRIANGLES, 0, static_cast<int>(pointAmount), static_cast<int>(drawAmount));
+		}
+		else
+		{
+			GLSafeExecute(
+				glDrawElementsInstanced, 
+				GL_TRIANGLES, 
+				static_cast<int>(pointAmount), 
+				GL_UNSIGNED_INT, 
+				reinterpret_cast<void*>(indexOffset * sizeof(unsigned int)), 
+				static_cast<int>(drawAmount)
+			);
+		}
+	}
+
+	GLSafeExecute(glUniform1i, instancedLocation, 0);
+
+	uniformLocationTracker.clear();
+}
+
+void LGL::SortInstancesByLOD(const VAOInfo& vaoInfo, const std::vector<LODRange>& lods, const std::vector<InstanceTransform>& instances)
+{
+	// Length of the second row is the vertical projection scale, 1 / tan(fovY / 2) for perspective,
+	// the fourth row gives the view depth, so error * pixelScale / depth is the error in pixels
+	glm::mat4 rows = glm::transpose(cullingViewProj);
+	float pixelScale = glm::length(glm::vec3(rows[1])) * std::max(renderStats.renderHeight, 1) * 0.5f;
+
+	lodInstanceAmounts.assign(lods.size() + 1, 0);
+	instanceLODs.resize(instances.size());
+
+	for (size_t instance = 0; instance < instances.size(); ++instance)
+	{
+		const glm::mat4& model = instances[instance].model;
+
+		float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+		glm::vec4 center = model * glm::vec4(glm::vec3(vaoInfo.boundingSphere), 1.0f);
+		// Nearest point of the bounding sphere, instances the camera is inside of use the base mesh
+		float depth = glm::dot(rows[3], center) - vaoInfo.boundingSphere.w * scale;
+
+		unsigned char lod = 0;
+
+		if (depth > 0.0f)
+		{
+			float pixelsPerUnit = scale * pixelScale / depth;
+
+			while (lod < lods.size() && lods[lod].error * pixelsPerUnit <= lodMaxPixelError)
+			{
+				++lod;
+			}
+		}
+
+		instanceLODs[instance] = lod;
+		++lodInstanceAmounts[lod];
+	}
+
+	// Counting sort, order of instances within a LOD is kept
+	std::vector<size_t> lodStarts(lodInstanceAmounts.size(), 0);
+	for (size_t lod = 1; lod < lodStarts.size(); ++lod)
+	{
+		lodStarts[lod] = lodStarts[lod - 1] + lodInstanceAmounts[lod - 1];
+	}
+
+	lodSortedInstances.resize(instances.size());
+	for (size_t instance = 0; instance < instances.size(); ++instance)
+	{
+		lodSortedInstances[lodStarts[instanceLODs[instance]]++] = instances[instance];
+	}
+}
+
+void LGL::SetCullingView(const glm::mat4& viewProj, const glm::vec3& viewPos)
+{
+	ContextLock
+
+	cullingPlanes = ExtractFrustumPlanes(viewProj);
+	cullingViewProj = viewProj;
+	cullingViewPos = viewPos;
+	cullingViewSet = true;
+}
+
+void LGL::SetMeshletCulling(bool frustumCulling, bool coneCulling)
+{
+	ContextLock
+
+	meshletFrustumCulling = frustumCulling;
+	meshletConeCulling = coneCulling;
+}
+
+void LGL::SetLODSelection(float maxPixelError)
+{
+	ContextLock
+
+	lodMaxPixelError = maxPixelError;
+}
+
+void LGL::BindInstanceAttributes(VBO instanceSource, size_t firstInstance)
+{
+	GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, instanceSource);
+
+	for (int column = 0; column < 4; ++column)
+	{
+		GLSafeExecute(glEnableVertexAttribArray, instanceAttribLocation + column);
+		GLSafeExecute(
+			glVertexAttribPointer, 
+			instanceAttribLocation + column, 
+			4, 
+			GL_FLOAT, 
+			GL_FALSE, 
+			static_cast<int>(sizeof(InstanceTransform)), 
+			reinterpret_cast<void*>(firstInstance * sizeof(InstanceTransform) + column * sizeof(glm::vec4))
+		);
+		GLSafeExecute(glVertexAttribDivisor, instanceAttribLocation + column, 1);
+	}
+
+	for (int column = 0; column < 3; ++column)
+	{
+		GLSafeExecute(glEnableVertexAttribArray, instanceNormalAttribLocation + column);
+		GLSafeExecute(
+			glVertexAttribPointer, 
+			instanceNormalAttribLocation + column, 
+			3, 
+			GL_FLOAT, 
+			GL_FALSE, 
+			static_cast<int>(sizeof(InstanceTransform)), 
+			reinterpret_cast<void*>(firstInstance * sizeof(InstanceTransform) + offsetof(InstanceTransform, normal) + column * sizeof(glm::vec3))
+		);
+		GLSafeExecute(glVertexAttribDivisor, instanceNormalAttribLocation + column, 1);
+	}
+}
+
+void LGL::RenderMeshletInstances(
+	const VAOInfo& vaoInfo, 
+	const LGLMeshletCuller& meshletCuller, 
+	const InstanceTransform* instances, 
+	size_t instanceAmount,
+	VBO instanceSource
+)
+{
+	GLSafeExecute(glBindVertexArray, vaoInfo.vboId);
+
+	int instancedLocation = GLExecute(glGetUniformLocation, shaderProgramCollection[lastProgram], "instanced");
+	GLSafeExecute(glUniform1i, instancedLocation, 1);
+
+	for (size_t instance = 0; instance < instanceAmount; ++instance)
+	{
+		size_t visibleMeshlets = meshletCuller.Cull(
+			cullingPlanes, 
+			cullingViewPos, 
+			instances[instance].model, 
+			meshletFrustumCulling, 
+			meshletConeCulling, 
+			meshletRanges
+		);
+
+		frameMeshletsSubmitted += meshletCuller.GetMeshletAmount();
+		frameMeshletsVisible += visibleMeshlets;
+		++frameInstancesSubmitted;
+
+		if (!visibleMeshlets)
+		{
+			continue;
+		}
+
+		++frameInstancesVisible;
+
+		for (int count : meshletRanges.counts)
+		{
+			frameInstanceTriangles += count / 3;
+		}
+
+		// Not instanced draw reads attributes with divisor from the first element, which is this instance
+		BindInstanceAttributes(instanceSource, instance);
+
+		GLSafeExecute(
+			glMultiDrawElements, 
+			GL_TRIANGLES, 
+			meshletRanges.counts.data(), 
+			GL_UNSIGNED_INT, 
+			meshletRanges.offsets.data(), 
+			static_cast<int>(meshletRanges.counts.size())
+		);
+	}
+
+	GLSafeExecute(glUniform1i, instancedLocation, 0);
+
+	uniformLocationTracker.clear();
+}
+
+LGL::InstanceBuffers& LGL::GetInstanceBuffers(VAO vaoId, size_t instanceAmount)
+{
+	InstanceBuffers& instanceBuffers = instanceCollection[vaoId];
+
+	if (!instanceBuffers.sourceId)
+	{
+		GLSafeExecute(glGenBuffers, 1, &instanceBuffers.sourceId);
+		GLSafeExecute(glGenBuffers, 1, &instanceBuffers.visibleId);
+
+		// Culling reads transforms of all instances as 4 model matrix and 3 normal matrix attributes,
+		// visible ones are written to the same layout
+		GLSafeExecute(glGenVertexArrays, 1, &instanceBuffers.cullVAO);
+		GLSafeExecute(glBindVertexArray, instanceBuffers.cullVAO);
+		GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, instanceBuffers.sourceId);
+
+		for (int column = 0; column < 7; ++column)
+		{
+			bool normalColumn = column >= 4;
+
+			GLSafeExecute(glEnableVertexAttribArray, column);
+			GLSafeExecute(
+				glVertexAttribPointer, 
+				column, 
+				normalColumn ? 3 : 4, 
+				GL_FLOAT, 
+				GL_FALSE, 
+				static_cast<int>(sizeof(InstanceTransform)), 
+				reinterpret_cast<void*>(normalColumn ? 
+					offsetof(InstanceTransform, normal) + (column - 4) * sizeof(glm::vec3) : 
+					column * sizeof(glm::vec4))
+			);
+		}
+	}
+
+	if (instanceBuffers.capacity < instanceAmount)
+	{
+		// Growing in powers of two, so a slowly growing amount does not reallocate every frame
+		size_t newCapacity = std::max<size_t>(instanceBuffers.capacity, 64);
+		while (newCapacity < instanceAmount)
+		{
+			newCapacity *= 2;
+		}
+		instanceBuffers.capacity = newCapacity;
+
+		GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, instanceBuffers.visibleId);
+		GLSafeExecute(glBufferData, GL_ARRAY_BUFFER, newCapacity * sizeof(InstanceTransform), nullptr, GL_STREAM_COPY);
+
+		// Source is allocated with the same capacity on upload
+		for (VBO bufferId : { instanceBuffers.sourceId, instanceBuffers.visibleId })
+		{
+			memoryBudget.Track(LGLMemoryBudget::ObjectType::Buffer, bufferId, LGLMemoryBudget::Category::Vertex, newCapacity * sizeof(InstanceTransform));
+		}
+	}
+
+	return instanceBuffers;
+}
+
+bool LGL::PrepareInstanceCulling()
+{
+	if (instanceCullLoaded)
+	{
+		return true;
+	}
+
+	if (!LoadAndCompileShader("instanceCull"))
+	{
+		return false;
+	}
+
+	instanceCullProgram = shaderProgramCollection["instanceCull"];
+	cullPlanesLocation = GLExecute(glGetUniformLocation, instanceCullProgram, "frustumPlanes");
+	cullSphereLocation = GLExecute(glGetUniformLocation, instanceCullProgram, "boundingSphere");
+	instanceCullLoaded = true;
+
+	return true;
+}
+
+void LGL::CullInstances(InstanceBuffers& instanceBuffers, size_t firstGroup, const glm::vec4& boundingSphere)
+{
+	// Orphaned and zeroed, so instances past the ones culling writes this frame draw nothing
+	size_t visibleBytes = instanceBuffers.capacity * sizeof(InstanceTransform);
+	if (zeroInstanceData.size() < visibleBytes)
+	{
+		zeroInstanceData.resize(visibleBytes, 0);
+	}
+
+	GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, instanceBuffers.visibleId);
+	GLSafeExecute(glBufferData, GL_ARRAY_BUFFER, visibleBytes, zeroInstanceData.data(), GL_STREAM_COPY);
+
+	if (instanceBuffers.cullGroups.size() < lodInstanceAmounts.size())
+	{
+		instanceBuffers.cullGroups.resize(lodInstanceAmounts.size());
+	}
+
+	GLSafeExecute(glUseProgram, instanceCullProgram);
+	GLSafeExecute(glUniform4fv, cullPlanesLocation, static_cast<int>(cullingPlanes.size()), glm::value_ptr(cullingPlanes[0]));
+	GLSafeExecute(glUniform4fv, cullSphereLocation, 1, glm::value_ptr(boundingSphere));
+
+	GLSafeExecute(glBindVertexArray, instanceBuffers.cullVAO);
+	GLSafeExecute(glEnable, GL_RASTERIZER_DISCARD);
+
+	size_t firstInstance = 0;
+
+	for (size_t group = 0; group < lodInstanceAmounts.size(); firstInstance += lodInstanceAmounts[group++])
+	{
+		size_t instanceAmount = lodInstanceAmounts[group];
+		CullGroup& cullGroup = instanceBuffers.cullGroups[group];
+		cullGroup.drawAmount = 0;
+
+		if (group < firstGroup || !instanceAmount)
+		{
+			continue;
+		}
+
+		if (!cullGroup.visibleQuery)
+		{
+			GLSafeExecute(glGenQueries, 1, &cullGroup.visibleQuery);
+		}
+
+		// Indirect draws need 4.0, so on 3.3 the count of the previous frame is used instead of waiting
+		// for this one. Query is not restarted until its result is read
+		if (cullGroup.queryPending)
+		{
+			unsigned int resultAvailable = GL_FALSE;
+			GLSafeExecute(glGetQueryObjectuiv, cullGroup.visibleQuery, GL_QUERY_RESULT_AVAILABLE, &resultAvailable);
+
+			if (resultAvailable)
+			{
+				unsigned int visibleResult = 0;
+				GLSafeExecute(glGetQueryObjectuiv, cullGroup.visibleQuery, GL_QUERY_RESULT, &visibleResult);
+
+				cullGroup.visibleAmount = visibleResult;
+				cullGroup.visibleAmountKnown = true;
+				cullGroup.queryPending = false;
+			}
+		}
+
+		bool startQuery = !cullGroup.queryPending;
+
+		// Visible instances of the group are packed from its first instance on
+		GLSafeExecute(
+			glBindBufferRange, 
+			GL_TRANSFORM_FEEDBACK_BUFFER, 
+			0, 
+			instanceBuffers.visibleId, 
+			static_cast<GLintptr>(firstInstance * sizeof(InstanceTransform)), 
+			static_cast<GLsizeiptr>(instanceAmount * sizeof(InstanceTransform))
+		);
+
+		if (startQuery)
+		{
+			GLSafeExecute(glBeginQuery, GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, cullGroup.visibleQuery);
+		}
+		GLSafeExecute(glBeginTransformFeedback, GL_POINTS);
+
+		GLSafeExecute(glDrawArrays, GL_POINTS, static_cast<int>(firstInstance), static_cast<int>(instanceAmount));
+
+		GLExecute(glEndTransformFeedback);
+		if (startQuery)
+		{
+			GLSafeExecute(glEndQuery, GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+			cullGroup.queryPending = true;
+		}
+
+		// Headroom covers instances turning visible since the counted frame, zeroed rest draws nothing
+		if (cullGroup.visibleAmountKnown)
+		{
+			size_t headroom = (instanceAmount + cullHeadroomDivisor - 1) / cullHeadroomDivisor;
+			cullGroup.drawAmount = std::min(instanceAmount, cullGroup.visibleAmount + headroom);
+		}
+		else
+		{
+			cullGroup.drawAmount = instanceAmount;
+		}
+	}
+
+	GLSafeExecute(glDisable, GL_RASTERIZER_DISCARD);
+	GLSafeExecute(glBindBufferBase, GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+	GLSafeExecute(glUseProgram, shaderProgramCollection[lastProgram]);
+}
+
+std::array<glm::vec4, 6> LGL::ExtractFrustumPlanes(const glm::mat4& viewProj)
+{
+	// Planes from rows of the matrix, as described by Gribb and Hartmann
+	glm::mat4 rows = glm::transpose(viewProj);
+
+	std::array<glm::vec4, 6> planes
+	{
+		rows[3] + rows[0], rows[3] - rows[0],
+		rows[3] + rows[1], rows[3] - rows[1],
+		rows[3] + rows[2], rows[3] - rows[2]
+	};
+
+	for (auto& plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+	return planes;
+}
+
+void LGL::SetMemoryBudget(size_t budgetBytes, size_t evictAfterFrames)
+{
+	ContextLock
+
+	memoryBudget.SetBudget(budgetBytes);
+	this->evictAfterFrames = evictAfterFrames;
+}
+
+MemoryStats LGL::GetMemoryStats()
+{
+	ContextLock
+
+	using Category = LGLMemoryBudget::Category;
+
+	MemoryStats memoryStats;
+	memoryStats.vertexBytes = memoryBudget.GetTotal(Category::Vertex);
+	memoryStats.indexBytes = memoryBudget.GetTotal(Category::Index);
+	memoryStats.textureBytes = memoryBudget.GetTotal(Category::Texture);
+	memoryStats.renderTargetBytes = memoryBudget.GetTotal(Category::RenderTarget);
+	memoryStats.stagingBytes = memoryBudget.GetTotal(Category::Staging);
+	memoryStats.totalBytes = memoryBudget.GetTotal();
+	memoryStats.budgetBytes = memoryBudget.GetBudget();
+	memoryStats.evictions = evictionCount;
+	memoryStats.reuploads = reuploadCount;
+
+	return memoryStats;
+}
+
+size_t LGL::UploadMeshBuffers(VAO vaoId)
+{
+	const MeshBuffers& meshBuffers = meshBufferCollection[vaoId];
+	const Mesh& mesh = meshBuffers.meshInfo->mesh;
+	GLenum usage = meshBuffers.meshInfo->isDynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+
+	// Element buffer binding is state of the vertex array
+	GLSafeExecute(glBindVertexArray, vaoId);
+
+	size_t vertexSize = mesh.vert.size() * sizeof(Vertex);
+
+	GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, meshBuffers.vertexId);
+	GLSafeExecute(glBufferData, GL_ARRAY_BUFFER, vertexSize, &mesh.vert[0], usage);
+	memoryBudget.Track(LGLMemoryBudget::ObjectType::Buffer, meshBuffers.vertexId, LGLMemoryBudget::Category::Vertex, vertexSize);
+
+	if (!meshBuffers.indexId)
+	{
+		return vertexSize;
+	}
+
+	auto lodIter = lodCollection.find(vaoId);
+	size_t baseSize = mesh.indices.size() * sizeof(unsigned int);
+	size_t indexSize = lodIter == lodCollection.end() ? baseSize :
+		(lodIter->second.back().indexOffset + lodIter->second.back().indexAmount) * sizeof(unsigned int);
+
+	GLSafeExecute(glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, meshBuffers.indexId);
+	GLSafeExecute(
+		glBufferData, 
+		GL_ELEMENT_ARRAY_BUFFER, 
+		indexSize, 
+		lodIter == lodCollection.end() ? &mesh.indices[0] : nullptr, 
+		usage
+	);
+
+	if (lodIter != lodCollection.end())
+	{
+		GLSafeExecute(glBufferSubData, GL_ELEMENT_ARRAY_BUFFER, 0, baseSize, &mesh.indices[0]);
+
+		for (size_t lod = 0; lod < lodIter->second.size(); ++lod)
+		{
+			GLSafeExecute(
+				glBufferSubData, 
+				GL_ELEMENT_ARRAY_BUFFER, 
+				lodIter->second[lod].indexOffset * sizeof(unsigned int), 
+				lodIter->second[lod].indexAmount * sizeof(unsigned int), 
+				&mesh.lods[lod].indices[0]
+			);
+		}
+	}
+
+	memoryBudget.Track(LGLMemoryBudget::ObjectType::Buffer, meshBuffers.indexId, LGLMemoryBudget::Category::Index, indexSize);
+
+	return vertexSize + indexSize;
+}
+
+void LGL::RestoreMesh(VAO vaoId)
+{
+	UploadMeshBuffers(vaoId);
+
+	memoryBudget.SetResident(LGLMemoryBudget::ObjectType::VertexArray, vaoId, true);
+	++reuploadCount;
+}
+
+void LGL::RestoreTexture(TextureID textureId)
+{
+	const TextureCopy& textureCopy = textureCopyCollection[textureId];
+
+	// Copy is tightly packed
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, textureId);
+	GLSafeExecute(glPixelStorei, GL_UNPACK_ALIGNMENT, 1);
+	GLSafeExecute(
+		glTexImage2D, 
+		GL_TEXTURE_2D, 
+		0, 
+		textureCopy.format, 
+		textureCopy.width, 
+		textureCopy.height, 
+		0, 
+		textureCopy.format, 
+		GL_UNSIGNED_BYTE, 
+		textureCopy.data.data()
+	);
+
+	size_t textureSize = textureCopy.data.size();
+
+	if (textureCopy.mipmaps)
+	{
+		GLSafeExecute(glGenerateMipmap, GL_TEXTURE_2D);
+		textureSize += textureSize / 3;
+	}
+
+	memoryBudget.Track(LGLMemoryBudget::ObjectType::Texture, textureId, LGLMemoryBudget::Category::Texture, textureSize);
+	memoryBudget.SetResident(LGLMemoryBudget::ObjectType::Texture, textureId, true);
+	++reuploadCount;
+}
+
+void LGL::EvictResources()
+{
+	ProfileZone("EvictResources");
+
+	memoryBudget.CollectEvictions(renderStats.frameCount, evictAfterFrames, evictions);
+
+	if (evictions.empty())
+	{
+		return;
+	}
+
+	// Storage is released with zero sized data instead of deleting, so names and
+	// vertex array bindings stay valid for the upload on the next draw
+	for (auto& object : evictions)
+	{
+		if (object.first == LGLMemoryBudget::ObjectType::VertexArray)
+		{
+			const MeshBuffers& meshBuffers = meshBufferCollection[object.second];
+
+			GLSafeExecute(glBindVertexArray, object.second);
+
+			GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, meshBuffers.vertexId);
+			GLSafeExecute(glBufferData, GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+			memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Buffer, meshBuffers.vertexId);
+
+			if (meshBuffers.indexId)
+			{
+				GLSafeExecute(glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, meshBuffers.indexId);
+				GLSafeExecute(glBufferData, GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+				memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Buffer, meshBuffers.indexId);
+			}
+		}
+		else
+		{
+			const TextureCopy& textureCopy = textureCopyCollection[object.second];
+
+			int levelAmount = 1;
+			while (textureCopy.mipmaps && std::max(textureCopy.width, textureCopy.height) >> levelAmount)
+			{
+				++levelAmount;
+			}
+
+			GLSafeExecute(glBindTexture, GL_TEXTURE_2D, object.second);
+			for (int level = 0; level < levelAmount; ++level)
+			{
+				GLSafeExecute(glTexImage2D, GL_TEXTURE_2D, level, textureCopy.format, 0, 0, 0, textureCopy.format, GL_UNSIGNED_BYTE, nullptr);
+			}
+
+			memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Texture, object.second);
+		}
+
+		memoryBudget.SetResident(object.first, object.second, false);
+		++evictionCount;
+	}
+
+	GLSafeExecute(glBindVertexArray, 0);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+	GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, 0);
+}
+
+void LGL::SetDebugDraw(bool enabled)
+{
+	ContextLock
+
+	if (debugDrawEnabled == enabled)
+	{
+		return;
+	}
+
+	if (enabled && !LoadAndCompileShader("debugDraw"))
+	{
+		std::cout << "[ERROR] debugDraw shader program is required for debug draw\n";
+		return;
+	}
+
+	debugDrawEnabled = enabled;
+	debugVertices.clear();
+
+	if (enabled)
+	{
+		// Drawn over the composited scene, before it is upscaled into the backbuffer
+		renderGraph.AddPass("DebugDraw", { "sceneColor", "sceneDepth" }, { "sceneColor" }, [this]() { RenderDebugDraw(); });
+	}
+	else
+	{
+		renderGraph.RemovePass("DebugDraw");
+	}
+}
+
+bool LGL::IsDebugDrawEnabled()
+{
+	return debugDrawEnabled;
+}
+
+void LGL::DebugLine(const glm::vec3& from, const glm::vec3& to, const glm::vec3& color)
+{
+	if (!debugDrawEnabled)
+	{
+		return;
+	}
+
+	ContextLock
+
+	AddDebugLine(from, to, PackDebugColor(color));
+}
+
+void LGL::DebugBox(const glm::vec3& min, const glm::vec3& max, const glm::vec3& color)
+{
+	if (!debugDrawEnabled)
+	{
+		return;
+	}
+
+	ContextLock
+
+	std::array<glm::vec3, 8> corners;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		corners[corner] = glm::vec3(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z);
+	}
+
+	AddDebugBoxEdges(corners, PackDebugColor(color));
+}
+
+void LGL::DebugSphere(const glm::vec3& center, float radius, const glm::vec3& color)
+{
+	if (!debugDrawEnabled)
+	{
+		return;
+	}
+
+	ContextLock
+
+	uint32_t packedColor = PackDebugColor(color);
+
+	// One circle around each axis
+	glm::vec2 last(radius, 0.0f);
+	for (int segment = 1; segment <= debugSphereSegments; ++segment)
+	{
+		float angle = glm::two_pi<float>() * segment / debugSphereSegments;
+		glm::vec2 next(radius * std::cos(angle), radius * std::sin(angle));
+
+		AddDebugLine(center + glm::vec3(last.x, last.y, 0.0f), center + glm::vec3(next.x, next.y, 0.0f), packedColor);
+		AddDebugLine(center + glm::vec3(last.x, 0.0f, last.y), center + glm::vec3(next.x, 0.0f, next.y), packedColor);
+		AddDebugLine(center + glm::vec3(0.0f, last.x, last.y), center + glm::vec3(0.0f, next.x, next.y), packedColor);
+
+		last = next;
+	}
+}
+
+void LGL::DebugFrustum(const glm::mat4& viewProj, const glm::vec3& color)
+{
+	if (!debugDrawEnabled)
+	{
+		return;
+	}
+
+	ContextLock
+
+	glm::mat4 inverseViewProj = glm::inverse(viewProj);
+
+	std::array<glm::vec3, 8> corners;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		glm::vec4 clipCorner(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f, 1.0f);
+		glm::vec4 worldCorner = inverseViewProj * clipCorner;
+
+		corners[corner] = glm::vec3(worldCorner) / worldCorner.w;
+	}
+
+	AddDebugBoxEdges(corners, PackDebugColor(color));
+}
+
+void LGL::AddDebugLine(const glm::vec3& from, const glm::vec3& to, uint32_t color)
+{
+	debugVertices.push_back({ from, color });
+	debugVertices.push_back({ to, color });
+}
+
+void LGL::AddDebugBoxEdges(const std::array<glm::vec3, 8>& corners, uint32_t color)
+{
+	// Every corner is connected to the ones that differ from it in a single axis
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		for (int axisBit = 1; axisBit < 8; axisBit <<= 1)
+		{
+			if (!(corner & axisBit))
+			{
+				AddDebugLine(corners[corner], corners[corner | axisBit], color);
+			}
+		}
+	}
+}
+
+uint32_t LGL::PackDebugColor(const glm::vec3& color)
+{
+	glm::uvec3 bytes = glm::uvec3(glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+	return bytes.r | (bytes.g << 8) | (bytes.b << 16) | (0xFFu << 24);
+}
+
+void LGL::RenderDebugDraw()
+{
+	ProfileGPUZone("DebugDraw");
+
+	if (debugVertices.empty() || !cullingViewSet)
+	{
+		debugVertices.clear();
+		return;
+	}
+
+	if (!debugDrawVAO)
+	{
+		GLSafeExecute(glGenVertexArrays, 1, &debugDrawVAO);
+		GLSafeExecute(glGenBuffers, 1, &debugDrawVBO);
+
+		GLSafeExecute(glBindVertexArray, debugDrawVAO);
+		GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, debugDrawVBO);
+
+		GLSafeExecute(glEnableVertexAttribArray, 0);
+		GLSafeExecute(
+			glVertexAttribPointer, 
+			0, 
+			3, 
+			GL_FLOAT, 
+			GL_FALSE, 
+			static_cast<int>(sizeof(DebugVertex)), 
+			reinterpret_cast<void*>(offsetof(DebugVertex, position))
+		);
+		GLSafeExecute(glEnableVertexAttribArray, 1);
+		GLSafeExecute(
+			glVertexAttribPointer, 
+			1, 
+			4, 
+			GL_UNSIGNED_BYTE, 
+			GL_TRUE, 
+			static_cast<int>(sizeof(DebugVertex)), 
+			reinterpret_cast<void*>(offsetof(DebugVertex, color))
+		);
+	}
+	else
+	{
+		GLSafeExecute(glBindVertexArray, debugDrawVAO);
+		GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, debugDrawVBO);
+	}
+
+	// Growing in powers of two, as instance buffers do
+	if (debugDrawCapacity < debugVertices.size())
+	{
+		debugDrawCapacity = std::max<size_t>(debugDrawCapacity, 4096);
+		while (debugDrawCapacity < debugVertices.size())
+		{
+			debugDrawCapacity *= 2;
+		}
+
+		memoryBudget.Track(
+			LGLMemoryBudget::ObjectType::Buffer, 
+			debugDrawVBO, 
+			LGLMemoryBudget::Category::Vertex, 
+			debugDrawCapacity * sizeof(DebugVertex)
+		);
+	}
+
+	// Orphaning the previous storage, so upload does not wait for the last frame draw
+	GLSafeExecute(glBufferData, GL_ARRAY_BUFFER, debugDrawCapacity * sizeof(DebugVertex), nullptr, GL_STREAM_DRAW);
+	GLSafeExecute(glBufferSubData, GL_ARRAY_BUFFER, 0, debugVertices.size() * sizeof(DebugVertex), debugVertices.data());
+
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, sceneTarget.fboId);
+	GLSafeExecute(glViewport, 0, 0, renderStats.renderWidth, renderStats.renderHeight);
+
+	ShaderProgram program = shaderProgramCollection["debugDraw"];
+	lastProgram = "debugDraw";
+	GLSafeExecute(glUseProgram, program);
+	GLSafeExecute(
+		glUniformMatrix4fv, 
+		GLExecute(glGetUniformLocation, program, "viewProj"), 
+		1, 
+		GL_FALSE, 
+		glm::value_ptr(cullingViewProj)
+	);
+
+	GLSafeExecute(glDrawArrays, GL_LINES, 0, static_cast<int>(debugVertices.size()));
+
+	debugVertices.clear();
+}
+
+void LGL::StartCapture(const CaptureCallback& callback, size_t frameInterval)
+{
+	{
+		std::lock_guard<std::mutex> lock(captureMutex);
+		continuousCapture = callback;
+		captureFrameInterval = std::max<size_t>(frameInterval, 1);
+	}
+
+	if (!captureThread)
+	{
+		captureThreadStop = false;
+		captureThread = std::make_unique<std::thread>(&LGL::CaptureWorker, this);
+	}
+
+	std::cout << "Capture started, every " << captureFrameInterval << " frame(s)\n";
+}
+
+void LGL::StopCapture()
+{
+	std::lock_guard<std::mutex> lock(captureMutex);
+	continuousCapture = nullptr;
+
+	std::cout << "Capture stopped\n";
+}
+
+void LGL::RequestCapture(const CaptureCallback& callback)
+{
+	{
+		std::lock_guard<std::mutex> lock(captureMutex);
+		singleCaptures.push_back(callback);
+	}
+
+	if (!captureThread)
+	{
+		captureThreadStop = false;
+		captureThread = std::make_unique<std::thread>(&LGL::CaptureWorker, this);
+	}
+}
+
+bool LGL::StartCommandCapture(const std::string& path, size_t frameAmount)
+{
+	std::lock_guard<std::mutex> lock(commandCaptureMutex);
+
+	if (!commandCapturePath.empty())
+	{
+		std::cout << "[WARNING] GL command capture into " << commandCapturePath << " is already requested\n";
+		return false;
+	}
+
+	commandCapturePath = path;
+	commandCaptureFrames = frameAmount;
+	commandCaptureStopRequested = false;
+
+	return true;
+}
+
+void LGL::StopCommandCapture()
+{
+	std::lock_guard<std::mutex> lock(commandCaptureMutex);
+
+	commandCapturePath.clear();
+	commandCaptureStopRequested = true;
+}
+
+bool LGL::IsCommandCaptureActive()
+{
+	return LGLCommandRecorder::IsRecording();
+}
+
+void LGL::UpdateCommandCapture()
+{
+	std::string path;
+	size_t frameAmount = 0;
+	{
+		std::lock_guard<std::mutex> lock(commandCaptureMutex);
+
+		if (commandCaptureStopRequested)
+		{
+			LGLCommandRecorder::Stop();
+			commandCaptureStopRequested = false;
+		}
+
+		path.swap(commandCapturePath);
+		frameAmount = commandCaptureFrames;
+	}
+
+	if (path.empty() || !LGLCommandRecorder::Start(path, frameAmount))
+	{
+		return;
+	}
+
+#ifdef LGL_SOFTWARE_BACKEND
+	std::cout << "[WARNING] Software backend cannot read objects back, ones created before the capture are missing from it\n";
+#else
+	RecordObjectSnapshot();
+#endif
+}
+
+void LGL::RecordObjectSnapshot()
+{
+	ProfileZone("CommandCaptureSnapshot");
+
+	// State is read back first, as snapshot binds objects to read them
+	constexpr static std::array<GLenum, 7> capabilities
+	{
+		GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_STENCIL_TEST, GL_SCISSOR_TEST, GL_FRAMEBUFFER_SRGB, GL_PROGRAM_POINT_SIZE
+	};
+	std::array<bool, capabilities.size()> enabled;
+
+	std::array<int, 4> blendFunc = { GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };
+	int depthFunc = GL_LESS;
+	int depthMask = GL_TRUE;
+	std::array<float, 4> clearColor = {};
+	std::array<int, 4> viewport = {};
+	int program = 0;
+	int vertexArray = 0;
+	int arrayBuffer = 0;
+	int drawFramebuffer = 0;
+	int readFramebuffer = 0;
+	int activeTexture = GL_TEXTURE0;
+	int textureUnitAmount = 0;
+
+	LGLCommandRecorder::SetPaused(true);
+
+	for (size_t capability = 0; capability < capabilities.size(); ++capability)
+	{
+		enabled[capability] = GLExecute(glIsEnabled, capabilities[capability]) == GL_TRUE;
+	}
+
+	GLSafeExecute(glGetIntegerv, GL_BLEND_SRC_RGB, &blendFunc[0]);
+	GLSafeExecute(glGetIntegerv, GL_BLEND_DST_RGB, &blendFunc[1]);
+	GLSafeExecute(glGetIntegerv, GL_BLEND_SRC_ALPHA, &blendFunc[2]);
+	GLSafeExecute(glGetIntegerv, GL_BLEND_DST_ALPHA, &blendFunc[3]);
+	GLSafeExecute(glGetIntegerv, GL_DEPTH_FUNC, &depthFunc);
+	GLSafeExecute(glGetIntegerv, GL_DEPTH_WRITEMASK, &depthMask);
+	GLSafeExecute(glGetFloatv, GL_COLOR_CLEAR_VALUE, clearColor.data());
+	GLSafeExecute(glGetIntegerv, GL_VIEWPORT, viewport.data());
+	GLSafeExecute(glGetIntegerv, GL_CURRENT_PROGRAM, &program);
+	GLSafeExecute(glGetIntegerv, GL_VERTEX_ARRAY_BINDING, &vertexArray);
+	GLSafeExecute(glGetIntegerv, GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+	GLSafeExecute(glGetIntegerv, GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+	GLSafeExecute(glGetIntegerv, GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+	GLSafeExecute(glGetIntegerv, GL_ACTIVE_TEXTURE, &activeTexture);
+	GLSafeExecute(glGetIntegerv, GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &textureUnitAmount);
+
+	// Shadow maps stay bound to their units between frames
+	std::vector<std::pair<int, int>> unitTextures(std::min(textureUnitAmount, 32)); // 2D and cube map
+	for (size_t unit = 0; unit < unitTextures.size(); ++unit)
+	{
+		GLSafeExecute(glActiveTexture, static_cast<GLenum>(GL_TEXTURE0 + unit));
+		GLSafeExecute(glGetIntegerv, GL_TEXTURE_BINDING_2D, &unitTextures[unit].first);
+		GLSafeExecute(glGetIntegerv, GL_TEXTURE_BINDING_CUBE_MAP, &unitTextures[unit].second);
+	}
+
+	// Data read back is tightly packed
+	LGLCommandRecorder::Record("glPixelStorei", 0, GL_UNPACK_ALIGNMENT, 4);
+
+	RecordProgramSnapshot();
+	RecordTextureSnapshot();
+	RecordBufferSnapshot();
+	RecordFramebufferSnapshot();
+	RecordQuerySnapshot();
+
+	int unpackAlignment = 4;
+	GLSafeExecute(glGetIntegerv, GL_UNPACK_ALIGNMENT, &unpackAlignment);
+
+	// Saved state is set back through GLSafeExecute, so it is recorded as well
+	LGLCommandRecorder::SetPaused(false);
+
+	GLSafeExecute(glPixelStorei, GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+	for (size_t capability = 0; capability < capabilities.size(); ++capability)
+	{
+		if (enabled[capability])
+		{
+			GLSafeExecute(glEnable, capabilities[capability]);
+		}
+		else
+		{
+			GLSafeExecute(glDisable, capabilities[capability]);
+		}
+	}
+
+	GLSafeExecute(glBlendFuncSeparate, blendFunc[0], blendFunc[1], blendFunc[2], blendFunc[3]);
+	GLSafeExecute(glDepthFunc, depthFunc);
+	GLSafeExecute(glDepthMask, static_cast<GLboolean>(depthMask));
+	GLSafeExecute(glClearColor, clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+	GLSafeExecute(glViewport, viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	for (size_t unit = 0; unit < unitTextures.size(); ++unit)
+	{
+		GLSafeExecute(glActiveTexture, static_cast<GLenum>(GL_TEXTURE0 + unit));
+		GLSafeExecute(glBindTexture, GL_TEXTURE_2D, unitTextures[unit].first);
+		GLSafeExecute(glBindTexture, GL_TEXTURE_CUBE_MAP, unitTextures[unit].second);
+	}
+	GLSafeExecute(glActiveTexture, activeTexture);
+
+	GLSafeExecute(glUseProgram, program);
+	GLSafeExecute(glBindVertexArray, vertexArray);
+	GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, arrayBuffer);
+	GLSafeExecute(glBindFramebuffer, GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+	GLSafeExecute(glBindFramebuffer, GL_READ_FRAMEBUFFER, readFramebuffer);
+}
+
+void LGL::RecordProgramSnapshot()
+{
+	std::unordered_set<GLuint> recordedShaders;
+
+	for (auto& shaderProgram : shaderProgramCollection)
+	{
+		ShaderProgram program = shaderProgram.second;
+
+		int shaderAmount = 0;
+		GLSafeExecute(glGetProgramiv, program, GL_ATTACHED_SHADERS, &shaderAmount);
+
+		std::vector<GLuint> shaders(std::max(shaderAmount, 1));
+		GLSafeExecute(glGetAttachedShaders, program, static_cast<int>(shaders.size()), &shaderAmount, shaders.data());
+		shaders.resize(std::min<size_t>(std::max(shaderAmount, 0), shaders.size()));
+
+		for (GLuint shader : shaders)
+		{
+			if (!recordedShaders.insert(shader).second)
+			{
+				continue;
+			}
+
+			int shaderType = 0;
+			int sourceLength = 0;
+			GLSafeExecute(glGetShaderiv, shader, GL_SHADER_TYPE, &shaderType);
+			GLSafeExecute(glGetShaderiv, shader, GL_SHADER_SOURCE_LENGTH, &sourceLength);
+
+			std::vector<GLchar> source(std::max(sourceLength, 1), '\0');
+			GLSafeExecute(glGetShaderSource, shader, static_cast<int>(source.size()), nullptr, source.data());
+			source.back() = '\0';
+			const GLchar* sourceText = source.data();
+
+			LGLCommandRecorder::Record("glCreateShader", shader, static_cast<GLenum>(shaderType));
+			LGLCommandRecorder::Record("glShaderSource", 0, shader, 1, &sourceText, static_cast<const GLint*>(nullptr));
+			LGLCommandRecorder::Record("glCompileShader", 0, shader);
+		}
+
+		LGLCommandRecorder::Record("glCreateProgram", program);
+
+		for (GLuint shader : shaders)
+		{
+			LGLCommandRecorder::Record("glAttachShader", 0, program, shader);
+		}
+
+		auto varyingsIter = transformFeedbackVaryings.find(shaderProgram.first);
+		if (varyingsIter != transformFeedbackVaryings.end())
+		{
+			std::vector<const GLchar*> varyings;
+			for (auto& varying : varyingsIter->second)
+			{
+				varyings.push_back(varying.c_str());
+			}
+
+			LGLCommandRecorder::Record(
+				"glTransformFeedbackVaryings", 
+				0, 
+				program, 
+				static_cast<int>(varyings.size()), 
+				varyings.data(), 
+				GL_INTERLEAVED_ATTRIBS
+			);
+		}
+
+		LGLCommandRecorder::Record("glLinkProgram", 0, program);
+		LGLCommandRecorder::Record("glUseProgram", 0, program);
+
+		// Locations cached before the start are mapped by these, values set once are kept
+		int uniformAmount = 0;
+		int maxNameLength = 0;
+		GLSafeExecute(glGetProgramiv, program, GL_ACTIVE_UNIFORMS, &uniformAmount);
+		GLSafeExecute(glGetProgramiv, program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+		std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1), '\0');
+
+		for (int uniform = 0; uniform < uniformAmount; ++uniform)
+		{
+			int nameLength = 0;
+			int arraySize = 0;
+			GLenum type = 0;
+			GLSafeExecute(
+				glGetActiveUniform, 
+				program, 
+				static_cast<GLuint>(uniform), 
+				static_cast<int>(nameBuffer.size()), 
+				&nameLength, 
+				&arraySize, 
+				&type, 
+				nameBuffer.data()
+			);
+
+			// Arrays are reported by their first element, the others are resolved by name
+			std::string name(nameBuffer.data(), std::min<size_t>(std::max(nameLength, 0), nameBuffer.size()));
+			bool isArray = name.size() > 3 && !name.compare(name.size() - 3, 3, "[0]");
+			if (isArray)
+			{
+				name.resize(name.size() - 3);
+			}
+
+			for (int element = 0; element < std::max(arraySize, 1); ++element)
+			{
+				std::string elementName = isArray ? name + '[' + std::to_string(element) + ']' : name;
+				int location = GLExecute(glGetUniformLocation, program, elementName.c_str());
+
+				if (location < 0)
+				{
+					continue;
+				}
+
+				LGLCommandRecorder::Record("glGetUniformLocation", location, program, elementName.c_str());
+
+				std::array<float, 16> floats = {};
+				int integer = 0;
+
+				switch (type)
+				{
+				case GL_FLOAT:
+					GLSafeExecute(glGetUniformfv, program, location, floats.data());
+					LGLCommandRecorder::Record("glUniform1f", 0, location, floats[0]);
+					break;
+				case GL_FLOAT_VEC2:
+					GLSafeExecute(glGetUniformfv, program, location, floats.data());
+					LGLCommandRecorder::Record("glUniform2f", 0, location, floats[0], floats[1]);
+					break;
+				case GL_FLOAT_VEC3:
+					GLSafeExecute(glGetUniformfv, program, location, floats.data());
+					LGLCommandRecorder::Record("glUniform3f", 0, location, floats[0], floats[1], floats[2]);
+					break;
+				case GL_FLOAT_VEC4:
+					GLSafeExecute(glGetUniformfv, program, location, floats.data());
+					LGLCommandRecorder::Record("glUniform4f", 0, location, floats[0], floats[1], floats[2], floats[3]);
+					break;
+				case GL_FLOAT_MAT4:
+					GLSafeExecute(glGetUniformfv, program, location, floats.data());
+					LGLCommandRecorder::Record("glUniformMatrix4fv", 0, location, 1, static_cast<GLboolean>(GL_FALSE), floats.data());
+					break;
+				case GL_INT:
+				case GL_BOOL:
+				case GL_SAMPLER_2D:
+				case GL_SAMPLER_2D_SHADOW:
+				case GL_SAMPLER_CUBE:
+				case GL_SAMPLER_CUBE_SHADOW:
+					GLSafeExecute(glGetUniformiv, program, location, &integer);
+					LGLCommandRecorder::Record("glUniform1i", 0, location, integer);
+					break;
+				default:
+					// Other types are set by LGL before every draw that uses them
+					break;
+				}
+			}
+		}
+	}
+}
+
+void LGL::RecordTextureSnapshot()
+{
+	// Evicted textures keep their names, but are not tracked
+	std::vector<TextureID> textureIds = memoryBudget.GetObjects(LGLMemoryBudget::ObjectType::Texture);
+	for (auto& texture : textureCollection)
+	{
+		textureIds.push_back(texture.second);
+	}
+
+	std::unordered_set<TextureID> cubeMaps;
+	for (auto& shadowMap : shadowMapCollection)
+	{
+		if (shadowMap.second.isCube)
+		{
+			cubeMaps.insert({ shadowMap.second.staticDepthId, shadowMap.second.depthId });
+		}
+	}
+
+	std::sort(textureIds.begin(), textureIds.end());
+	textureIds.erase(std::unique(textureIds.begin(), textureIds.end()), textureIds.end());
+
+	constexpr static int maxLevelAmount = 16;
+	constexpr static std::array<GLenum, 7> parameters
+	{
+		GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R,
+		GL_TEXTURE_COMPARE_MODE, GL_TEXTURE_COMPARE_FUNC
+	};
+
+	std::vector<float> pixels;
+
+	for (const TextureID& textureId : textureIds)
+	{
+		bool isCube = cubeMaps.count(textureId) > 0;
+		GLenum target = isCube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+
+		GLSafeExecute(glBindTexture, target, textureId);
+
+		LGLCommandRecorder::Record("glGenTextures", 0, 1, &textureId);
+		LGLCommandRecorder::Record("glBindTexture", 0, target, textureId);
+
+		for (int face = 0; face < (isCube ? 6 : 1); ++face)
+		{
+			GLenum imageTarget = isCube ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+
+			for (int level = 0; level < maxLevelAmount; ++level)
+			{
+				int width = 0;
+				int height = 0;
+				int internalFormat = GL_RGBA;
+				GLSafeExecute(glGetTexLevelParameteriv, imageTarget, level, GL_TEXTURE_WIDTH, &width);
+				GLSafeExecute(glGetTexLevelParameteriv, imageTarget, level, GL_TEXTURE_HEIGHT, &height);
+				GLSafeExecute(glGetTexLevelParameteriv, imageTarget, level, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+
+				if (level && (!width || !height))
+				{
+					break;
+				}
+
+				bool depthStencil = internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH32F_STENCIL8;
+				bool depth = depthStencil || internalFormat == GL_DEPTH_COMPONENT || internalFormat == GL_DEPTH_COMPONENT16 || 
+					internalFormat == GL_DEPTH_COMPONENT24 || internalFormat == GL_DEPTH_COMPONENT32F;
+
+				// Depth is rendered every frame, only color is read back
+				const void* data = nullptr;
+				if (!depth && width > 0 && height > 0)
+				{
+					pixels.resize(static_cast<size_t>(width) * height * 4);
+					GLSafeExecute(glGetTexImage, imageTarget, level, GL_RGBA, GL_FLOAT, pixels.data());
+					data = pixels.data();
+				}
+
+				LGLCommandRecorder::Record(
+					"glTexImage2D", 
+					0, 
+					imageTarget, 
+					level, 
+					internalFormat, 
+					width, 
+					height, 
+					0, 
+					static_cast<GLenum>(depthStencil ? GL_DEPTH_STENCIL : depth ? GL_DEPTH_COMPONENT : GL_RGBA), 
+					static_cast<GLenum>(depthStencil ? GL_UNSIGNED_INT_24_8 : GL_FLOAT), 
+					data
+				);
+
+				if (width <= 1 && height <= 1)
+				{
+					break;
+				}
+			}
+		}
+
+		for (GLenum parameter : parameters)
+		{
+			int value = 0;
+			GLSafeExecute(glGetTexParameteriv, target, parameter, &value);
+			LGLCommandRecorder::Record("glTexParameteri", 0, target, parameter, value);
+		}
+
+		std::array<float, 4> borderColor = {};
+		GLSafeExecute(glGetTexParameterfv, target, GL_TEXTURE_BORDER_COLOR, borderColor.data());
+		LGLCommandRecorder::Record("glTexParameterfv", 0, target, GL_TEXTURE_BORDER_COLOR, borderColor.data());
+
+		GLSafeExecute(glBindTexture, target, 0);
+		LGLCommandRecorder::Record("glBindTexture", 0, target, 0);
+	}
+}
+
+void LGL::RecordBufferSnapshot()
+{
+	struct VertexAttribute
+	{
+		GLuint index;
+		int enabled;
+		int buffer;
+		int size;
+		int type;
+		int normalized;
+		int stride;
+		int divisor;
+		void* offset;
+	};
+
+	struct VertexArray
+	{
+		VAO id;
+		int elementBuffer;
+		std::vector<VertexAttribute> attributes;
+	};
+
+	std::vector<VAO> vertexArrayIds = { fullscreenVAO, debugDrawVAO };
+	for (auto& vaoInfo : VAOCollection)
+	{
+		vertexArrayIds.push_back(vaoInfo.vboId);
+	}
+	for (auto& instanceBuffers : instanceCollection)
+	{
+		vertexArrayIds.push_back(instanceBuffers.second.cullVAO);
+	}
+
+	int attributeAmount = 0;
+	GLSafeExecute(glGetIntegerv, GL_MAX_VERTEX_ATTRIBS, &attributeAmount);
+	attributeAmount = std::min(attributeAmount, 16);
+
+	// Evicted mesh buffers are not tracked, but vertex arrays still refer to them
+	std::vector<VBO> bufferIds = memoryBudget.GetObjects(LGLMemoryBudget::ObjectType::Buffer);
+	std::vector<VertexArray> vertexArrays;
+
+	for (VAO vertexArrayId : vertexArrayIds)
+	{
+		if (!vertexArrayId)
+		{
+			continue;
+		}
+
+		VertexArray vertexArray = { vertexArrayId, 0, {} };
+
+		GLSafeExecute(glBindVertexArray, vertexArrayId);
+		GLSafeExecute(glGetIntegerv, GL_ELEMENT_ARRAY_BUFFER_BINDING, &vertexArray.elementBuffer);
+
+		for (int index = 0; index < attributeAmount; ++index)
+		{
+			VertexAttribute attribute = { static_cast<GLuint>(index), 0, 0, 4, GL_FLOAT, 0, 0, 0, nullptr };
+
+			GLSafeExecute(glGetVertexAttribiv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &attribute.enabled);
+			GLSafeExecute(glGetVertexAttribiv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &attribute.buffer);
+
+			if (!attribute.enabled && !attribute.buffer)
+			{
+				continue;
+			}
+
+			GLSafeExecute(glGetVertexAttribiv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attribute.size);
+			GLSafeExecute(glGetVertexAttribiv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attribute.type);
+			GLSafeExecute(glGetVertexAttribiv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attribute.normalized);
+			GLSafeExecute(glGetVertexAttribiv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &attribute.stride);
+			GLSafeExecute(glGetVertexAttribiv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, &attribute.divisor);
+			GLSafeExecute(glGetVertexAttribPointerv, attribute.index, GL_VERTEX_ATTRIB_ARRAY_POINTER, &attribute.offset);
+
+			bufferIds.push_back(static_cast<VBO>(attribute.buffer));
+			vertexArray.attributes.push_back(attribute);
+		}
+
+		bufferIds.push_back(static_cast<VBO>(vertexArray.elementBuffer));
+		vertexArrays.push_back(std::move(vertexArray));
+	}
+
+	GLSafeExecute(glBindVertexArray, 0);
+
+	std::sort(bufferIds.begin(), bufferIds.end());
+	bufferIds.erase(std::unique(bufferIds.begin(), bufferIds.end()), bufferIds.end());
+
+	std::vector<unsigned char> data;
+
+	for (const VBO& bufferId : bufferIds)
+	{
+		if (!bufferId)
+		{
+			continue;
+		}
+
+		int size = 0;
+		int usage = GL_STATIC_DRAW;
+		int mapped = GL_FALSE;
+
+		GLSafeExecute(glBindBuffer, GL_COPY_READ_BUFFER, bufferId);
+		GLSafeExecute(glGetBufferParameteriv, GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+		GLSafeExecute(glGetBufferParameteriv, GL_COPY_READ_BUFFER, GL_BUFFER_USAGE, &usage);
+		GLSafeExecute(glGetBufferParameteriv, GL_COPY_READ_BUFFER, GL_BUFFER_MAPPED, &mapped);
+
+		// Mapped buffers are capture staging, written by GPU for the CPU
+		const void* content = nullptr;
+		if (size > 0 && !mapped)
+		{
+			data.resize(size);
+			GLSafeExecute(glGetBufferSubData, GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(size), data.data());
+			content = data.data();
+		}
+
+		LGLCommandRecorder::Record("glGenBuffers", 0, 1, &bufferId);
+		LGLCommandRecorder::Record("glBindBuffer", 0, GL_COPY_WRITE_BUFFER, bufferId);
+		LGLCommandRecorder::Record("glBufferData", 0, GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), content, static_cast<GLenum>(usage));
+	}
+
+	GLSafeExecute(glBindBuffer, GL_COPY_READ_BUFFER, 0);
+	LGLCommandRecorder::Record("glBindBuffer", 0, GL_COPY_WRITE_BUFFER, 0);
+
+	for (const VertexArray& vertexArray : vertexArrays)
+	{
+		LGLCommandRecorder::Record("glGenVertexArrays", 0, 1, &vertexArray.id);
+		LGLCommandRecorder::Record("glBindVertexArray", 0, vertexArray.id);
+
+		for (const VertexAttribute& attribute : vertexArray.attributes)
+		{
+			LGLCommandRecorder::Record("glBindBuffer", 0, GL_ARRAY_BUFFER, attribute.buffer);
+			LGLCommandRecorder::Record(
+				"glVertexAttribPointer", 
+				0, 
+				attribute.index, 
+				attribute.size, 
+				static_cast<GLenum>(attribute.type), 
+				static_cast<GLboolean>(attribute.normalized), 
+				attribute.stride, 
+				static_cast<const void*>(attribute.offset)
+			);
+
+			if (attribute.divisor)
+			{
+				LGLCommandRecorder::Record("glVertexAttribDivisor", 0, attribute.index, static_cast<GLuint>(attribute.divisor));
+			}
+			if (attribute.enabled)
+			{
+				LGLCommandRecorder::Record("glEnableVertexAttribArray", 0, attribute.index);
+			}
+		}
+
+		LGLCommandRecorder::Record("glBindBuffer", 0, GL_ELEMENT_ARRAY_BUFFER, vertexArray.elementBuffer);
+		LGLCommandRecorder::Record("glBindVertexArray", 0, 0);
+	}
+}
+
+void LGL::RecordFramebufferSnapshot()
+{
+	std::vector<FBO> framebufferIds = { sceneTarget.fboId };
+	for (auto& framebuffer : framebufferCache)
+	{
+		framebufferIds.push_back(framebuffer.second);
+	}
+	for (auto& shadowMap : shadowMapCollection)
+	{
+		framebufferIds.push_back(shadowMap.second.staticFBOId);
+		framebufferIds.push_back(shadowMap.second.FBOId);
+	}
+
+	constexpr static int maxColorAttachments = 8;
+
+	for (const FBO& framebufferId : framebufferIds)
+	{
+		if (!framebufferId)
+		{
+			continue;
+		}
+
+		GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, framebufferId);
+
+		LGLCommandRecorder::Record("glGenFramebuffers", 0, 1, &framebufferId);
+		LGLCommandRecorder::Record("glBindFramebuffer", 0, GL_FRAMEBUFFER, framebufferId);
+
+		std::vector<GLenum> attachments = { GL_DEPTH_ATTACHMENT, GL_STENCIL_ATTACHMENT };
+		for (int color = 0; color < maxColorAttachments; ++color)
+		{
+			attachments.push_back(GL_COLOR_ATTACHMENT0 + color);
+		}
+
+		int depthTexture = 0;
+
+		for (GLenum attachment : attachments)
+		{
+			int objectType = GL_NONE;
+			GLSafeExecute(glGetFramebufferAttachmentParameteriv, GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &objectType);
+
+			if (objectType != GL_TEXTURE)
+			{
+				continue;
+			}
+
+			int texture = 0;
+			int level = 0;
+			int cubeFace = 0;
+			GLSafeExecute(glGetFramebufferAttachmentParameteriv, GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &texture);
+			GLSafeExecute(glGetFramebufferAttachmentParameteriv, GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL, &level);
+			GLSafeExecute(glGetFramebufferAttachmentParameteriv, GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_CUBE_MAP_FACE, &cubeFace);
+
+			// Depth stencil textures are reported under both attachments
+			if (attachment == GL_DEPTH_ATTACHMENT)
+			{
+				depthTexture = texture;
+			}
+			else if (attachment == GL_STENCIL_ATTACHMENT && texture == depthTexture)
+			{
+				attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+			}
+
+			LGLCommandRecorder::Record(
+				"glFramebufferTexture2D", 
+				0, 
+				GL_FRAMEBUFFER, 
+				attachment, 
+				static_cast<GLenum>(cubeFace ? cubeFace : GL_TEXTURE_2D), 
+				static_cast<GLuint>(texture), 
+				level
+			);
+		}
+
+		std::vector<GLenum> drawBuffers;
+		for (int drawBuffer = 0; drawBuffer < maxColorAttachments; ++drawBuffer)
+		{
+			int value = GL_NONE;
+			GLSafeExecute(glGetIntegerv, GL_DRAW_BUFFER0 + drawBuffer, &value);
+			drawBuffers.push_back(static_cast<GLenum>(value));
+		}
+		while (!drawBuffers.empty() && drawBuffers.back() == GL_NONE)
+		{
+			drawBuffers.pop_back();
+		}
+
+		if (drawBuffers.empty())
+		{
+			LGLCommandRecorder::Record("glDrawBuffer", 0, GL_NONE);
+		}
+		else
+		{
+			LGLCommandRecorder::Record("glDrawBuffers", 0, static_cast<int>(drawBuffers.size()), drawBuffers.data());
+		}
+
+		int readBuffer = GL_NONE;
+		GLSafeExecute(glGetIntegerv, GL_READ_BUFFER, &readBuffer);
+		LGLCommandRecorder::Record("glReadBuffer", 0, static_cast<GLenum>(readBuffer));
+	}
+
+	GLSafeExecute(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+	LGLCommandRecorder::Record("glBindFramebuffer", 0, GL_FRAMEBUFFER, 0);
+}
+
+void LGL::RecordQuerySnapshot()
+{
+	std::vector<Query> queryIds(frameTimerQueries.begin(), frameTimerQueries.end());
+	for (auto& gpuProfileFrame : gpuProfileFrames)
+	{
+		queryIds.insert(queryIds.end(), gpuProfileFrame.queries.begin(), gpuProfileFrame.queries.end());
+	}
+	for (auto& instanceBuffers : instanceCollection)
+	{
+		for (CullGroup& cullGroup : instanceBuffers.second.cullGroups)
+		{
+			queryIds.push_back(cullGroup.visibleQuery);
+		}
+	}
+
+	// Results pending at the start are read from queries that did not run in the replay
+	for (const Query& queryId : queryIds)
+	{
+		if (queryId)
+		{
+			LGLCommandRecorder::Record("glGenQueries", 0, 1, &queryId);
+		}
+	}
 }
 
-bool LGL::InitGLAD()
+void LGL::CaptureFrame()
 {
-	ContextLock
+	ProfileGPUZone("Capture");
 
-	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+	ProcessCaptures();
+
+	std::vector<CaptureCallback> callbacks;
+	bool continuous = false;
 	{
-		std::cout << "Failed to init GLAD\n";
-		return false;
+		std::lock_guard<std::mutex> lock(captureMutex);
+
+		if (continuousCapture && renderStats.frameCount % captureFrameInterval == 0)
+		{
+			callbacks.push_back(continuousCapture);
+			continuous = true;
+		}
+
+		callbacks.insert(callbacks.end(), singleCaptures.begin(), singleCaptures.end());
+		singleCaptures.clear();
 	}
 
-	SetDepthTest(DepthTestMode::Less);
+	if (callbacks.empty())
+	{
+		return;
+	}
 
-	std::cout << "GLAD initialized\n";
+	auto slotIter = std::find_if(captureSlots.begin(), captureSlots.end(),
+		[](const CaptureSlot& slot) { return slot.state == CaptureSlot::State::Free; }
+	);
 
-	return true;
-}
+	// Waiting for a slot would stall, continuous frame is dropped and single captures wait for the next one
+	if (slotIter == captureSlots.end())
+	{
+		{
+			std::lock_guard<std::mutex> lock(captureMutex);
+			singleCaptures.insert(singleCaptures.begin(), callbacks.begin() + continuous, callbacks.end());
+		}
 
-void LGL::InitCallbacks()
-{
-	ContextLock
+		if (continuous)
+		{
+			std::lock_guard<std::mutex> lock(renderStatsMutex);
+			++renderStats.droppedCaptures;
+		}
 
-	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
-	glfwSetErrorCallback(GLFWErrorCallback);
-}
+		return;
+	}
 
-void LGL::TerminateOpenGL()
-{
-	glfwTerminate();
+	CaptureSlot& slot = *slotIter;
 
-	std::cout << "Terminate OpenGL\n";
-}
+	slot.width = renderStats.outputWidth;
+	slot.height = renderStats.outputHeight;
+	slot.frameNumber = renderStats.frameCount;
+	slot.callbacks = std::move(callbacks);
 
-void LGL::SetDepthTest(DepthTestMode depthTestMode)
-{
-	ContextLock
+	size_t bufferSize = static_cast<size_t>(slot.width) * slot.height * 4;
 
-	if (depthTestMode == DepthTestMode::Disable)
+	if (!slot.bufferId)
 	{
-		GLSafeExecute(glDisable, GL_DEPTH_TEST);
+		GLSafeExecute(glGenBuffers, 1, &slot.bufferId);
 	}
-	else
+
+	GLSafeExecute(glBindBuffer, GL_PIXEL_PACK_BUFFER, slot.bufferId);
+	if (slot.bufferSize != bufferSize)
 	{
-		GLSafeExecute(glEnable, GL_DEPTH_TEST);
-		GLSafeExecute(glDepthFunc, static_cast<GLenum>(LGLEnumInterpreter::DepthTestModeInter[static_cast<GLenum>(depthTestMode)]));
+		GLSafeExecute(glBufferData, GL_PIXEL_PACK_BUFFER, bufferSize, nullptr, GL_STREAM_READ);
+		slot.bufferSize = bufferSize;
+
+		memoryBudget.Track(LGLMemoryBudget::ObjectType::Buffer, slot.bufferId, LGLMemoryBudget::Category::Staging, bufferSize);
 	}
-}
 
-void LGL::CaptureMouse()
-{
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	// With a pack buffer bound glReadPixels only queues the copy
+	GLSafeExecute(glBindFramebuffer, GL_READ_FRAMEBUFFER, 0);
+	GLSafeExecute(glReadPixels, 0, 0, slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	GLSafeExecute(glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
 
-	std::cout << "Mouse has been captured\n";
+	slot.fence = GLExecute(glFenceSync, GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.state = CaptureSlot::State::Pending;
 }
 
-void LGL::SetCursorPositionCallback(std::function<void(double, double)> callbackFunc)
+void LGL::ProcessCaptures()
 {
-	glfwSetCursorPosCallback(window, CursorPositionCallback);
-	cursorPositionFunc = callbackFunc;
+	for (size_t slotIndex = 0; slotIndex < captureSlots.size(); ++slotIndex)
+	{
+		CaptureSlot& slot = captureSlots[slotIndex];
 
-	std::cout << "Cursor callback set\n";
-}
+		if (slot.state == CaptureSlot::State::Processed)
+		{
+			GLSafeExecute(glBindBuffer, GL_PIXEL_PACK_BUFFER, slot.bufferId);
+			GLSafeExecute(glUnmapBuffer, GL_PIXEL_PACK_BUFFER);
 
-void LGL::SetScrollCallback(std::function<void(double, double)> callbackFunc)
-{
-	glfwSetScrollCallback(window, ScrollCallback);
-	scrollCallbackFunc = callbackFunc;
+			slot.mappedData = nullptr;
+			slot.state = CaptureSlot::State::Free;
+		}
+		else if (slot.state == CaptureSlot::State::Pending)
+		{
+			// Zero timeout, fence is only polled
+			GLenum waitResult = GLExecute(glClientWaitSync, static_cast<GLsync>(slot.fence), 0, 0);
 
-	std::cout << "Scroll callback set\n";
-}
+			if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED)
+			{
+				continue;
+			}
 
-int LGL::GetMaxAmountOfVertexAttr()
-{
-	ContextLock
+			GLExecute(glDeleteSync, static_cast<GLsync>(slot.fence));
+			slot.fence = nullptr;
 
-	int attr;
-	GLSafeExecute(glGetIntegerv, GL_MAX_VERTEX_ATTRIBS, &attr);
-	
-	std::cout << "Max amount of vertex attributes: " << attr << '\n';
-	
-	return attr;
+			GLSafeExecute(glBindBuffer, GL_PIXEL_PACK_BUFFER, slot.bufferId);
+			slot.mappedData = static_cast<const unsigned char*>(
+				GLExecute(glMapBufferRange, GL_PIXEL_PACK_BUFFER, 0, slot.bufferSize, GL_MAP_READ_BIT)
+			);
+
+			if (!slot.mappedData)
+			{
+				std::cout << "[ERROR] Capture buffer could not be mapped, frame " << slot.frameNumber << " is lost\n";
+				slot.callbacks.clear();
+				slot.state = CaptureSlot::State::Free;
+				continue;
+			}
+
+			slot.state = CaptureSlot::State::Mapped;
+
+			{
+				std::lock_guard<std::mutex> lock(captureMutex);
+				mappedCaptures.push_back(slotIndex);
+			}
+			captureCondition.notify_one();
+		}
+	}
+
+	GLSafeExecute(glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
 }
 
-void LGL::ProcessInput()
+void LGL::CaptureWorker()
 {
-	for (auto& interact : interactCollection)
+	while (true)
 	{
-		int retCode = glfwGetKey(window, interact.first);
+		size_t slotIndex = 0;
+		{
+			std::unique_lock<std::mutex> lock(captureMutex);
+			captureCondition.wait(lock, [this]() { return captureThreadStop || !mappedCaptures.empty(); });
 
-		if (retCode == GLFW_PRESS && interact.second.first)
+			if (mappedCaptures.empty())
+			{
+				return;
+			}
+
+			slotIndex = mappedCaptures.front();
+			mappedCaptures.pop_front();
+		}
+
+		CaptureSlot& slot = captureSlots[slotIndex];
+
+		for (auto& callback : slot.callbacks)
 		{
-			interact.second.first();
+			callback(slot.mappedData, slot.width, slot.height, slot.frameNumber);
 		}
-		else if (retCode == GLFW_RELEASE && interact.second.second)
+		slot.callbacks.clear();
+
 		{
-			interact.second.second();
+			std::lock_guard<std::mutex> lock(renderStatsMutex);
+			++renderStats.capturedFrames;
 		}
+
+		// Buffer is unmapped by the render thread, mapping belongs to its context
+		slot.state = CaptureSlot::State::Processed;
 	}
 }
 
-void LGL::FramebufferSizeCallback(GLFWwindow* window, int width, int height)
+void LGL::StopCaptureWorker()
 {
-	glViewport(0, 0, width, height);
-}
+	if (captureThread)
+	{
+		{
+			std::lock_guard<std::mutex> lock(captureMutex);
+			captureThreadStop = true;
+		}
+		captureCondition.notify_one();
 
-void LGL::Render()
-{
-	if (currentVAOToRender.vboId != 0)
+		captureThread->join();
+		captureThread.reset();
+	}
+
+	for (auto& slot : captureSlots)
 	{
-		if (!currentVAOToRender.useIndices)
+		if (slot.fence)
 		{
-			GLSafeExecute(glDrawArrays, GL_TRIANGLES, 0, currentVAOToRender.pointAmount);
+			GLExecute(glDeleteSync, static_cast<GLsync>(slot.fence));
 		}
-		else
+		if (slot.mappedData)
 		{
-			GLSafeExecute(glDrawElements, GL_TRIANGLES, currentVAOToRender.pointAmount, GL_UNSIGNED_INT, nullptr);
+			GLSafeExecute(glBindBuffer, GL_PIXEL_PACK_BUFFER, slot.bufferId);
+			GLSafeExecute(glUnmapBuffer, GL_PIXEL_PACK_BUFFER);
+		}
+		if (slot.bufferId)
+		{
+			memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Buffer, slot.bufferId);
+			GLSafeExecute(glDeleteBuffers, 1, &slot.bufferId);
 		}
-
-		uniformLocationTracker.clear();
 	}
 }
 
-void LGL::RunRenderingCycle(std::function<void()> additionalSteps)
+unsigned int LGL::CreateRenderResource(const RenderResourceDesc& desc, int width, int height)
 {
-	std::array<int, Texture::GetTextureTypeAmount()> textureTypesToUnbind;
-	std::fill(textureTypesToUnbind.begin(), textureTypesToUnbind.end(), false);
+	unsigned int id = 0;
 
-	while (!glfwWindowShouldClose(window))
+	if (desc.type == RenderResourceDesc::ResourceType::Buffer)
 	{
-		ContextLock
-
-		ProcessInput();
+		GLSafeExecute(glGenBuffers, 1, &id);
+		GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, id);
+		GLSafeExecute(glBufferData, GL_ARRAY_BUFFER, desc.bufferSize, nullptr, GL_DYNAMIC_DRAW);
+		GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, 0);
 
-		GLSafeExecute(glClearColor, background.r, background.g, background.b, background.a);
-		GLSafeExecute(glClear, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		memoryBudget.Track(LGLMemoryBudget::ObjectType::Buffer, id, LGLMemoryBudget::Category::RenderTarget, desc.bufferSize);
 
-		if (additionalSteps)
-		{
-			additionalSteps();
-		}
+		return id;
+	}
 
-		for (auto& currentVAO : VAOCollection)
-		{
-			if (currentVAO.meshInfo->render)
-			{
-				currentVAOToRender = currentVAO;
+	const std::array<int, 3>& format = LGLEnumInterpreter::RenderResourceFormatInter[static_cast<int>(desc.format)];
+
+	GLSafeExecute(glGenTextures, 1, &id);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, id);
+	GLSafeExecute(glTexImage2D, GL_TEXTURE_2D, 0, format[0], width, height, 0, format[1], format[2], nullptr);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	GLSafeExecute(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
+
+	// Texel sizes in RenderResourceDesc::TextureFormat order, depth 24 is padded to 4 bytes
+	constexpr size_t texelSizes[] = { 4, 8, 2, 1, 4, 4 };
+	static_assert(sizeof(texelSizes) / sizeof(size_t) == static_cast<size_t>(RenderResourceDesc::TextureFormat::_SIZE), "Texel size is missing");
+
+	memoryBudget.Track(
+		LGLMemoryBudget::ObjectType::Texture, 
+		id, 
+		LGLMemoryBudget::Category::RenderTarget, 
+		static_cast<size_t>(width) * height * texelSizes[static_cast<int>(desc.format)]
+	);
 
-				std::string shaderProgramToCheck = currentVAO.meshInfo->shaderProgram;
-				if (lastProgram != shaderProgramToCheck)
-				{
-					lastProgram = shaderProgramToCheck;
-					GLSafeExecute(glUseProgram, shaderProgramCollection[lastProgram]);
-				}
+	std::cout << "Render target " << width << 'x' << height << " created\n";
 
-				GLSafeExecute(glBindVertexArray, currentVAO.vboId);
+	return id;
+}
 
-				for (auto& texture : currentVAO.meshInfo->mesh.textures)
-				{
-					auto currentTextureIter = textureCollection.find(texture.name);
-					if (currentTextureIter != textureCollection.end())
-					{
-						TextureID textureID = (*currentTextureIter).second;
-						int convertedTextureType = static_cast<int>(texture.type);
-						GLSafeExecute(glActiveTexture, GL_TEXTURE0 + convertedTextureType);
-						GLSafeExecute(glBindTexture, GL_TEXTURE_2D, textureID);
+void LGL::DeleteRenderResource(const RenderResourceDesc& desc, unsigned int id)
+{
+	if (desc.type == RenderResourceDesc::ResourceType::Buffer)
+	{
+		memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Buffer, id);
+		GLSafeExecute(glDeleteBuffers, 1, &id);
+		return;
+	}
 
-						textureTypesToUnbind[convertedTextureType] = true;
-					}
-				}
+	DeleteCachedFramebuffers(id);
+	memoryBudget.Untrack(LGLMemoryBudget::ObjectType::Texture, id);
 
-				std::function<void()> behaviourToCheck = currentVAO.meshInfo->behaviour;
-				if (behaviourToCheck)
-				{
-					behaviourToCheck();
-				}
+	GLSafeExecute(glDeleteTextures, 1, &id);
+}
 
-				Render();
+void LGL::DeleteCachedFramebuffers(TextureID attachmentId)
+{
+	// Texture names are recycled by OpenGL, framebuffers with a deleted attachment must go
+	for (auto framebufferIter = framebufferCache.begin(); framebufferIter != framebufferCache.end();)
+	{
+		const std::vector<TextureID>& attachments = framebufferIter->first;
 
-				for (auto& textureTypeToUnbind : textureTypesToUnbind)
-				{
-					if (textureTypeToUnbind)
-					{
-						GLSafeExecute(glActiveTexture, GL_TEXTURE0 + textureTypeToUnbind);
-						GLSafeExecute(glBindTexture, GL_TEXTURE_2D, 0);
-						textureTypeToUnbind = false;
-					}
-				}
-			}
+		if (std::find(attachments.begin(), attachments.end(), attachmentId) != attachments.end())
+		{
+			GLSafeExecute(glDeleteFramebuffers, 1, &framebufferIter->second);
+			framebufferIter = framebufferCache.erase(framebufferIter);
+		}
+		else
+		{
+			++framebufferIter;
 		}
-		currentVAOToRender = {};
-
-		glfwSwapBuffers(window);
-		glfwPollEvents();
 	}
 }
 
-void LGL::SetStaticBackgroundColor(const glm::vec4& rgba)
-{
-	background = rgba;
-}
-
 void LGL::CreateMesh(MeshInfo& meshInfo)
 {
 	ContextLock
@@ -348,14 +3560,11 @@ void LGL::CreateMesh(MeshInfo& meshInfo)
 	VBO* newVBO = &VBOCollection.back();
 
 	GLSafeExecute(glGenBuffers, 1, newVBO);
-	GLSafeExecute(glBindBuffer, GL_ARRAY_BUFFER, *newVBO);
-	GLSafeExecute(
-		glBufferData,
-		GL_ARRAY_BUFFER, 
-		meshInfo.mesh.vert.size() * sizeof(Vertex),
-		&meshInfo.mesh.vert[0],
-		meshInfo.isDynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW
-	);
+
+	MeshBuffers& meshBuffers = meshBufferCollection[*newVAO];
+	meshBuffers.vertexId = *newVBO;
+	meshBuffers.meshInfo = &meshInfo;
+
 	size_t stride = 0;
 	for (int i = 0; i < steps.size(); ++i)
 	{
@@ -368,14 +3577,23 @@ void LGL::CreateMesh(MeshInfo& meshInfo)
 		EBO* newEBO = &EBOCollection.back();
 
 		GLSafeExecute(glGenBuffers, 1, newEBO);
-		GLSafeExecute(glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, *newEBO);
-		GLSafeExecute(
-			glBufferData,
-			GL_ELEMENT_ARRAY_BUFFER, 
-			meshInfo.mesh.indices.size() * sizeof(unsigned int),
-			&meshInfo.mesh.indices[0],
-			meshInfo.isDynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW
-		);
+		meshBuffers.indexId = *newEBO;
+
+		// LOD indices go after the base ones, so one element buffer serves all of them
+		size_t indexAmount = meshInfo.mesh.indices.size();
+		std::vector<LODRange> lods;
+
+		for (auto& lod : meshInfo.mesh.lods)
+		{
+			lods.push_back({ indexAmount, lod.indices.size(), lod.error });
+			indexAmount += lod.indices.size();
+		}
+
+		if (!lods.empty())
+		{
+			lodCollection[*newVAO] = std::move(lods);
+		}
+
 		VAOCollection.back().useIndices = true;
 		VAOCollection.back().pointAmount = meshInfo.mesh.indices.size();
 	}
@@ -384,8 +3602,47 @@ void LGL::CreateMesh(MeshInfo& meshInfo)
 		VAOCollection.back().pointAmount = meshInfo.mesh.vert.size();
 	}
 
+	// Leaves the vertex array and its vertex buffer bound for the attributes below
+	size_t meshSize = UploadMeshBuffers(*newVAO);
+
+	if (meshInfo.retention == MeshRetention::Keep)
+	{
+		memoryBudget.SetEvictable(LGLMemoryBudget::ObjectType::VertexArray, *newVAO, meshSize, renderStats.frameCount);
+	}
+
 	VAOCollection.back().meshInfo = &meshInfo;
 
+	if (meshInfo.mesh.boundingSphere.w > 0.0f)
+	{
+		VAOCollection.back().boundingSphere = meshInfo.mesh.boundingSphere;
+	}
+	else if (!meshInfo.mesh.vert.empty())
+	{
+		glm::vec3 minPoint = meshInfo.mesh.vert.front().Position;
+		glm::vec3 maxPoint = minPoint;
+
+		for (auto& vert : meshInfo.mesh.vert)
+		{
+			minPoint = glm::min(minPoint, vert.Position);
+			maxPoint = glm::max(maxPoint, vert.Position);
+		}
+
+		glm::vec3 center = (minPoint + maxPoint) * 0.5f;
+		float radius = 0.0f;
+
+		for (auto& vert : meshInfo.mesh.vert)
+		{
+			radius = std::max(radius, glm::length(vert.Position - center));
+		}
+
+		VAOCollection.back().boundingSphere = glm::vec4(center, radius);
+	}
+
+	if (!meshInfo.mesh.meshlets.empty() && VAOCollection.back().useIndices)
+	{
+		meshletCollection.emplace(*newVAO, LGLMeshletCuller(meshInfo.mesh.meshlets));
+	}
+
 	stride *= sizeof(float);
 
 	size_t step = 0;
@@ -402,10 +3659,47 @@ void LGL::CreateMesh(MeshInfo& meshInfo)
 	std::cout << "Mesh with " << VAOCollection.back().pointAmount << " point(s) / " << polygons << " polygons created\n";
 
 	LoadAndCompileShader(meshInfo.shaderProgram);
+	if (meshInfo.isTransparent)
+	{
+		std::string shaderProgram = meshInfo.shaderProgram;
+
+		if (transparentProgramCollection.find(shaderProgram) == transparentProgramCollection.end())
+		{
+			// Variant writes accumulation outputs instead of the color one, so the lighting code is shared
+			std::string transparentProgram = shaderProgram + "OIT";
+			transparentProgramCollection[shaderProgram] = 
+				ShaderChecksDefine(shaderProgram, "OIT") && LoadAndCompileShader(transparentProgram, shaderProgram, { "OIT" }) ? 
+				transparentProgram : 
+				shaderProgram;
+		}
+
+		if (!LoadAndCompileShader("oitComposite"))
+		{
+			std::cout << "[WARNING] oitComposite shader program is missing, transparent meshes will not be visible\n";
+		}
+	}
 	for (auto& texture : meshInfo.mesh.textures)
 	{
 		ConfigureTexture(texture);
 	}
+
+	ReleaseMeshData(meshInfo);
+}
+
+void LGL::ReleaseMeshData(MeshInfo& meshInfo)
+{
+	if (meshInfo.retention == MeshRetention::Keep)
+	{
+		return;
+	}
+
+	Mesh& mesh = meshInfo.mesh;
+
+	// Swapped with empty ones, clear keeps the capacity
+	std::vector<Vertex>().swap(mesh.vert);
+	std::vector<unsigned int>().swap(mesh.indices);
+	std::vector<MeshLOD>().swap(mesh.lods);
+	std::vector<Meshlet>().swap(mesh.meshlets);
 }
 
 void LGL::CreateModel(LGLStructs::ModelInfo& model)
@@ -617,7 +3911,12 @@ bool LGL::CompileShader(const std::string& name)
 	return shaderCompiled;
 }
 
-bool LGL::LoadShaderFromFile(const std::string& name, const std::string& file, const std::string& shaderType)
+bool LGL::LoadShaderFromFile(
+	const std::string& name, 
+	const std::string& file, 
+	const std::string& shaderType, 
+	const std::vector<std::string>& defines
+)
 {
 	std::string shader; // change to stringstream
 	std::string line;
@@ -632,14 +3931,27 @@ bool LGL::LoadShaderFromFile(const std::string& name, const std::string& file, c
 		return atLeastOneFileLoaded;
 	}
 
+	bool versionLine = true;
+
 	while (std::getline(reader, line))
 	{
 		shader += (line + '\n');
+
+		// #version has to stay the first line of the shader
+		if (versionLine)
+		{
+			for (auto& define : defines)
+			{
+				shader += "#define " + define + '\n';
+			}
+
+			versionLine = false;
+		}
 	}
 
 	shaderInfoCollection[name].emplace_back(
 		ShaderInfo{
-			glCreateShader(shaderTypeChoice[shaderType]),
+			GLExecute(glCreateShader, shaderTypeChoice[shaderType]),
 			shader
 		}
 	);
@@ -750,6 +4062,23 @@ bool LGL::ConfigureTexture(const Texture& texture)
 		texture.data
 	);
 
+	size_t dataSize = static_cast<size_t>(texture.width) * texture.height * texture.channelAmount;
+	size_t textureSize = texture.params.createMipmaps ? dataSize + dataSize / 3 : dataSize;
+
+	memoryBudget.Track(LGLMemoryBudget::ObjectType::Texture, newTextureID, LGLMemoryBudget::Category::Texture, textureSize);
+
+	if (memoryBudget.GetBudget() && texture.data)
+	{
+		TextureCopy& textureCopy = textureCopyCollection[newTextureID];
+		textureCopy.data.assign(texture.data, texture.data + dataSize);
+		textureCopy.width = texture.width;
+		textureCopy.height = texture.height;
+		textureCopy.format = textureFormat;
+		textureCopy.mipmaps = texture.params.createMipmaps;
+
+		memoryBudget.SetEvictable(LGLMemoryBudget::ObjectType::Texture, newTextureID, textureSize, renderStats.frameCount);
+	}
+
 	std::cout << "Texture " << texture.name << " configured\n";
 
 	return true;
@@ -759,13 +4088,32 @@ bool LGL::CreateShaderProgram(const std::string& name, const std::vector<std::st
 {	
 	ContextLock
 
-	shaderProgramCollection.emplace(name, glCreateProgram());
+	shaderProgramCollection.emplace(name, GLExecute(glCreateProgram));
 	ShaderProgram* newShaderProgram = &shaderProgramCollection[name];
 
 	for (auto& shaderInfo : shaderInfoCollection[name])
 	{
 		GLSafeExecute(glAttachShader, *newShaderProgram, shaderInfo.shaderId);
 	}
+
+	auto varyingsIter = transformFeedbackVaryings.find(name);
+	if (varyingsIter != transformFeedbackVaryings.end())
+	{
+		std::vector<const char*> varyings;
+		for (auto& varying : varyingsIter->second)
+		{
+			varyings.push_back(varying.c_str());
+		}
+
+		GLSafeExecute(
+			glTransformFeedbackVaryings, 
+			*newShaderProgram, 
+			static_cast<int>(varyings.size()), 
+			varyings.data(), 
+			GL_INTERLEAVED_ATTRIBS
+		);
+	}
+
 	GLSafeExecute(glLinkProgram, *newShaderProgram);
 
 	int success;
@@ -783,6 +4131,11 @@ void LGL::SetShaderFolder(const std::string& path)
 }
 
 bool LGL::LoadAndCompileShader(const std::string& name)
+{
+	return LoadAndCompileShader(name, name, {});
+}
+
+bool LGL::LoadAndCompileShader(const std::string& name, const std::string& fileName, const std::vector<std::string>& defines)
 {
 	if (shaderProgramCollection.find(name) != shaderProgramCollection.end())
 	{
@@ -793,7 +4146,7 @@ bool LGL::LoadAndCompileShader(const std::string& name)
 
 	for (const auto& shaderFileType : shaderTypeChoice)
 	{
-		if (!LoadShaderFromFile(name, shaderPath + '\\' + name + '.' + shaderFileType.first, shaderFileType.first)) continue;
+		if (!LoadShaderFromFile(name, shaderPath + '\\' + fileName + '.' + shaderFileType.first, shaderFileType.first, defines)) continue;
 		if (!CompileShader(name)) // remove if did not compile
 		{
 			shaderInfoCollection[name].pop_back();
@@ -803,6 +4156,24 @@ bool LGL::LoadAndCompileShader(const std::string& name)
 	return shaderInfoCollection[name].size() && CreateShaderProgram(name);
 }
 
+bool LGL::ShaderChecksDefine(const std::string& name, const std::string& define)
+{
+	auto shaderInfoIter = shaderInfoCollection.find(name);
+
+	if (shaderInfoIter == shaderInfoCollection.end())
+	{
+		return false;
+	}
+
+	return std::any_of(shaderInfoIter->second.begin(), shaderInfoIter->second.end(),
+		[&define](const ShaderInfo& shaderInfo)
+		{
+			return shaderInfo.shaderCode.find("#ifdef " + define) != std::string::npos || 
+				shaderInfo.shaderCode.find("defined(" + define + ')') != std::string::npos;
+		}
+	);
+}
+
 void LGL::SetInteractable(unsigned char key, const OnPressFunction& preFunc, const OnReleaseFunction& relFunc)
 {
 	interactCollection[std::toupper(key)] = {preFunc, relFunc};
@@ -847,24 +4218,24 @@ void LGL::SetAssetOnOpenGLFailure(bool value)
 
 const std::unordered_map<std::type_index, std::function<void(int, void*)>> uniformValueLocators
 {
-	{ typeid(int), [](int uniformValueLocation, void* value) { glUniform1i(uniformValueLocation, *reinterpret_cast<int*>(value)); } },
-	{ typeid(float), [](int uniformValueLocation, void* value) { glUniform1f(uniformValueLocation, *reinterpret_cast<float*>(value)); } },
+	{ typeid(int), [](int uniformValueLocation, void* value) { GLExecute(glUniform1i, uniformValueLocation, *reinterpret_cast<int*>(value)); } },
+	{ typeid(float), [](int uniformValueLocation, void* value) { GLExecute(glUniform1f, uniformValueLocation, *reinterpret_cast<float*>(value)); } },
 
 	{ typeid(glm::vec3), [](int uniformValueLocation, void* value)
 	{
 		glm::vec3* coords = reinterpret_cast<glm::vec3*>(value);
-		glUniform3f(uniformValueLocation, coords->x, coords->y, coords->z);
+		GLExecute(glUniform3f, uniformValueLocation, coords->x, coords->y, coords->z);
 	} },
 
 	{ typeid(glm::vec4), [](int uniformValueLocation, void* value)
 	{
 		glm::vec4* coords = reinterpret_cast<glm::vec4*>(value);
-		glUniform4f(uniformValueLocation, coords->x, coords->y, coords->z, coords->w);
+		GLExecute(glUniform4f, uniformValueLocation, coords->x, coords->y, coords->z, coords->w);
 	} },
 
 	{ typeid(glm::mat4), [](int uniformValueLocation, void* value)
 	{
-		glUniformMatrix4fv(uniformValueLocation, 1, GL_FALSE, glm::value_ptr(*reinterpret_cast<glm::mat4*>(value)));
+		GLExecute(glUniformMatrix4fv, uniformValueLocation, 1, GL_FALSE, glm::value_ptr(*reinterpret_cast<glm::mat4*>(value)));
 	} }
 
 };
@@ -874,7 +4245,7 @@ int LGL::CheckUniformValueLocation(const std::string& valueName, const std::stri
 {
 	ShaderProgram shaderProgramToUse = shaderProgramCollection[shaderProgramName == "" ? lastProgram : shaderProgramName];
 
-	int uniformValueLocation = glGetUniformLocation(shaderProgramToUse, valueName.c_str());
+	int uniformValueLocation = GLExecute(glGetUniformLocation, shaderProgramToUse, valueName.c_str());
 
 	if (uniformValueLocation == -1)
 	{
@@ -13,10 +13,19 @@
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <typeindex>
 #include <unordered_set>
+#include <array>
 
 #include "LGLStructs.h"
+#include "LGLRenderGraph.h"
+#include "LGLMeshletCuller.h"
+#include "LGLProfiler.h"
+#include "LGLMemoryBudget.h"
 
 #define CALLBACK static void
 
@@ -36,6 +45,10 @@ private:
 	using VBO = unsigned int; // Vertex Buffer Object
 	using VAO = unsigned int; // Vertex Array Object
 	using EBO = unsigned int; // Element Buffer Object
+	using FBO = unsigned int; // Frame Buffer Object
+	using Query = unsigned int;
+	using PBO = unsigned int; // Pixel Buffer Object
+	using Sync = void*;       // GLsync, glad is not included in this header
 
 	using Shader = unsigned int;
 	using ShaderCode = std::string;
@@ -55,6 +68,63 @@ private:
 		size_t pointAmount;
 		bool useIndices;
 		LGLStructs::MeshInfo* meshInfo = nullptr;
+		glm::vec4 boundingSphere = glm::vec4(0.0f); // Model space center and radius
+	};
+
+	// Indices of a LOD follow the base indices in the element buffer of the mesh
+	struct LODRange
+	{
+		size_t indexOffset;
+		size_t indexAmount;
+		float error; // In model space
+	};
+
+	// Per instance attributes, normal matrix is the inverse transpose of the model one
+	struct InstanceTransform
+	{
+		glm::mat4 model;
+		glm::mat3 normal;
+	};
+
+	// Source holds all instance transforms, visible is filled by culling transform feedback
+	// Instances culled on GPU are drawn with the visible amount of the previous frame, so the draw
+	// does not wait for the culling one. Results are read once they are available
+	struct CullGroup
+	{
+		Query visibleQuery = 0;
+		bool queryPending = false;
+		bool visibleAmountKnown = false;
+		size_t visibleAmount = 0;
+		size_t drawAmount = 0; // Instances to draw from the visible buffer this frame
+	};
+
+	// Visible instances of a LOD group are written at the offset of the group in the source
+	struct InstanceBuffers
+	{
+		VBO sourceId = 0;
+		VBO visibleId = 0;
+		size_t capacity = 0;
+		VAO cullVAO = 0;
+		std::vector<CullGroup> cullGroups; // Indexed by LOD
+	};
+
+	// Mesh buffers are released on eviction and uploaded again from meshInfo, names are kept,
+	// so the vertex array stays valid
+	struct MeshBuffers
+	{
+		VBO vertexId = 0;
+		EBO indexId = 0;
+		LGLStructs::MeshInfo* meshInfo = nullptr;
+	};
+
+	// System memory copy of a texture, textures configured while a memory budget is set keep one
+	struct TextureCopy
+	{
+		std::vector<unsigned char> data;
+		int width = 0;
+		int height = 0;
+		unsigned int format = 0;
+		bool mipmaps = false;
 	};
 
 	struct ShaderInfo
@@ -63,12 +133,119 @@ private:
 		ShaderCode shaderCode;
 	};
 
+	// Offscreen target the scene is rendered into when dynamic resolution is enabled
+	// Allocated at maxScale of the window, the actual render size is a sub rect of it
+	struct SceneTarget
+	{
+		FBO fboId = 0;
+		TextureID colorId = 0;
+		TextureID depthId = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	// Depth of static meshes is cached in staticDepthId and re-rendered only if invalidated,
+	// dynamic meshes are drawn every frame on top of a copy of it in depthId
+	struct ShadowMapInfo
+	{
+		TextureID staticDepthId = 0;
+		TextureID depthId = 0;
+		TextureID sampledDepthId = 0;
+		FBO staticFBOId = 0;
+		FBO FBOId = 0;
+		int size = 0;
+		bool isCube = false;
+		int textureUnit = 0;
+		std::vector<glm::mat4> lightSpaceMatrices;
+		bool staticDirty = true;
+	};
+
+	// Capture goes Free -> Pending (read issued) -> Mapped (on worker) -> Processed -> Free
+	struct CaptureSlot
+	{
+		enum class State
+		{
+			Free,
+			Pending,
+			Mapped,
+			Processed
+		};
+
+		PBO bufferId = 0;
+		size_t bufferSize = 0;
+		Sync fence = nullptr;
+		const unsigned char* mappedData = nullptr;
+		int width = 0;
+		int height = 0;
+		size_t frameNumber = 0;
+		std::vector<std::function<void(const unsigned char*, int, int, size_t)>> callbacks;
+		std::atomic<State> state{ State::Free };
+	};
+
+	// Timer queries are read back frameTimerQueryAmount frames later to avoid stalls
+	constexpr static size_t frameTimerQueryAmount = 4;
+	constexpr static float frameTimeSmoothing = 0.1f;
+	constexpr static float dynResDeadZone = 0.05f;
+	constexpr static float dynResAdjustRate = 0.1f;
+
+	// Instance model matrix takes 4 attribute locations, starting from this one,
+	// normal matrix takes 3 after it
+	constexpr static int instanceAttribLocation = 5;
+	constexpr static int instanceNormalAttribLocation = 9;
+	// Up to this amount, instances of meshes with meshlets are drawn one by one with meshlet culling
+	constexpr static size_t meshletInstanceLimit = 8;
+	// Instances culled on GPU are drawn up to the visible amount of the previous frame plus this
+	// share of the submitted ones, instances turning visible past that show up a frame late
+	constexpr static size_t cullHeadroomDivisor = 4;
+
+	// Captures are mapped after their fence signalled, frames with no free slot are dropped
+	constexpr static size_t captureSlotAmount = 4;
+
+	// GPU zone is a pair of timestamp queries, they nest unlike GL_TIME_ELAPSED ones
+	struct GPUZone
+	{
+		const char* name;
+		Query start;
+		Query end;
+	};
+
+	// Line list vertex of debug draw, color is RGBA8
+	struct DebugVertex
+	{
+		glm::vec3 position;
+		uint32_t color;
+	};
+
+	constexpr static int debugSphereSegments = 24;
+
+	// Queries of a frame are read back gpuProfileLatency frames later, then reused
+	struct GPUProfileFrame
+	{
+		std::vector<Query> queries;
+		size_t usedQueries = 0;
+		std::vector<GPUZone> zones;
+	};
+
+	constexpr static size_t gpuProfileLatency = 4;
+
+	class ScopedGPUZone
+	{
+	public:
+		ScopedGPUZone(LGL& lgl, const char* name);
+		~ScopedGPUZone();
+
+	private:
+		LGL& lgl;
+		size_t zoneIndex;
+	};
+
 	class LGLEnumInterpreter
 	{
 	public:
 		static const std::vector<int> DepthTestModeInter;
 		static const std::vector<int> TextureOverlayTypeInter;
 		static const std::vector<int> SpecialKeyInter;
+		static const std::vector<std::array<int, 3>> RenderResourceFormatInter;
 	};
 
 public:
@@ -107,6 +284,11 @@ public:
 	// Additional steps to rendering can be passed as a function pointer or a lambda
 	// It is expected to get a lambda with a script for camera behaviour
 	LGL_API void RunRenderingCycle(std::function<void()> additionalSteps = nullptr);
+	// Rendering cycle returns after the current frame, same as closing the window
+	LGL_API void StopRenderingCycle();
+	// Steps run on the calling thread while no frame is rendered, for changing data the frame
+	// reads (instance matrices, scene objects) from other threads. Called from a frame they run at once
+	LGL_API void ExecuteBetweenFrames(const std::function<void()>& steps);
 	LGL_API void SetStaticBackgroundColor(const glm::vec4& rgba);
 
 	// Creates a VAO, VBO and (if indices are given) EBO
@@ -116,7 +298,8 @@ public:
 	// exaclty at it's VAO binding.
 	// If you need several shapes with similar behaviour, it's possible 
 	// to render additional ones with SetShaderUniformValue function inside
-	// the lambda script without creating additional VAOs
+	// the lambda script without creating additional VAOs.
+	// Mesh data the retention policy of the mesh does not keep is freed after upload
 #ifdef ENABLE_OLD_MODEL_IMPORT
 	LGL_API void GetMeshFromFile(const std::string& file, std::vector<LGLStructs::Vertex>& vertexes, std::vector<unsigned int>& indeces);
 #else	
@@ -142,6 +325,127 @@ public:
 
 	LGL_API void SetShaderFolder(const std::string& path);
 
+	// Scene is rendered into an offscreen target with resolution adjusted each frame
+	// from the measured GPU frame time towards config.targetFrameTimeMs, then upscaled
+	LGL_API void SetDynamicResolution(const LGLStructs::DynamicResolutionConfig& config);
+	LGL_API LGLStructs::RenderStats GetRenderStats();
+
+	// Null backend
+	// Built with LGL_NULL_BACKEND, OpenGL and GLFW calls do no work and are only counted,
+	// window is fake, so CPU cost of a frame can be measured without a GPU.
+	// Counts are totals by function name since the last reset, empty when built with OpenGL
+	LGL_API static bool IsNullBackend();
+	LGL_API std::map<std::string, size_t> GetBackendCallCounts();
+	LGL_API void ResetBackendCallCounts();
+
+	// Software backend
+	// Built with LGL_SOFTWARE_BACKEND, scenes are rendered on CPU by LGLSoftwareRasterizer
+	// on all hardware threads, without a GPU or a GL driver. Only lightComb and single color
+	// programs are drawn, frames are read with RequestCapture
+	LGL_API static bool IsSoftwareBackend();
+
+	// Render graph
+	// Passes are ordered by the resources they read and write, passes that do not
+	// contribute to "backbuffer" (and have no side effects) are culled.
+	// Built in passes: "Scene" writes "sceneColor", "Upscale" reads "sceneColor" and writes "backbuffer"
+	LGL_API void AddRenderPass(
+		const std::string& name,
+		const std::vector<std::string>& reads,
+		const std::vector<std::string>& writes,
+		std::function<void()> execute,
+		bool hasSideEffects = false
+	);
+	LGL_API bool RemoveRenderPass(const std::string& name);
+	// Transient targets with non overlapping lifetimes and equal descriptions share memory
+	LGL_API void DeclareRenderTarget(const std::string& name, const LGLStructs::RenderResourceDesc& desc);
+	// Valid inside a pass only
+	LGL_API unsigned int GetRenderResource(const std::string& name);
+	LGL_API bool BindRenderTargets(const std::vector<std::string>& colorNames, const std::string& depthName = "");
+	LGL_API LGLRenderGraph::Stats GetRenderGraphStats();
+
+	// Shadow maps
+	// Rendered in "Shadows" pass with shadowDepth shader program, behaviours are called as usual,
+	// IsShadowPass can be used inside of them to only set "model" uniform or RenderInstances without culling.
+	// Static meshes are re-rendered only after they are invalidated or the light matrices change,
+	// meshes with isDynamic are drawn over the cached static depth every frame.
+	// Cube shadow map expects 6 matrices in GL_TEXTURE_CUBE_MAP_POSITIVE_X + i order
+	LGL_API bool CreateShadowMap(const std::string& name, int size, bool isCube = false);
+	LGL_API void DeleteShadowMap(const std::string& name);
+	LGL_API void SetShadowMapView(const std::string& name, const std::vector<glm::mat4>& lightSpaceMatrices);
+	LGL_API void InvalidateShadowMaps();
+	LGL_API void InvalidateShadowMap(const std::string& name);
+	// Only shadow maps with a face whose view the world space box intersects
+	LGL_API void InvalidateShadowMaps(const glm::vec3& boxMin, const glm::vec3& boxMax);
+	// Unknown names get the first shadow map unit, so samplers without a shadow map stay valid
+	LGL_API int GetShadowMapTextureUnit(const std::string& name);
+	LGL_API bool IsShadowPass();
+
+	// Instancing
+	// Draws current mesh once per model matrix, has to be called inside of a behaviour instead of
+	// setting "model" uniform per instance. Shader program gets per instance matrix at attribute 
+	// location 5, normal matrix at location 9 and "instanced" uniform set to true for the draw.
+	// If culling view is set, instances are culled as InstanceCulling describes
+	LGL_API void RenderInstances(
+		const std::vector<glm::mat4>& modelMatrices, 
+		LGLStructs::InstanceCulling culling = LGLStructs::InstanceCulling::All
+	);
+	// Same, with normal matrices cached by the caller instead of computed per instance on every draw
+	LGL_API void RenderInstances(
+		const std::vector<glm::mat4>& modelMatrices, 
+		const std::vector<glm::mat3>& normalMatrices, 
+		LGLStructs::InstanceCulling culling = LGLStructs::InstanceCulling::All
+	);
+	LGL_API void SetCullingView(const glm::mat4& viewProj, const glm::vec3& viewPos);
+	// Meshes with Mesh::meshlets are culled per meshlet on CPU and drawn with glMultiDrawElements.
+	// Cone culling removes back facing meshlets, so it expects one sided geometry
+	LGL_API void SetMeshletCulling(bool frustumCulling, bool coneCulling);
+	// Instances of meshes with Mesh::lods are drawn with the coarsest LOD whose error projected
+	// with the culling view stays under maxPixelError pixels, so switches are not noticeable.
+	// Instances drawn with meshlet culling use the base mesh, 0 disables LOD selection
+	LGL_API void SetLODSelection(float maxPixelError);
+
+	// Capture
+	// Window framebuffer is read into a ring of pixel pack buffers without waiting for the GPU,
+	// buffers are mapped frames later once their fence has signalled and handed to the callback 
+	// on a worker thread. Data is RGBA, rows go bottom to top, and is valid only during the callback
+	using CaptureCallback = std::function<void(const unsigned char* rgba, int width, int height, size_t frameNumber)>;
+	// Captures every frameInterval-th frame until StopCapture
+	LGL_API void StartCapture(const CaptureCallback& callback, size_t frameInterval = 1);
+	LGL_API void StopCapture();
+	// Captures the next frame once, for thumbnails
+	LGL_API void RequestCapture(const CaptureCallback& callback);
+
+	// Command capture
+	// GL calls are written with the data they read into a binary file for frameAmount frames
+	// (0 until StopCommandCapture), LGLReplay re-issues them with timing. Capture starts and stops
+	// with the next frame, objects alive at the start are read back and written as the calls that
+	// create them (not with the software backend, which cannot read them back)
+	LGL_API bool StartCommandCapture(const std::string& path, size_t frameAmount = 0);
+	LGL_API void StopCommandCapture();
+	LGL_API static bool IsCommandCaptureActive();
+
+	// GPU memory
+	// Buffers and textures are accounted by category. Over the budget, meshes whose render flag
+	// has been false for evictAfterFrames frames and textures unused for as long are released,
+	// least recently used first, and uploaded again on their next draw. Textures can be evicted
+	// only if they were configured while a budget was set, they keep a copy in system memory.
+	// Budget of 0 disables eviction, accounting is always on
+	LGL_API void SetMemoryBudget(size_t budgetBytes, size_t evictAfterFrames = 600);
+	LGL_API LGLStructs::MemoryStats GetMemoryStats();
+
+	// Debug draw
+	// Primitives are collected as lines into one streaming buffer and drawn by the "DebugDraw" pass
+	// with debugDraw shader program in a single draw, depth tested over the scene, with the view
+	// of SetCullingView. Lines are kept for the frame they were added in. The pass only exists while
+	// debug draw is enabled, otherwise the calls return right away and nothing is collected
+	LGL_API void SetDebugDraw(bool enabled);
+	LGL_API bool IsDebugDrawEnabled();
+	LGL_API void DebugLine(const glm::vec3& from, const glm::vec3& to, const glm::vec3& color);
+	LGL_API void DebugBox(const glm::vec3& min, const glm::vec3& max, const glm::vec3& color);
+	LGL_API void DebugSphere(const glm::vec3& center, float radius, const glm::vec3& color);
+	// Edges of the volume viewProj projects into clip space, for camera and light frusta
+	LGL_API void DebugFrustum(const glm::mat4& viewProj, const glm::vec3& color);
+
 	//Callback setters
 	LGL_API void SetCursorPositionCallback(std::function<void(double, double)> callbackFunc);
 	LGL_API void SetScrollCallback(std::function<void(double, double)> callbackFunc);
@@ -158,13 +462,23 @@ private:
 
 	// If no name is given will compile last loaded shader
 	bool CompileShader(const std::string& name = "");
-	bool LoadShaderFromFile(const std::string& name, const std::string& file, const std::string& shaderType);
+	// Defines are inserted after the first line, which is the #version one
+	bool LoadShaderFromFile(
+		const std::string& name, 
+		const std::string& file, 
+		const std::string& shaderType, 
+		const std::vector<std::string>& defines = {}
+	);
 
 	// If no list of shaders is provided, will create a program with all compiled shaders
 	bool CreateShaderProgram(const std::string& name, const std::vector<std::string>& shaderVector = {});
 
 	// If shader file names can be identical to shader program name, general load and compile can be used
 	bool LoadAndCompileShader(const std::string& name);
+	// Variant of the program of fileName, compiled from its files with the defines
+	bool LoadAndCompileShader(const std::string& name, const std::string& fileName, const std::vector<std::string>& defines);
+	// If the loaded sources of the program check the define with #ifdef or defined()
+	bool ShaderChecksDefine(const std::string& name, const std::string& define);
 
 
 
@@ -181,6 +495,88 @@ private:
 
 	void ProcessInput();
 	void Render();
+	void RenderScene();
+	void DrawMesh(VAOInfo& vaoInfo, const std::string& shaderProgram);
+	void DrawFullscreenTriangle();
+	void RenderShadowMaps();
+	void DrawShadowCasters(bool dynamicCasters);
+	void AttachShadowFace(FBO fboId, TextureID textureId, bool isCube, int face);
+	void DeleteShadowMapObjects(ShadowMapInfo& shadowMap);
+
+	// Weighted blended order independent transparency
+	void DeclareTransparencyTargets();
+	void RenderTransparent();
+	void CompositeTransparent();
+
+	// Capture
+	void CaptureFrame();
+	void ProcessCaptures();
+	void CaptureWorker();
+	void StopCaptureWorker();
+	// Starts and stops command capture requested since the last frame
+	void UpdateCommandCapture();
+	// Objects are written in dependency order, state bound at the start is written last
+	void RecordObjectSnapshot();
+	void RecordProgramSnapshot();
+	void RecordTextureSnapshot();
+	void RecordBufferSnapshot();
+	void RecordFramebufferSnapshot();
+	void RecordQuerySnapshot();
+
+	// GPU memory
+	// Returns uploaded size, leaves the vertex array bound
+	size_t UploadMeshBuffers(VAO vaoId);
+	void RestoreMesh(VAO vaoId);
+	// Frees system memory copies the retention policy of the mesh does not keep, after upload
+	void ReleaseMeshData(LGLStructs::MeshInfo& meshInfo);
+	void RestoreTexture(TextureID textureId);
+	void EvictResources();
+
+	// Debug draw
+	void AddDebugLine(const glm::vec3& from, const glm::vec3& to, uint32_t color);
+	// Corners are indexed by bits, 1 for x, 2 for y and 4 for z of the max corner
+	void AddDebugBoxEdges(const std::array<glm::vec3, 8>& corners, uint32_t color);
+	static uint32_t PackDebugColor(const glm::vec3& color);
+	void RenderDebugDraw();
+
+	// Profiler
+	size_t BeginGPUZone(const char* name);
+	void EndGPUZone(size_t zoneIndex);
+	void ResolveGPUZones();
+
+	// Render graph resources
+	unsigned int CreateRenderResource(const LGLStructs::RenderResourceDesc& desc, int width, int height);
+	void DeleteRenderResource(const LGLStructs::RenderResourceDesc& desc, unsigned int id);
+	void DeleteCachedFramebuffers(TextureID attachmentId);
+
+	// Instancing
+	InstanceBuffers& GetInstanceBuffers(VAO vaoId, size_t instanceAmount);
+	// Resolves the culling program and its uniform locations once, false if it is missing
+	bool PrepareInstanceCulling();
+	// Culls every LOD group in lodInstanceAmounts from firstGroup on in one pass, sets their drawAmount
+	void CullInstances(InstanceBuffers& instanceBuffers, size_t firstGroup, const glm::vec4& boundingSphere);
+	static std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& viewProj);
+	// Draws instanceTransforms for the current mesh
+	void RenderInstanceTransforms(LGLStructs::InstanceCulling culling);
+	void BindInstanceAttributes(VBO instanceSource, size_t firstInstance);
+	void RenderMeshletInstances(
+		const VAOInfo& vaoInfo, 
+		const LGLMeshletCuller& meshletCuller, 
+		const InstanceTransform* instances, 
+		size_t instanceAmount,
+		VBO instanceSource
+	);
+	// Fills lodSortedInstances grouped by LOD, from the base mesh up, and lodInstanceAmounts
+	void SortInstancesByLOD(const VAOInfo& vaoInfo, const std::vector<LODRange>& lods, const std::vector<InstanceTransform>& instances);
+
+	// Dynamic resolution
+	bool ResizeSceneTarget(int width, int height);
+	void DeleteSceneTarget();
+	void BeginSceneTarget();
+	void ResolveSceneTarget();
+	void BeginFrameTimer();
+	void EndFrameTimer();
+	void UpdateResolutionScale();
 
 	GLFWwindow* window;
 
@@ -208,6 +604,101 @@ private:
 	std::map<size_t, std::pair<OnPressFunction, OnReleaseFunction>> interactCollection;
 
 	std::unordered_set<size_t> uniformLocationTracker;
+
+	// Dynamic resolution
+	LGLStructs::DynamicResolutionConfig dynResConfig;
+	SceneTarget sceneTarget;
+	VAO fullscreenVAO;
+	std::array<Query, frameTimerQueryAmount> frameTimerQueries;
+	size_t frameTimerIndex;
+
+	std::mutex renderStatsMutex;
+	LGLStructs::RenderStats renderStats;
+
+	// Render graph
+	LGLRenderGraph renderGraph;
+	LGLRenderGraph::Allocator renderGraphAllocator;
+	std::map<std::vector<TextureID>, FBO> framebufferCache;
+
+	// Shadow maps
+	std::map<std::string, ShadowMapInfo> shadowMapCollection;
+	bool shadowPassActive;
+
+	// Transparency
+	// Shader program of a transparent mesh to its variant compiled with OIT defined,
+	// or to itself if its sources do not check OIT
+	std::map<std::string, std::string> transparentProgramCollection;
+	bool transparentMeshesPresent;
+
+	// Instancing
+	std::map<VAO, InstanceBuffers> instanceCollection;
+	std::vector<InstanceTransform> instanceTransforms;
+	std::array<glm::vec4, 6> cullingPlanes;
+	glm::mat4 cullingViewProj;
+	glm::vec3 cullingViewPos;
+	bool cullingViewSet;
+	size_t frameInstancesSubmitted;
+	size_t frameInstancesVisible;
+	bool instanceCullLoaded;
+	ShaderProgram instanceCullProgram;
+	int cullPlanesLocation;
+	int cullSphereLocation;
+	// Visible buffer is zeroed past what culling writes, zeroed transforms collapse to a point
+	std::vector<unsigned char> zeroInstanceData;
+
+	// Meshlets
+	std::map<VAO, LGLMeshletCuller> meshletCollection;
+	LGLMeshletCuller::DrawRanges meshletRanges;
+	bool meshletFrustumCulling;
+	bool meshletConeCulling;
+	size_t frameMeshletsSubmitted;
+	size_t frameMeshletsVisible;
+	size_t frameInstanceTriangles;
+
+	// LODs
+	std::map<VAO, std::vector<LODRange>> lodCollection;
+	float lodMaxPixelError;
+	std::vector<InstanceTransform> lodSortedInstances;
+	std::vector<size_t> lodInstanceAmounts;
+	std::vector<unsigned char> instanceLODs;
+
+	// Capture
+	std::array<CaptureSlot, captureSlotAmount> captureSlots;
+	CaptureCallback continuousCapture;
+	size_t captureFrameInterval;
+	std::vector<CaptureCallback> singleCaptures;
+	std::mutex captureMutex;
+	std::condition_variable captureCondition;
+	std::deque<size_t> mappedCaptures; // Slot indices waiting for the worker
+	std::unique_ptr<std::thread> captureThread;
+	bool captureThreadStop;
+	std::mutex commandCaptureMutex;
+	std::string commandCapturePath; // Empty if no start is requested
+	size_t commandCaptureFrames;
+	bool commandCaptureStopRequested;
+
+	// GPU memory
+	LGLMemoryBudget memoryBudget;
+	std::map<VAO, MeshBuffers> meshBufferCollection;
+	std::map<TextureID, TextureCopy> textureCopyCollection;
+	size_t evictAfterFrames;
+	size_t evictionCount;
+	size_t reuploadCount;
+	std::vector<LGLMemoryBudget::Object> evictions;
+
+	// Debug draw
+	std::atomic<bool> debugDrawEnabled;
+	std::vector<DebugVertex> debugVertices;
+	VAO debugDrawVAO;
+	VBO debugDrawVBO;
+	size_t debugDrawCapacity; // Vertices
+
+	// Profiler
+	std::array<GPUProfileFrame, gpuProfileLatency> gpuProfileFrames;
+	size_t gpuProfileFrameIndex;
+
+	// Output names captured by transform feedback, set before the program is linked
+	std::map<std::string, std::vector<std::string>> transformFeedbackVaryings;
 };
 
 #undef CALLBACK
@@ -0,0 +1,373 @@
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+#include <string>
+
+#include "LGLCommandRecorder.h"
+
+using namespace LGLCommandStream;
+
+bool LGLCommandRecorder::recording = false;
+bool LGLCommandRecorder::paused = false;
+
+namespace
+{
+	struct RecorderState
+	{
+		std::ofstream file;
+		std::string path;
+		std::unordered_map<std::string, uint16_t> functionIds;
+		size_t frameAmount = 0;
+		size_t framesRecorded = 0;
+		std::chrono::steady_clock::time_point lastFrameEnd;
+		int width = 0;
+		int height = 0;
+
+		// State that changes how much memory calls read
+		int unpackAlignment = 4;
+		bool packBufferBound = false;
+	};
+
+	RecorderState& GetState()
+	{
+		static RecorderState state;
+		return state;
+	}
+
+	template<typename Type>
+	void Write(Type value)
+	{
+		GetState().file.write(reinterpret_cast<const char*>(&value), sizeof(Type));
+	}
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		Write(static_cast<uint32_t>(size));
+		GetState().file.write(static_cast<const char*>(data), size);
+	}
+
+	// Bytes glTexImage2D reads, the last row is not padded to the alignment
+	size_t GetTextureSize(int64_t width, int64_t height, int64_t format, int64_t type, int alignment)
+	{
+		size_t channelAmount;
+		switch (format)
+		{
+		case GL_RED:
+		case GL_DEPTH_COMPONENT:
+		case GL_DEPTH_STENCIL:
+			channelAmount = 1;
+			break;
+		case GL_RG:
+			channelAmount = 2;
+			break;
+		case GL_RGB:
+		case GL_BGR:
+			channelAmount = 3;
+			break;
+		default:
+			channelAmount = 4;
+			break;
+		}
+
+		size_t channelSize;
+		switch (type)
+		{
+		case GL_UNSIGNED_BYTE:
+		case GL_BYTE:
+			channelSize = 1;
+			break;
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT:
+			channelSize = 2;
+			break;
+		default:
+			channelSize = 4;
+			break;
+		}
+
+		if (width <= 0 || height <= 0)
+		{
+			return 0;
+		}
+
+		size_t pixelRowSize = static_cast<size_t>(width) * channelAmount * channelSize;
+		size_t rowSize = (pixelRowSize + alignment - 1) / alignment * alignment;
+
+		return rowSize * static_cast<size_t>(height - 1) + pixelRowSize;
+	}
+}
+
+bool LGLCommandRecorder::Start(const std::string& path, size_t frameAmount)
+{
+	RecorderState& state = GetState();
+
+	if (recording)
+	{
+		std::cout << "[WARNING] GL command capture is already running into " << state.path << '\n';
+		return false;
+	}
+
+	state.file.open(path, std::ios::binary | std::ios::trunc);
+	if (!state.file)
+	{
+		std::cout << "[ERROR] Failed to open " << path << " for GL command capture\n";
+		return false;
+	}
+
+	state.path = path;
+	state.functionIds.clear();
+	state.frameAmount = frameAmount;
+	state.framesRecorded = 0;
+	state.lastFrameEnd = std::chrono::steady_clock::now();
+	state.width = 0;
+	state.height = 0;
+	state.unpackAlignment = 4;
+	state.packBufferBound = false;
+
+	Header header = { { magic[0], magic[1], magic[2], magic[3] }, version, 0, 0 };
+	Write(header);
+
+	recording = true;
+	paused = false;
+
+	std::cout << "GL command capture started into " << path << '\n';
+
+	return true;
+}
+
+void LGLCommandRecorder::Stop()
+{
+	RecorderState& state = GetState();
+
+	if (!recording)
+	{
+		return;
+	}
+
+	recording = false;
+
+	// Size is only known once a frame is rendered
+	state.file.seekp(offsetof(Header, width));
+	Write(static_cast<int32_t>(state.width));
+	Write(static_cast<int32_t>(state.height));
+	state.file.close();
+
+	std::cout << "GL command capture of " << state.framesRecorded << " frame(s) written into " << state.path << '\n';
+}
+
+void LGLCommandRecorder::EndFrame(int width, int height)
+{
+	RecorderState& state = GetState();
+
+	if (!recording)
+	{
+		return;
+	}
+
+	if (!state.framesRecorded)
+	{
+		state.width = width;
+		state.height = height;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+
+	Write(RecordType::FrameEnd);
+	Write(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - state.lastFrameEnd).count()));
+
+	state.lastFrameEnd = now;
+	++state.framesRecorded;
+
+	if (state.frameAmount && state.framesRecorded >= state.frameAmount)
+	{
+		Stop();
+	}
+}
+
+void LGLCommandRecorder::WriteCall(const std::string& function, int64_t result, const std::vector<Argument>& arguments)
+{
+	RecorderState& state = GetState();
+
+	auto idIter = state.functionIds.find(function);
+	if (idIter == state.functionIds.end())
+	{
+		idIter = state.functionIds.emplace(function, static_cast<uint16_t>(state.functionIds.size())).first;
+
+		Write(RecordType::Function);
+		Write(idIter->second);
+		Write(static_cast<uint16_t>(function.size()));
+		state.file.write(function.data(), function.size());
+	}
+
+	Write(RecordType::Call);
+	Write(idIter->second);
+	Write(static_cast<uint8_t>(arguments.size()));
+
+	for (size_t index = 0; index < arguments.size(); ++index)
+	{
+		WriteArgument(function, index, arguments);
+	}
+
+	Write(result);
+
+	if (function == "glPixelStorei" && arguments[0].integer == GL_UNPACK_ALIGNMENT)
+	{
+		state.unpackAlignment = static_cast<int>(arguments[1].integer);
+	}
+	else if (function == "glBindBuffer" && arguments[0].integer == GL_PIXEL_PACK_BUFFER)
+	{
+		state.packBufferBound = arguments[1].integer != 0;
+	}
+
+	if (!state.file)
+	{
+		std::cout << "[ERROR] Failed to write GL command capture, it is stopped\n";
+		Stop();
+	}
+}
+
+void LGLCommandRecorder::WriteArgument(const std::string& function, size_t index, const std::vector<Argument>& arguments)
+{
+	RecorderState& state = GetState();
+	const Argument& argument = arguments[index];
+
+	auto Integer = [&arguments](size_t argumentIndex)
+	{
+		return argumentIndex < arguments.size() ? arguments[argumentIndex].integer : 0;
+	};
+
+	auto WriteData = [&argument](int64_t size)
+	{
+		Write(ArgumentType::Data);
+		WriteBytes(argument.pointer, static_cast<size_t>(std::max<int64_t>(size, 0)));
+	};
+
+	auto WriteStrings = [&argument](int64_t amount, const GLint* lengths)
+	{
+		const GLchar* const* strings = static_cast<const GLchar* const*>(argument.pointer);
+
+		Write(ArgumentType::Strings);
+		Write(static_cast<uint32_t>(amount));
+
+		// Terminating 0 is kept, so replay can pass strings as they are in the file
+		for (int64_t i = 0; i < amount; ++i)
+		{
+			std::string value = lengths && lengths[i] >= 0 ? std::string(strings[i], lengths[i]) : std::string(strings[i]);
+			WriteBytes(value.c_str(), value.size() + 1);
+		}
+	};
+
+	switch (argument.kind)
+	{
+	case Argument::Kind::Integer:
+		Write(ArgumentType::Integer);
+		Write(argument.integer);
+		return;
+	case Argument::Kind::Float:
+		Write(ArgumentType::Float);
+		Write(argument.real);
+		return;
+	default:
+		break;
+	}
+
+	if (!argument.pointer)
+	{
+		Write(ArgumentType::Null);
+		return;
+	}
+
+	// glGen* names are written after the call, glDelete* names are read by it
+	if ((!function.compare(0, 5, "glGen") || !function.compare(0, 8, "glDelete")) && index == 1)
+	{
+		WriteData(Integer(0) * sizeof(GLuint));
+	}
+	else if (function == "glBufferData" && index == 2)
+	{
+		WriteData(Integer(1));
+	}
+	else if (function == "glBufferSubData" && index == 3)
+	{
+		WriteData(Integer(2));
+	}
+	else if (function == "glTexImage2D" && index == 8)
+	{
+		WriteData(GetTextureSize(Integer(3), Integer(4), Integer(6), Integer(7), state.unpackAlignment));
+	}
+	else if (function == "glTexParameterfv" && index == 2)
+	{
+		WriteData((Integer(1) == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(GLfloat));
+	}
+	else if (function == "glDrawBuffers" && index == 1)
+	{
+		WriteData(Integer(0) * sizeof(GLenum));
+	}
+	else if (function == "glUniform4fv" && index == 2)
+	{
+		WriteData(Integer(1) * 4 * sizeof(GLfloat));
+	}
+	else if (function == "glUniformMatrix4fv" && index == 3)
+	{
+		WriteData(Integer(1) * 16 * sizeof(GLfloat));
+	}
+	else if (function == "glClearBufferfv" && index == 2)
+	{
+		WriteData((Integer(0) == GL_COLOR ? 4 : 1) * sizeof(GLfloat));
+	}
+	else if (function == "glMultiDrawElements" && index == 1)
+	{
+		WriteData(Integer(4) * sizeof(GLsizei));
+	}
+	else if (function == "glMultiDrawElements" && index == 3)
+	{
+		const void* const* offsets = static_cast<const void* const*>(argument.pointer);
+
+		Write(ArgumentType::Offsets);
+		Write(static_cast<uint32_t>(Integer(4)));
+		for (int64_t i = 0; i < Integer(4); ++i)
+		{
+			Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(offsets[i])));
+		}
+	}
+	else if (function == "glShaderSource" && index == 2)
+	{
+		WriteStrings(Integer(1), static_cast<const GLint*>(arguments[3].pointer));
+	}
+	else if (function == "glShaderSource" && index == 3)
+	{
+		// Lengths are applied to the recorded strings
+		Write(ArgumentType::Null);
+	}
+	else if (function == "glTransformFeedbackVaryings" && index == 2)
+	{
+		WriteStrings(Integer(1), nullptr);
+	}
+	else if (function == "glGetUniformLocation" && index == 1)
+	{
+		const GLchar* name = static_cast<const GLchar*>(argument.pointer);
+
+		Write(ArgumentType::Strings);
+		Write(static_cast<uint32_t>(1));
+		WriteBytes(name, std::char_traits<GLchar>::length(name) + 1);
+	}
+	else if (function == "glReadPixels" && index == 6 && !state.packBufferBound)
+	{
+		Write(ArgumentType::Output);
+		Write(static_cast<uint32_t>(GetTextureSize(Integer(2), Integer(3), Integer(4), Integer(5), 8)));
+	}
+	else if (!function.compare(0, 5, "glGet"))
+	{
+		// Results of queries, replay only needs room for them
+		Write(ArgumentType::Output);
+		Write(static_cast<uint32_t>(16 * sizeof(GLint64)));
+	}
+	else
+	{
+		Write(ArgumentType::Offset);
+		Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(argument.pointer)));
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#include <glad/glad.h>
+
+#include "LGLCommandStream.h"
+
+/*
+	Records GL calls made through GLSafeExecute and GLExecute into a LGLCommandStream file,
+	with the buffer, texture and shader data they read, so LGLReplay can re-issue them
+	without the engine and its assets.
+
+	Sizes of memory behind pointer arguments are known per function, pointers of other
+	functions are recorded as outputs (glGet*) or as offsets (vertex attributes, indices)
+*/
+class LGLCommandRecorder
+{
+public:
+	// With frameAmount of 0 records until Stop
+	static bool Start(const std::string& path, size_t frameAmount);
+	static void Stop();
+	// Called before buffers are swapped, stops after the requested amount of frames
+	static void EndFrame(int width, int height);
+
+	static bool IsRecording()
+	{
+		return recording && !paused;
+	}
+
+	// Calls made while paused are not recorded, Record still writes, so state read back from GL
+	// can be written as the calls that recreate it
+	static void SetPaused(bool value)
+	{
+		paused = value;
+	}
+
+	template<typename... Types>
+	static void Record(const std::string& function, int64_t result, Types... values)
+	{
+		static std::vector<Argument> arguments;
+
+		arguments.clear();
+		int expand[] = { 0, (arguments.push_back(ToArgument(values)), 0)... };
+		(void)expand;
+
+		WriteCall(function, result, arguments);
+	}
+
+	template<typename Type>
+	static int64_t ToResult(Type value)
+	{
+		return ToResult(value, std::is_pointer<Type>());
+	}
+
+private:
+	struct Argument
+	{
+		enum class Kind
+		{
+			Integer,
+			Float,
+			Pointer
+		};
+
+		Kind kind;
+		int64_t integer;
+		double real;
+		const void* pointer;
+	};
+
+	template<typename Type>
+	static typename std::enable_if<std::is_integral<Type>::value || std::is_enum<Type>::value, Argument>::type ToArgument(Type value)
+	{
+		return { Argument::Kind::Integer, static_cast<int64_t>(value), 0.0, nullptr };
+	}
+
+	template<typename Type>
+	static typename std::enable_if<std::is_floating_point<Type>::value, Argument>::type ToArgument(Type value)
+	{
+		return { Argument::Kind::Float, 0, static_cast<double>(value), nullptr };
+	}
+
+	template<typename Type>
+	static Argument ToArgument(Type* value)
+	{
+		return { Argument::Kind::Pointer, 0, 0.0, value };
+	}
+
+	// Syncs are handles, not memory
+	static Argument ToArgument(GLsync value)
+	{
+		return { Argument::Kind::Integer, static_cast<int64_t>(reinterpret_cast<intptr_t>(value)), 0.0, nullptr };
+	}
+
+	static Argument ToArgument(std::nullptr_t)
+	{
+		return { Argument::Kind::Pointer, 0, 0.0, nullptr };
+	}
+
+	template<typename Type>
+	static int64_t ToResult(Type value, std::true_type)
+	{
+		return static_cast<int64_t>(reinterpret_cast<intptr_t>(value));
+	}
+
+	template<typename Type>
+	static int64_t ToResult(Type value, std::false_type)
+	{
+		return static_cast<int64_t>(value);
+	}
+
+	static void WriteCall(const std::string& function, int64_t result, const std::vector<Argument>& arguments);
+	static void WriteArgument(const std::string& function, size_t index, const std::vector<Argument>& arguments);
+
+	static bool recording;
+	static bool paused;
+};
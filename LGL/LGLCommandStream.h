@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+	Binary format of GL command captures, written by LGLCommandRecorder and read by LGLReplay
+
+	File starts with Header, followed by records, each one is a RecordType byte and its content:
+	 - Function: id (uint16), name length (uint16) and name, ids are given in order of first use
+	 - Call: function id (uint16), argument amount (uint8), arguments and the returned value (int64).
+	   Object names, uniform locations and syncs returned by calls are recorded, so replay
+	   can map them to its own
+	 - FrameEnd: buffers were swapped, nanoseconds since the previous frame end (uint64)
+
+	Every argument is an ArgumentType byte followed by:
+	 - Integer: int64, Float: double, Null: nothing, Offset: uint64 (pointer used as an offset into a bound buffer)
+	 - Data: size (uint32) and bytes the call reads, for glGen* it holds the names that were generated
+	 - Output: size (uint32) of memory the call writes, its content is not recorded
+	 - Strings: amount (uint32), each string is its size with terminating 0 (uint32) and bytes
+	 - Offsets: amount (uint32) of uint64 offsets, arrays of pointers used as offsets
+
+	Values are little endian, as written by the recording machine
+*/
+namespace LGLCommandStream
+{
+	constexpr char magic[4] = { 'L', 'G', 'L', 'C' };
+	constexpr uint32_t version = 1;
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		int32_t width;  // Framebuffer size of the first recorded frame
+		int32_t height;
+	};
+
+	enum class RecordType : uint8_t
+	{
+		Function,
+		Call,
+		FrameEnd
+	};
+
+	enum class ArgumentType : uint8_t
+	{
+		Integer,
+		Float,
+		Null,
+		Offset,
+		Data,
+		Output,
+		Strings,
+		Offsets
+	};
+}
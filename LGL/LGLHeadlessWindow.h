@@ -0,0 +1,111 @@
+#pragma once
+
+#ifndef LGL_EXPORT
+#error "LGLHeadlessWindow is LGL only"
+#endif
+
+/*
+	Fake GLFW window for LGL backends that do not need a GL context
+	(LGL_NULL_BACKEND and LGL_SOFTWARE_BACKEND)
+
+	Framebuffer keeps the size the window was created with, there is no input,
+	rendering cycle runs until glfwSetWindowShouldClose (StopRenderingCycle).
+
+	Has to be included after GLFW, names are redirected with macros
+*/
+
+#include <GLFW/glfw3.h>
+
+class LGLHeadlessWindow
+{
+public:
+	static int& FramebufferWidth()
+	{
+		static int width = 0;
+		return width;
+	}
+
+	static int& FramebufferHeight()
+	{
+		static int height = 0;
+		return height;
+	}
+
+	static bool& WindowShouldClose()
+	{
+		static bool shouldClose = false;
+		return shouldClose;
+	}
+
+	static GLFWwindow* glfwCreateWindow(int width, int height, const char*, GLFWmonitor*, GLFWwindow*)
+	{
+		FramebufferWidth() = width;
+		FramebufferHeight() = height;
+		WindowShouldClose() = false;
+
+		return GetWindow();
+	}
+
+	static GLFWwindow* glfwGetCurrentContext()
+	{
+		return GetWindow();
+	}
+
+	static void glfwGetFramebufferSize(GLFWwindow*, int* width, int* height)
+	{
+		*width = FramebufferWidth();
+		*height = FramebufferHeight();
+	}
+
+	static int glfwWindowShouldClose(GLFWwindow*)
+	{
+		return WindowShouldClose();
+	}
+
+	static void glfwSetWindowShouldClose(GLFWwindow*, int value)
+	{
+		WindowShouldClose() = value;
+	}
+
+	static int glfwGetKey(GLFWwindow*, int)
+	{
+		return GLFW_RELEASE;
+	}
+
+	static int glfwInit() { return GLFW_TRUE; }
+	static void glfwTerminate() {}
+	static void glfwWindowHint(int, int) {}
+	static void glfwMakeContextCurrent(GLFWwindow*) {}
+	static void glfwSetInputMode(GLFWwindow*, int, int) {}
+	static void glfwSwapBuffers(GLFWwindow*) {}
+	static void glfwPollEvents() {}
+	static GLFWframebuffersizefun glfwSetFramebufferSizeCallback(GLFWwindow*, GLFWframebuffersizefun) { return nullptr; }
+	static GLFWerrorfun glfwSetErrorCallback(GLFWerrorfun) { return nullptr; }
+	static GLFWcursorposfun glfwSetCursorPosCallback(GLFWwindow*, GLFWcursorposfun) { return nullptr; }
+	static GLFWscrollfun glfwSetScrollCallback(GLFWwindow*, GLFWscrollfun) { return nullptr; }
+
+private:
+	// Window is never dereferenced, address only has to be unique and not null
+	static GLFWwindow* GetWindow()
+	{
+		return reinterpret_cast<GLFWwindow*>(&WindowShouldClose());
+	}
+};
+
+#define glfwCreateWindow LGLHeadlessWindow::glfwCreateWindow
+#define glfwGetCurrentContext LGLHeadlessWindow::glfwGetCurrentContext
+#define glfwGetFramebufferSize LGLHeadlessWindow::glfwGetFramebufferSize
+#define glfwWindowShouldClose LGLHeadlessWindow::glfwWindowShouldClose
+#define glfwSetWindowShouldClose LGLHeadlessWindow::glfwSetWindowShouldClose
+#define glfwGetKey LGLHeadlessWindow::glfwGetKey
+#define glfwInit LGLHeadlessWindow::glfwInit
+#define glfwTerminate LGLHeadlessWindow::glfwTerminate
+#define glfwWindowHint LGLHeadlessWindow::glfwWindowHint
+#define glfwMakeContextCurrent LGLHeadlessWindow::glfwMakeContextCurrent
+#define glfwSetInputMode LGLHeadlessWindow::glfwSetInputMode
+#define glfwSwapBuffers LGLHeadlessWindow::glfwSwapBuffers
+#define glfwPollEvents LGLHeadlessWindow::glfwPollEvents
+#define glfwSetFramebufferSizeCallback LGLHeadlessWindow::glfwSetFramebufferSizeCallback
+#define glfwSetErrorCallback LGLHeadlessWindow::glfwSetErrorCallback
+#define glfwSetCursorPosCallback LGLHeadlessWindow::glfwSetCursorPosCallback
+#define glfwSetScrollCallback LGLHeadlessWindow::glfwSetScrollCallback
\ No newline at end of file
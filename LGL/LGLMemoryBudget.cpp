@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <numeric>
+
+#include "LGLMemoryBudget.h"
+
+void LGLMemoryBudget::Track(ObjectType type, unsigned int id, Category category, size_t size)
+{
+	Untrack(type, id);
+
+	allocations[GetKey(type, id)] = { category, size };
+	totals[static_cast<size_t>(category)] += size;
+}
+
+void LGLMemoryBudget::Untrack(ObjectType type, unsigned int id)
+{
+	auto allocationIter = allocations.find(GetKey(type, id));
+
+	if (allocationIter == allocations.end())
+	{
+		return;
+	}
+
+	totals[static_cast<size_t>(allocationIter->second.category)] -= allocationIter->second.size;
+	allocations.erase(allocationIter);
+}
+
+void LGLMemoryBudget::SetEvictable(ObjectType type, unsigned int id, size_t releasedSize, size_t frame)
+{
+	evictables[GetKey(type, id)] = { releasedSize, frame, true };
+}
+
+void LGLMemoryBudget::SetResident(ObjectType type, unsigned int id, bool resident)
+{
+	auto evictableIter = evictables.find(GetKey(type, id));
+
+	if (evictableIter != evictables.end())
+	{
+		evictableIter->second.resident = resident;
+	}
+}
+
+bool LGLMemoryBudget::IsResident(ObjectType type, unsigned int id) const
+{
+	auto evictableIter = evictables.find(GetKey(type, id));
+
+	return evictableIter == evictables.end() || evictableIter->second.resident;
+}
+
+void LGLMemoryBudget::Touch(ObjectType type, unsigned int id, size_t frame)
+{
+	auto evictableIter = evictables.find(GetKey(type, id));
+
+	if (evictableIter != evictables.end())
+	{
+		evictableIter->second.lastUsedFrame = frame;
+	}
+}
+
+void LGLMemoryBudget::CollectEvictions(size_t frame, size_t unusedFrames, std::vector<Object>& evictions) const
+{
+	evictions.clear();
+
+	size_t total = GetTotal();
+
+	if (!budget || total <= budget)
+	{
+		return;
+	}
+
+	using Candidate = std::pair<uint64_t, const Evictable*>;
+	std::vector<Candidate> candidates;
+
+	for (auto& evictable : evictables)
+	{
+		if (evictable.second.resident && evictable.second.lastUsedFrame + unusedFrames <= frame)
+		{
+			candidates.emplace_back(evictable.first, &evictable.second);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& left, const Candidate& right)
+	{
+		return left.second->lastUsedFrame < right.second->lastUsedFrame;
+	});
+
+	for (auto& candidate : candidates)
+	{
+		if (total <= budget)
+		{
+			break;
+		}
+
+		evictions.emplace_back(static_cast<ObjectType>(candidate.first >> 32), static_cast<unsigned int>(candidate.first));
+		total -= std::min(total, candidate.second->releasedSize);
+	}
+}
+
+void LGLMemoryBudget::SetBudget(size_t bytes)
+{
+	budget = bytes;
+}
+
+size_t LGLMemoryBudget::GetBudget() const
+{
+	return budget;
+}
+
+size_t LGLMemoryBudget::GetTotal() const
+{
+	return std::accumulate(totals.begin(), totals.end(), static_cast<size_t>(0));
+}
+
+size_t LGLMemoryBudget::GetTotal(Category category) const
+{
+	return totals[static_cast<size_t>(category)];
+}
+
+std::vector<unsigned int> LGLMemoryBudget::GetObjects(ObjectType type) const
+{
+	std::vector<unsigned int> objects;
+
+	for (auto& allocation : allocations)
+	{
+		if (allocation.first >> 32 == static_cast<uint64_t>(type))
+		{
+			objects.push_back(static_cast<unsigned int>(allocation.first));
+		}
+	}
+
+	return objects;
+}
+
+uint64_t LGLMemoryBudget::GetKey(ObjectType type, unsigned int id)
+{
+	return (static_cast<uint64_t>(type) << 32) | id;
+}
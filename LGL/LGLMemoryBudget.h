@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+	Accounting of GPU memory allocated by LGL
+
+	Every buffer and texture is tracked under a category with its size, tracking the same
+	object again replaces its size. Sizes are estimated from dimensions and formats,
+	drivers add their own padding and alignment on top.
+
+	Evictable entries stand for what their owner can release and restore later (buffers of
+	a mesh, a texture). Once the total is over budget, entries unused for long enough are
+	evicted least recently used first, until it fits
+*/
+class LGLMemoryBudget
+{
+public:
+	enum class Category
+	{
+		Vertex,
+		Index,
+		Texture,
+		RenderTarget,
+		Staging,
+		_SIZE
+	};
+
+	enum class ObjectType
+	{
+		Buffer,
+		Texture,
+		VertexArray
+	};
+
+	using Object = std::pair<ObjectType, unsigned int>;
+
+	void Track(ObjectType type, unsigned int id, Category category, size_t size);
+	void Untrack(ObjectType type, unsigned int id);
+
+	// Released size is what evicting the entry frees, it starts resident and used in frame
+	void SetEvictable(ObjectType type, unsigned int id, size_t releasedSize, size_t frame);
+	void SetResident(ObjectType type, unsigned int id, bool resident);
+	// Objects that are not evictable are always resident
+	bool IsResident(ObjectType type, unsigned int id) const;
+	void Touch(ObjectType type, unsigned int id, size_t frame);
+
+	// Fills resident entries unused for at least unusedFrames, in eviction order
+	void CollectEvictions(size_t frame, size_t unusedFrames, std::vector<Object>& evictions) const;
+
+	// 0 disables eviction
+	void SetBudget(size_t bytes);
+	size_t GetBudget() const;
+	size_t GetTotal() const;
+	size_t GetTotal(Category category) const;
+	// Ids of tracked objects of the type, in no particular order
+	std::vector<unsigned int> GetObjects(ObjectType type) const;
+
+private:
+	struct Allocation
+	{
+		Category category;
+		size_t size;
+	};
+
+	struct Evictable
+	{
+		size_t releasedSize;
+		size_t lastUsedFrame;
+		bool resident;
+	};
+
+	static uint64_t GetKey(ObjectType type, unsigned int id);
+
+	std::unordered_map<uint64_t, Allocation> allocations;
+	std::unordered_map<uint64_t, Evictable> evictables;
+	std::array<size_t, static_cast<size_t>(Category::_SIZE)> totals = {};
+	size_t budget = 0;
+};
@@ -0,0 +1,146 @@
+#include <emmintrin.h>
+#include <algorithm>
+
+#include "LGLMeshletCuller.h"
+
+LGLMeshletCuller::LGLMeshletCuller(const std::vector<LGLStructs::Meshlet>& meshlets)
+{
+	meshletAmount = meshlets.size();
+
+	size_t paddedAmount = (meshletAmount + 3) & ~static_cast<size_t>(3);
+
+	for (auto* soaArray : { &centerX, &centerY, &centerZ, &radius, &axisX, &axisY, &axisZ, &cutoff })
+	{
+		soaArray->assign(paddedAmount, 0.0f);
+	}
+
+	for (size_t i = 0; i < meshletAmount; ++i)
+	{
+		const LGLStructs::Meshlet& meshlet = meshlets[i];
+
+		centerX[i] = meshlet.boundingSphere.x;
+		centerY[i] = meshlet.boundingSphere.y;
+		centerZ[i] = meshlet.boundingSphere.z;
+		radius[i]  = meshlet.boundingSphere.w;
+		axisX[i]   = meshlet.cone.x;
+		axisY[i]   = meshlet.cone.y;
+		axisZ[i]   = meshlet.cone.z;
+		cutoff[i]  = meshlet.cone.w;
+
+		indexOffsets.push_back(meshlet.indexOffset);
+		indexAmounts.push_back(meshlet.indexAmount);
+	}
+}
+
+size_t LGLMeshletCuller::Cull(
+	const std::array<glm::vec4, 6>& frustumPlanes,
+	const glm::vec3& viewPos,
+	const glm::mat4& model,
+	bool frustumCulling,
+	bool coneCulling,
+	DrawRanges& ranges
+) const
+{
+	ranges.counts.clear();
+	ranges.offsets.clear();
+
+	// dot(plane, model * point) == dot(transpose(model) * plane, point), distance stays in world units
+	glm::mat4 modelTransposed = glm::transpose(model);
+	std::array<glm::vec4, 6> modelPlanes;
+	for (size_t i = 0; i < frustumPlanes.size(); ++i)
+	{
+		modelPlanes[i] = modelTransposed * frustumPlanes[i];
+	}
+
+	float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	glm::vec3 modelViewPos = glm::vec3(glm::inverse(model) * glm::vec4(viewPos, 1.0f));
+
+	// Mirroring flips the winding, normal cones would point the other way
+	bool useCone = coneCulling && glm::determinant(glm::mat3(model)) > 0.0f;
+
+	const __m128 allVisible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	const __m128 scaleVec = _mm_set1_ps(scale);
+	const __m128 viewX = _mm_set1_ps(modelViewPos.x);
+	const __m128 viewY = _mm_set1_ps(modelViewPos.y);
+	const __m128 viewZ = _mm_set1_ps(modelViewPos.z);
+
+	size_t visibleAmount = 0;
+	unsigned int lastRangeEnd = static_cast<unsigned int>(-1);
+
+	for (size_t base = 0; base < meshletAmount; base += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&centerX[base]);
+		__m128 cy = _mm_loadu_ps(&centerY[base]);
+		__m128 cz = _mm_loadu_ps(&centerZ[base]);
+		__m128 r  = _mm_loadu_ps(&radius[base]);
+
+		__m128 visible = allVisible;
+
+		if (frustumCulling)
+		{
+			__m128 negWorldRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(r, scaleVec));
+
+			for (const glm::vec4& plane : modelPlanes)
+			{
+				__m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w))
+				);
+
+				visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negWorldRadius));
+			}
+		}
+
+		if (useCone)
+		{
+			// Whole meshlet faces away if dot(center - view, axis) >= cutoff * |center - view| + radius
+			__m128 toCenterX = _mm_sub_ps(cx, viewX);
+			__m128 toCenterY = _mm_sub_ps(cy, viewY);
+			__m128 toCenterZ = _mm_sub_ps(cz, viewZ);
+
+			__m128 axisDot = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(toCenterX, _mm_loadu_ps(&axisX[base])), _mm_mul_ps(toCenterY, _mm_loadu_ps(&axisY[base]))),
+				_mm_mul_ps(toCenterZ, _mm_loadu_ps(&axisZ[base]))
+			);
+			__m128 distance = _mm_sqrt_ps(_mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(toCenterX, toCenterX), _mm_mul_ps(toCenterY, toCenterY)),
+				_mm_mul_ps(toCenterZ, toCenterZ)
+			));
+
+			__m128 backfacing = _mm_cmpge_ps(axisDot, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&cutoff[base]), distance), r));
+			visible = _mm_andnot_ps(backfacing, visible);
+		}
+
+		int visibleMask = _mm_movemask_ps(visible);
+
+		for (size_t lane = 0; lane < 4 && base + lane < meshletAmount; ++lane)
+		{
+			if (!(visibleMask & (1 << lane)))
+			{
+				continue;
+			}
+
+			size_t meshlet = base + lane;
+			++visibleAmount;
+
+			if (indexOffsets[meshlet] == lastRangeEnd)
+			{
+				ranges.counts.back() += indexAmounts[meshlet];
+			}
+			else
+			{
+				ranges.counts.push_back(indexAmounts[meshlet]);
+				ranges.offsets.push_back(reinterpret_cast<const void*>(indexOffsets[meshlet] * sizeof(unsigned int)));
+			}
+
+			lastRangeEnd = indexOffsets[meshlet] + indexAmounts[meshlet];
+		}
+	}
+
+	return visibleAmount;
+}
+
+size_t LGLMeshletCuller::GetMeshletAmount() const
+{
+	return meshletAmount;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "LGLStructs.h"
+
+/*
+	CPU culling of meshlets for LGL
+
+	Bounds are kept as structure of arrays padded to a multiple of 4,
+	so 4 meshlets are tested at once with SSE. Tests are done in model space:
+	frustum planes and view position are moved into it once per draw,
+	instead of moving every meshlet into world space.
+	Backface test with a normal cone does not depend on the transform,
+	as long as it does not mirror the mesh
+*/
+class LGLMeshletCuller
+{
+public:
+	// Arguments for glMultiDrawElements, adjacent visible meshlets are merged into one range
+	struct DrawRanges
+	{
+		std::vector<int> counts;
+		std::vector<const void*> offsets;
+	};
+
+	LGLMeshletCuller() = default;
+	explicit LGLMeshletCuller(const std::vector<LGLStructs::Meshlet>& meshlets);
+
+	// Returns amount of visible meshlets, frustum planes are in world space and normalized
+	size_t Cull(
+		const std::array<glm::vec4, 6>& frustumPlanes,
+		const glm::vec3& viewPos,
+		const glm::mat4& model,
+		bool frustumCulling,
+		bool coneCulling,
+		DrawRanges& ranges
+	) const;
+
+	size_t GetMeshletAmount() const;
+
+private:
+	size_t meshletAmount = 0;
+
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+	std::vector<float> axisX;
+	std::vector<float> axisY;
+	std::vector<float> axisZ;
+	std::vector<float> cutoff;
+
+	std::vector<unsigned int> indexOffsets;
+	std::vector<unsigned int> indexAmounts;
+};
@@ -0,0 +1,314 @@
+#pragma once
+
+#ifndef LGL_EXPORT
+#error "LGLNullBackend is LGL only"
+#endif
+
+/*
+	Null backend for LGL, enabled with LGL_NULL_BACKEND define
+
+	Every GLSafeExecute call and every OpenGL or GLFW function LGL calls directly is
+	replaced with a stub that does no work and only counts calls by function name.
+	glGen* and glCreate* return fake object names. Values reported back:
+	 - glGet* write 1 into every output, so sizes and counts are 1, statuses and query
+	   availability are GL_TRUE and timer queries report 1 ns
+	 - GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN queries report the primitives drawn while
+	   they were active, so instances culled on GPU are all visible
+	 - glGetUniformLocation returns 0, glIsEnabled GL_TRUE
+	 - framebuffers are complete, fences are signalled right away and mapped memory is zeroed
+	Window is replaced with LGLHeadlessWindow, so RunRenderingCycle can be driven
+	without a GPU.
+
+	Has to be included after glad, names are redirected with macros
+*/
+
+#include <glad/glad.h>
+
+#include "LGLHeadlessWindow.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <type_traits>
+
+// glad defines its function names as macros, stubs below reuse these names
+#undef glCreateShader
+#undef glCreateProgram
+#undef glGetUniformLocation
+#undef glIsEnabled
+#undef glCheckFramebufferStatus
+#undef glFenceSync
+#undef glClientWaitSync
+#undef glMapBufferRange
+#undef glGetError
+#undef glDeleteSync
+#undef glEndTransformFeedback
+#undef glViewport
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform3f
+#undef glUniform4f
+#undef glUniformMatrix4fv
+
+class LGLNullBackend
+{
+public:
+	using CallCounts = std::unordered_map<std::string, size_t>;
+
+	static CallCounts& GetCallCounts()
+	{
+		static CallCounts callCounts;
+		return callCounts;
+	}
+
+	template<typename... Types>
+	static void Execute(const std::string& annotation, Types... values)
+	{
+		++GetCallCounts()[annotation];
+
+		if (!annotation.compare(0, 5, "glGen"))
+		{
+			GenerateNames(values...);
+		}
+		else if (annotation == "glGetQueryObjectuiv")
+		{
+			WriteQueryResult(values...);
+		}
+		else if (!annotation.compare(0, 5, "glGet"))
+		{
+			WriteResults(values...);
+		}
+		else if (annotation == "glBeginQuery" || annotation == "glEndQuery")
+		{
+			TrackQuery(annotation == "glBeginQuery", values...);
+		}
+		else if (annotation == "glDrawArrays")
+		{
+			CountPrimitives(values...);
+		}
+	}
+
+	// OpenGL functions called outside of GLSafeExecute
+	static GLuint glCreateShader(GLenum)
+	{
+		Count("glCreateShader");
+		return NextName();
+	}
+
+	static GLuint glCreateProgram()
+	{
+		Count("glCreateProgram");
+		return NextName();
+	}
+
+	static GLint glGetUniformLocation(GLuint, const GLchar*)
+	{
+		Count("glGetUniformLocation");
+		return 0;
+	}
+
+	static GLboolean glIsEnabled(GLenum)
+	{
+		Count("glIsEnabled");
+		return GL_TRUE;
+	}
+
+	static GLenum glCheckFramebufferStatus(GLenum)
+	{
+		Count("glCheckFramebufferStatus");
+		return GL_FRAMEBUFFER_COMPLETE;
+	}
+
+	static GLsync glFenceSync(GLenum, GLbitfield)
+	{
+		Count("glFenceSync");
+		return reinterpret_cast<GLsync>(&GetCallCounts());
+	}
+
+	static GLenum glClientWaitSync(GLsync, GLbitfield, GLuint64)
+	{
+		Count("glClientWaitSync");
+		return GL_ALREADY_SIGNALED;
+	}
+
+	// Mapped memory is zeroed and stays valid until backend is unloaded,
+	// as other threads may still read an older mapping
+	static void* glMapBufferRange(GLenum, GLintptr offset, GLsizeiptr length, GLbitfield)
+	{
+		static std::vector<std::unique_ptr<unsigned char[]>> mappings;
+		static size_t mappingSize = 0;
+
+		Count("glMapBufferRange");
+
+		size_t requiredSize = static_cast<size_t>(offset + length);
+		if (requiredSize > mappingSize || mappings.empty())
+		{
+			mappings.emplace_back(new unsigned char[requiredSize]());
+			mappingSize = requiredSize;
+		}
+
+		return mappings.back().get();
+	}
+
+	static GLenum glGetError() { return GL_NO_ERROR; }
+	static void glDeleteSync(GLsync) { Count("glDeleteSync"); }
+	static void glEndTransformFeedback() { Count("glEndTransformFeedback"); }
+	static void glViewport(GLint, GLint, GLsizei, GLsizei) { Count("glViewport"); }
+	static void glUniform1i(GLint, GLint) { Count("glUniform1i"); }
+	static void glUniform1f(GLint, GLfloat) { Count("glUniform1f"); }
+	static void glUniform3f(GLint, GLfloat, GLfloat, GLfloat) { Count("glUniform3f"); }
+	static void glUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) { Count("glUniform4f"); }
+	static void glUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { Count("glUniformMatrix4fv"); }
+
+private:
+	static void Count(const char* name)
+	{
+		++GetCallCounts()[name];
+	}
+
+	static GLuint NextName()
+	{
+		static GLuint lastName = 0;
+		return ++lastName;
+	}
+
+	static void GenerateNames(GLsizei amount, GLuint* names)
+	{
+		for (GLsizei i = 0; i < amount; ++i)
+		{
+			names[i] = NextName();
+		}
+	}
+
+	// glGenerateMipmap and alike
+	template<typename... Types>
+	static void GenerateNames(Types...) {}
+
+	struct PrimitiveQueries
+	{
+		GLuint active = 0;
+		std::unordered_map<GLuint, GLuint> written; // By query
+	};
+
+	static PrimitiveQueries& GetPrimitiveQueries()
+	{
+		static PrimitiveQueries primitiveQueries;
+		return primitiveQueries;
+	}
+
+	template<typename Target, typename Id>
+	static typename std::enable_if<std::is_integral<Target>::value && std::is_integral<Id>::value>::type TrackQuery(
+		bool begin, 
+		Target target, 
+		Id id
+	)
+	{
+		PrimitiveQueries& primitiveQueries = GetPrimitiveQueries();
+
+		if (static_cast<GLenum>(target) == GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN)
+		{
+			primitiveQueries.active = begin ? static_cast<GLuint>(id) : 0;
+			primitiveQueries.written[primitiveQueries.active] = 0;
+		}
+	}
+
+	// glEndQuery takes only the target
+	template<typename Target>
+	static typename std::enable_if<std::is_integral<Target>::value>::type TrackQuery(bool begin, Target target)
+	{
+		if (!begin && static_cast<GLenum>(target) == GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN)
+		{
+			GetPrimitiveQueries().active = 0;
+		}
+	}
+
+	template<typename... Types>
+	static void TrackQuery(bool, Types...) {}
+
+	template<typename Mode, typename First, typename Count>
+	static typename std::enable_if<std::is_integral<Mode>::value && std::is_integral<Count>::value>::type CountPrimitives(
+		Mode mode, 
+		First, 
+		Count count
+	)
+	{
+		PrimitiveQueries& primitiveQueries = GetPrimitiveQueries();
+
+		if (!primitiveQueries.active)
+		{
+			return;
+		}
+
+		GLuint verticesPerPrimitive = mode == GL_POINTS ? 1 : mode == GL_LINES ? 2 : 3;
+		primitiveQueries.written[primitiveQueries.active] += static_cast<GLuint>(count) / verticesPerPrimitive;
+	}
+
+	template<typename... Types>
+	static void CountPrimitives(Types...) {}
+
+	template<typename Id, typename Name>
+	static typename std::enable_if<std::is_integral<Id>::value && std::is_integral<Name>::value>::type WriteQueryResult(
+		Id id, 
+		Name name, 
+		GLuint* params
+	)
+	{
+		auto& written = GetPrimitiveQueries().written;
+		auto writtenIter = written.find(static_cast<GLuint>(id));
+
+		if (params)
+		{
+			*params = static_cast<GLenum>(name) == GL_QUERY_RESULT && writtenIter != written.end() ? writtenIter->second : 1;
+		}
+	}
+
+	template<typename... Types>
+	static void WriteQueryResult(Types... values)
+	{
+		WriteResults(values...);
+	}
+
+	static void WriteResults() {}
+
+	template<typename Type, typename... Types>
+	static void WriteResults(Type value, Types... values)
+	{
+		using Pointee = typename std::remove_pointer<Type>::type;
+
+		WriteResult(value, std::integral_constant<bool,
+			std::is_pointer<Type>::value && std::is_arithmetic<Pointee>::value && !std::is_const<Pointee>::value
+		>());
+		WriteResults(values...);
+	}
+
+	template<typename Type>
+	static void WriteResult(Type value, std::true_type)
+	{
+		if (value)
+		{
+			*value = 1;
+		}
+	}
+
+	template<typename Type>
+	static void WriteResult(Type, std::false_type) {}
+};
+
+#define glCreateShader LGLNullBackend::glCreateShader
+#define glCreateProgram LGLNullBackend::glCreateProgram
+#define glGetUniformLocation LGLNullBackend::glGetUniformLocation
+#define glIsEnabled LGLNullBackend::glIsEnabled
+#define glCheckFramebufferStatus LGLNullBackend::glCheckFramebufferStatus
+#define glFenceSync LGLNullBackend::glFenceSync
+#define glClientWaitSync LGLNullBackend::glClientWaitSync
+#define glMapBufferRange LGLNullBackend::glMapBufferRange
+#define glGetError LGLNullBackend::glGetError
+#define glDeleteSync LGLNullBackend::glDeleteSync
+#define glEndTransformFeedback LGLNullBackend::glEndTransformFeedback
+#define glViewport LGLNullBackend::glViewport
+#define glUniform1i LGLNullBackend::glUniform1i
+#define glUniform1f LGLNullBackend::glUniform1f
+#define glUniform3f LGLNullBackend::glUniform3f
+#define glUniform4f LGLNullBackend::glUniform4f
+#define glUniformMatrix4fv LGLNullBackend::glUniformMatrix4fv
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define LGL_EXPORT
+#include "LGLProfiler.h"
+
+namespace
+{
+	struct Zone
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	// Written only by its thread and read only by Collect, so indices are enough for synchronization
+	struct ThreadBuffer
+	{
+		constexpr static size_t capacity = 16384;
+
+		ThreadBuffer(uint32_t threadId, const std::string& threadName) : threadId(threadId), threadName(threadName) {}
+
+		std::array<Zone, capacity> zones;
+		std::atomic<uint64_t> written{ 0 };
+		std::atomic<uint64_t> read{ 0 };
+		std::atomic<uint64_t> dropped{ 0 };
+
+		uint32_t threadId;
+		std::string threadName;
+	};
+
+	struct CapturedZone
+	{
+		Zone zone;
+		uint32_t threadId;
+	};
+
+	struct ProfilerState
+	{
+		std::atomic<bool> capturing{ false };
+
+		std::mutex threadsMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> threads;
+
+		// Guards everything below, only taken by Collect, capture control and export
+		std::mutex captureMutex;
+		std::vector<CapturedZone> captured;
+		uint64_t captureStart = 0;
+		uint64_t droppedZones = 0;
+		bool limitReached = false;
+	};
+
+	// Zones past this amount are not captured, about 64 MB
+	constexpr size_t maxCapturedZones = 2 * 1024 * 1024;
+	// Thread id GPU zones are shown under
+	constexpr uint32_t gpuThreadId = 0;
+
+	ProfilerState& GetState()
+	{
+		static ProfilerState state;
+		return state;
+	}
+
+	ThreadBuffer& GetThreadBuffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+
+		if (!buffer)
+		{
+			ProfilerState& state = GetState();
+			std::lock_guard<std::mutex> lock(state.threadsMutex);
+
+			uint32_t threadId = static_cast<uint32_t>(state.threads.size() + 1);
+
+			state.threads.push_back(std::make_unique<ThreadBuffer>(threadId, "Thread " + std::to_string(threadId)));
+			buffer = state.threads.back().get();
+		}
+
+		return *buffer;
+	}
+
+	ThreadBuffer& GetGPUBuffer()
+	{
+		static ThreadBuffer buffer(gpuThreadId, "GPU");
+		return buffer;
+	}
+
+	void PushZone(ThreadBuffer& buffer, const char* name, uint64_t start, uint64_t end)
+	{
+		uint64_t written = buffer.written.load(std::memory_order_relaxed);
+
+		if (written - buffer.read.load(std::memory_order_acquire) >= ThreadBuffer::capacity)
+		{
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		buffer.zones[written % ThreadBuffer::capacity] = { name, start, end };
+		buffer.written.store(written + 1, std::memory_order_release);
+	}
+
+	// captureMutex has to be held
+	void Drain(ProfilerState& state, ThreadBuffer& buffer)
+	{
+		uint64_t read = buffer.read.load(std::memory_order_relaxed);
+		uint64_t written = buffer.written.load(std::memory_order_acquire);
+
+		for (; read < written; ++read)
+		{
+			const Zone& zone = buffer.zones[read % ThreadBuffer::capacity];
+
+			// Zones which started before the capture belong to the previous one
+			if (zone.start < state.captureStart)
+			{
+				continue;
+			}
+
+			if (state.captured.size() >= maxCapturedZones)
+			{
+				state.limitReached = true;
+				break;
+			}
+
+			state.captured.push_back({ zone, buffer.threadId });
+		}
+
+		buffer.read.store(written, std::memory_order_release);
+		state.droppedZones += buffer.dropped.exchange(0, std::memory_order_relaxed);
+	}
+
+	void WriteEscaped(std::ostream& stream, const char* text)
+	{
+		for (; *text; ++text)
+		{
+			if (*text == '"' || *text == '\\')
+			{
+				stream << '\\';
+			}
+
+			stream << (static_cast<unsigned char>(*text) < 0x20 ? ' ' : *text);
+		}
+	}
+}
+
+void LGLProfiler::StartCapture()
+{
+	ProfilerState& state = GetState();
+
+	{
+		std::lock_guard<std::mutex> lock(state.captureMutex);
+
+		state.captured.clear();
+		state.captureStart = Now();
+		state.droppedZones = 0;
+		state.limitReached = false;
+	}
+
+	state.capturing = true;
+
+#ifdef LGL_PROFILER
+	std::cout << "Profiler capture started\n";
+#else
+	std::cout << "[WARNING] LGL is built without LGL_PROFILER, only zones of other projects are captured\n";
+#endif
+}
+
+void LGLProfiler::StopCapture()
+{
+	ProfilerState& state = GetState();
+
+	if (!state.capturing)
+	{
+		return;
+	}
+
+	Collect();
+	state.capturing = false;
+
+	std::lock_guard<std::mutex> lock(state.captureMutex);
+	std::cout << "Profiler capture stopped, " << state.captured.size() << " zone(s) recorded\n";
+}
+
+bool LGLProfiler::IsCapturing()
+{
+	return GetState().capturing.load(std::memory_order_relaxed);
+}
+
+bool LGLProfiler::ExportChromeTrace(const std::string& path)
+{
+	ProfilerState& state = GetState();
+
+	if (state.capturing)
+	{
+		Collect();
+	}
+
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "[ERROR] Failed to open " << path << " for the profiler trace\n";
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(state.captureMutex);
+
+	if (state.droppedZones)
+	{
+		std::cout << "[WARNING] " << state.droppedZones << " profiler zone(s) were dropped, ring buffers were full\n";
+	}
+	if (state.limitReached)
+	{
+		std::cout << "[WARNING] Profiler capture reached " << maxCapturedZones << " zones, later zones are missing\n";
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	// Thread names first, so viewers label the tracks
+	std::vector<const ThreadBuffer*> threads = { &GetGPUBuffer() };
+	{
+		std::lock_guard<std::mutex> threadsLock(state.threadsMutex);
+		for (auto& thread : state.threads)
+		{
+			threads.push_back(thread.get());
+		}
+	}
+
+	bool first = true;
+	for (const ThreadBuffer* thread : threads)
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->threadId
+			<< ",\"args\":{\"name\":\"";
+		WriteEscaped(file, thread->threadName.c_str());
+		file << "\"}}";
+
+		first = false;
+	}
+
+	// Microseconds from the capture start, with nanosecond precision
+	file << std::fixed << std::setprecision(3);
+
+	for (const CapturedZone& captured : state.captured)
+	{
+		file << ",\n{\"name\":\"";
+		WriteEscaped(file, captured.zone.name);
+		file << "\",\"cat\":\"" << (captured.threadId == gpuThreadId ? "GPU" : "CPU") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << captured.threadId
+			<< ",\"ts\":" << (captured.zone.start - state.captureStart) / 1000.0
+			<< ",\"dur\":" << (captured.zone.end - captured.zone.start) / 1000.0 << '}';
+	}
+
+	file << "\n]}\n";
+
+	if (!file)
+	{
+		std::cout << "[ERROR] Failed to write the profiler trace into " << path << '\n';
+		return false;
+	}
+
+	std::cout << "Profiler trace of " << state.captured.size() << " zone(s) written into " << path << '\n';
+
+	return true;
+}
+
+void LGLProfiler::SetThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(GetState().threadsMutex);
+	buffer.threadName = name;
+}
+
+uint64_t LGLProfiler::Now()
+{
+	return static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()
+	);
+}
+
+void LGLProfiler::WriteZone(const char* name, uint64_t start, uint64_t end)
+{
+	PushZone(GetThreadBuffer(), name, start, end);
+}
+
+void LGLProfiler::WriteGPUZone(const char* name, uint64_t start, uint64_t end)
+{
+	// GPU zones are resolved on the rendering thread only
+	PushZone(GetGPUBuffer(), name, start, end);
+}
+
+void LGLProfiler::Collect()
+{
+	ProfilerState& state = GetState();
+
+	if (!state.capturing)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(state.captureMutex);
+
+	Drain(state, GetGPUBuffer());
+
+	std::lock_guard<std::mutex> threadsLock(state.threadsMutex);
+	for (auto& thread : state.threads)
+	{
+		Drain(state, *thread);
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#ifdef LGL_EXPORT
+#define LGL_API __declspec(dllexport)
+#else
+#define LGL_API __declspec(dllimport)
+#endif
+
+#include <string>
+#include <cstdint>
+
+/*
+	Hierarchical CPU/GPU profiler, zones are enabled with LGL_PROFILER define
+
+	ProfileZone(name) times the rest of the scope it is placed in, zones nest by time.
+	Every thread writes its zones into its own ring buffer without locks, buffers are
+	drained into the capture once per frame by the rendering cycle. GPU zones of LGL are
+	timed with timestamp queries which are read a few frames later, so the GPU is not stalled.
+
+	Nothing is recorded outside of a capture, the capture is exported as Chrome trace JSON
+	(chrome://tracing, ui.perfetto.dev). Names have to outlive the capture, string literals are expected.
+	Without LGL_PROFILER zones compile to nothing, the define is needed in every project
+	that places zones
+*/
+class LGLProfiler
+{
+public:
+	class ScopedZone
+	{
+	public:
+		ScopedZone(const char* name) : name(name), active(IsCapturing())
+		{
+			if (active)
+			{
+				start = Now();
+			}
+		}
+
+		~ScopedZone()
+		{
+			if (active)
+			{
+				WriteZone(name, start, Now());
+			}
+		}
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+
+	private:
+		const char* name;
+		bool active;
+		uint64_t start = 0;
+	};
+
+	LGL_API static void StartCapture();
+	// Drains what is left in the ring buffers and stops recording, the capture is kept until the next start
+	LGL_API static void StopCapture();
+	LGL_API static bool IsCapturing();
+	LGL_API static bool ExportChromeTrace(const std::string& path);
+
+	// Name shown for the calling thread in the trace
+	LGL_API static void SetThreadName(const std::string& name);
+
+	// Nanoseconds on the steady clock
+	LGL_API static uint64_t Now();
+	LGL_API static void WriteZone(const char* name, uint64_t start, uint64_t end);
+	// Times have to be converted to the CPU clock
+	LGL_API static void WriteGPUZone(const char* name, uint64_t start, uint64_t end);
+
+	// Moves zones from the ring buffers of all threads into the capture
+	LGL_API static void Collect();
+};
+
+#define LGL_PROFILE_CONCAT_INNER(left, right) left##right
+#define LGL_PROFILE_CONCAT(left, right) LGL_PROFILE_CONCAT_INNER(left, right)
+
+#ifdef LGL_PROFILER
+#define ProfileZone(name) LGLProfiler::ScopedZone LGL_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define ProfileZone(name)
+#endif
@@ -0,0 +1,474 @@
+#include <iostream>
+#include <algorithm>
+#include <set>
+#include <cmath>
+
+#include "LGLRenderGraph.h"
+
+using namespace LGLStructs;
+
+void LGLRenderGraph::AddPass(
+	const std::string& name,
+	const std::vector<std::string>& reads,
+	const std::vector<std::string>& writes,
+	PassFunction execute,
+	bool hasSideEffects
+)
+{
+	RemovePass(name);
+
+	passes.push_back({ name, reads, writes, execute, hasSideEffects });
+	compiled = false;
+}
+
+bool LGLRenderGraph::RemovePass(const std::string& name)
+{
+	auto passIter = std::find_if(passes.begin(), passes.end(), [&name](const PassInfo& pass) { return pass.name == name; });
+
+	if (passIter == passes.end())
+	{
+		return false;
+	}
+
+	passes.erase(passIter);
+	compiled = false;
+
+	return true;
+}
+
+bool LGLRenderGraph::HasPass(const std::string& name) const
+{
+	return std::find_if(passes.begin(), passes.end(), [&name](const PassInfo& pass) { return pass.name == name; }) != passes.end();
+}
+
+void LGLRenderGraph::DeclareTransient(const std::string& name, const RenderResourceDesc& desc)
+{
+	auto transientIter = transients.find(name);
+
+	if (transientIter != transients.end() && transientIter->second.desc == desc)
+	{
+		return;
+	}
+
+	transients[name] = { desc, 0, 0, 0 };
+	compiled = false;
+}
+
+void LGLRenderGraph::ImportResource(const std::string& name, ResourceID id)
+{
+	imported[name] = id;
+}
+
+void LGLRenderGraph::MarkOutput(const std::string& name)
+{
+	if (std::find(outputs.begin(), outputs.end(), name) == outputs.end())
+	{
+		outputs.push_back(name);
+		compiled = false;
+	}
+}
+
+bool LGLRenderGraph::Compile()
+{
+	constexpr size_t unused = static_cast<size_t>(-1);
+
+	executionOrder.clear();
+
+	// Writers of one resource keep the order they were added in,
+	// readers of a resource are executed after its last writer
+	std::map<std::string, std::vector<size_t>> writers;
+	for (size_t i = 0; i < passes.size(); ++i)
+	{
+		for (auto& write : passes[i].writes)
+		{
+			writers[write].push_back(i);
+		}
+	}
+
+	std::vector<std::set<size_t>> dependencies(passes.size());
+	std::vector<std::set<size_t>> dependents(passes.size());
+
+	auto AddDependency = [&dependencies, &dependents](size_t from, size_t to)
+	{
+		if (from != to)
+		{
+			dependencies[to].insert(from);
+			dependents[from].insert(to);
+		}
+	};
+
+	for (auto& writerList : writers)
+	{
+		for (size_t i = 1; i < writerList.second.size(); ++i)
+		{
+			AddDependency(writerList.second[i - 1], writerList.second[i]);
+		}
+	}
+
+	for (size_t i = 0; i < passes.size(); ++i)
+	{
+		for (auto& read : passes[i].reads)
+		{
+			auto writerIter = writers.find(read);
+			if (writerIter == writers.end())
+			{
+				if (transients.find(read) != transients.end())
+				{
+					std::cout << "[WARNING] Render pass " << passes[i].name << " reads " << read << " which nobody writes\n";
+				}
+				continue;
+			}
+
+			const std::vector<size_t>& writerList = writerIter->second;
+
+			// Read-modify-write passes are part of the writer chain already
+			if (std::find(writerList.begin(), writerList.end(), i) == writerList.end())
+			{
+				AddDependency(writerList.back(), i);
+			}
+		}
+	}
+
+	// Topological sort, ties are resolved by the order passes were added in
+	std::vector<size_t> sorted;
+	std::vector<size_t> dependencyAmount(passes.size());
+	std::set<size_t> ready;
+
+	for (size_t i = 0; i < passes.size(); ++i)
+	{
+		dependencyAmount[i] = dependencies[i].size();
+		if (!dependencyAmount[i])
+		{
+			ready.insert(i);
+		}
+	}
+
+	while (!ready.empty())
+	{
+		size_t current = *ready.begin();
+		ready.erase(ready.begin());
+		sorted.push_back(current);
+
+		for (size_t dependent : dependents[current])
+		{
+			if (!--dependencyAmount[dependent])
+			{
+				ready.insert(dependent);
+			}
+		}
+	}
+
+	if (sorted.size() != passes.size())
+	{
+		std::cout << "[ERROR] Render graph has a cycle, passes will not be executed\n";
+		compiled = false;
+		return false;
+	}
+
+	// Culling, only passes contributing to outputs or having side effects survive
+	std::vector<bool> alive(passes.size(), false);
+	std::vector<size_t> toVisit;
+
+	for (size_t i = 0; i < passes.size(); ++i)
+	{
+		bool writesOutput = std::find_first_of(
+			passes[i].writes.begin(), passes[i].writes.end(), outputs.begin(), outputs.end()
+		) != passes[i].writes.end();
+
+		if (passes[i].hasSideEffects || writesOutput)
+		{
+			alive[i] = true;
+			toVisit.push_back(i);
+		}
+	}
+
+	while (!toVisit.empty())
+	{
+		size_t current = toVisit.back();
+		toVisit.pop_back();
+
+		for (size_t dependency : dependencies[current])
+		{
+			if (!alive[dependency])
+			{
+				alive[dependency] = true;
+				toVisit.push_back(dependency);
+			}
+		}
+	}
+
+	for (size_t passIndex : sorted)
+	{
+		if (alive[passIndex])
+		{
+			executionOrder.push_back(passIndex);
+		}
+	}
+
+	// Lifetimes of transient resources in execution order
+	for (auto& transient : transients)
+	{
+		transient.second.firstUse = unused;
+		transient.second.lastUse = 0;
+		transient.second.physicalIndex = unused;
+	}
+
+	for (size_t order = 0; order < executionOrder.size(); ++order)
+	{
+		const PassInfo& pass = passes[executionOrder[order]];
+
+		for (const auto* resourceList : { &pass.reads, &pass.writes })
+		{
+			for (auto& resource : *resourceList)
+			{
+				auto transientIter = transients.find(resource);
+				if (transientIter != transients.end())
+				{
+					TransientInfo& transient = transientIter->second;
+					transient.firstUse = std::min(transient.firstUse, order);
+					transient.lastUse = std::max(transient.lastUse, order);
+				}
+			}
+		}
+	}
+
+	// Aliasing, greedy by first use
+	std::vector<TransientInfo*> usedTransients;
+	for (auto& transient : transients)
+	{
+		if (transient.second.firstUse != unused)
+		{
+			usedTransients.push_back(&transient.second);
+		}
+	}
+
+	std::sort(usedTransients.begin(), usedTransients.end(),
+		[](const TransientInfo* left, const TransientInfo* right) { return left->firstUse < right->firstUse; }
+	);
+
+	std::vector<PhysicalInfo> previousPhysicals = std::move(physicals);
+	physicals.clear();
+
+	for (TransientInfo* transient : usedTransients)
+	{
+		auto physicalIter = std::find_if(physicals.begin(), physicals.end(),
+			[transient](const PhysicalInfo& physical)
+			{
+				return physical.desc == transient->desc && physical.lastUse < transient->firstUse;
+			}
+		);
+
+		if (physicalIter == physicals.end())
+		{
+			physicals.push_back({ transient->desc });
+			physicalIter = physicals.end() - 1;
+		}
+
+		physicalIter->lastUse = transient->lastUse;
+		transient->physicalIndex = physicalIter - physicals.begin();
+	}
+
+	// Already allocated resources are reused by matching descriptions
+	for (auto& physical : physicals)
+	{
+		auto previousIter = std::find_if(previousPhysicals.begin(), previousPhysicals.end(),
+			[&physical](const PhysicalInfo& previous) { return previous.id && previous.desc == physical.desc; }
+		);
+
+		if (previousIter != previousPhysicals.end())
+		{
+			physical.id = previousIter->id;
+			physical.width = previousIter->width;
+			physical.height = previousIter->height;
+			previousIter->id = 0;
+		}
+	}
+
+	// Leftovers are destroyed on the next Execute, allocator is not available here
+	for (auto& previous : previousPhysicals)
+	{
+		if (previous.id)
+		{
+			previous.lastUse = 0;
+			physicals.push_back(previous);
+		}
+	}
+
+	stats.passAmount = passes.size();
+	stats.culledPassAmount = passes.size() - executionOrder.size();
+	stats.transientAmount = usedTransients.size();
+
+	compiled = true;
+
+	std::cout << "Render graph compiled: " << executionOrder.size() << " pass(es), "
+		<< stats.culledPassAmount << " culled, " << stats.transientAmount << " transient resource(s)\n";
+
+	return true;
+}
+
+void LGLRenderGraph::Execute(const Allocator& allocator, int outputWidth, int outputHeight)
+{
+	if (!compiled && !Compile())
+	{
+		return;
+	}
+
+	currentOutputWidth = outputWidth;
+	currentOutputHeight = outputHeight;
+
+	// Physicals past the used ones are leftovers from a previous compile
+	size_t usedPhysicalAmount = 0;
+	for (auto& transient : transients)
+	{
+		if (transient.second.physicalIndex != static_cast<size_t>(-1))
+		{
+			usedPhysicalAmount = std::max(usedPhysicalAmount, transient.second.physicalIndex + 1);
+		}
+	}
+
+	for (size_t i = usedPhysicalAmount; i < physicals.size(); ++i)
+	{
+		allocator.destroy(physicals[i].desc, physicals[i].id);
+	}
+	physicals.resize(usedPhysicalAmount);
+
+	stats.physicalAmount = physicals.size();
+	stats.transientMemory = 0;
+	stats.transientMemoryNoAliasing = 0;
+
+	for (auto& physical : physicals)
+	{
+		int width = 0;
+		int height = 0;
+		GetDescSize(physical.desc, width, height);
+
+		if (physical.id && (physical.width != width || physical.height != height))
+		{
+			allocator.destroy(physical.desc, physical.id);
+			physical.id = 0;
+		}
+
+		if (!physical.id)
+		{
+			physical.id = allocator.create(physical.desc, width, height);
+			physical.width = width;
+			physical.height = height;
+		}
+
+		stats.transientMemory += GetResourceMemory(physical.desc, width, height);
+	}
+
+	for (auto& transient : transients)
+	{
+		if (transient.second.physicalIndex != static_cast<size_t>(-1))
+		{
+			const PhysicalInfo& physical = physicals[transient.second.physicalIndex];
+			stats.transientMemoryNoAliasing += GetResourceMemory(physical.desc, physical.width, physical.height);
+		}
+	}
+
+	for (size_t passIndex : executionOrder)
+	{
+		if (passes[passIndex].execute)
+		{
+			passes[passIndex].execute();
+		}
+	}
+}
+
+void LGLRenderGraph::Release(const Allocator& allocator)
+{
+	for (auto& physical : physicals)
+	{
+		if (physical.id)
+		{
+			allocator.destroy(physical.desc, physical.id);
+			physical.id = 0;
+		}
+	}
+
+	physicals.clear();
+	compiled = false;
+}
+
+LGLRenderGraph::ResourceID LGLRenderGraph::GetResource(const std::string& name) const
+{
+	auto importedIter = imported.find(name);
+	if (importedIter != imported.end())
+	{
+		return importedIter->second;
+	}
+
+	auto transientIter = transients.find(name);
+	if (transientIter != transients.end() && transientIter->second.physicalIndex < physicals.size())
+	{
+		return physicals[transientIter->second.physicalIndex].id;
+	}
+
+	return 0;
+}
+
+void LGLRenderGraph::GetResourceSize(const std::string& name, int& width, int& height) const
+{
+	width = currentOutputWidth;
+	height = currentOutputHeight;
+
+	auto transientIter = transients.find(name);
+	if (transientIter != transients.end())
+	{
+		GetDescSize(transientIter->second.desc, width, height);
+	}
+}
+
+LGLRenderGraph::Stats LGLRenderGraph::GetStats() const
+{
+	return stats;
+}
+
+void LGLRenderGraph::GetDescSize(const RenderResourceDesc& desc, int& width, int& height) const
+{
+	if (desc.width && desc.height)
+	{
+		width = desc.width;
+		height = desc.height;
+	}
+	else
+	{
+		width = GetScaledSize(currentOutputWidth, desc.outputScale);
+		height = GetScaledSize(currentOutputHeight, desc.outputScale);
+	}
+}
+
+int LGLRenderGraph::GetScaledSize(int outputSize, float scale)
+{
+	return std::max(1, static_cast<int>(std::ceil(static_cast<double>(outputSize) * scale)));
+}
+
+size_t LGLRenderGraph::GetResourceMemory(const RenderResourceDesc& desc, int width, int height)
+{
+	using TextureFormat = RenderResourceDesc::TextureFormat;
+
+	if (desc.type == RenderResourceDesc::ResourceType::Buffer)
+	{
+		return desc.bufferSize;
+	}
+
+	size_t bytesPerPixel = 4;
+
+	switch (desc.format)
+	{
+	case TextureFormat::RGBA16F:
+		bytesPerPixel = 8;
+		break;
+	case TextureFormat::R16F:
+		bytesPerPixel = 2;
+		break;
+	case TextureFormat::R8:
+		bytesPerPixel = 1;
+		break;
+	default:
+		break;
+	}
+
+	return static_cast<size_t>(width) * height * bytesPerPixel;
+}
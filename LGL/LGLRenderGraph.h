@@ -0,0 +1,120 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+#include "LGLStructs.h"
+
+/*
+	Render graph for LGL
+
+	Passes declare which resources they read and write, order of execution is derived
+	from these declarations, passes which do not contribute to an output are culled.
+	Transient resources whose lifetimes do not overlap share one physical resource.
+	OpenGL has no explicit memory aliasing, so sharing is done on object level:
+	resources with identical descriptions reuse the same texture or buffer.
+
+	Graph does not call OpenGL itself, physical resources are created and deleted
+	through the allocator given to Execute
+*/
+class LGLRenderGraph
+{
+public:
+	using ResourceID = unsigned int;
+	using PassFunction = std::function<void()>;
+
+	struct Allocator
+	{
+		std::function<ResourceID(const LGLStructs::RenderResourceDesc&, int width, int height)> create;
+		std::function<void(const LGLStructs::RenderResourceDesc&, ResourceID)> destroy;
+	};
+
+	struct Stats
+	{
+		size_t passAmount = 0;
+		size_t culledPassAmount = 0;
+		size_t transientAmount = 0;
+		size_t physicalAmount = 0;
+		size_t transientMemory = 0; // Bytes, after aliasing
+		size_t transientMemoryNoAliasing = 0;
+	};
+
+	LGLRenderGraph() = default;
+	LGLRenderGraph(const LGLRenderGraph&) = delete;
+	LGLRenderGraph& operator=(const LGLRenderGraph&) = delete;
+
+	// Pass with side effects is never culled even if nothing reads what it writes
+	void AddPass(
+		const std::string& name,
+		const std::vector<std::string>& reads,
+		const std::vector<std::string>& writes,
+		PassFunction execute,
+		bool hasSideEffects = false
+	);
+	bool RemovePass(const std::string& name);
+	bool HasPass(const std::string& name) const;
+
+	void DeclareTransient(const std::string& name, const LGLStructs::RenderResourceDesc& desc);
+	// Imported resources are owned outside of the graph (window framebuffer, persistent targets)
+	void ImportResource(const std::string& name, ResourceID id);
+	void MarkOutput(const std::string& name);
+
+	bool Compile();
+	void Execute(const Allocator& allocator, int outputWidth, int outputHeight);
+	// Deletes all physical resources, must be called while allocator is still valid
+	void Release(const Allocator& allocator);
+
+	// Valid only inside a pass function
+	ResourceID GetResource(const std::string& name) const;
+	void GetResourceSize(const std::string& name, int& width, int& height) const;
+
+	Stats GetStats() const;
+
+	// Size of a target scaled from the output one, rounded up and at least 1. Targets scaled
+	// outside of the graph go through it as well, so they match the graph ones to the pixel
+	static int GetScaledSize(int outputSize, float scale);
+
+private:
+	struct PassInfo
+	{
+		std::string name;
+		std::vector<std::string> reads;
+		std::vector<std::string> writes;
+		PassFunction execute;
+		bool hasSideEffects;
+	};
+
+	struct TransientInfo
+	{
+		LGLStructs::RenderResourceDesc desc;
+		size_t firstUse;
+		size_t lastUse;
+		size_t physicalIndex;
+	};
+
+	struct PhysicalInfo
+	{
+		LGLStructs::RenderResourceDesc desc;
+		ResourceID id = 0;
+		int width = 0;
+		int height = 0;
+		size_t lastUse = 0;
+	};
+
+	static size_t GetResourceMemory(const LGLStructs::RenderResourceDesc& desc, int width, int height);
+	void GetDescSize(const LGLStructs::RenderResourceDesc& desc, int& width, int& height) const;
+
+	std::vector<PassInfo> passes;
+	std::vector<size_t> executionOrder; // Indices into passes, culled passes are excluded
+	std::map<std::string, TransientInfo> transients;
+	std::map<std::string, ResourceID> imported;
+	std::vector<std::string> outputs;
+	std::vector<PhysicalInfo> physicals;
+
+	int currentOutputWidth = 0;
+	int currentOutputHeight = 0;
+	bool compiled = false;
+	Stats stats;
+};
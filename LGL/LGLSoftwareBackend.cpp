@@ -0,0 +1,2128 @@
+#ifdef LGL_SOFTWARE_BACKEND
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <array>
+#include <set>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define LGL_EXPORT
+#define LGL_SOFTWARE_BACKEND_IMPLEMENTATION
+#include "LGLSoftwareBackend.h"
+
+namespace
+{
+	using Rasterizer = LGLSoftwareRasterizer;
+
+	constexpr int maxVertexAttribs = 16;
+	constexpr int maxTextureUnits = 32;
+	constexpr int maxLightAmount = 10; // LIGHT_MAX_AMOUNT of lightComb
+
+	struct Buffer
+	{
+		std::vector<unsigned char> data;
+	};
+
+	// Color is always stored as RGBA8 and depth as float, cube maps have no storage
+	struct Texture
+	{
+		std::vector<unsigned char> color;
+		std::vector<float> depth;
+		int width = 0;
+		int height = 0;
+		Rasterizer::Wrap wrapS = Rasterizer::Wrap::Repeat;
+		Rasterizer::Wrap wrapT = Rasterizer::Wrap::Repeat;
+		bool linear = true;
+	};
+
+	struct VertexAttrib
+	{
+		bool enabled = false;
+		GLuint buffer = 0;
+		int size = 4;
+		GLenum type = GL_FLOAT;
+		size_t stride = 0;
+		size_t offset = 0;
+		GLuint divisor = 0;
+	};
+
+	struct VertexArray
+	{
+		std::array<VertexAttrib, maxVertexAttribs> attribs;
+		GLuint elementBuffer = 0;
+	};
+
+	struct Framebuffer
+	{
+		std::unordered_map<GLenum, GLuint> colorAttachments;
+		GLuint depthAttachment = 0;
+		std::vector<GLenum> drawBuffers = { GL_COLOR_ATTACHMENT0 };
+		GLenum readBuffer = GL_COLOR_ATTACHMENT0;
+	};
+
+	struct Shader
+	{
+		GLenum type;
+		std::string source;
+	};
+
+	enum class ProgramType
+	{
+		Unsupported,
+		Lit,      // lightComb
+		Flat,     // model, view and proj transform with one color
+		Feedback  // Transform feedback, instanceCull if it has frustumPlanes and boundingSphere
+	};
+
+	struct Program
+	{
+		std::vector<GLuint> shaders;
+		std::vector<std::string> feedbackVaryings;
+		ProgramType type = ProgramType::Unsupported;
+
+		std::unordered_map<std::string, GLint> locations;
+		std::vector<std::string> names;               // By location
+		std::vector<std::vector<float>> values;       // By location, empty until set
+		std::shared_ptr<const Rasterizer::Lighting> lighting;
+		bool lightingChanged = true;
+		bool warned = false;
+	};
+
+	struct Query
+	{
+		GLuint64 result = 0;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	struct Context
+	{
+		Rasterizer rasterizer;
+		GLuint lastName = 0;
+		GLenum error = GL_NO_ERROR;
+
+		std::unordered_map<GLuint, Buffer> buffers;
+		std::unordered_map<GLuint, Texture> textures;
+		std::unordered_map<GLuint, VertexArray> vertexArrays = { { 0, VertexArray() } };
+		std::unordered_map<GLuint, Framebuffer> framebuffers;
+		std::unordered_map<GLuint, Shader> shaders;
+		std::unordered_map<GLuint, Program> programs;
+		std::unordered_map<GLuint, Query> queries;
+
+		std::unordered_map<GLenum, GLuint> boundBuffers;
+		GLuint feedbackBuffer = 0;
+		size_t feedbackOffset = 0;
+		size_t feedbackSize = 0; // Whole buffer if 0
+		GLuint vertexArray = 0;
+		int activeTexture = 0;
+		std::array<std::unordered_map<GLenum, GLuint>, maxTextureUnits> textureUnits;
+		GLuint drawFramebuffer = 0;
+		GLuint readFramebuffer = 0;
+		GLuint program = 0;
+		std::unordered_map<GLenum, GLuint> activeQueries;
+		bool feedbackActive = false;
+
+		// Default framebuffer, sized as the headless window
+		Texture defaultColor;
+		Texture defaultDepth;
+
+		std::array<int, 4> viewport = {};
+		glm::vec4 clearColor = glm::vec4(0.0f);
+		bool depthTest = false;
+		bool depthMask = true;
+		Rasterizer::DepthFunc depthFunc = Rasterizer::DepthFunc::Less;
+		bool blend = false;
+		bool cullFace = false;
+		bool rasterizerDiscard = false;
+		int unpackAlignment = 4;
+		int packAlignment = 4;
+
+		std::set<std::string> warnings;
+	};
+
+	Context& GetContext()
+	{
+		static Context context;
+		return context;
+	}
+
+	void SetError(GLenum error)
+	{
+		Context& context = GetContext();
+
+		if (context.error == GL_NO_ERROR)
+		{
+			context.error = error;
+		}
+	}
+
+	void WarnOnce(const std::string& warning)
+	{
+		if (GetContext().warnings.insert(warning).second)
+		{
+			std::cout << "[WARNING] Software backend: " << warning << '\n';
+		}
+	}
+
+	GLuint NextName()
+	{
+		return ++GetContext().lastName;
+	}
+
+	Buffer* GetBuffer(GLuint name)
+	{
+		auto bufferIter = GetContext().buffers.find(name);
+
+		return bufferIter != GetContext().buffers.end() ? &bufferIter->second : nullptr;
+	}
+
+	GLuint& GetBufferBinding(GLenum target)
+	{
+		Context& context = GetContext();
+
+		if (target == GL_ELEMENT_ARRAY_BUFFER)
+		{
+			return context.vertexArrays[context.vertexArray].elementBuffer;
+		}
+
+		return context.boundBuffers[target];
+	}
+
+	Texture* GetTexture(GLuint name)
+	{
+		auto textureIter = GetContext().textures.find(name);
+
+		return textureIter != GetContext().textures.end() ? &textureIter->second : nullptr;
+	}
+
+	Program* GetProgram(GLuint name)
+	{
+		auto programIter = GetContext().programs.find(name);
+
+		return programIter != GetContext().programs.end() ? &programIter->second : nullptr;
+	}
+
+	void EnsureDefaultFramebuffer()
+	{
+		Context& context = GetContext();
+
+		int width = LGLHeadlessWindow::FramebufferWidth();
+		int height = LGLHeadlessWindow::FramebufferHeight();
+
+		if (context.defaultColor.width == width && context.defaultColor.height == height)
+		{
+			return;
+		}
+
+		context.rasterizer.Flush();
+
+		size_t pixelAmount = static_cast<size_t>(std::max(width, 0)) * std::max(height, 0);
+
+		context.defaultColor.color.assign(pixelAmount * 4, 0);
+		context.defaultColor.width = width;
+		context.defaultColor.height = height;
+		context.defaultDepth.depth.assign(pixelAmount, 1.0f);
+		context.defaultDepth.width = width;
+		context.defaultDepth.height = height;
+	}
+
+	// Surface of a color buffer (GL_NONE for none) and the depth attachment of a framebuffer
+	Rasterizer::Surface GetSurface(GLuint framebuffer, GLenum colorBuffer, bool withDepth)
+	{
+		Context& context = GetContext();
+		Rasterizer::Surface surface;
+
+		Texture* color = nullptr;
+		Texture* depth = nullptr;
+
+		if (!framebuffer)
+		{
+			EnsureDefaultFramebuffer();
+
+			color = colorBuffer != GL_NONE ? &context.defaultColor : nullptr;
+			depth = &context.defaultDepth;
+		}
+		else
+		{
+			Framebuffer& fbo = context.framebuffers[framebuffer];
+
+			auto attachmentIter = fbo.colorAttachments.find(colorBuffer);
+			if (colorBuffer != GL_NONE && attachmentIter != fbo.colorAttachments.end())
+			{
+				color = GetTexture(attachmentIter->second);
+			}
+
+			depth = GetTexture(fbo.depthAttachment);
+		}
+
+		if (color && !color->color.empty())
+		{
+			surface.color = color->color.data();
+			surface.width = color->width;
+			surface.height = color->height;
+		}
+
+		// Attachments of different sizes are not supported, depth is dropped
+		if (withDepth && depth && !depth->depth.empty() && (!surface.color || (depth->width == surface.width && depth->height == surface.height)))
+		{
+			surface.depth = depth->depth.data();
+			surface.width = depth->width;
+			surface.height = depth->height;
+		}
+
+		return surface;
+	}
+
+	std::vector<GLenum> GetDrawBuffers()
+	{
+		Context& context = GetContext();
+
+		if (!context.drawFramebuffer)
+		{
+			return { GL_BACK };
+		}
+
+		return context.framebuffers[context.drawFramebuffer].drawBuffers;
+	}
+
+	GLenum GetReadBuffer()
+	{
+		Context& context = GetContext();
+
+		if (!context.readFramebuffer)
+		{
+			return GL_BACK;
+		}
+
+		return context.framebuffers[context.readFramebuffer].readBuffer;
+	}
+
+	GLint GetUniformLocation(Program& program, std::string name)
+	{
+		// "name[0]" and "name" are the same uniform
+		if (name.size() > 3 && !name.compare(name.size() - 3, 3, "[0]"))
+		{
+			name.resize(name.size() - 3);
+		}
+
+		auto locationIter = program.locations.find(name);
+		if (locationIter != program.locations.end())
+		{
+			return locationIter->second;
+		}
+
+		GLint location = static_cast<GLint>(program.names.size());
+		program.locations.emplace(name, location);
+		program.names.push_back(name);
+		program.values.emplace_back();
+
+		return location;
+	}
+
+	const std::vector<float>* FindUniform(const Program& program, const std::string& name)
+	{
+		auto locationIter = program.locations.find(name);
+
+		if (locationIter == program.locations.end() || program.values[locationIter->second].empty())
+		{
+			return nullptr;
+		}
+
+		return &program.values[locationIter->second];
+	}
+
+	float GetUniformFloat(const Program& program, const std::string& name, float defaultValue)
+	{
+		const std::vector<float>* value = FindUniform(program, name);
+
+		return value ? (*value)[0] : defaultValue;
+	}
+
+	glm::vec3 GetUniformVec3(const Program& program, const std::string& name, const glm::vec3& defaultValue)
+	{
+		const std::vector<float>* value = FindUniform(program, name);
+
+		if (!value)
+		{
+			return defaultValue;
+		}
+
+		glm::vec3 result(0.0f);
+		for (size_t i = 0; i < std::min<size_t>(value->size(), 3); ++i)
+		{
+			result[static_cast<int>(i)] = (*value)[i];
+		}
+
+		return result;
+	}
+
+	bool GetUniformMat4(const Program& program, const std::string& name, glm::mat4& result)
+	{
+		const std::vector<float>* value = FindUniform(program, name);
+
+		if (!value || value->size() < 16)
+		{
+			return false;
+		}
+
+		result = glm::make_mat4(value->data());
+
+		return true;
+	}
+
+	void SetUniform(GLint location, const float* values, size_t amount)
+	{
+		Program* program = GetProgram(GetContext().program);
+
+		if (!program)
+		{
+			SetError(GL_INVALID_OPERATION);
+			return;
+		}
+
+		// Location -1 is silently ignored as in OpenGL
+		if (location < 0 || static_cast<size_t>(location) >= program->values.size())
+		{
+			return;
+		}
+
+		program->values[location].assign(values, values + amount);
+
+		// Transforms change every draw, everything else is lighting state
+		const std::string& name = program->names[location];
+		if (name != "model" && name != "inv" && name != "instanced")
+		{
+			program->lightingChanged = true;
+		}
+	}
+
+	std::shared_ptr<const Rasterizer::Lighting> GetLighting(Program& program)
+	{
+		if (!program.lightingChanged && program.lighting)
+		{
+			return program.lighting;
+		}
+
+		auto lighting = std::make_shared<Rasterizer::Lighting>();
+
+		lighting->viewPos = GetUniformVec3(program, "viewPos", glm::vec3(0.0f));
+		lighting->ambient = GetUniformVec3(program, "ambient", glm::vec3(0.0f));
+		lighting->shininess = GetUniformFloat(program, "material.shininess", 32.0f);
+
+		auto GetAmount = [&program](const std::string& name)
+		{
+			return std::min(std::max(static_cast<int>(GetUniformFloat(program, name, 0.0f)), 0), maxLightAmount);
+		};
+
+		for (int i = 0, amount = GetAmount("dirLightAmount"); i < amount; ++i)
+		{
+			std::string prefix = "dirLights[" + std::to_string(i) + "].";
+
+			lighting->dirLights.push_back({
+				GetUniformVec3(program, prefix + "direction", glm::vec3(0.0f)),
+				GetUniformVec3(program, prefix + "diffuse", glm::vec3(0.0f)),
+				GetUniformVec3(program, prefix + "specular", glm::vec3(0.0f))
+			});
+		}
+
+		for (int i = 0, amount = GetAmount("pointLightAmount"); i < amount; ++i)
+		{
+			std::string prefix = "pointLights[" + std::to_string(i) + "].";
+
+			lighting->pointLights.push_back({
+				GetUniformVec3(program, prefix + "position", glm::vec3(0.0f)),
+				GetUniformVec3(program, prefix + "diffuse", glm::vec3(0.0f)),
+				GetUniformVec3(program, prefix + "specular", glm::vec3(0.0f)),
+				GetUniformFloat(program, prefix + "constant", 1.0f),
+				GetUniformFloat(program, prefix + "linear", 0.0f),
+				GetUniformFloat(program, prefix + "quadratic", 0.0f)
+			});
+		}
+
+		for (int i = 0, amount = GetAmount("spotLightAmount"); i < amount; ++i)
+		{
+			std::string prefix = "spotLights[" + std::to_string(i) + "].";
+
+			lighting->spotLights.push_back({
+				GetUniformVec3(program, prefix + "position", glm::vec3(0.0f)),
+				GetUniformVec3(program, prefix + "direction", glm::vec3(0.0f)),
+				GetUniformFloat(program, prefix + "cutOff", 0.0f),
+				GetUniformFloat(program, prefix + "outerCutOff", 0.0f),
+				GetUniformVec3(program, prefix + "diffuse", glm::vec3(0.0f)),
+				GetUniformVec3(program, prefix + "specular", glm::vec3(0.0f)),
+				GetUniformFloat(program, prefix + "constant", 1.0f),
+				GetUniformFloat(program, prefix + "linear", 0.0f),
+				GetUniformFloat(program, prefix + "quadratic", 0.0f)
+			});
+		}
+
+		program.lighting = lighting;
+		program.lightingChanged = false;
+
+		return program.lighting;
+	}
+
+	Rasterizer::TextureView GetTextureView(const Program& program, const std::string& sampler)
+	{
+		Context& context = GetContext();
+		Rasterizer::TextureView view;
+
+		int unit = static_cast<int>(GetUniformFloat(program, sampler, 0.0f));
+		if (unit < 0 || unit >= maxTextureUnits)
+		{
+			return view;
+		}
+
+		auto bindingIter = context.textureUnits[unit].find(GL_TEXTURE_2D);
+		Texture* texture = bindingIter != context.textureUnits[unit].end() ? GetTexture(bindingIter->second) : nullptr;
+
+		if (texture && !texture->color.empty())
+		{
+			view.rgba = texture->color.data();
+			view.width = texture->width;
+			view.height = texture->height;
+			view.wrapS = texture->wrapS;
+			view.wrapT = texture->wrapT;
+			view.linear = texture->linear;
+		}
+
+		return view;
+	}
+
+	// Data of an enabled float attribute, null if it is disabled or out of its buffer
+	const unsigned char* GetAttribData(const VertexAttrib& attrib, size_t element, size_t& available)
+	{
+		available = 0;
+
+		Buffer* buffer = attrib.enabled ? GetBuffer(attrib.buffer) : nullptr;
+		size_t elementSize = attrib.size * sizeof(float);
+		size_t stride = attrib.stride ? attrib.stride : elementSize;
+		size_t start = attrib.offset + stride * element;
+
+		if (!buffer || buffer->data.size() < start + elementSize)
+		{
+			return nullptr;
+		}
+
+		available = (buffer->data.size() - start - elementSize) / stride + 1;
+
+		return buffer->data.data() + start;
+	}
+
+	void EmulateFeedback(Program& program, GLint first, GLsizei count)
+	{
+		Context& context = GetContext();
+		const VertexArray& vao = context.vertexArrays[context.vertexArray];
+
+		Buffer* output = GetBuffer(context.feedbackBuffer);
+		if (!output)
+		{
+			SetError(GL_INVALID_OPERATION);
+			return;
+		}
+
+		// instanceCull: model matrix in attributes 0 to 3 is kept if its bounding sphere is in the frustum
+		const std::vector<float>* frustumPlanes = FindUniform(program, "frustumPlanes");
+		const std::vector<float>* boundingSphere = FindUniform(program, "boundingSphere");
+		bool cull = frustumPlanes && frustumPlanes->size() >= 24 && boundingSphere && boundingSphere->size() >= 4;
+
+		auto primitivesQuery = context.activeQueries.find(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+		size_t written = primitivesQuery != context.activeQueries.end() ? context.queries[primitivesQuery->second].result : 0;
+
+		std::vector<float> values;
+
+		for (GLsizei vertex = 0; vertex < count; ++vertex)
+		{
+			values.clear();
+
+			for (auto& attrib : vao.attribs)
+			{
+				size_t available;
+				const float* data = reinterpret_cast<const float*>(GetAttribData(attrib, first + vertex, available));
+
+				if (data)
+				{
+					values.insert(values.end(), data, data + attrib.size);
+				}
+			}
+
+			if (cull && values.size() >= 16)
+			{
+				glm::mat4 model = glm::make_mat4(values.data());
+				glm::vec3 center = glm::vec3(model * glm::vec4((*boundingSphere)[0], (*boundingSphere)[1], (*boundingSphere)[2], 1.0f));
+				float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+				float radius = (*boundingSphere)[3] * scale;
+
+				bool visible = true;
+				for (int plane = 0; plane < 6; ++plane)
+				{
+					const float* planeValues = frustumPlanes->data() + plane * 4;
+
+					if (glm::dot(glm::vec3(planeValues[0], planeValues[1], planeValues[2]), center) + planeValues[3] < -radius)
+					{
+						visible = false;
+					}
+				}
+
+				if (!visible)
+				{
+					continue;
+				}
+			}
+
+			size_t outputSize = values.size() * sizeof(float);
+			size_t outputEnd = context.feedbackSize ? context.feedbackOffset + context.feedbackSize : output->data.size();
+			if (std::min(outputEnd, output->data.size()) < context.feedbackOffset + (written + 1) * outputSize)
+			{
+				break;
+			}
+
+			std::memcpy(output->data.data() + context.feedbackOffset + written * outputSize, values.data(), outputSize);
+			++written;
+		}
+
+		if (primitivesQuery != context.activeQueries.end())
+		{
+			context.queries[primitivesQuery->second].result = written;
+		}
+	}
+
+	struct DrawRange
+	{
+		const void* indices;
+		GLint first;
+		GLsizei count;
+	};
+
+	void Draw(GLenum mode, const std::vector<DrawRange>& ranges, bool indexed, GLenum indexType, GLsizei instanceAmount)
+	{
+		Context& context = GetContext();
+
+		Program* program = GetProgram(context.program);
+		if (!program)
+		{
+			SetError(GL_INVALID_OPERATION);
+			return;
+		}
+
+		if (context.feedbackActive)
+		{
+			if (program->type == ProgramType::Feedback && mode == GL_POINTS && !indexed)
+			{
+				for (auto& range : ranges)
+				{
+					EmulateFeedback(*program, range.first, range.count);
+				}
+			}
+			return;
+		}
+
+		if (context.rasterizerDiscard || !instanceAmount)
+		{
+			return;
+		}
+
+		if (program->type != ProgramType::Lit && program->type != ProgramType::Flat)
+		{
+			if (!program->warned)
+			{
+				std::cout << "[WARNING] Software backend: shader program " << context.program << " is not supported, its draws are skipped\n";
+				program->warned = true;
+			}
+			return;
+		}
+
+		if (mode != GL_TRIANGLES)
+		{
+			WarnOnce("only triangle lists are drawn");
+			return;
+		}
+
+		if (context.blend)
+		{
+			WarnOnce("blended draws (transparent meshes) are skipped");
+			return;
+		}
+
+		if (indexed && indexType != GL_UNSIGNED_INT)
+		{
+			WarnOnce("only GL_UNSIGNED_INT indices are supported");
+			return;
+		}
+
+		const VertexArray& vao = context.vertexArrays[context.vertexArray];
+		Rasterizer::DrawCall drawCall;
+
+		// lightComb layout: position, normal and texture coordinates in locations 0 to 2
+		Rasterizer::Attribute* attributes[] = { &drawCall.position, &drawCall.normal, &drawCall.texCoords };
+		drawCall.vertexAmount = std::numeric_limits<size_t>::max();
+
+		for (int location = 0; location < 3; ++location)
+		{
+			const VertexAttrib& attrib = vao.attribs[location];
+			size_t available;
+			const unsigned char* data = GetAttribData(attrib, 0, available);
+
+			if (!data || attrib.divisor)
+			{
+				continue;
+			}
+
+			if (attrib.type != GL_FLOAT)
+			{
+				WarnOnce("only GL_FLOAT vertex attributes are drawn");
+				return;
+			}
+
+			attributes[location]->data = data;
+			attributes[location]->stride = attrib.stride ? attrib.stride : attrib.size * sizeof(float);
+			attributes[location]->size = attrib.size;
+			drawCall.vertexAmount = std::min(drawCall.vertexAmount, available);
+		}
+
+		if (!drawCall.position.data)
+		{
+			return;
+		}
+
+		Buffer* elementBuffer = indexed ? GetBuffer(vao.elementBuffer) : nullptr;
+		if (indexed && !elementBuffer)
+		{
+			SetError(GL_INVALID_OPERATION);
+			return;
+		}
+
+		for (auto& range : ranges)
+		{
+			if (!indexed)
+			{
+				drawCall.ranges.push_back({ nullptr, static_cast<size_t>(range.first), static_cast<size_t>(range.count) });
+				continue;
+			}
+
+			size_t offset = reinterpret_cast<size_t>(range.indices);
+			if (offset + range.count * sizeof(GLuint) > elementBuffer->data.size())
+			{
+				SetError(GL_INVALID_OPERATION);
+				return;
+			}
+
+			drawCall.ranges.push_back({
+				reinterpret_cast<const unsigned int*>(elementBuffer->data.data() + offset),
+				0,
+				static_cast<size_t>(range.count)
+			});
+		}
+
+		// Instanced model matrices come from attributes 5 to 8 and normal matrices from 9 to 11, read
+		// with their divisor (with a not instanced draw it is the first element, as LGL binds one instance
+		// at a time). Without normal attributes the normal matrix is computed from the model one
+		if (GetUniformFloat(*program, "instanced", 0.0f) != 0.0f)
+		{
+			bool normalAttribs = vao.attribs[9].enabled && vao.attribs[10].enabled && vao.attribs[11].enabled;
+
+			for (GLsizei instance = 0; instance < instanceAmount; ++instance)
+			{
+				glm::mat4 model;
+				glm::mat3 normalMatrix;
+
+				for (int column = 0; column < 7; ++column)
+				{
+					if (column >= 4 && !normalAttribs)
+					{
+						normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+						break;
+					}
+
+					const VertexAttrib& attrib = vao.attribs[5 + column];
+					size_t available;
+					const float* data = reinterpret_cast<const float*>(
+						GetAttribData(attrib, attrib.divisor ? instance / attrib.divisor : 0, available)
+					);
+
+					if (!data || attrib.size != (column < 4 ? 4 : 3))
+					{
+						SetError(GL_INVALID_OPERATION);
+						return;
+					}
+
+					if (column < 4)
+					{
+						model[column] = glm::make_vec4(data);
+					}
+					else
+					{
+						normalMatrix[column - 4] = glm::make_vec3(data);
+					}
+				}
+
+				drawCall.instances.push_back({ model, normalMatrix });
+			}
+		}
+		else
+		{
+			glm::mat4 model(1.0f);
+			glm::mat4 inv;
+			GetUniformMat4(*program, "model", model);
+
+			glm::mat3 normalMatrix = GetUniformMat4(*program, "inv", inv) ?
+				glm::mat3(glm::transpose(inv)) :
+				glm::transpose(glm::inverse(glm::mat3(model)));
+
+			drawCall.instances.assign(instanceAmount, { model, normalMatrix });
+		}
+
+		glm::mat4 view(1.0f);
+		glm::mat4 proj(1.0f);
+		GetUniformMat4(*program, "view", view);
+		GetUniformMat4(*program, "proj", proj);
+		drawCall.viewProj = proj * view;
+
+		if (program->type == ProgramType::Lit)
+		{
+			drawCall.shading = Rasterizer::ShadingModel::Lit;
+			drawCall.diffuse = GetTextureView(*program, "material.diffuse");
+			drawCall.specular = GetTextureView(*program, "material.specular");
+			drawCall.lighting = GetLighting(*program);
+		}
+		else
+		{
+			drawCall.shading = Rasterizer::ShadingModel::Flat;
+			drawCall.flatColor = glm::vec4(GetUniformVec3(*program, "lightColor", glm::vec3(1.0f)), 1.0f);
+		}
+
+		drawCall.depthTest = context.depthTest;
+		drawCall.depthWrite = context.depthMask;
+		drawCall.depthFunc = context.depthFunc;
+		drawCall.cullBackFaces = context.cullFace;
+
+		std::vector<GLenum> drawBuffers = GetDrawBuffers();
+		Rasterizer::Surface target = GetSurface(context.drawFramebuffer, drawBuffers.empty() ? GL_NONE : drawBuffers[0], true);
+		drawCall.colorWrite = target.color != nullptr;
+
+		context.rasterizer.Draw(target, context.viewport, drawCall);
+	}
+
+	void ClearColorBuffer(GLenum colorBuffer, const glm::vec4& color)
+	{
+		Context& context = GetContext();
+
+		if (colorBuffer != GL_NONE)
+		{
+			context.rasterizer.Clear(GetSurface(context.drawFramebuffer, colorBuffer, false), &color, nullptr);
+		}
+	}
+
+	void ClearDepthBuffer(float depth)
+	{
+		Context& context = GetContext();
+		Rasterizer::Surface surface = GetSurface(context.drawFramebuffer, GL_NONE, true);
+
+		context.rasterizer.Clear(surface, nullptr, &depth);
+	}
+
+	glm::vec4 ReadTexel(const Texture& texture, int x, int y)
+	{
+		const unsigned char* texel = texture.color.data() + (static_cast<size_t>(y) * texture.width + x) * 4;
+
+		return glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.0f;
+	}
+
+	// Framebuffer texture of a color buffer, to be read or written directly
+	Texture* GetColorTexture(GLuint framebuffer, GLenum colorBuffer)
+	{
+		Context& context = GetContext();
+
+		if (!framebuffer)
+		{
+			EnsureDefaultFramebuffer();
+			return colorBuffer != GL_NONE ? &context.defaultColor : nullptr;
+		}
+
+		Framebuffer& fbo = context.framebuffers[framebuffer];
+		auto attachmentIter = fbo.colorAttachments.find(colorBuffer);
+
+		return attachmentIter != fbo.colorAttachments.end() ? GetTexture(attachmentIter->second) : nullptr;
+	}
+
+	Texture* GetDepthTexture(GLuint framebuffer)
+	{
+		Context& context = GetContext();
+
+		if (!framebuffer)
+		{
+			EnsureDefaultFramebuffer();
+			return &context.defaultDepth;
+		}
+
+		return GetTexture(context.framebuffers[framebuffer].depthAttachment);
+	}
+
+	Rasterizer::Wrap InterpretWrap(GLint param)
+	{
+		switch (param)
+		{
+		case GL_MIRRORED_REPEAT:
+			return Rasterizer::Wrap::Mirrored;
+		case GL_CLAMP_TO_EDGE:
+		case GL_CLAMP_TO_BORDER:
+			return Rasterizer::Wrap::Clamp;
+		default:
+			return Rasterizer::Wrap::Repeat;
+		}
+	}
+
+	bool IsDepthFormat(GLint internalFormat)
+	{
+		switch (internalFormat)
+		{
+		case GL_DEPTH_COMPONENT:
+		case GL_DEPTH_COMPONENT16:
+		case GL_DEPTH_COMPONENT24:
+		case GL_DEPTH_COMPONENT32:
+		case GL_DEPTH_COMPONENT32F:
+		case GL_DEPTH_STENCIL:
+		case GL_DEPTH24_STENCIL8:
+		case GL_DEPTH32F_STENCIL8:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Amount of channels of an unsigned byte pixel format, 0 if not supported
+	int GetChannelAmount(GLenum format)
+	{
+		switch (format)
+		{
+		case GL_RED:
+			return 1;
+		case GL_RG:
+			return 2;
+		case GL_RGB:
+			return 3;
+		case GL_RGBA:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	size_t AlignRow(size_t rowSize, int alignment)
+	{
+		return (rowSize + alignment - 1) / alignment * alignment;
+	}
+}
+
+LGLSoftwareRasterizer::Stats LGLSoftwareBackend::GetRasterizerStats()
+{
+	return GetContext().rasterizer.GetStats();
+}
+
+size_t LGLSoftwareBackend::GetThreadAmount()
+{
+	return GetContext().rasterizer.GetThreadAmount();
+}
+
+GLenum LGLSoftwareBackend::glGetError()
+{
+	GLenum error = GetContext().error;
+	GetContext().error = GL_NO_ERROR;
+
+	return error;
+}
+
+void LGLSoftwareBackend::glEnable(GLenum cap)
+{
+	Context& context = GetContext();
+
+	switch (cap)
+	{
+	case GL_DEPTH_TEST:
+		context.depthTest = true;
+		break;
+	case GL_BLEND:
+		context.blend = true;
+		break;
+	case GL_CULL_FACE:
+		context.cullFace = true;
+		break;
+	case GL_RASTERIZER_DISCARD:
+		context.rasterizerDiscard = true;
+		break;
+	default:
+		break;
+	}
+}
+
+void LGLSoftwareBackend::glDisable(GLenum cap)
+{
+	Context& context = GetContext();
+
+	switch (cap)
+	{
+	case GL_DEPTH_TEST:
+		context.depthTest = false;
+		break;
+	case GL_BLEND:
+		context.blend = false;
+		break;
+	case GL_CULL_FACE:
+		context.cullFace = false;
+		break;
+	case GL_RASTERIZER_DISCARD:
+		context.rasterizerDiscard = false;
+		break;
+	default:
+		break;
+	}
+}
+
+GLboolean LGLSoftwareBackend::glIsEnabled(GLenum cap)
+{
+	Context& context = GetContext();
+
+	switch (cap)
+	{
+	case GL_DEPTH_TEST:
+		return context.depthTest;
+	case GL_BLEND:
+		return context.blend;
+	case GL_CULL_FACE:
+		return context.cullFace;
+	case GL_RASTERIZER_DISCARD:
+		return context.rasterizerDiscard;
+	default:
+		return GL_FALSE;
+	}
+}
+
+void LGLSoftwareBackend::glGetIntegerv(GLenum pname, GLint* data)
+{
+	Context& context = GetContext();
+
+	switch (pname)
+	{
+	case GL_MAX_VERTEX_ATTRIBS:
+		*data = maxVertexAttribs;
+		break;
+	case GL_MAX_TEXTURE_IMAGE_UNITS:
+	case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+		*data = maxTextureUnits;
+		break;
+	case GL_VIEWPORT:
+		std::copy(context.viewport.begin(), context.viewport.end(), data);
+		break;
+	case GL_DRAW_FRAMEBUFFER_BINDING:
+		*data = static_cast<GLint>(context.drawFramebuffer);
+		break;
+	case GL_READ_FRAMEBUFFER_BINDING:
+		*data = static_cast<GLint>(context.readFramebuffer);
+		break;
+	case GL_CURRENT_PROGRAM:
+		*data = static_cast<GLint>(context.program);
+		break;
+	default:
+		*data = 0;
+		SetError(GL_INVALID_ENUM);
+		break;
+	}
+}
+
+void LGLSoftwareBackend::glGetInteger64v(GLenum pname, GLint64* data)
+{
+	// Timestamps are taken on the CPU clock
+	if (pname == GL_TIMESTAMP)
+	{
+		*data = static_cast<GLint64>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()
+		);
+		return;
+	}
+
+	GLint value = 0;
+	glGetIntegerv(pname, &value);
+
+	*data = value;
+}
+
+void LGLSoftwareBackend::glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	GetContext().viewport = { x, y, width, height };
+}
+
+void LGLSoftwareBackend::glDepthFunc(GLenum func)
+{
+	if (func < GL_NEVER || func > GL_ALWAYS)
+	{
+		SetError(GL_INVALID_ENUM);
+		return;
+	}
+
+	// GL_NEVER to GL_ALWAYS follow the order of DepthFunc
+	GetContext().depthFunc = static_cast<Rasterizer::DepthFunc>(func - GL_NEVER);
+}
+
+void LGLSoftwareBackend::glDepthMask(GLboolean flag)
+{
+	GetContext().depthMask = flag != GL_FALSE;
+}
+
+void LGLSoftwareBackend::glBlendFunc(GLenum, GLenum) {}
+void LGLSoftwareBackend::glBlendFuncSeparate(GLenum, GLenum, GLenum, GLenum) {}
+
+void LGLSoftwareBackend::glPixelStorei(GLenum pname, GLint param)
+{
+	Context& context = GetContext();
+
+	if (param != 1 && param != 2 && param != 4 && param != 8)
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	if (pname == GL_UNPACK_ALIGNMENT)
+	{
+		context.unpackAlignment = param;
+	}
+	else if (pname == GL_PACK_ALIGNMENT)
+	{
+		context.packAlignment = param;
+	}
+}
+
+void LGLSoftwareBackend::glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	GetContext().clearColor = glm::vec4(red, green, blue, alpha);
+}
+
+void LGLSoftwareBackend::glClear(GLbitfield mask)
+{
+	Context& context = GetContext();
+
+	if (mask & GL_COLOR_BUFFER_BIT)
+	{
+		for (GLenum drawBuffer : GetDrawBuffers())
+		{
+			ClearColorBuffer(drawBuffer, context.clearColor);
+		}
+	}
+
+	if ((mask & GL_DEPTH_BUFFER_BIT) && context.depthMask)
+	{
+		ClearDepthBuffer(1.0f);
+	}
+}
+
+void LGLSoftwareBackend::glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* value)
+{
+	if (buffer == GL_COLOR)
+	{
+		std::vector<GLenum> drawBuffers = GetDrawBuffers();
+
+		if (drawbuffer >= 0 && drawbuffer < static_cast<GLint>(drawBuffers.size()))
+		{
+			ClearColorBuffer(drawBuffers[drawbuffer], glm::make_vec4(value));
+		}
+	}
+	else if (buffer == GL_DEPTH && GetContext().depthMask)
+	{
+		ClearDepthBuffer(value[0]);
+	}
+}
+
+void LGLSoftwareBackend::glGenBuffers(GLsizei n, GLuint* buffers)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		buffers[i] = NextName();
+		GetContext().buffers[buffers[i]];
+	}
+}
+
+void LGLSoftwareBackend::glDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		GetContext().buffers.erase(buffers[i]);
+	}
+}
+
+void LGLSoftwareBackend::glBindBuffer(GLenum target, GLuint buffer)
+{
+	if (buffer)
+	{
+		GetContext().buffers[buffer];
+	}
+
+	GetBufferBinding(target) = buffer;
+}
+
+void LGLSoftwareBackend::glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	glBindBufferRange(target, index, buffer, 0, 0);
+}
+
+void LGLSoftwareBackend::glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	glBindBuffer(target, buffer);
+
+	// Only one transform feedback output is used
+	if (target == GL_TRANSFORM_FEEDBACK_BUFFER && !index)
+	{
+		Context& context = GetContext();
+		context.feedbackBuffer = buffer;
+		context.feedbackOffset = static_cast<size_t>(offset);
+		context.feedbackSize = static_cast<size_t>(size);
+	}
+}
+
+void LGLSoftwareBackend::glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum)
+{
+	Buffer* buffer = GetBuffer(GetBufferBinding(target));
+
+	if (!buffer || size < 0)
+	{
+		SetError(!buffer ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+		return;
+	}
+
+	buffer->data.assign(static_cast<size_t>(size), 0);
+
+	if (data)
+	{
+		std::memcpy(buffer->data.data(), data, static_cast<size_t>(size));
+	}
+}
+
+void LGLSoftwareBackend::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	Buffer* buffer = GetBuffer(GetBufferBinding(target));
+
+	if (!buffer || offset < 0 || size < 0 || static_cast<size_t>(offset + size) > buffer->data.size())
+	{
+		SetError(!buffer ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+		return;
+	}
+
+	std::memcpy(buffer->data.data() + offset, data, static_cast<size_t>(size));
+}
+
+void* LGLSoftwareBackend::glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield)
+{
+	Buffer* buffer = GetBuffer(GetBufferBinding(target));
+
+	if (!buffer || offset < 0 || length < 0 || static_cast<size_t>(offset + length) > buffer->data.size())
+	{
+		SetError(!buffer ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+		return nullptr;
+	}
+
+	return buffer->data.data() + offset;
+}
+
+GLboolean LGLSoftwareBackend::glUnmapBuffer(GLenum)
+{
+	return GL_TRUE;
+}
+
+void LGLSoftwareBackend::glGenVertexArrays(GLsizei n, GLuint* arrays)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		arrays[i] = NextName();
+		GetContext().vertexArrays[arrays[i]];
+	}
+}
+
+void LGLSoftwareBackend::glDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+	Context& context = GetContext();
+
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		if (!arrays[i])
+		{
+			continue;
+		}
+
+		context.vertexArrays.erase(arrays[i]);
+
+		if (context.vertexArray == arrays[i])
+		{
+			context.vertexArray = 0;
+		}
+	}
+}
+
+void LGLSoftwareBackend::glBindVertexArray(GLuint array)
+{
+	Context& context = GetContext();
+
+	if (!context.vertexArrays.count(array))
+	{
+		SetError(GL_INVALID_OPERATION);
+		return;
+	}
+
+	context.vertexArray = array;
+}
+
+void LGLSoftwareBackend::glEnableVertexAttribArray(GLuint index)
+{
+	if (index >= maxVertexAttribs)
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	GetContext().vertexArrays[GetContext().vertexArray].attribs[index].enabled = true;
+}
+
+void LGLSoftwareBackend::glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean, GLsizei stride, const void* pointer)
+{
+	Context& context = GetContext();
+
+	if (index >= maxVertexAttribs || size < 1 || size > 4 || stride < 0)
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	// Other types are kept, so draws of unsupported programs (debug draw colors) do not fail,
+	// draws that would read them are skipped
+	VertexAttrib& attrib = context.vertexArrays[context.vertexArray].attribs[index];
+	attrib.buffer = context.boundBuffers[GL_ARRAY_BUFFER];
+	attrib.size = size;
+	attrib.type = type;
+	attrib.stride = static_cast<size_t>(stride);
+	attrib.offset = reinterpret_cast<size_t>(pointer);
+}
+
+void LGLSoftwareBackend::glVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	if (index >= maxVertexAttribs)
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	GetContext().vertexArrays[GetContext().vertexArray].attribs[index].divisor = divisor;
+}
+
+void LGLSoftwareBackend::glGenTextures(GLsizei n, GLuint* textures)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		textures[i] = NextName();
+		GetContext().textures[textures[i]];
+	}
+}
+
+void LGLSoftwareBackend::glDeleteTextures(GLsizei n, const GLuint* textures)
+{
+	Context& context = GetContext();
+
+	// Pending draws may still sample or render into them
+	context.rasterizer.Flush();
+
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		context.textures.erase(textures[i]);
+	}
+}
+
+void LGLSoftwareBackend::glActiveTexture(GLenum texture)
+{
+	int unit = static_cast<int>(texture) - GL_TEXTURE0;
+
+	if (unit < 0 || unit >= maxTextureUnits)
+	{
+		SetError(GL_INVALID_ENUM);
+		return;
+	}
+
+	GetContext().activeTexture = unit;
+}
+
+void LGLSoftwareBackend::glBindTexture(GLenum target, GLuint texture)
+{
+	Context& context = GetContext();
+
+	if (texture)
+	{
+		context.textures[texture];
+	}
+
+	context.textureUnits[context.activeTexture][target] = texture;
+}
+
+void LGLSoftwareBackend::glTexImage2D(
+	GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+	GLint, GLenum format, GLenum type, const void* pixels
+)
+{
+	Context& context = GetContext();
+
+	// Cube map faces are only used by shadow maps, which are not rendered
+	if (target != GL_TEXTURE_2D || level)
+	{
+		return;
+	}
+
+	Texture* texture = GetTexture(context.textureUnits[context.activeTexture][GL_TEXTURE_2D]);
+	if (!texture || width < 0 || height < 0)
+	{
+		SetError(!texture ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+		return;
+	}
+
+	// Storage is reallocated under pending draws
+	context.rasterizer.Flush();
+
+	size_t pixelAmount = static_cast<size_t>(width) * height;
+	texture->width = width;
+	texture->height = height;
+	texture->color.clear();
+	texture->depth.clear();
+
+	if (IsDepthFormat(internalformat))
+	{
+		texture->depth.assign(pixelAmount, 1.0f);
+		return;
+	}
+
+	texture->color.assign(pixelAmount * 4, 0);
+
+	if (!pixels)
+	{
+		return;
+	}
+
+	int channelAmount = GetChannelAmount(format);
+	if (!channelAmount || type != GL_UNSIGNED_BYTE)
+	{
+		WarnOnce("only unsigned byte RED, RG, RGB and RGBA textures can be uploaded");
+		return;
+	}
+
+	// Missing channels read as in OpenGL, 0 for color and 1 for alpha
+	const unsigned char* source = static_cast<const unsigned char*>(pixels);
+	size_t sourceRowSize = AlignRow(static_cast<size_t>(width) * channelAmount, context.unpackAlignment);
+
+	for (GLsizei y = 0; y < height; ++y)
+	{
+		const unsigned char* sourcePixel = source + y * sourceRowSize;
+		unsigned char* pixel = texture->color.data() + static_cast<size_t>(y) * width * 4;
+
+		for (GLsizei x = 0; x < width; ++x, sourcePixel += channelAmount, pixel += 4)
+		{
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				pixel[channel] = channel < channelAmount ? sourcePixel[channel] : (channel == 3 ? 255 : 0);
+			}
+		}
+	}
+}
+
+void LGLSoftwareBackend::glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	Context& context = GetContext();
+	Texture* texture = GetTexture(context.textureUnits[context.activeTexture][target]);
+
+	if (!texture)
+	{
+		return;
+	}
+
+	// There are no mipmaps, magnification filter is used for everything
+	switch (pname)
+	{
+	case GL_TEXTURE_WRAP_S:
+		texture->wrapS = InterpretWrap(param);
+		break;
+	case GL_TEXTURE_WRAP_T:
+		texture->wrapT = InterpretWrap(param);
+		break;
+	case GL_TEXTURE_MAG_FILTER:
+		texture->linear = param == GL_LINEAR;
+		break;
+	default:
+		break;
+	}
+}
+
+void LGLSoftwareBackend::glGenerateMipmap(GLenum) {}
+
+void LGLSoftwareBackend::glGenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		framebuffers[i] = NextName();
+		GetContext().framebuffers[framebuffers[i]];
+	}
+}
+
+void LGLSoftwareBackend::glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+	Context& context = GetContext();
+
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		if (!framebuffers[i])
+		{
+			continue;
+		}
+
+		context.framebuffers.erase(framebuffers[i]);
+
+		context.drawFramebuffer = context.drawFramebuffer == framebuffers[i] ? 0 : context.drawFramebuffer;
+		context.readFramebuffer = context.readFramebuffer == framebuffers[i] ? 0 : context.readFramebuffer;
+	}
+}
+
+void LGLSoftwareBackend::glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	Context& context = GetContext();
+
+	if (framebuffer)
+	{
+		context.framebuffers[framebuffer];
+	}
+
+	if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER)
+	{
+		context.drawFramebuffer = framebuffer;
+	}
+
+	if (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER)
+	{
+		context.readFramebuffer = framebuffer;
+	}
+}
+
+void LGLSoftwareBackend::glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum, GLuint texture, GLint)
+{
+	Context& context = GetContext();
+	GLuint framebuffer = target == GL_READ_FRAMEBUFFER ? context.readFramebuffer : context.drawFramebuffer;
+
+	if (!framebuffer)
+	{
+		SetError(GL_INVALID_OPERATION);
+		return;
+	}
+
+	// Attachments change where pending draws go
+	context.rasterizer.Flush();
+
+	Framebuffer& fbo = context.framebuffers[framebuffer];
+
+	if (attachment == GL_DEPTH_ATTACHMENT || attachment == GL_DEPTH_STENCIL_ATTACHMENT)
+	{
+		fbo.depthAttachment = texture;
+	}
+	else
+	{
+		fbo.colorAttachments[attachment] = texture;
+	}
+}
+
+GLenum LGLSoftwareBackend::glCheckFramebufferStatus(GLenum)
+{
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void LGLSoftwareBackend::glDrawBuffer(GLenum buf)
+{
+	Context& context = GetContext();
+
+	if (context.drawFramebuffer)
+	{
+		context.framebuffers[context.drawFramebuffer].drawBuffers = { buf };
+	}
+}
+
+void LGLSoftwareBackend::glDrawBuffers(GLsizei n, const GLenum* bufs)
+{
+	Context& context = GetContext();
+
+	if (context.drawFramebuffer)
+	{
+		context.framebuffers[context.drawFramebuffer].drawBuffers.assign(bufs, bufs + n);
+	}
+}
+
+void LGLSoftwareBackend::glReadBuffer(GLenum src)
+{
+	Context& context = GetContext();
+
+	if (context.readFramebuffer)
+	{
+		context.framebuffers[context.readFramebuffer].readBuffer = src;
+	}
+}
+
+void LGLSoftwareBackend::glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+{
+	Context& context = GetContext();
+
+	context.rasterizer.Flush();
+
+	// With a pack buffer bound pixels is an offset in it
+	unsigned char* destination = static_cast<unsigned char*>(pixels);
+	size_t destinationSize = std::numeric_limits<size_t>::max();
+
+	if (GLuint packBuffer = context.boundBuffers[GL_PIXEL_PACK_BUFFER])
+	{
+		Buffer* buffer = GetBuffer(packBuffer);
+		size_t offset = reinterpret_cast<size_t>(pixels);
+
+		if (!buffer || offset > buffer->data.size())
+		{
+			SetError(GL_INVALID_OPERATION);
+			return;
+		}
+
+		destination = buffer->data.data() + offset;
+		destinationSize = buffer->data.size() - offset;
+	}
+
+	bool readDepth = format == GL_DEPTH_COMPONENT;
+	int channelAmount = readDepth ? 1 : GetChannelAmount(format);
+	size_t channelSize = readDepth ? sizeof(float) : 1;
+
+	if (!channelAmount || (readDepth ? type != GL_FLOAT : type != GL_UNSIGNED_BYTE))
+	{
+		WarnOnce("only unsigned byte color and float depth can be read");
+		SetError(GL_INVALID_ENUM);
+		return;
+	}
+
+	size_t rowSize = AlignRow(static_cast<size_t>(width) * channelAmount * channelSize, context.packAlignment);
+	if (width < 0 || height < 0 || rowSize * height > destinationSize)
+	{
+		SetError(GL_INVALID_OPERATION);
+		return;
+	}
+
+	Texture* source = readDepth ? GetDepthTexture(context.readFramebuffer) : GetColorTexture(context.readFramebuffer, GetReadBuffer());
+
+	for (GLsizei row = 0; row < height; ++row)
+	{
+		unsigned char* pixel = destination + row * rowSize;
+
+		for (GLsizei column = 0; column < width; ++column, pixel += channelAmount * channelSize)
+		{
+			int sourceX = x + column;
+			int sourceY = y + row;
+			bool inside = source && sourceX >= 0 && sourceY >= 0 && sourceX < source->width && sourceY < source->height;
+			size_t sourceIndex = inside ? static_cast<size_t>(sourceY) * source->width + sourceX : 0;
+
+			if (readDepth)
+			{
+				float depth = inside && !source->depth.empty() ? source->depth[sourceIndex] : 1.0f;
+				std::memcpy(pixel, &depth, sizeof(float));
+			}
+			else if (inside && !source->color.empty())
+			{
+				std::copy(&source->color[sourceIndex * 4], &source->color[sourceIndex * 4] + channelAmount, pixel);
+			}
+			else
+			{
+				std::fill(pixel, pixel + channelAmount, 0);
+			}
+		}
+	}
+}
+
+void LGLSoftwareBackend::glBlitFramebuffer(
+	GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+	GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+	GLbitfield mask, GLenum filter
+)
+{
+	Context& context = GetContext();
+
+	context.rasterizer.Flush();
+
+	Texture* sourceColor = (mask & GL_COLOR_BUFFER_BIT) ? GetColorTexture(context.readFramebuffer, GetReadBuffer()) : nullptr;
+	Texture* sourceDepth = (mask & GL_DEPTH_BUFFER_BIT) ? GetDepthTexture(context.readFramebuffer) : nullptr;
+
+	std::vector<GLenum> drawBuffers = GetDrawBuffers();
+	Texture* destinationColor = sourceColor && !drawBuffers.empty() ? GetColorTexture(context.drawFramebuffer, drawBuffers[0]) : nullptr;
+	Texture* destinationDepth = sourceDepth ? GetDepthTexture(context.drawFramebuffer) : nullptr;
+
+	bool copyColor = sourceColor && destinationColor && !sourceColor->color.empty() && !destinationColor->color.empty();
+	bool copyDepth = sourceDepth && destinationDepth && !sourceDepth->depth.empty() && !destinationDepth->depth.empty();
+
+	if ((!copyColor && !copyDepth) || dstX0 == dstX1 || dstY0 == dstY1)
+	{
+		return;
+	}
+
+	float scaleX = static_cast<float>(srcX1 - srcX0) / (dstX1 - dstX0);
+	float scaleY = static_cast<float>(srcY1 - srcY0) / (dstY1 - dstY0);
+
+	Texture* destination = copyColor ? destinationColor : destinationDepth;
+	int minX = std::max(std::min(dstX0, dstX1), 0);
+	int maxX = std::min(std::max(dstX0, dstX1), destination->width);
+	int minY = std::max(std::min(dstY0, dstY1), 0);
+	int maxY = std::min(std::max(dstY0, dstY1), destination->height);
+
+	for (int y = minY; y < maxY; ++y)
+	{
+		float sourceY = srcY0 + (y + 0.5f - dstY0) * scaleY;
+
+		for (int x = minX; x < maxX; ++x)
+		{
+			float sourceX = srcX0 + (x + 0.5f - dstX0) * scaleX;
+
+			if (copyColor && x < destinationColor->width && y < destinationColor->height)
+			{
+				glm::vec4 color;
+
+				if (filter == GL_LINEAR)
+				{
+					float texelX = std::min(std::max(sourceX - 0.5f, 0.0f), sourceColor->width - 1.0f);
+					float texelY = std::min(std::max(sourceY - 0.5f, 0.0f), sourceColor->height - 1.0f);
+					int x0 = static_cast<int>(texelX);
+					int y0 = static_cast<int>(texelY);
+					int x1 = std::min(x0 + 1, sourceColor->width - 1);
+					int y1 = std::min(y0 + 1, sourceColor->height - 1);
+					float fracX = texelX - x0;
+					float fracY = texelY - y0;
+
+					color = glm::mix(
+						glm::mix(ReadTexel(*sourceColor, x0, y0), ReadTexel(*sourceColor, x1, y0), fracX),
+						glm::mix(ReadTexel(*sourceColor, x0, y1), ReadTexel(*sourceColor, x1, y1), fracX),
+						fracY
+					);
+				}
+				else
+				{
+					int texelX = std::min(std::max(static_cast<int>(std::floor(sourceX)), 0), sourceColor->width - 1);
+					int texelY = std::min(std::max(static_cast<int>(std::floor(sourceY)), 0), sourceColor->height - 1);
+					color = ReadTexel(*sourceColor, texelX, texelY);
+				}
+
+				unsigned char* pixel = destinationColor->color.data() + (static_cast<size_t>(y) * destinationColor->width + x) * 4;
+				for (int channel = 0; channel < 4; ++channel)
+				{
+					pixel[channel] = static_cast<unsigned char>(color[channel] * 255.0f + 0.5f);
+				}
+			}
+
+			// Depth is always copied with nearest filtering
+			if (copyDepth && x < destinationDepth->width && y < destinationDepth->height)
+			{
+				int texelX = std::min(std::max(static_cast<int>(std::floor(sourceX)), 0), sourceDepth->width - 1);
+				int texelY = std::min(std::max(static_cast<int>(std::floor(sourceY)), 0), sourceDepth->height - 1);
+
+				destinationDepth->depth[static_cast<size_t>(y) * destinationDepth->width + x] =
+					sourceDepth->depth[static_cast<size_t>(texelY) * sourceDepth->width + texelX];
+			}
+		}
+	}
+}
+
+GLuint LGLSoftwareBackend::glCreateShader(GLenum type)
+{
+	GLuint name = NextName();
+	GetContext().shaders[name].type = type;
+
+	return name;
+}
+
+void LGLSoftwareBackend::glDeleteShader(GLuint shader)
+{
+	GetContext().shaders.erase(shader);
+}
+
+void LGLSoftwareBackend::glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+	auto shaderIter = GetContext().shaders.find(shader);
+
+	if (shaderIter == GetContext().shaders.end())
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	shaderIter->second.source.clear();
+
+	for (GLsizei i = 0; i < count; ++i)
+	{
+		if (length && length[i] >= 0)
+		{
+			shaderIter->second.source.append(string[i], length[i]);
+		}
+		else
+		{
+			shaderIter->second.source.append(string[i]);
+		}
+	}
+}
+
+void LGLSoftwareBackend::glCompileShader(GLuint) {}
+
+GLuint LGLSoftwareBackend::glCreateProgram()
+{
+	GLuint name = NextName();
+	GetContext().programs[name];
+
+	return name;
+}
+
+void LGLSoftwareBackend::glDeleteProgram(GLuint program)
+{
+	GetContext().programs.erase(program);
+}
+
+void LGLSoftwareBackend::glAttachShader(GLuint program, GLuint shader)
+{
+	Program* programInfo = GetProgram(program);
+
+	if (!programInfo)
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	programInfo->shaders.push_back(shader);
+}
+
+void LGLSoftwareBackend::glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum)
+{
+	Program* programInfo = GetProgram(program);
+
+	if (!programInfo)
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	programInfo->feedbackVaryings.assign(varyings, varyings + count);
+}
+
+void LGLSoftwareBackend::glLinkProgram(GLuint program)
+{
+	Context& context = GetContext();
+	Program* programInfo = GetProgram(program);
+
+	if (!programInfo)
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	// Shaders are not compiled, programs LGL uses are recognized by their uniforms
+	std::string vertexSource;
+	std::string fragmentSource;
+
+	for (GLuint shader : programInfo->shaders)
+	{
+		auto shaderIter = context.shaders.find(shader);
+		if (shaderIter == context.shaders.end())
+		{
+			continue;
+		}
+
+		if (shaderIter->second.type == GL_VERTEX_SHADER)
+		{
+			vertexSource += shaderIter->second.source;
+		}
+		else if (shaderIter->second.type == GL_FRAGMENT_SHADER)
+		{
+			fragmentSource += shaderIter->second.source;
+		}
+	}
+
+	if (!programInfo->feedbackVaryings.empty())
+	{
+		programInfo->type = ProgramType::Feedback;
+	}
+	else if (fragmentSource.find("pointLights") != std::string::npos && vertexSource.find("proj") != std::string::npos)
+	{
+		programInfo->type = ProgramType::Lit;
+	}
+	else if (vertexSource.find("proj") != std::string::npos && vertexSource.find("model") != std::string::npos)
+	{
+		programInfo->type = ProgramType::Flat;
+	}
+	else
+	{
+		programInfo->type = ProgramType::Unsupported;
+	}
+}
+
+void LGLSoftwareBackend::glGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+	if (!GetProgram(program))
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	switch (pname)
+	{
+	case GL_LINK_STATUS:
+	case GL_VALIDATE_STATUS:
+		*params = GL_TRUE;
+		break;
+	default:
+		*params = 0;
+		break;
+	}
+}
+
+void LGLSoftwareBackend::glUseProgram(GLuint program)
+{
+	if (program && !GetProgram(program))
+	{
+		SetError(GL_INVALID_VALUE);
+		return;
+	}
+
+	GetContext().program = program;
+}
+
+GLint LGLSoftwareBackend::glGetUniformLocation(GLuint program, const GLchar* name)
+{
+	Program* programInfo = GetProgram(program);
+
+	if (!programInfo)
+	{
+		SetError(GL_INVALID_VALUE);
+		return -1;
+	}
+
+	return GetUniformLocation(*programInfo, name);
+}
+
+void LGLSoftwareBackend::glUniform1i(GLint location, GLint v0)
+{
+	float value = static_cast<float>(v0);
+	SetUniform(location, &value, 1);
+}
+
+void LGLSoftwareBackend::glUniform1f(GLint location, GLfloat v0)
+{
+	SetUniform(location, &v0, 1);
+}
+
+void LGLSoftwareBackend::glUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+	float values[] = { v0, v1 };
+	SetUniform(location, values, 2);
+}
+
+void LGLSoftwareBackend::glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+	float values[] = { v0, v1, v2 };
+	SetUniform(location, values, 3);
+}
+
+void LGLSoftwareBackend::glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+	float values[] = { v0, v1, v2, v3 };
+	SetUniform(location, values, 4);
+}
+
+void LGLSoftwareBackend::glUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	SetUniform(location, value, static_cast<size_t>(count) * 4);
+}
+
+void LGLSoftwareBackend::glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	if (!transpose)
+	{
+		SetUniform(location, value, static_cast<size_t>(count) * 16);
+		return;
+	}
+
+	std::vector<float> values(value, value + count * 16);
+	for (GLsizei matrix = 0; matrix < count; ++matrix)
+	{
+		glm::mat4 transposed = glm::transpose(glm::make_mat4(value + matrix * 16));
+		std::copy(glm::value_ptr(transposed), glm::value_ptr(transposed) + 16, values.begin() + matrix * 16);
+	}
+
+	SetUniform(location, values.data(), values.size());
+}
+
+void LGLSoftwareBackend::glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	Draw(mode, { { nullptr, first, count } }, false, GL_NONE, 1);
+}
+
+void LGLSoftwareBackend::glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+{
+	Draw(mode, { { nullptr, first, count } }, false, GL_NONE, instancecount);
+}
+
+void LGLSoftwareBackend::glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+	Draw(mode, { { indices, 0, count } }, true, type, 1);
+}
+
+void LGLSoftwareBackend::glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
+{
+	Draw(mode, { { indices, 0, count } }, true, type, instancecount);
+}
+
+void LGLSoftwareBackend::glMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount)
+{
+	std::vector<DrawRange> ranges;
+
+	for (GLsizei draw = 0; draw < drawcount; ++draw)
+	{
+		ranges.push_back({ indices[draw], 0, count[draw] });
+	}
+
+	Draw(mode, ranges, true, type, 1);
+}
+
+void LGLSoftwareBackend::glBeginTransformFeedback(GLenum)
+{
+	GetContext().feedbackActive = true;
+}
+
+void LGLSoftwareBackend::glEndTransformFeedback()
+{
+	GetContext().feedbackActive = false;
+}
+
+void LGLSoftwareBackend::glGenQueries(GLsizei n, GLuint* ids)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		ids[i] = NextName();
+		GetContext().queries[ids[i]];
+	}
+}
+
+void LGLSoftwareBackend::glDeleteQueries(GLsizei n, const GLuint* ids)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		GetContext().queries.erase(ids[i]);
+	}
+}
+
+void LGLSoftwareBackend::glBeginQuery(GLenum target, GLuint id)
+{
+	Context& context = GetContext();
+
+	if (!context.queries.count(id) || context.activeQueries.count(target))
+	{
+		SetError(GL_INVALID_OPERATION);
+		return;
+	}
+
+	Query& query = context.queries[id];
+	query.result = 0;
+
+	// Timer measures the work queued inside it, rasterizing what was queued before is not counted
+	if (target == GL_TIME_ELAPSED)
+	{
+		context.rasterizer.Flush();
+		query.start = std::chrono::steady_clock::now();
+	}
+
+	context.activeQueries[target] = id;
+}
+
+void LGLSoftwareBackend::glEndQuery(GLenum target)
+{
+	Context& context = GetContext();
+
+	auto activeIter = context.activeQueries.find(target);
+	if (activeIter == context.activeQueries.end())
+	{
+		SetError(GL_INVALID_OPERATION);
+		return;
+	}
+
+	if (target == GL_TIME_ELAPSED)
+	{
+		context.rasterizer.Flush();
+
+		Query& query = context.queries[activeIter->second];
+		query.result = static_cast<GLuint64>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - query.start).count()
+		);
+	}
+
+	context.activeQueries.erase(activeIter);
+}
+
+void LGLSoftwareBackend::glGetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+	GLuint64 result;
+	glGetQueryObjectui64v(id, pname, &result);
+
+	*params = static_cast<GLint>(result);
+}
+
+void LGLSoftwareBackend::glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params)
+{
+	GLuint64 result;
+	glGetQueryObjectui64v(id, pname, &result);
+
+	*params = static_cast<GLuint>(result);
+}
+
+void LGLSoftwareBackend::glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+	auto queryIter = GetContext().queries.find(id);
+
+	if (queryIter == GetContext().queries.end())
+	{
+		*params = 0;
+		SetError(GL_INVALID_OPERATION);
+		return;
+	}
+
+	// Queries are resolved when they end
+	*params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : queryIter->second.result;
+}
+
+void LGLSoftwareBackend::glQueryCounter(GLuint id, GLenum target)
+{
+	Context& context = GetContext();
+
+	auto queryIter = context.queries.find(id);
+	if (queryIter == context.queries.end() || target != GL_TIMESTAMP)
+	{
+		SetError(GL_INVALID_OPERATION);
+		return;
+	}
+
+	// Timestamp is taken once the work queued before it is rasterized
+	context.rasterizer.Flush();
+
+	GLint64 timestamp;
+	glGetInteger64v(GL_TIMESTAMP, &timestamp);
+	queryIter->second.result = static_cast<GLuint64>(timestamp);
+}
+
+GLsync LGLSoftwareBackend::glFenceSync(GLenum, GLbitfield)
+{
+	GetContext().rasterizer.Flush();
+
+	return reinterpret_cast<GLsync>(&GetContext());
+}
+
+GLenum LGLSoftwareBackend::glClientWaitSync(GLsync, GLbitfield, GLuint64)
+{
+	return GL_ALREADY_SIGNALED;
+}
+
+void LGLSoftwareBackend::glDeleteSync(GLsync) {}
+
+#endif
@@ -0,0 +1,311 @@
+#pragma once
+
+#ifndef LGL_EXPORT
+#error "LGLSoftwareBackend is LGL only"
+#endif
+
+/*
+	Software backend for LGL, enabled with LGL_SOFTWARE_BACKEND define
+
+	Implements the part of OpenGL LGL uses on top of LGLSoftwareRasterizer, so scenes
+	render without a GPU or a GL driver. Window is replaced with LGLHeadlessWindow,
+	rendered frames are read with LGL capture functions.
+
+	GLSL is not compiled, shader programs are matched by their sources instead:
+	programs with lightComb lighting (pointLights uniform) are shaded with its lighting model,
+	other programs with model, view and proj uniforms are drawn with one color taken from
+	lightColor or color uniform. Draws with any other program (shadows, full screen passes),
+	blended draws (transparency) and non triangle draws are skipped.
+	Transform feedback of instanceCull is emulated on CPU with its frustum test, other feedback
+	programs copy vertex attributes as they are.
+
+	Has to be included after glad, names are redirected with macros
+*/
+
+#include <glad/glad.h>
+
+#include "LGLHeadlessWindow.h"
+#include "LGLSoftwareRasterizer.h"
+
+// glad defines its function names as macros, backend functions reuse these names
+#undef glActiveTexture
+#undef glAttachShader
+#undef glBeginQuery
+#undef glBeginTransformFeedback
+#undef glBindBuffer
+#undef glBindBufferBase
+#undef glBindBufferRange
+#undef glBindFramebuffer
+#undef glBindTexture
+#undef glBindVertexArray
+#undef glBlendFunc
+#undef glBlendFuncSeparate
+#undef glBlitFramebuffer
+#undef glBufferData
+#undef glBufferSubData
+#undef glCheckFramebufferStatus
+#undef glClear
+#undef glClearBufferfv
+#undef glClearColor
+#undef glClientWaitSync
+#undef glCompileShader
+#undef glCreateProgram
+#undef glCreateShader
+#undef glDeleteBuffers
+#undef glDeleteFramebuffers
+#undef glDeleteProgram
+#undef glDeleteQueries
+#undef glDeleteShader
+#undef glDeleteSync
+#undef glDeleteTextures
+#undef glDeleteVertexArrays
+#undef glDepthFunc
+#undef glDepthMask
+#undef glDisable
+#undef glDrawArrays
+#undef glDrawArraysInstanced
+#undef glDrawBuffer
+#undef glDrawBuffers
+#undef glDrawElements
+#undef glDrawElementsInstanced
+#undef glEnable
+#undef glEnableVertexAttribArray
+#undef glEndQuery
+#undef glEndTransformFeedback
+#undef glFenceSync
+#undef glFramebufferTexture2D
+#undef glGenBuffers
+#undef glGenFramebuffers
+#undef glGenQueries
+#undef glGenTextures
+#undef glGenVertexArrays
+#undef glGenerateMipmap
+#undef glGetError
+#undef glGetInteger64v
+#undef glGetIntegerv
+#undef glGetProgramiv
+#undef glGetQueryObjectiv
+#undef glGetQueryObjectui64v
+#undef glGetQueryObjectuiv
+#undef glGetUniformLocation
+#undef glIsEnabled
+#undef glLinkProgram
+#undef glMapBufferRange
+#undef glMultiDrawElements
+#undef glPixelStorei
+#undef glQueryCounter
+#undef glReadBuffer
+#undef glReadPixels
+#undef glShaderSource
+#undef glTexImage2D
+#undef glTexParameteri
+#undef glTransformFeedbackVaryings
+#undef glUniform1f
+#undef glUniform1i
+#undef glUniform2f
+#undef glUniform3f
+#undef glUniform4f
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#undef glUnmapBuffer
+#undef glUseProgram
+#undef glVertexAttribDivisor
+#undef glVertexAttribPointer
+#undef glViewport
+
+class LGLSoftwareBackend
+{
+public:
+	static LGLSoftwareRasterizer::Stats GetRasterizerStats();
+	static size_t GetThreadAmount();
+
+	// State
+	static GLenum glGetError();
+	static void glEnable(GLenum cap);
+	static void glDisable(GLenum cap);
+	static GLboolean glIsEnabled(GLenum cap);
+	static void glGetIntegerv(GLenum pname, GLint* data);
+	static void glGetInteger64v(GLenum pname, GLint64* data);
+	static void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	static void glDepthFunc(GLenum func);
+	static void glDepthMask(GLboolean flag);
+	static void glBlendFunc(GLenum sfactor, GLenum dfactor);
+	static void glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha);
+	static void glPixelStorei(GLenum pname, GLint param);
+	static void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+	static void glClear(GLbitfield mask);
+	static void glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* value);
+
+	// Buffers and vertex arrays
+	static void glGenBuffers(GLsizei n, GLuint* buffers);
+	static void glDeleteBuffers(GLsizei n, const GLuint* buffers);
+	static void glBindBuffer(GLenum target, GLuint buffer);
+	static void glBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	static void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	static void glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+	static void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+	static void* glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	static GLboolean glUnmapBuffer(GLenum target);
+	static void glGenVertexArrays(GLsizei n, GLuint* arrays);
+	static void glDeleteVertexArrays(GLsizei n, const GLuint* arrays);
+	static void glBindVertexArray(GLuint array);
+	static void glEnableVertexAttribArray(GLuint index);
+	static void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+	static void glVertexAttribDivisor(GLuint index, GLuint divisor);
+
+	// Textures and framebuffers
+	static void glGenTextures(GLsizei n, GLuint* textures);
+	static void glDeleteTextures(GLsizei n, const GLuint* textures);
+	static void glActiveTexture(GLenum texture);
+	static void glBindTexture(GLenum target, GLuint texture);
+	static void glTexImage2D(
+		GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, 
+		GLint border, GLenum format, GLenum type, const void* pixels
+	);
+	static void glTexParameteri(GLenum target, GLenum pname, GLint param);
+	static void glGenerateMipmap(GLenum target);
+	static void glGenFramebuffers(GLsizei n, GLuint* framebuffers);
+	static void glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+	static void glBindFramebuffer(GLenum target, GLuint framebuffer);
+	static void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+	static GLenum glCheckFramebufferStatus(GLenum target);
+	static void glDrawBuffer(GLenum buf);
+	static void glDrawBuffers(GLsizei n, const GLenum* bufs);
+	static void glReadBuffer(GLenum src);
+	static void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+	static void glBlitFramebuffer(
+		GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, 
+		GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, 
+		GLbitfield mask, GLenum filter
+	);
+
+	// Shaders and uniforms
+	static GLuint glCreateShader(GLenum type);
+	static void glDeleteShader(GLuint shader);
+	static void glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+	static void glCompileShader(GLuint shader);
+	static GLuint glCreateProgram();
+	static void glDeleteProgram(GLuint program);
+	static void glAttachShader(GLuint program, GLuint shader);
+	static void glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode);
+	static void glLinkProgram(GLuint program);
+	static void glGetProgramiv(GLuint program, GLenum pname, GLint* params);
+	static void glUseProgram(GLuint program);
+	static GLint glGetUniformLocation(GLuint program, const GLchar* name);
+	static void glUniform1i(GLint location, GLint v0);
+	static void glUniform1f(GLint location, GLfloat v0);
+	static void glUniform2f(GLint location, GLfloat v0, GLfloat v1);
+	static void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+	static void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+	static void glUniform4fv(GLint location, GLsizei count, const GLfloat* value);
+	static void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+	// Draws
+	static void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+	static void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+	static void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+	static void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+	static void glMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount);
+	static void glBeginTransformFeedback(GLenum primitiveMode);
+	static void glEndTransformFeedback();
+
+	// Queries and synchronization, work is done by the time a fence, a timer query or a timestamp is reached
+	static void glGenQueries(GLsizei n, GLuint* ids);
+	static void glDeleteQueries(GLsizei n, const GLuint* ids);
+	static void glBeginQuery(GLenum target, GLuint id);
+	static void glEndQuery(GLenum target);
+	static void glGetQueryObjectiv(GLuint id, GLenum pname, GLint* params);
+	static void glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params);
+	static void glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+	static void glQueryCounter(GLuint id, GLenum target);
+	static GLsync glFenceSync(GLenum condition, GLbitfield flags);
+	static GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+	static void glDeleteSync(GLsync sync);
+};
+
+#ifndef LGL_SOFTWARE_BACKEND_IMPLEMENTATION
+#define glActiveTexture LGLSoftwareBackend::glActiveTexture
+#define glAttachShader LGLSoftwareBackend::glAttachShader
+#define glBeginQuery LGLSoftwareBackend::glBeginQuery
+#define glBeginTransformFeedback LGLSoftwareBackend::glBeginTransformFeedback
+#define glBindBuffer LGLSoftwareBackend::glBindBuffer
+#define glBindBufferBase LGLSoftwareBackend::glBindBufferBase
+#define glBindBufferRange LGLSoftwareBackend::glBindBufferRange
+#define glBindFramebuffer LGLSoftwareBackend::glBindFramebuffer
+#define glBindTexture LGLSoftwareBackend::glBindTexture
+#define glBindVertexArray LGLSoftwareBackend::glBindVertexArray
+#define glBlendFunc LGLSoftwareBackend::glBlendFunc
+#define glBlendFuncSeparate LGLSoftwareBackend::glBlendFuncSeparate
+#define glBlitFramebuffer LGLSoftwareBackend::glBlitFramebuffer
+#define glBufferData LGLSoftwareBackend::glBufferData
+#define glBufferSubData LGLSoftwareBackend::glBufferSubData
+#define glCheckFramebufferStatus LGLSoftwareBackend::glCheckFramebufferStatus
+#define glClear LGLSoftwareBackend::glClear
+#define glClearBufferfv LGLSoftwareBackend::glClearBufferfv
+#define glClearColor LGLSoftwareBackend::glClearColor
+#define glClientWaitSync LGLSoftwareBackend::glClientWaitSync
+#define glCompileShader LGLSoftwareBackend::glCompileShader
+#define glCreateProgram LGLSoftwareBackend::glCreateProgram
+#define glCreateShader LGLSoftwareBackend::glCreateShader
+#define glDeleteBuffers LGLSoftwareBackend::glDeleteBuffers
+#define glDeleteFramebuffers LGLSoftwareBackend::glDeleteFramebuffers
+#define glDeleteProgram LGLSoftwareBackend::glDeleteProgram
+#define glDeleteQueries LGLSoftwareBackend::glDeleteQueries
+#define glDeleteShader LGLSoftwareBackend::glDeleteShader
+#define glDeleteSync LGLSoftwareBackend::glDeleteSync
+#define glDeleteTextures LGLSoftwareBackend::glDeleteTextures
+#define glDeleteVertexArrays LGLSoftwareBackend::glDeleteVertexArrays
+#define glDepthFunc LGLSoftwareBackend::glDepthFunc
+#define glDepthMask LGLSoftwareBackend::glDepthMask
+#define glDisable LGLSoftwareBackend::glDisable
+#define glDrawArrays LGLSoftwareBackend::glDrawArrays
+#define glDrawArraysInstanced LGLSoftwareBackend::glDrawArraysInstanced
+#define glDrawBuffer LGLSoftwareBackend::glDrawBuffer
+#define glDrawBuffers LGLSoftwareBackend::glDrawBuffers
+#define glDrawElements LGLSoftwareBackend::glDrawElements
+#define glDrawElementsInstanced LGLSoftwareBackend::glDrawElementsInstanced
+#define glEnable LGLSoftwareBackend::glEnable
+#define glEnableVertexAttribArray LGLSoftwareBackend::glEnableVertexAttribArray
+#define glEndQuery LGLSoftwareBackend::glEndQuery
+#define glEndTransformFeedback LGLSoftwareBackend::glEndTransformFeedback
+#define glFenceSync LGLSoftwareBackend::glFenceSync
+#define glFramebufferTexture2D LGLSoftwareBackend::glFramebufferTexture2D
+#define glGenBuffers LGLSoftwareBackend::glGenBuffers
+#define glGenFramebuffers LGLSoftwareBackend::glGenFramebuffers
+#define glGenQueries LGLSoftwareBackend::glGenQueries
+#define glGenTextures LGLSoftwareBackend::glGenTextures
+#define glGenVertexArrays LGLSoftwareBackend::glGenVertexArrays
+#define glGenerateMipmap LGLSoftwareBackend::glGenerateMipmap
+#define glGetError LGLSoftwareBackend::glGetError
+#define glGetInteger64v LGLSoftwareBackend::glGetInteger64v
+#define glGetIntegerv LGLSoftwareBackend::glGetIntegerv
+#define glGetProgramiv LGLSoftwareBackend::glGetProgramiv
+#define glGetQueryObjectiv LGLSoftwareBackend::glGetQueryObjectiv
+#define glGetQueryObjectui64v LGLSoftwareBackend::glGetQueryObjectui64v
+#define glGetQueryObjectuiv LGLSoftwareBackend::glGetQueryObjectuiv
+#define glGetUniformLocation LGLSoftwareBackend::glGetUniformLocation
+#define glIsEnabled LGLSoftwareBackend::glIsEnabled
+#define glLinkProgram LGLSoftwareBackend::glLinkProgram
+#define glMapBufferRange LGLSoftwareBackend::glMapBufferRange
+#define glMultiDrawElements LGLSoftwareBackend::glMultiDrawElements
+#define glPixelStorei LGLSoftwareBackend::glPixelStorei
+#define glQueryCounter LGLSoftwareBackend::glQueryCounter
+#define glReadBuffer LGLSoftwareBackend::glReadBuffer
+#define glReadPixels LGLSoftwareBackend::glReadPixels
+#define glShaderSource LGLSoftwareBackend::glShaderSource
+#define glTexImage2D LGLSoftwareBackend::glTexImage2D
+#define glTexParameteri LGLSoftwareBackend::glTexParameteri
+#define glTransformFeedbackVaryings LGLSoftwareBackend::glTransformFeedbackVaryings
+#define glUniform1f LGLSoftwareBackend::glUniform1f
+#define glUniform1i LGLSoftwareBackend::glUniform1i
+#define glUniform2f LGLSoftwareBackend::glUniform2f
+#define glUniform3f LGLSoftwareBackend::glUniform3f
+#define glUniform4f LGLSoftwareBackend::glUniform4f
+#define glUniform4fv LGLSoftwareBackend::glUniform4fv
+#define glUniformMatrix4fv LGLSoftwareBackend::glUniformMatrix4fv
+#define glUnmapBuffer LGLSoftwareBackend::glUnmapBuffer
+#define glUseProgram LGLSoftwareBackend::glUseProgram
+#define glVertexAttribDivisor LGLSoftwareBackend::glVertexAttribDivisor
+#define glVertexAttribPointer LGLSoftwareBackend::glVertexAttribPointer
+#define glViewport LGLSoftwareBackend::glViewport
+#endif
\ No newline at end of file
@@ -0,0 +1,895 @@
+#include <emmintrin.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "LGLSoftwareRasterizer.h"
+
+LGLSoftwareRasterizer::LGLSoftwareRasterizer(size_t threadAmount)
+{
+	if (!threadAmount)
+	{
+		threadAmount = std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	threadBins.resize(threadAmount);
+
+	// Calling thread works as worker 0
+	for (size_t workerIndex = 1; workerIndex < threadAmount; ++workerIndex)
+	{
+		workers.emplace_back(&LGLSoftwareRasterizer::WorkerLoop, this, workerIndex);
+	}
+}
+
+LGLSoftwareRasterizer::~LGLSoftwareRasterizer()
+{
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		workersStop = true;
+	}
+	workerWake.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+size_t LGLSoftwareRasterizer::GetThreadAmount() const
+{
+	return threadBins.size();
+}
+
+LGLSoftwareRasterizer::Stats LGLSoftwareRasterizer::GetStats() const
+{
+	return stats;
+}
+
+void LGLSoftwareRasterizer::RunOnWorkers(const std::function<void(size_t workerIndex)>& job)
+{
+	if (workers.empty())
+	{
+		job(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		workerJob = &job;
+		workersRunning = workers.size();
+		++workerGeneration;
+	}
+	workerWake.notify_all();
+
+	job(0);
+
+	std::unique_lock<std::mutex> lock(workerMutex);
+	workerDone.wait(lock, [this]() { return !workersRunning; });
+	workerJob = nullptr;
+}
+
+void LGLSoftwareRasterizer::WorkerLoop(size_t workerIndex)
+{
+	size_t seenGeneration = 0;
+
+	while (true)
+	{
+		const std::function<void(size_t)>* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(workerMutex);
+			workerWake.wait(lock, [this, seenGeneration]() { return workersStop || workerGeneration != seenGeneration; });
+
+			if (workersStop)
+			{
+				return;
+			}
+
+			seenGeneration = workerGeneration;
+			job = workerJob;
+		}
+
+		(*job)(workerIndex);
+
+		std::lock_guard<std::mutex> lock(workerMutex);
+		if (!--workersRunning)
+		{
+			workerDone.notify_one();
+		}
+	}
+}
+
+void LGLSoftwareRasterizer::PrepareTarget(const Surface& target)
+{
+	currentTarget = target;
+	tileColumns = (target.width + tileSize - 1) / tileSize;
+	tileRows = (target.height + tileSize - 1) / tileSize;
+
+	for (auto& bins : threadBins)
+	{
+		bins.tiles.resize(static_cast<size_t>(tileColumns) * tileRows);
+	}
+}
+
+void LGLSoftwareRasterizer::Draw(const Surface& target, const std::array<int, 4>& viewport, const DrawCall& drawCall)
+{
+	// Small draws are not worth waking the workers
+	constexpr size_t parallelVertexAmount = 2048;
+	constexpr size_t parallelTriangleAmount = 1024;
+	constexpr size_t vertexChunk = 1024;
+
+	if (!(target == currentTarget))
+	{
+		Flush();
+		PrepareTarget(target);
+	}
+
+	if (!target.width || !target.height || drawCall.instances.empty() || !drawCall.position.data)
+	{
+		return;
+	}
+
+	size_t triangleAmount = 0;
+	for (auto& range : drawCall.ranges)
+	{
+		triangleAmount += range.amount / 3;
+	}
+
+	++stats.drawCalls;
+	stats.trianglesSubmitted += triangleAmount * drawCall.instances.size();
+
+	pendingDraws.push_back({
+		drawCall.shading,
+		drawCall.diffuse,
+		drawCall.specular,
+		drawCall.flatColor,
+		drawCall.lighting,
+		drawCall.depthTest,
+		drawCall.depthWrite,
+		drawCall.depthFunc,
+		drawCall.colorWrite
+	});
+
+	transformedVertices.resize(drawCall.vertexAmount);
+
+	for (size_t instance = 0; instance < drawCall.instances.size(); ++instance)
+	{
+		if (drawCall.vertexAmount < parallelVertexAmount)
+		{
+			TransformVertices(drawCall, instance, 0, drawCall.vertexAmount);
+		}
+		else
+		{
+			std::atomic<size_t> nextChunk(0);
+			RunOnWorkers([&](size_t)
+			{
+				for (size_t first; (first = nextChunk++ * vertexChunk) < drawCall.vertexAmount;)
+				{
+					TransformVertices(drawCall, instance, first, std::min(first + vertexChunk, drawCall.vertexAmount));
+				}
+			});
+		}
+
+		size_t sequenceBase = nextSequence;
+		nextSequence += triangleAmount;
+
+		if (triangleAmount < parallelTriangleAmount)
+		{
+			SetupTriangles(drawCall, viewport, 0, triangleAmount, sequenceBase, threadBins[0]);
+		}
+		else
+		{
+			// Contiguous ranges per worker, sequences restore the order when tiles merge the bins
+			size_t workerAmount = threadBins.size();
+			RunOnWorkers([&](size_t workerIndex)
+			{
+				SetupTriangles(
+					drawCall,
+					viewport,
+					triangleAmount * workerIndex / workerAmount,
+					triangleAmount * (workerIndex + 1) / workerAmount,
+					sequenceBase,
+					threadBins[workerIndex]
+				);
+			});
+		}
+	}
+}
+
+void LGLSoftwareRasterizer::TransformVertices(const DrawCall& drawCall, size_t instance, size_t first, size_t last)
+{
+	const DrawCall::Instance& transform = drawCall.instances[instance];
+
+	auto Fetch = [](const Attribute& attribute, size_t index, float defaultW)
+	{
+		glm::vec4 value(0.0f, 0.0f, 0.0f, defaultW);
+
+		if (attribute.data)
+		{
+			const float* source = reinterpret_cast<const float*>(attribute.data + attribute.stride * index);
+			for (int i = 0; i < std::min(attribute.size, 3); ++i)
+			{
+				value[i] = source[i];
+			}
+		}
+
+		return value;
+	};
+
+	for (size_t index = first; index < last; ++index)
+	{
+		TransformedVertex& vertex = transformedVertices[index];
+
+		glm::vec4 worldPos = transform.model * Fetch(drawCall.position, index, 1.0f);
+		glm::vec3 normal = transform.normalMatrix * glm::vec3(Fetch(drawCall.normal, index, 0.0f));
+		glm::vec4 texCoords = Fetch(drawCall.texCoords, index, 0.0f);
+
+		vertex.position = drawCall.viewProj * worldPos;
+		vertex.varyings[0] = worldPos.x;
+		vertex.varyings[1] = worldPos.y;
+		vertex.varyings[2] = worldPos.z;
+		vertex.varyings[3] = normal.x;
+		vertex.varyings[4] = normal.y;
+		vertex.varyings[5] = normal.z;
+		vertex.varyings[6] = texCoords.x;
+		vertex.varyings[7] = texCoords.y;
+	}
+}
+
+void LGLSoftwareRasterizer::SetupTriangles(
+	const DrawCall& drawCall,
+	const std::array<int, 4>& viewport,
+	size_t firstTriangle,
+	size_t lastTriangle,
+	size_t sequenceBase,
+	ThreadBins& bins
+)
+{
+	size_t rangeStart = 0;
+
+	for (auto& range : drawCall.ranges)
+	{
+		size_t rangeTriangles = range.amount / 3;
+		size_t begin = std::max(firstTriangle, rangeStart);
+		size_t end = std::min(lastTriangle, rangeStart + rangeTriangles);
+
+		for (size_t triangle = begin; triangle < end; ++triangle)
+		{
+			size_t local = (triangle - rangeStart) * 3;
+			size_t indices[3];
+			bool valid = true;
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				indices[corner] = range.indices ? range.indices[local + corner] : range.first + local + corner;
+				valid = valid && indices[corner] < drawCall.vertexAmount;
+			}
+
+			if (!valid)
+			{
+				continue;
+			}
+
+			ClipVertex vertices[3];
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const TransformedVertex& transformed = transformedVertices[indices[corner]];
+				vertices[corner].position = transformed.position;
+				std::copy(transformed.varyings, transformed.varyings + varyingAmount, vertices[corner].varyings);
+			}
+
+			// Trivial reject, all corners outside of one clip plane
+			int outsideAnd = 0x3F;
+			int outsideOr = 0;
+			for (auto& vertex : vertices)
+			{
+				const glm::vec4& p = vertex.position;
+				int outside =
+					(p.x < -p.w) | (p.x > p.w) << 1 | (p.y < -p.w) << 2 |
+					(p.y > p.w) << 3 | (p.z < -p.w) << 4 | (p.z > p.w) << 5;
+				outsideAnd &= outside;
+				outsideOr |= outside;
+			}
+
+			if (outsideAnd)
+			{
+				continue;
+			}
+
+			size_t sequence = (sequenceBase + triangle) * 2;
+
+			// Only near plane is clipped, other planes are handled by clamping the bounds to the viewport
+			if (!(outsideOr & 0x10))
+			{
+				SetupTriangle(vertices, viewport, drawCall.cullBackFaces, sequence, bins);
+				continue;
+			}
+
+			ClipVertex polygon[4];
+			size_t polygonSize = 0;
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const ClipVertex& current = vertices[corner];
+				const ClipVertex& next = vertices[(corner + 1) % 3];
+				float currentDistance = current.position.z + current.position.w;
+				float nextDistance = next.position.z + next.position.w;
+
+				if (currentDistance >= 0.0f)
+				{
+					polygon[polygonSize++] = current;
+				}
+
+				if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+				{
+					float t = currentDistance / (currentDistance - nextDistance);
+					ClipVertex& clipped = polygon[polygonSize++];
+
+					clipped.position = current.position + (next.position - current.position) * t;
+					for (int i = 0; i < varyingAmount; ++i)
+					{
+						clipped.varyings[i] = current.varyings[i] + (next.varyings[i] - current.varyings[i]) * t;
+					}
+				}
+			}
+
+			for (size_t fan = 1; fan + 1 < polygonSize; ++fan)
+			{
+				const ClipVertex fanVertices[3] = { polygon[0], polygon[fan], polygon[fan + 1] };
+				SetupTriangle(fanVertices, viewport, drawCall.cullBackFaces, sequence + fan - 1, bins);
+			}
+		}
+
+		rangeStart += rangeTriangles;
+	}
+}
+
+void LGLSoftwareRasterizer::SetupTriangle(
+	const ClipVertex (&vertices)[3],
+	const std::array<int, 4>& viewport,
+	bool cullBackFaces,
+	size_t sequence,
+	ThreadBins& bins
+)
+{
+	constexpr float subpixelSteps = 256.0f;
+
+	float x[3];
+	float y[3];
+	float z[3];
+	float invW[3];
+
+	for (int corner = 0; corner < 3; ++corner)
+	{
+		const glm::vec4& position = vertices[corner].position;
+
+		if (position.w <= 0.0f)
+		{
+			return;
+		}
+
+		invW[corner] = 1.0f / position.w;
+
+		// Snapped to a subpixel grid, so shared edges produce identical edge functions
+		x[corner] = std::round(((position.x * invW[corner]) * 0.5f + 0.5f) * viewport[2] * subpixelSteps) / subpixelSteps + viewport[0];
+		y[corner] = std::round(((position.y * invW[corner]) * 0.5f + 0.5f) * viewport[3] * subpixelSteps) / subpixelSteps + viewport[1];
+		z[corner] = (position.z * invW[corner]) * 0.5f + 0.5f;
+	}
+
+	double area =
+		static_cast<double>(x[1] - x[0]) * (y[2] - y[0]) -
+		static_cast<double>(x[2] - x[0]) * (y[1] - y[0]);
+
+	// Counter clockwise is front facing
+	if (area == 0.0 || (cullBackFaces && area < 0.0))
+	{
+		return;
+	}
+
+	int clipMinX = std::max(viewport[0], 0);
+	int clipMinY = std::max(viewport[1], 0);
+	int clipMaxX = std::min(viewport[0] + viewport[2], currentTarget.width) - 1;
+	int clipMaxY = std::min(viewport[1] + viewport[3], currentTarget.height) - 1;
+
+	// Pixel is covered if its center is, centers are at half coordinates
+	Triangle triangle;
+	triangle.minX = std::max(clipMinX, static_cast<int>(std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5f)));
+	triangle.minY = std::max(clipMinY, static_cast<int>(std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5f)));
+	triangle.maxX = std::min(clipMaxX, static_cast<int>(std::floor(std::max({ x[0], x[1], x[2] }) - 0.5f)));
+	triangle.maxY = std::min(clipMaxY, static_cast<int>(std::floor(std::max({ y[0], y[1], y[2] }) - 0.5f)));
+
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+	{
+		return;
+	}
+
+	float orientation = area > 0.0 ? 1.0f : -1.0f;
+
+	for (int edge = 0; edge < 3; ++edge)
+	{
+		int from = edge;
+		int to = (edge + 1) % 3;
+
+		Plane& plane = triangle.edges[edge];
+		plane.dx = (y[from] - y[to]) * orientation;
+		plane.dy = (x[to] - x[from]) * orientation;
+		plane.offset = (x[from] * y[to] - x[to] * y[from]) * orientation;
+
+		triangle.edgeInclusive[edge] = plane.dx > 0.0f || (plane.dx == 0.0f && plane.dy > 0.0f);
+	}
+
+	// Other values are relative to the first corner, so large offsets do not eat the precision
+	triangle.originX = x[0];
+	triangle.originY = y[0];
+
+	auto MakePlane = [&x, &y, area](float value0, float value1, float value2)
+	{
+		double dx = ((value1 - value0) * static_cast<double>(y[2] - y[0]) - (value2 - value0) * static_cast<double>(y[1] - y[0])) / area;
+		double dy = ((value2 - value0) * static_cast<double>(x[1] - x[0]) - (value1 - value0) * static_cast<double>(x[2] - x[0])) / area;
+
+		return Plane{ static_cast<float>(dx), static_cast<float>(dy), value0 };
+	};
+
+	triangle.depth = MakePlane(z[0], z[1], z[2]);
+	triangle.invW = MakePlane(invW[0], invW[1], invW[2]);
+
+	unsigned int drawIndex = static_cast<unsigned int>(pendingDraws.size() - 1);
+
+	if (pendingDraws[drawIndex].shading == ShadingModel::Lit)
+	{
+		for (int i = 0; i < varyingAmount; ++i)
+		{
+			triangle.varyings[i] = MakePlane(
+				vertices[0].varyings[i] * invW[0],
+				vertices[1].varyings[i] * invW[1],
+				vertices[2].varyings[i] * invW[2]
+			);
+		}
+	}
+
+	triangle.drawIndex = drawIndex;
+
+	unsigned int triangleIndex = static_cast<unsigned int>(bins.triangles.size());
+	bins.triangles.push_back(triangle);
+
+	for (int tileY = triangle.minY / tileSize; tileY <= triangle.maxY / tileSize; ++tileY)
+	{
+		for (int tileX = triangle.minX / tileSize; tileX <= triangle.maxX / tileSize; ++tileX)
+		{
+			bins.tiles[static_cast<size_t>(tileY) * tileColumns + tileX].push_back({ sequence, triangleIndex });
+		}
+	}
+}
+
+void LGLSoftwareRasterizer::Flush()
+{
+	if (pendingDraws.empty())
+	{
+		return;
+	}
+
+	size_t tileAmount = static_cast<size_t>(tileColumns) * tileRows;
+	std::atomic<size_t> nextTile(0);
+
+	RunOnWorkers([&](size_t workerIndex)
+	{
+		for (size_t tileIndex; (tileIndex = nextTile++) < tileAmount;)
+		{
+			threadBins[workerIndex].rasterized += RasterizeTile(tileIndex);
+		}
+	});
+
+	for (auto& bins : threadBins)
+	{
+		stats.trianglesBinned += bins.triangles.size();
+		stats.tileTriangles += bins.rasterized;
+
+		bins.triangles.clear();
+		bins.rasterized = 0;
+
+		for (auto& tile : bins.tiles)
+		{
+			tile.clear();
+		}
+	}
+
+	pendingDraws.clear();
+	nextSequence = 0;
+	++stats.flushes;
+}
+
+size_t LGLSoftwareRasterizer::RasterizeTile(size_t tileIndex)
+{
+	int tileMinX = static_cast<int>(tileIndex % tileColumns) * tileSize;
+	int tileMinY = static_cast<int>(tileIndex / tileColumns) * tileSize;
+	int tileMaxX = std::min(tileMinX + tileSize, currentTarget.width) - 1;
+	int tileMaxY = std::min(tileMinY + tileSize, currentTarget.height) - 1;
+
+	// Bins of every thread are sorted by sequence already, merging them restores submission order
+	struct BinHead
+	{
+		const BinEntry* current;
+		const BinEntry* end;
+		const ThreadBins* bins;
+	};
+
+	std::vector<BinHead> heads;
+	for (auto& bins : threadBins)
+	{
+		const std::vector<BinEntry>& tile = bins.tiles[tileIndex];
+		if (!tile.empty())
+		{
+			heads.push_back({ tile.data(), tile.data() + tile.size(), &bins });
+		}
+	}
+
+	const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	const __m128 laneIndices = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	size_t rasterized = 0;
+
+	while (!heads.empty())
+	{
+		size_t headIndex = 0;
+		for (size_t i = 1; i < heads.size(); ++i)
+		{
+			if (heads[i].current->sequence < heads[headIndex].current->sequence)
+			{
+				headIndex = i;
+			}
+		}
+
+		BinHead& head = heads[headIndex];
+		const Triangle& triangle = head.bins->triangles[head.current->triangle];
+
+		if (++head.current == head.end)
+		{
+			heads.erase(heads.begin() + headIndex);
+		}
+
+		const PendingDraw& draw = pendingDraws[triangle.drawIndex];
+
+		int minX = std::max(triangle.minX, tileMinX);
+		int minY = std::max(triangle.minY, tileMinY);
+		int maxX = std::min(triangle.maxX, tileMaxX);
+		int maxY = std::min(triangle.maxY, tileMaxY);
+
+		if (minX > maxX || minY > maxY)
+		{
+			continue;
+		}
+
+		++rasterized;
+
+		__m128 edgeDx[3];
+		__m128 inclusive[3];
+		for (int edge = 0; edge < 3; ++edge)
+		{
+			edgeDx[edge] = _mm_set1_ps(triangle.edges[edge].dx);
+			inclusive[edge] = _mm_castsi128_ps(_mm_set1_epi32(triangle.edgeInclusive[edge] ? -1 : 0));
+		}
+
+		const __m128 depthDx = _mm_set1_ps(triangle.depth.dx);
+		const __m128 laneMinX = _mm_set1_ps(static_cast<float>(minX));
+		const __m128 laneMaxX = _mm_set1_ps(static_cast<float>(maxX));
+
+		bool useDepth = currentTarget.depth && draw.depthTest;
+
+		for (int pixelY = minY; pixelY <= maxY; ++pixelY)
+		{
+			float centerY = pixelY + 0.5f;
+
+			// Edge values are evaluated directly instead of stepping, so neighbours get exactly negated values
+			__m128 edgeRow[3];
+			for (int edge = 0; edge < 3; ++edge)
+			{
+				edgeRow[edge] = _mm_set1_ps(triangle.edges[edge].dy * centerY + triangle.edges[edge].offset);
+			}
+
+			__m128 depthRow = _mm_set1_ps(triangle.depth.offset + triangle.depth.dy * (centerY - triangle.originY));
+
+			size_t rowOffset = static_cast<size_t>(pixelY) * currentTarget.width;
+
+			for (int blockX = minX & ~3; blockX <= maxX; blockX += 4)
+			{
+				__m128 blockIndices = _mm_add_ps(_mm_set1_ps(static_cast<float>(blockX)), laneIndices);
+				__m128 centersX = _mm_add_ps(_mm_set1_ps(static_cast<float>(blockX)), laneOffsets);
+
+				__m128 covered = _mm_and_ps(_mm_cmpge_ps(blockIndices, laneMinX), _mm_cmple_ps(blockIndices, laneMaxX));
+
+				for (int edge = 0; edge < 3; ++edge)
+				{
+					__m128 value = _mm_add_ps(_mm_mul_ps(edgeDx[edge], centersX), edgeRow[edge]);
+					__m128 inside = _mm_or_ps(_mm_cmpgt_ps(value, zero), _mm_and_ps(_mm_cmpeq_ps(value, zero), inclusive[edge]));
+					covered = _mm_and_ps(covered, inside);
+				}
+
+				int coverageMask = _mm_movemask_ps(covered);
+				if (!coverageMask)
+				{
+					continue;
+				}
+
+				__m128 depth = _mm_add_ps(depthRow, _mm_mul_ps(depthDx, _mm_sub_ps(centersX, _mm_set1_ps(triangle.originX))));
+				float* depthRowPointer = currentTarget.depth ? currentTarget.depth + rowOffset + blockX : nullptr;
+
+				if (useDepth)
+				{
+					// Last block of a row may stick out of the surface
+					__m128 stored;
+					if (blockX + 4 <= currentTarget.width)
+					{
+						stored = _mm_loadu_ps(depthRowPointer);
+					}
+					else
+					{
+						alignas(16) float partial[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+						for (int lane = 0; blockX + lane < currentTarget.width; ++lane)
+						{
+							partial[lane] = depthRowPointer[lane];
+						}
+						stored = _mm_load_ps(partial);
+					}
+
+					__m128 passed;
+					switch (draw.depthFunc)
+					{
+					case DepthFunc::Never:
+						passed = zero;
+						break;
+					case DepthFunc::Less:
+						passed = _mm_cmplt_ps(depth, stored);
+						break;
+					case DepthFunc::Equal:
+						passed = _mm_cmpeq_ps(depth, stored);
+						break;
+					case DepthFunc::LessEqual:
+						passed = _mm_cmple_ps(depth, stored);
+						break;
+					case DepthFunc::Greater:
+						passed = _mm_cmpgt_ps(depth, stored);
+						break;
+					case DepthFunc::NotEqual:
+						passed = _mm_cmpneq_ps(depth, stored);
+						break;
+					case DepthFunc::GreaterEqual:
+						passed = _mm_cmpge_ps(depth, stored);
+						break;
+					default:
+						passed = _mm_castsi128_ps(_mm_set1_epi32(-1));
+						break;
+					}
+
+					coverageMask &= _mm_movemask_ps(passed);
+					if (!coverageMask)
+					{
+						continue;
+					}
+				}
+
+				alignas(16) float depthValues[4];
+				_mm_store_ps(depthValues, depth);
+
+				for (int lane = 0; lane < 4; ++lane)
+				{
+					if (!(coverageMask & (1 << lane)))
+					{
+						continue;
+					}
+
+					int pixelX = blockX + lane;
+
+					if (draw.colorWrite && currentTarget.color)
+					{
+						ShadePixel(draw, triangle, pixelX + 0.5f, centerY, currentTarget.color + (rowOffset + pixelX) * 4);
+					}
+
+					// Depth writes are disabled along with the test in OpenGL
+					if (useDepth && draw.depthWrite)
+					{
+						depthRowPointer[lane] = std::min(std::max(depthValues[lane], 0.0f), 1.0f);
+					}
+				}
+			}
+		}
+	}
+
+	return rasterized;
+}
+
+void LGLSoftwareRasterizer::ShadePixel(const PendingDraw& draw, const Triangle& triangle, float x, float y, unsigned char* color) const
+{
+	glm::vec4 result = draw.flatColor;
+
+	if (draw.shading == ShadingModel::Lit)
+	{
+		float relativeX = x - triangle.originX;
+		float relativeY = y - triangle.originY;
+
+		auto Evaluate = [relativeX, relativeY](const Plane& plane)
+		{
+			return plane.offset + plane.dx * relativeX + plane.dy * relativeY;
+		};
+
+		float w = 1.0f / Evaluate(triangle.invW);
+
+		float varyings[varyingAmount];
+		for (int i = 0; i < varyingAmount; ++i)
+		{
+			varyings[i] = Evaluate(triangle.varyings[i]) * w;
+		}
+
+		glm::vec3 fragPos(varyings[0], varyings[1], varyings[2]);
+		glm::vec3 normal(varyings[3], varyings[4], varyings[5]);
+		float normalLength = glm::length(normal);
+		normal = normalLength > 0.0f ? normal / normalLength : normal;
+
+		glm::vec3 diffuseColor = glm::vec3(Sample(draw.diffuse, varyings[6], varyings[7]));
+		glm::vec3 specularColor = glm::vec3(Sample(draw.specular, varyings[6], varyings[7]));
+
+		static const Lighting noLighting;
+		result = glm::vec4(
+			ShadeLit(draw.lighting ? *draw.lighting : noLighting, fragPos, normal, diffuseColor, specularColor),
+			1.0f
+		);
+	}
+
+	for (int channel = 0; channel < 4; ++channel)
+	{
+		color[channel] = static_cast<unsigned char>(std::min(std::max(result[channel], 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+glm::vec4 LGLSoftwareRasterizer::Sample(const TextureView& texture, float u, float v)
+{
+	// Same as sampling an incomplete texture in OpenGL
+	if (!texture.rgba || texture.width <= 0 || texture.height <= 0)
+	{
+		return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	auto WrapCoord = [](int coord, int size, Wrap wrap)
+	{
+		switch (wrap)
+		{
+		case Wrap::Repeat:
+			coord %= size;
+			return coord < 0 ? coord + size : coord;
+		case Wrap::Mirrored:
+		{
+			int period = size * 2;
+			coord %= period;
+			coord = coord < 0 ? coord + period : coord;
+			return coord < size ? coord : period - 1 - coord;
+		}
+		default:
+			return std::min(std::max(coord, 0), size - 1);
+		}
+	};
+
+	auto Texel = [&texture, &WrapCoord](int x, int y)
+	{
+		x = WrapCoord(x, texture.width, texture.wrapS);
+		y = WrapCoord(y, texture.height, texture.wrapT);
+
+		const unsigned char* texel = texture.rgba + (static_cast<size_t>(y) * texture.width + x) * 4;
+		return glm::vec4(texel[0], texel[1], texel[2], texel[3]) * (1.0f / 255.0f);
+	};
+
+	float texelX = u * texture.width;
+	float texelY = v * texture.height;
+
+	if (!texture.linear)
+	{
+		return Texel(static_cast<int>(std::floor(texelX)), static_cast<int>(std::floor(texelY)));
+	}
+
+	texelX -= 0.5f;
+	texelY -= 0.5f;
+
+	float floorX = std::floor(texelX);
+	float floorY = std::floor(texelY);
+	float fractionX = texelX - floorX;
+	float fractionY = texelY - floorY;
+	int x = static_cast<int>(floorX);
+	int y = static_cast<int>(floorY);
+
+	glm::vec4 bottom = glm::mix(Texel(x, y), Texel(x + 1, y), fractionX);
+	glm::vec4 top = glm::mix(Texel(x, y + 1), Texel(x + 1, y + 1), fractionX);
+
+	return glm::mix(bottom, top, fractionY);
+}
+
+glm::vec3 LGLSoftwareRasterizer::ShadeLit(
+	const Lighting& lighting,
+	const glm::vec3& fragPos,
+	const glm::vec3& normal,
+	const glm::vec3& diffuseColor,
+	const glm::vec3& specularColor
+)
+{
+	// Mirrors lightComb.frag, shadows are not rendered
+	glm::vec3 viewDir = glm::normalize(lighting.viewPos - fragPos);
+	glm::vec3 result = lighting.ambient * diffuseColor;
+
+	auto Phong = [&](const glm::vec3& lightDir, const glm::vec3& diffuse, const glm::vec3& specular)
+	{
+		float diff = std::max(glm::dot(normal, lightDir), 0.0f);
+
+		glm::vec3 reflectDir = glm::reflect(-lightDir, normal);
+		float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), lighting.shininess);
+
+		return diffuse * diff * diffuseColor + specular * spec * specularColor;
+	};
+
+	for (auto& light : lighting.dirLights)
+	{
+		result += Phong(glm::normalize(light.direction), light.diffuse, light.specular);
+	}
+
+	for (auto& light : lighting.pointLights)
+	{
+		float distance = glm::length(light.position - fragPos);
+		float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+
+		result += Phong(glm::normalize(light.position - fragPos), light.diffuse, light.specular) * attenuation;
+	}
+
+	for (auto& light : lighting.spotLights)
+	{
+		glm::vec3 lightDir = glm::normalize(light.position - fragPos);
+
+		float theta = glm::dot(lightDir, glm::normalize(-light.direction));
+		float epsilon = light.cutOff - light.outerCutOff;
+		float intensity = std::min(std::max((theta - light.outerCutOff) / epsilon, 0.0f), 1.0f);
+
+		float distance = glm::length(light.position - fragPos);
+		float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+
+		result += Phong(lightDir, light.diffuse, light.specular) * intensity * attenuation;
+	}
+
+	return result;
+}
+
+void LGLSoftwareRasterizer::Clear(const Surface& target, const glm::vec4* color, const float* depth)
+{
+	Flush();
+
+	if (!target.width || !target.height)
+	{
+		return;
+	}
+
+	unsigned char clearColor[4] = {};
+	if (color)
+	{
+		for (int channel = 0; channel < 4; ++channel)
+		{
+			clearColor[channel] = static_cast<unsigned char>(std::min(std::max((*color)[channel], 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+	}
+
+	std::atomic<int> nextRow(0);
+	RunOnWorkers([&](size_t)
+	{
+		for (int row; (row = nextRow++) < target.height;)
+		{
+			size_t rowOffset = static_cast<size_t>(row) * target.width;
+
+			if (color && target.color)
+			{
+				unsigned char* pixel = target.color + rowOffset * 4;
+				for (int x = 0; x < target.width; ++x, pixel += 4)
+				{
+					std::copy(clearColor, clearColor + 4, pixel);
+				}
+			}
+
+			if (depth && target.depth)
+			{
+				std::fill(target.depth + rowOffset, target.depth + rowOffset + target.width, *depth);
+			}
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "LGLStructs.h"
+
+/*
+	Tile binned software rasterizer for LGL
+
+	Draws are processed in two stages. Vertices are transformed and triangles are
+	clipped against the near plane, set up and binned into 64x64 pixel tiles right
+	away, split between all worker threads. Tiles are rasterized on Flush, one tile
+	per worker at a time, so no two threads ever touch the same pixel.
+	Coverage and depth are evaluated for 4 pixels at once with SSE, covered pixels
+	are shaded one by one with the lightComb lighting model.
+
+	Rasterizer does not call OpenGL and does not own any pixel memory,
+	surfaces and vertex data are given by the caller. Color is RGBA8 and depth is
+	float, rows go bottom to top as in OpenGL
+*/
+class LGLSoftwareRasterizer
+{
+public:
+	enum class ShadingModel
+	{
+		Lit,  // lightComb: ambient, directional, point and spot lights, no shadows
+		Flat  // Single color, for lamps and alike
+	};
+
+	enum class DepthFunc
+	{
+		Never,
+		Less,
+		Equal,
+		LessEqual,
+		Greater,
+		NotEqual,
+		GreaterEqual,
+		Always
+	};
+
+	enum class Wrap
+	{
+		Repeat,
+		Mirrored,
+		Clamp
+	};
+
+	struct Surface
+	{
+		unsigned char* color = nullptr; // Optional
+		float* depth = nullptr;         // Optional
+		int width = 0;
+		int height = 0;
+
+		bool operator==(const Surface& surface) const
+		{
+			return color == surface.color && depth == surface.depth && width == surface.width && height == surface.height;
+		}
+	};
+
+	// RGBA8, has to stay valid until the next Flush
+	struct TextureView
+	{
+		const unsigned char* rgba = nullptr;
+		int width = 0;
+		int height = 0;
+		Wrap wrapS = Wrap::Repeat;
+		Wrap wrapT = Wrap::Repeat;
+		bool linear = true;
+	};
+
+	// Float vertex attribute, only has to stay valid during Draw
+	struct Attribute
+	{
+		const unsigned char* data = nullptr;
+		size_t stride = 0;
+		int size = 0;
+	};
+
+	struct Lighting
+	{
+		struct DirLight
+		{
+			glm::vec3 direction;
+			glm::vec3 diffuse;
+			glm::vec3 specular;
+		};
+
+		struct PointLight
+		{
+			glm::vec3 position;
+			glm::vec3 diffuse;
+			glm::vec3 specular;
+			float constant;
+			float linear;
+			float quadratic;
+		};
+
+		struct SpotLight
+		{
+			glm::vec3 position;
+			glm::vec3 direction;
+			float cutOff;
+			float outerCutOff;
+			glm::vec3 diffuse;
+			glm::vec3 specular;
+			float constant;
+			float linear;
+			float quadratic;
+		};
+
+		glm::vec3 viewPos = glm::vec3(0.0f);
+		glm::vec3 ambient = glm::vec3(0.0f);
+		float shininess = 32.0f;
+		std::vector<DirLight> dirLights;
+		std::vector<PointLight> pointLights;
+		std::vector<SpotLight> spotLights;
+	};
+
+	struct DrawCall
+	{
+		struct IndexRange
+		{
+			const unsigned int* indices; // Triangle list, if null vertices are taken in order from first
+			size_t first;
+			size_t amount;
+		};
+
+		struct Instance
+		{
+			glm::mat4 model;
+			glm::mat3 normalMatrix;
+		};
+
+		ShadingModel shading = ShadingModel::Lit;
+		Attribute position;
+		Attribute normal;
+		Attribute texCoords;
+		size_t vertexAmount = 0; // Vertices available in attributes, indices past it are skipped
+		std::vector<IndexRange> ranges;
+		std::vector<Instance> instances;
+		glm::mat4 viewProj = glm::mat4(1.0f);
+
+		TextureView diffuse;
+		TextureView specular;
+		glm::vec4 flatColor = glm::vec4(1.0f);
+		std::shared_ptr<const Lighting> lighting;
+
+		bool depthTest = true;
+		bool depthWrite = true;
+		DepthFunc depthFunc = DepthFunc::Less;
+		bool cullBackFaces = false;
+		bool colorWrite = true;
+	};
+
+	struct Stats
+	{
+		size_t drawCalls = 0;
+		size_t trianglesSubmitted = 0;
+		size_t trianglesBinned = 0;  // After clipping and culling
+		size_t tileTriangles = 0;    // Sum of triangles over all tiles they were rasterized in
+		size_t flushes = 0;
+	};
+
+	// With threadAmount of 0 all hardware threads are used
+	explicit LGLSoftwareRasterizer(size_t threadAmount = 0);
+	~LGLSoftwareRasterizer();
+	LGLSoftwareRasterizer(const LGLSoftwareRasterizer&) = delete;
+	LGLSoftwareRasterizer& operator=(const LGLSoftwareRasterizer&) = delete;
+
+	// Viewport is x, y, width and height, draws into another surface flush the previous one
+	void Draw(const Surface& target, const std::array<int, 4>& viewport, const DrawCall& drawCall);
+	// Flushes pending draws first, null values are not cleared
+	void Clear(const Surface& target, const glm::vec4* color, const float* depth);
+	// Rasterizes all pending draws, surface memory can be read after it
+	void Flush();
+
+	size_t GetThreadAmount() const;
+	Stats GetStats() const;
+
+private:
+	constexpr static int tileSize = 64;
+	constexpr static int varyingAmount = 8; // World position, normal, texture coordinates
+
+	struct ClipVertex
+	{
+		glm::vec4 position;
+		float varyings[varyingAmount];
+	};
+
+	// Values are interpolated as plane equations value = x * dx + y * dy + offset
+	struct Plane
+	{
+		float dx;
+		float dy;
+		float offset;
+	};
+
+	struct Triangle
+	{
+		Plane edges[3];         // Positive inside, in pixel coordinates
+		bool edgeInclusive[3];  // Pixels exactly on an edge belong to one triangle only
+		float originX;          // Other planes are relative to the first corner
+		float originY;
+		Plane depth;
+		Plane invW;
+		Plane varyings[varyingAmount]; // Divided by w, for perspective correct interpolation
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		unsigned int drawIndex;
+	};
+
+	// Sequence keeps submission order when bins of several threads are merged
+	struct BinEntry
+	{
+		size_t sequence;
+		unsigned int triangle;
+	};
+
+	struct PendingDraw
+	{
+		ShadingModel shading;
+		TextureView diffuse;
+		TextureView specular;
+		glm::vec4 flatColor;
+		std::shared_ptr<const Lighting> lighting;
+		bool depthTest;
+		bool depthWrite;
+		DepthFunc depthFunc;
+		bool colorWrite;
+	};
+
+	struct ThreadBins
+	{
+		std::vector<Triangle> triangles;
+		std::vector<std::vector<BinEntry>> tiles;
+		size_t rasterized = 0;
+	};
+
+	struct TransformedVertex
+	{
+		glm::vec4 position;
+		float varyings[varyingAmount];
+	};
+
+	// Runs job on every worker and the calling thread, worker index 0 is the caller
+	void RunOnWorkers(const std::function<void(size_t workerIndex)>& job);
+	void WorkerLoop(size_t workerIndex);
+
+	void PrepareTarget(const Surface& target);
+	void TransformVertices(const DrawCall& drawCall, size_t instance, size_t first, size_t last);
+	void SetupTriangles(
+		const DrawCall& drawCall,
+		const std::array<int, 4>& viewport,
+		size_t firstTriangle,
+		size_t lastTriangle,
+		size_t sequenceBase,
+		ThreadBins& bins
+	);
+	void SetupTriangle(const ClipVertex (&vertices)[3], const std::array<int, 4>& viewport, bool cullBackFaces, size_t sequence, ThreadBins& bins);
+	// Returns amount of triangles rasterized in the tile
+	size_t RasterizeTile(size_t tileIndex);
+	void ShadePixel(const PendingDraw& draw, const Triangle& triangle, float x, float y, unsigned char* color) const;
+
+	static glm::vec4 Sample(const TextureView& texture, float u, float v);
+	static glm::vec3 ShadeLit(const Lighting& lighting, const glm::vec3& fragPos, const glm::vec3& normal, const glm::vec3& diffuseColor, const glm::vec3& specularColor);
+
+	std::vector<std::thread> workers;
+	std::mutex workerMutex;
+	std::condition_variable workerWake;
+	std::condition_variable workerDone;
+	const std::function<void(size_t)>* workerJob = nullptr;
+	size_t workerGeneration = 0;
+	size_t workersRunning = 0;
+	bool workersStop = false;
+
+	Surface currentTarget;
+	int tileColumns = 0;
+	int tileRows = 0;
+
+	std::vector<ThreadBins> threadBins;
+	std::vector<PendingDraw> pendingDraws;
+	std::vector<TransformedVertex> transformedVertices;
+	size_t nextSequence = 0;
+
+	Stats stats;
+};
\ No newline at end of file
@@ -113,11 +113,60 @@ namespace LGLStructs
 		}
 	};
 
+	// Cluster of triangles, a range of Mesh::indices with bounds used for culling
+	struct Meshlet
+	{
+		unsigned int indexOffset;
+		unsigned int indexAmount;
+		glm::vec4 boundingSphere; // Center and radius, in model space
+		glm::vec4 cone;           // Average face normal and cutoff, cutoff of 1 never culls
+	};
+
+	// Coarser version of a mesh, indexes the same vertices as the mesh
+	struct MeshLOD
+	{
+		std::vector<unsigned int> indices;
+		float error = 0.0f; // Largest distance the surface moved by, in model space
+	};
+
+	// Import time LOD generation, each level is simplified from the previous one until it has
+	// triangleRatio of the base mesh triangles, or until the surface would move by more than
+	// maxError, relative to the mesh bounding radius
+	struct LODLevel
+	{
+		float triangleRatio;
+		float maxError;
+	};
+
+	// Mesh data kept in system memory once the mesh is uploaded, the GPU copy is authoritative.
+	// Meshes that do not keep their vertices can not be evicted, they could not be uploaded again
+	enum class MeshRetention
+	{
+		Keep,
+		Drop // Only bounds, textures and opacity are kept
+	};
+
+	// What RenderInstances culls against the culling view
+	enum class InstanceCulling
+	{
+		None,
+		Meshlets, // For instances the caller culled already, meshes with meshlets are culled per meshlet
+		All       // Whole instances are culled on GPU by bounding sphere as well
+	};
+
 	struct Mesh
 	{
 		std::vector<Vertex> vert;
 		std::vector<unsigned int> indices;
 		std::vector<Texture> textures;
+		float opacity = 1.0f;
+		std::vector<Meshlet> meshlets; // Optional, meshlets cover all indices in order
+		std::vector<MeshLOD> lods;     // Optional, from finer to coarser, meshlets are of the base indices only
+
+		// Model space bounds, radius of 0 means they were not computed at import
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+		glm::vec4 boundingSphere = glm::vec4(0.0f); // Center and radius
 	};
 
 	struct MeshInfo
@@ -127,9 +176,21 @@ namespace LGLStructs
 		stdEx::ValWithBackup<bool> render;
 		stdEx::ValWithBackup<std::string> shaderProgram;
 		stdEx::ValWithBackup<std::function<void()>> behaviour;
+		stdEx::ValWithBackup<MeshRetention> retention;
+		// Transparent meshes are drawn in order independent transparency pass, with shaderProgram
+		// compiled with OIT defined if it checks the define
+		bool isTransparent;
 
-		MeshInfo(const Mesh& mesh, bool& render, bool& isDynamic, std::string& shaderProgram, std::function<void()>& behaviour)
-			: mesh(mesh), render(&render), isDynamic(&isDynamic), shaderProgram(&shaderProgram), behaviour(&behaviour) {}
+		MeshInfo(
+			const Mesh& mesh, 
+			bool& render, 
+			bool& isDynamic, 
+			std::string& shaderProgram, 
+			std::function<void()>& behaviour, 
+			MeshRetention& retention
+		)
+			: mesh(mesh), render(&render), isDynamic(&isDynamic), shaderProgram(&shaderProgram), behaviour(&behaviour),
+			retention(&retention), isTransparent(mesh.opacity < 1.0f) {}
 	
 	};
 	
@@ -140,10 +201,11 @@ namespace LGLStructs
 		bool isDynamic = false;
 		std::string shaderProgram = "0";
 		std::function<void()> behaviour = nullptr;
+		MeshRetention retention = MeshRetention::Keep;
 
 		void AddMesh(const Mesh& mesh)
 		{
-			meshes.emplace_back(MeshInfo(mesh, render, isDynamic, shaderProgram, behaviour));
+			meshes.emplace_back(MeshInfo(mesh, render, isDynamic, shaderProgram, behaviour, retention));
 		}
 
 		void ResetDefaults()
@@ -154,6 +216,7 @@ namespace LGLStructs
 				mesh.isDynamic.ResetBackup(&isDynamic);
 				mesh.shaderProgram.ResetBackup(&shaderProgram);
 				mesh.behaviour.ResetBackup(&behaviour);
+				mesh.retention.ResetBackup(&retention);
 			}
 		}
 
@@ -164,6 +227,7 @@ namespace LGLStructs
 			isDynamic = modelInfo.isDynamic;
 			shaderProgram = modelInfo.shaderProgram;
 			behaviour = modelInfo.behaviour;
+			retention = modelInfo.retention;
 
 			ResetDefaults();
 
@@ -171,4 +235,89 @@ namespace LGLStructs
 		}
 	};
 
+	struct DynamicResolutionConfig
+	{
+		enum class UpscaleMode
+		{
+			Bilinear, // Plain glBlitFramebuffer with linear filtering
+			Sharpen   // Full screen pass with upscaleSharpen shader program
+		};
+
+		bool enabled = false;
+		float targetFrameTimeMs = 16.6f;
+		float minScale = 0.5f;
+		float maxScale = 1.0f;
+		float sharpness = 0.25f;
+		UpscaleMode upscaleMode = UpscaleMode::Bilinear;
+	};
+
+	struct RenderResourceDesc
+	{
+		enum class ResourceType
+		{
+			Texture,
+			Buffer
+		};
+
+		enum class TextureFormat
+		{
+			RGBA8,
+			RGBA16F,
+			R16F,
+			R8,
+			Depth24,
+			Depth32F,
+			_SIZE
+		};
+
+		ResourceType type = ResourceType::Texture;
+		TextureFormat format = TextureFormat::RGBA8;
+		// If width or height is 0, size is taken from the output multiplied by outputScale
+		int width = 0;
+		int height = 0;
+		float outputScale = 1.0f;
+		size_t bufferSize = 0;
+
+		bool operator==(const RenderResourceDesc& desc) const
+		{
+			return type == desc.type && format == desc.format && width == desc.width && 
+				height == desc.height && outputScale == desc.outputScale && bufferSize == desc.bufferSize;
+		}
+	};
+
+	// Estimated from dimensions and formats, totals are of currently resident objects
+	struct MemoryStats
+	{
+		size_t vertexBytes = 0;       // Mesh, instance and debug draw vertex buffers
+		size_t indexBytes = 0;
+		size_t textureBytes = 0;      // Mesh textures, with mipmaps
+		size_t renderTargetBytes = 0; // Scene, shadow map and render graph resources
+		size_t stagingBytes = 0;      // Capture readback buffers
+		size_t totalBytes = 0;
+		size_t budgetBytes = 0;       // 0 if there is no budget
+		size_t evictions = 0;         // Total, meshes and textures released over budget
+		size_t reuploads = 0;         // Total, evicted meshes and textures uploaded again
+	};
+
+	struct RenderStats
+	{
+		float resolutionScale = 1.0f;
+		float gpuFrameTimeMs = 0.0f; // Measured with GL_TIME_ELAPSED, a few frames late
+		float cpuFrameTimeMs = 0.0f;
+		int renderWidth = 0;
+		int renderHeight = 0;
+		int outputWidth = 0;
+		int outputHeight = 0;
+		size_t frameCount = 0;
+		size_t staticShadowUpdates = 0;  // Total amount of static depth re-renders, per shadow map face
+		size_t dynamicShadowUpdates = 0; // Total amount of dynamic overlays, per shadow map face
+		size_t instancesSubmitted = 0;   // Per frame, through RenderInstances
+		size_t instancesVisible = 0;     // Per frame, after GPU culling
+		size_t meshletsSubmitted = 0;    // Per frame, of meshes drawn with meshlet culling
+		size_t meshletsVisible = 0;
+		size_t instanceTriangles = 0;    // Per frame, drawn through RenderInstances after culling and LOD selection
+		size_t capturedFrames = 0;       // Total, handed to capture callbacks
+		size_t droppedCaptures = 0;      // Total, frames skipped as no capture slot was free
+	};
+
 }
\ No newline at end of file
@@ -0,0 +1,877 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "LGLCommandStream.h"
+
+/*
+	Replays GL command captures written by LGL::StartCommandCapture
+
+	Usage: LGLReplay <capture> [--paced] [--finish] [--checksum]
+	 --paced     waits between frames as long as the recorded frames took
+	 --finish    waits for the GPU (glFinish) before a frame is timed
+	 --checksum  prints a hash of the last frame, to compare replays on different machines
+
+	Calls are issued as they were recorded, object names, uniform locations and syncs
+	the driver returns are mapped from the recorded ones. Frame times and time spent
+	in every function are printed, so GL cost of a scene is measured without the engine
+*/
+
+using namespace LGLCommandStream;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Options
+	{
+		std::string path;
+		bool paced = false;
+		bool finish = false;
+		bool checksum = false;
+	};
+
+	struct Value
+	{
+		ArgumentType type = ArgumentType::Integer;
+		int64_t integer = 0;
+		double real = 0.0;
+		uint64_t offset = 0;
+		const char* data = nullptr;
+		uint32_t size = 0;
+
+		std::vector<char> output;
+		std::vector<const GLchar*> strings;
+		std::vector<const void*> offsets;
+		std::vector<GLuint> names; // Data of glDelete* with replayed names
+	};
+
+	class Reader
+	{
+	public:
+		Reader(const std::vector<char>& content) : content(content) {}
+
+		template<typename Type>
+		Type Read()
+		{
+			Type value{};
+
+			if (const char* bytes = ReadBytes(sizeof(Type)))
+			{
+				std::memcpy(&value, bytes, sizeof(Type));
+			}
+
+			return value;
+		}
+
+		const char* ReadBytes(size_t size)
+		{
+			if (failed || content.size() - position < size)
+			{
+				failed = true;
+				return nullptr;
+			}
+
+			const char* bytes = content.data() + position;
+			position += size;
+
+			return bytes;
+		}
+
+		bool IsEnd() const
+		{
+			return position == content.size();
+		}
+
+		bool IsFailed() const
+		{
+			return failed;
+		}
+
+	private:
+		const std::vector<char>& content;
+		size_t position = 0;
+		bool failed = false;
+	};
+
+	// Argument conversion to parameter types of GL functions
+
+	template<typename Type>
+	typename std::enable_if<std::is_arithmetic<Type>::value, Type>::type Convert(Value& value)
+	{
+		return value.type == ArgumentType::Float ? static_cast<Type>(value.real) : static_cast<Type>(value.integer);
+	}
+
+	// glGetUniformLocation takes one string, glShaderSource an array of them
+	template<typename Type>
+	Type ConvertStrings(Value& value, std::true_type)
+	{
+		return value.strings.empty() ? nullptr : value.strings[0];
+	}
+
+	template<typename Type>
+	Type ConvertStrings(Value& value, std::false_type)
+	{
+		return reinterpret_cast<Type>(value.strings.data());
+	}
+
+	template<typename Type>
+	typename std::enable_if<std::is_pointer<Type>::value, Type>::type Convert(Value& value)
+	{
+		using Pointee = typename std::remove_cv<typename std::remove_pointer<Type>::type>::type;
+
+		switch (value.type)
+		{
+		case ArgumentType::Integer:
+			return reinterpret_cast<Type>(static_cast<intptr_t>(value.integer));
+		case ArgumentType::Offset:
+			return reinterpret_cast<Type>(static_cast<uintptr_t>(value.offset));
+		case ArgumentType::Data:
+			return value.names.empty() ? reinterpret_cast<Type>(const_cast<char*>(value.data)) : reinterpret_cast<Type>(value.names.data());
+		case ArgumentType::Output:
+			return reinterpret_cast<Type>(value.output.data());
+		case ArgumentType::Strings:
+			return ConvertStrings<Type>(value, std::is_same<Pointee, GLchar>());
+		case ArgumentType::Offsets:
+			return reinterpret_cast<Type>(value.offsets.data());
+		default:
+			return nullptr;
+		}
+	}
+
+	template<typename Type>
+	int64_t ToInteger(Type value, std::true_type)
+	{
+		return static_cast<int64_t>(reinterpret_cast<intptr_t>(value));
+	}
+
+	template<typename Type>
+	int64_t ToInteger(Type value, std::false_type)
+	{
+		return static_cast<int64_t>(value);
+	}
+
+	template<typename Result, typename... Params, size_t... Indices>
+	int64_t Invoke(Result(APIENTRYP function)(Params...), std::vector<Value>& values, std::index_sequence<Indices...>, std::true_type)
+	{
+		(void)values;
+		function(Convert<Params>(values[Indices])...);
+		return 0;
+	}
+
+	template<typename Result, typename... Params, size_t... Indices>
+	int64_t Invoke(Result(APIENTRYP function)(Params...), std::vector<Value>& values, std::index_sequence<Indices...>, std::false_type)
+	{
+		(void)values;
+		return ToInteger(function(Convert<Params>(values[Indices])...), std::is_pointer<Result>());
+	}
+
+	struct Handler
+	{
+		std::function<int64_t(std::vector<Value>&)> call;
+		size_t argumentAmount;
+	};
+
+	template<typename Result, typename... Params>
+	Handler Bind(Result(APIENTRYP function)(Params...))
+	{
+		return
+		{
+			[function](std::vector<Value>& values)
+			{
+				return Invoke(function, values, std::index_sequence_for<Params...>(), std::is_void<Result>());
+			},
+			sizeof...(Params)
+		};
+	}
+
+#define REPLAY_FUNCTION(glFunc) { #glFunc, Bind(glFunc) }
+
+	// Has to be created after glad is loaded, its functions are pointers
+	std::unordered_map<std::string, Handler> CreateHandlers()
+	{
+		return
+		{
+			REPLAY_FUNCTION(glActiveTexture),
+			REPLAY_FUNCTION(glAttachShader),
+			REPLAY_FUNCTION(glBeginQuery),
+			REPLAY_FUNCTION(glBeginTransformFeedback),
+			REPLAY_FUNCTION(glBindBuffer),
+			REPLAY_FUNCTION(glBindBufferBase),
+			REPLAY_FUNCTION(glBindBufferRange),
+			REPLAY_FUNCTION(glBindFramebuffer),
+			REPLAY_FUNCTION(glBindTexture),
+			REPLAY_FUNCTION(glBindVertexArray),
+			REPLAY_FUNCTION(glBlendFunc),
+			REPLAY_FUNCTION(glBlendFuncSeparate),
+			REPLAY_FUNCTION(glBlitFramebuffer),
+			REPLAY_FUNCTION(glBufferData),
+			REPLAY_FUNCTION(glBufferSubData),
+			REPLAY_FUNCTION(glClear),
+			REPLAY_FUNCTION(glClearBufferfv),
+			REPLAY_FUNCTION(glClearColor),
+			REPLAY_FUNCTION(glClientWaitSync),
+			REPLAY_FUNCTION(glCompileShader),
+			REPLAY_FUNCTION(glCreateProgram),
+			REPLAY_FUNCTION(glCreateShader),
+			REPLAY_FUNCTION(glDeleteBuffers),
+			REPLAY_FUNCTION(glDeleteFramebuffers),
+			REPLAY_FUNCTION(glDeleteProgram),
+			REPLAY_FUNCTION(glDeleteQueries),
+			REPLAY_FUNCTION(glDeleteShader),
+			REPLAY_FUNCTION(glDeleteSync),
+			REPLAY_FUNCTION(glDeleteTextures),
+			REPLAY_FUNCTION(glDeleteVertexArrays),
+			REPLAY_FUNCTION(glDepthFunc),
+			REPLAY_FUNCTION(glDepthMask),
+			REPLAY_FUNCTION(glDisable),
+			REPLAY_FUNCTION(glDrawArrays),
+			REPLAY_FUNCTION(glDrawArraysInstanced),
+			REPLAY_FUNCTION(glDrawBuffer),
+			REPLAY_FUNCTION(glDrawBuffers),
+			REPLAY_FUNCTION(glDrawElements),
+			REPLAY_FUNCTION(glDrawElementsInstanced),
+			REPLAY_FUNCTION(glEnable),
+			REPLAY_FUNCTION(glEnableVertexAttribArray),
+			REPLAY_FUNCTION(glEndQuery),
+			REPLAY_FUNCTION(glEndTransformFeedback),
+			REPLAY_FUNCTION(glFenceSync),
+			REPLAY_FUNCTION(glFramebufferTexture2D),
+			REPLAY_FUNCTION(glGenBuffers),
+			REPLAY_FUNCTION(glGenFramebuffers),
+			REPLAY_FUNCTION(glGenQueries),
+			REPLAY_FUNCTION(glGenTextures),
+			REPLAY_FUNCTION(glGenVertexArrays),
+			REPLAY_FUNCTION(glGenerateMipmap),
+			REPLAY_FUNCTION(glGetInteger64v),
+			REPLAY_FUNCTION(glGetIntegerv),
+			REPLAY_FUNCTION(glGetProgramiv),
+			REPLAY_FUNCTION(glGetQueryObjectiv),
+			REPLAY_FUNCTION(glGetQueryObjectui64v),
+			REPLAY_FUNCTION(glGetQueryObjectuiv),
+			REPLAY_FUNCTION(glGetUniformLocation),
+			REPLAY_FUNCTION(glLinkProgram),
+			REPLAY_FUNCTION(glMapBufferRange),
+			REPLAY_FUNCTION(glMultiDrawElements),
+			REPLAY_FUNCTION(glPixelStorei),
+			REPLAY_FUNCTION(glQueryCounter),
+			REPLAY_FUNCTION(glReadBuffer),
+			REPLAY_FUNCTION(glReadPixels),
+			REPLAY_FUNCTION(glShaderSource),
+			REPLAY_FUNCTION(glTexImage2D),
+			REPLAY_FUNCTION(glTexParameterfv),
+			REPLAY_FUNCTION(glTexParameteri),
+			REPLAY_FUNCTION(glTransformFeedbackVaryings),
+			REPLAY_FUNCTION(glUniform1f),
+			REPLAY_FUNCTION(glUniform1i),
+			REPLAY_FUNCTION(glUniform2f),
+			REPLAY_FUNCTION(glUniform3f),
+			REPLAY_FUNCTION(glUniform4f),
+			REPLAY_FUNCTION(glUniform4fv),
+			REPLAY_FUNCTION(glUniformMatrix4fv),
+			REPLAY_FUNCTION(glUnmapBuffer),
+			REPLAY_FUNCTION(glUseProgram),
+			REPLAY_FUNCTION(glVertexAttribDivisor),
+			REPLAY_FUNCTION(glVertexAttribPointer),
+			REPLAY_FUNCTION(glViewport)
+		};
+	}
+
+#undef REPLAY_FUNCTION
+
+	// Name remapping
+
+	enum class NameType
+	{
+		Buffer,
+		Texture,
+		VertexArray,
+		Framebuffer,
+		Query,
+		Program, // Shaders and programs share names
+		Sync,
+		Amount
+	};
+
+	// Arguments that are names of objects
+	const std::unordered_map<std::string, std::vector<std::pair<size_t, NameType>>> nameArguments
+	{
+		{ "glBindBuffer", { { 1, NameType::Buffer } } },
+		{ "glBindBufferBase", { { 2, NameType::Buffer } } },
+		{ "glBindBufferRange", { { 2, NameType::Buffer } } },
+		{ "glBindTexture", { { 1, NameType::Texture } } },
+		{ "glFramebufferTexture2D", { { 3, NameType::Texture } } },
+		{ "glBindVertexArray", { { 0, NameType::VertexArray } } },
+		{ "glBindFramebuffer", { { 1, NameType::Framebuffer } } },
+		{ "glBeginQuery", { { 1, NameType::Query } } },
+		{ "glQueryCounter", { { 0, NameType::Query } } },
+		{ "glGetQueryObjectiv", { { 0, NameType::Query } } },
+		{ "glGetQueryObjectuiv", { { 0, NameType::Query } } },
+		{ "glGetQueryObjectui64v", { { 0, NameType::Query } } },
+		{ "glUseProgram", { { 0, NameType::Program } } },
+		{ "glAttachShader", { { 0, NameType::Program }, { 1, NameType::Program } } },
+		{ "glShaderSource", { { 0, NameType::Program } } },
+		{ "glCompileShader", { { 0, NameType::Program } } },
+		{ "glLinkProgram", { { 0, NameType::Program } } },
+		{ "glDeleteShader", { { 0, NameType::Program } } },
+		{ "glDeleteProgram", { { 0, NameType::Program } } },
+		{ "glGetProgramiv", { { 0, NameType::Program } } },
+		{ "glTransformFeedbackVaryings", { { 0, NameType::Program } } },
+		{ "glGetUniformLocation", { { 0, NameType::Program } } },
+		{ "glClientWaitSync", { { 0, NameType::Sync } } },
+		{ "glDeleteSync", { { 0, NameType::Sync } } }
+	};
+
+	// Functions that write names into their second argument
+	const std::unordered_map<std::string, NameType> nameGenerators
+	{
+		{ "glGenBuffers", NameType::Buffer },
+		{ "glGenTextures", NameType::Texture },
+		{ "glGenVertexArrays", NameType::VertexArray },
+		{ "glGenFramebuffers", NameType::Framebuffer },
+		{ "glGenQueries", NameType::Query }
+	};
+
+	// Functions that read names from their second argument
+	const std::unordered_map<std::string, NameType> nameDeleters
+	{
+		{ "glDeleteBuffers", NameType::Buffer },
+		{ "glDeleteTextures", NameType::Texture },
+		{ "glDeleteVertexArrays", NameType::VertexArray },
+		{ "glDeleteFramebuffers", NameType::Framebuffer },
+		{ "glDeleteQueries", NameType::Query }
+	};
+
+	// Functions that return a name
+	const std::unordered_map<std::string, NameType> nameResults
+	{
+		{ "glCreateShader", NameType::Program },
+		{ "glCreateProgram", NameType::Program },
+		{ "glFenceSync", NameType::Sync }
+	};
+
+	uint64_t HashBytes(const unsigned char* data, size_t size)
+	{
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ data[i]) * 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	class Replayer
+	{
+	public:
+		Replayer(const Options& options) : options(options) {}
+
+		bool Load()
+		{
+			std::ifstream file(options.path, std::ios::binary);
+			if (!file)
+			{
+				std::cout << "[ERROR] Failed to open " << options.path << '\n';
+				return false;
+			}
+
+			content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+			Reader reader(content);
+			Header header = reader.Read<Header>();
+
+			if (reader.IsFailed() || std::memcmp(header.magic, magic, sizeof(magic)))
+			{
+				std::cout << "[ERROR] " << options.path << " is not a GL command capture\n";
+				return false;
+			}
+			if (header.version != version)
+			{
+				std::cout << "[ERROR] Capture version " << header.version << " is not supported, expected " << version << '\n';
+				return false;
+			}
+
+			// Capture that was not stopped has no size
+			width = header.width > 0 ? header.width : 800;
+			height = header.height > 0 ? header.height : 600;
+
+			std::cout << "Capture " << options.path << " loaded, " << content.size() << " byte(s), " << width << 'x' << height << '\n';
+
+			return true;
+		}
+
+		bool Run()
+		{
+			if (!glfwInit())
+			{
+				std::cout << "[ERROR] Failed to init GLFW\n";
+				return false;
+			}
+
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+			glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+			window = glfwCreateWindow(width, height, "LGLReplay", nullptr, nullptr);
+			if (!window)
+			{
+				std::cout << "[ERROR] Failed to create GLFW window\n";
+				glfwTerminate();
+				return false;
+			}
+
+			glfwMakeContextCurrent(window);
+			// Frames are timed, not synchronized with the display
+			glfwSwapInterval(0);
+
+			if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+			{
+				std::cout << "[ERROR] Failed to init GLAD\n";
+				glfwTerminate();
+				return false;
+			}
+
+			handlers = CreateHandlers();
+
+			bool replayed = Replay();
+
+			PrintSummary();
+
+			glfwTerminate();
+
+			return replayed;
+		}
+
+	private:
+		struct FunctionStats
+		{
+			std::string name;
+			size_t callAmount = 0;
+			Clock::duration time = Clock::duration::zero();
+		};
+
+		struct FrameStats
+		{
+			double recordedMs;
+			double replayedMs;
+			double callMs;
+			size_t callAmount;
+		};
+
+		bool Replay()
+		{
+			Reader reader(content);
+			reader.Read<Header>();
+
+			std::vector<Value> arguments;
+			size_t frameCallAmount = 0;
+			Clock::duration frameCallTime = Clock::duration::zero();
+			Clock::time_point frameStart = Clock::now();
+
+			while (!reader.IsEnd() && !glfwWindowShouldClose(window))
+			{
+				RecordType recordType = reader.Read<RecordType>();
+
+				if (recordType == RecordType::Function)
+				{
+					uint16_t id = reader.Read<uint16_t>();
+					uint16_t nameSize = reader.Read<uint16_t>();
+					const char* name = reader.ReadBytes(nameSize);
+
+					if (name)
+					{
+						functions.resize(std::max<size_t>(functions.size(), id + 1));
+						functions[id].name.assign(name, nameSize);
+					}
+				}
+				else if (recordType == RecordType::Call)
+				{
+					uint16_t id = reader.Read<uint16_t>();
+					uint8_t argumentAmount = reader.Read<uint8_t>();
+
+					arguments.resize(argumentAmount);
+					for (Value& argument : arguments)
+					{
+						ReadValue(reader, argument);
+					}
+
+					int64_t result = reader.Read<int64_t>();
+
+					if (reader.IsFailed())
+					{
+						break;
+					}
+					if (id >= functions.size() || functions[id].name.empty())
+					{
+						std::cout << "[ERROR] Call of undeclared function " << id << ", capture is damaged\n";
+						return false;
+					}
+
+					Clock::duration time = Call(functions[id], arguments, result);
+
+					functions[id].time += time;
+					++functions[id].callAmount;
+					frameCallTime += time;
+					++frameCallAmount;
+				}
+				else if (recordType == RecordType::FrameEnd)
+				{
+					uint64_t recordedNs = reader.Read<uint64_t>();
+
+					if (reader.IsFailed())
+					{
+						break;
+					}
+
+					if (options.finish)
+					{
+						glFinish();
+					}
+
+					if (options.checksum && reader.IsEnd())
+					{
+						PrintChecksum();
+					}
+
+					if (options.paced)
+					{
+						std::this_thread::sleep_until(frameStart + std::chrono::nanoseconds(recordedNs));
+					}
+
+					glfwSwapBuffers(window);
+					glfwPollEvents();
+
+					Clock::time_point frameEnd = Clock::now();
+
+					FrameStats frame;
+					frame.recordedMs = recordedNs / 1e6;
+					frame.replayedMs = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+					frame.callMs = std::chrono::duration<double, std::milli>(frameCallTime).count();
+					frame.callAmount = frameCallAmount;
+					frames.push_back(frame);
+
+					std::cout << "Frame " << frames.size() << ": recorded " << frame.recordedMs << " ms, replayed " << frame.replayedMs
+						<< " ms, " << frame.callAmount << " call(s) took " << frame.callMs << " ms\n";
+
+					frameStart = frameEnd;
+					frameCallTime = Clock::duration::zero();
+					frameCallAmount = 0;
+				}
+				else
+				{
+					std::cout << "[ERROR] Unknown record type " << static_cast<int>(recordType) << ", capture is damaged\n";
+					return false;
+				}
+			}
+
+			if (reader.IsFailed())
+			{
+				std::cout << "[WARNING] Capture is truncated, replay stopped after " << frames.size() << " frame(s)\n";
+			}
+
+			return true;
+		}
+
+		void ReadValue(Reader& reader, Value& value)
+		{
+			value.type = reader.Read<ArgumentType>();
+			value.names.clear();
+
+			switch (value.type)
+			{
+			case ArgumentType::Integer:
+				value.integer = reader.Read<int64_t>();
+				break;
+			case ArgumentType::Float:
+				value.real = reader.Read<double>();
+				break;
+			case ArgumentType::Offset:
+				value.offset = reader.Read<uint64_t>();
+				break;
+			case ArgumentType::Data:
+				value.size = reader.Read<uint32_t>();
+				value.data = reader.ReadBytes(value.size);
+				break;
+			case ArgumentType::Output:
+				value.size = reader.Read<uint32_t>();
+				value.output.resize(std::max<size_t>(value.output.size(), value.size));
+				break;
+			case ArgumentType::Strings:
+			{
+				uint32_t amount = reader.Read<uint32_t>();
+
+				value.strings.clear();
+				for (uint32_t i = 0; i < amount && !reader.IsFailed(); ++i)
+				{
+					uint32_t size = reader.Read<uint32_t>();
+					value.strings.push_back(reader.ReadBytes(size));
+				}
+				break;
+			}
+			case ArgumentType::Offsets:
+			{
+				uint32_t amount = reader.Read<uint32_t>();
+
+				value.offsets.clear();
+				for (uint32_t i = 0; i < amount && !reader.IsFailed(); ++i)
+				{
+					value.offsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(reader.Read<uint64_t>())));
+				}
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		int64_t MapName(NameType type, int64_t name)
+		{
+			auto& typeNames = names[static_cast<size_t>(type)];
+			auto nameIter = typeNames.find(name);
+
+			// 0 and names created before the capture started stay as they are
+			return nameIter != typeNames.end() ? nameIter->second : name;
+		}
+
+		Clock::duration Call(FunctionStats& function, std::vector<Value>& arguments, int64_t recordedResult)
+		{
+			const std::string& name = function.name;
+
+			auto handlerIter = handlers.find(name);
+			if (handlerIter == handlers.end() || handlerIter->second.argumentAmount != arguments.size())
+			{
+				if (skippedFunctions.insert(name).second)
+				{
+					std::cout << "[WARNING] " << name << " with " << arguments.size() << " argument(s) is not supported, its calls are skipped\n";
+				}
+				return Clock::duration::zero();
+			}
+
+			int64_t recordedProgram = 0;
+
+			auto nameArgumentIter = nameArguments.find(name);
+			if (nameArgumentIter != nameArguments.end())
+			{
+				for (auto& nameArgument : nameArgumentIter->second)
+				{
+					Value& argument = arguments[nameArgument.first];
+
+					if (nameArgument.second == NameType::Program)
+					{
+						recordedProgram = argument.integer;
+					}
+
+					argument.integer = MapName(nameArgument.second, argument.integer);
+				}
+			}
+
+			// Locations are per program, glUniform* use the one in use
+			if (!name.compare(0, 9, "glUniform") && !arguments.empty())
+			{
+				auto locationIter = locations.find({ currentProgram, arguments[0].integer });
+				if (locationIter != locations.end())
+				{
+					arguments[0].integer = locationIter->second;
+				}
+			}
+			else if (name == "glUseProgram")
+			{
+				currentProgram = recordedProgram;
+			}
+
+			auto deleterIter = nameDeleters.find(name);
+			if (deleterIter != nameDeleters.end() && arguments[1].type == ArgumentType::Data)
+			{
+				Value& argument = arguments[1];
+
+				for (size_t i = 0; i < argument.size / sizeof(GLuint); ++i)
+				{
+					GLuint recordedName;
+					std::memcpy(&recordedName, argument.data + i * sizeof(GLuint), sizeof(GLuint));
+					argument.names.push_back(static_cast<GLuint>(MapName(deleterIter->second, recordedName)));
+				}
+			}
+
+			// Recorded names are replaced by the generated ones
+			auto generatorIter = nameGenerators.find(name);
+			if (generatorIter != nameGenerators.end() && arguments[1].type == ArgumentType::Data)
+			{
+				arguments[1].type = ArgumentType::Output;
+				arguments[1].output.resize(std::max<size_t>(arguments[1].output.size(), arguments[1].size));
+			}
+
+			Clock::time_point start = Clock::now();
+			int64_t result = handlerIter->second.call(arguments);
+			Clock::duration time = Clock::now() - start;
+
+			if (generatorIter != nameGenerators.end() && arguments[1].type == ArgumentType::Output)
+			{
+				const Value& argument = arguments[1];
+
+				for (size_t i = 0; i < argument.size / sizeof(GLuint); ++i)
+				{
+					GLuint recordedName;
+					GLuint replayedName;
+					std::memcpy(&recordedName, argument.data + i * sizeof(GLuint), sizeof(GLuint));
+					std::memcpy(&replayedName, argument.output.data() + i * sizeof(GLuint), sizeof(GLuint));
+					names[static_cast<size_t>(generatorIter->second)][recordedName] = replayedName;
+				}
+			}
+
+			auto resultIter = nameResults.find(name);
+			if (resultIter != nameResults.end())
+			{
+				names[static_cast<size_t>(resultIter->second)][recordedResult] = result;
+			}
+			else if (name == "glGetUniformLocation")
+			{
+				locations[{ recordedProgram, recordedResult }] = result;
+			}
+
+			return time;
+		}
+
+		void PrintChecksum()
+		{
+			std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+			std::cout << "Last frame checksum " << std::hex << std::setw(16) << std::setfill('0')
+				<< HashBytes(pixels.data(), pixels.size()) << std::dec << std::setfill(' ') << '\n';
+		}
+
+		void PrintSummary() const
+		{
+			if (frames.empty())
+			{
+				std::cout << "[WARNING] Capture has no frames\n";
+				return;
+			}
+
+			double recordedSum = 0.0;
+			double replayedSum = 0.0;
+			double replayedMin = frames[0].replayedMs;
+			double replayedMax = frames[0].replayedMs;
+
+			for (const FrameStats& frame : frames)
+			{
+				recordedSum += frame.recordedMs;
+				replayedSum += frame.replayedMs;
+				replayedMin = std::min(replayedMin, frame.replayedMs);
+				replayedMax = std::max(replayedMax, frame.replayedMs);
+			}
+
+			std::cout << frames.size() << " frame(s) replayed: avg " << replayedSum / frames.size() << " ms, min " << replayedMin
+				<< " ms, max " << replayedMax << " ms, recorded avg " << recordedSum / frames.size() << " ms\n";
+
+			std::vector<const FunctionStats*> sortedFunctions;
+			for (const FunctionStats& function : functions)
+			{
+				if (function.callAmount)
+				{
+					sortedFunctions.push_back(&function);
+				}
+			}
+
+			std::sort(sortedFunctions.begin(), sortedFunctions.end(),
+				[](const FunctionStats* left, const FunctionStats* right) { return left->time > right->time; });
+
+			constexpr size_t printedFunctionAmount = 15;
+
+			std::cout << "Functions by CPU time:\n";
+			for (size_t i = 0; i < std::min(sortedFunctions.size(), printedFunctionAmount); ++i)
+			{
+				const FunctionStats& function = *sortedFunctions[i];
+				double timeMs = std::chrono::duration<double, std::milli>(function.time).count();
+
+				std::cout << "  " << std::left << std::setw(32) << function.name << std::right << std::setw(8) << function.callAmount
+					<< " call(s) " << std::setw(10) << timeMs << " ms " << std::setw(10) << timeMs * 1000.0 / function.callAmount << " us/call\n";
+			}
+		}
+
+		Options options;
+		std::vector<char> content;
+		int width = 0;
+		int height = 0;
+		GLFWwindow* window = nullptr;
+
+		std::unordered_map<std::string, Handler> handlers;
+		std::vector<FunctionStats> functions; // By id in capture
+		std::unordered_set<std::string> skippedFunctions;
+
+		std::unordered_map<int64_t, int64_t> names[static_cast<size_t>(NameType::Amount)];
+		std::map<std::pair<int64_t, int64_t>, int64_t> locations; // Recorded program and location
+		int64_t currentProgram = 0;
+
+		std::vector<FrameStats> frames;
+	};
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--paced")
+		{
+			options.paced = true;
+		}
+		else if (argument == "--finish")
+		{
+			options.finish = true;
+		}
+		else if (argument == "--checksum")
+		{
+			options.checksum = true;
+		}
+		else if (options.path.empty() && argument.compare(0, 2, "--"))
+		{
+			options.path = argument;
+		}
+		else
+		{
+			std::cout << "[ERROR] Unknown argument " << argument << '\n';
+			return 1;
+		}
+	}
+
+	if (options.path.empty())
+	{
+		std::cout << "Usage: LGLReplay <capture> [--paced] [--finish] [--checksum]\n";
+		return 1;
+	}
+
+	Replayer replayer(options);
+
+	if (!replayer.Load() || !replayer.Run())
+	{
+		return 1;
+	}
+
+	return 0;
+}
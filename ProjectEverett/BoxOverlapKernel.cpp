@@ -0,0 +1,310 @@
+#include <immintrin.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "SolidSim.h"
+#include "BoxOverlapKernel.h"
+
+BoxOverlapKernel::InstructionSet BoxOverlapKernel::instructionSet = SIMDSupport::GetSupportedInstructionSet();
+
+void BoxOverlapKernel::FindOverlaps(
+	const Boxes& boxes,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	std::vector<uint64_t>& hitMask
+)
+{
+	hitMask.assign((boxes.amount + 63) / 64, 0);
+
+	GetOverlapFunction(instructionSet)(boxes, boxMin, boxMax, hitMask.data());
+}
+
+size_t BoxOverlapKernel::FindOverlaps(
+	const Boxes& boxes,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	std::vector<uint32_t>& hits
+)
+{
+	hits.clear();
+
+	// Mask words on the stack, so small arrays need no allocation
+	constexpr size_t wordsPerChunk = 16;
+	uint64_t hitMask[wordsPerChunk];
+
+	for (size_t chunkFirst = 0; chunkFirst < boxes.amount; chunkFirst += wordsPerChunk * 64)
+	{
+		Boxes chunk = {
+			boxes.minX + chunkFirst, boxes.minY + chunkFirst, boxes.minZ + chunkFirst,
+			boxes.maxX + chunkFirst, boxes.maxY + chunkFirst, boxes.maxZ + chunkFirst,
+			std::min(boxes.amount - chunkFirst, wordsPerChunk * 64)
+		};
+
+		size_t wordAmount = (chunk.amount + 63) / 64;
+		std::fill(hitMask, hitMask + wordAmount, 0);
+
+		GetOverlapFunction(instructionSet)(chunk, boxMin, boxMax, hitMask);
+
+		for (size_t word = 0; word < wordAmount; ++word)
+		{
+			for (uint64_t bits = hitMask[word]; bits; bits &= bits - 1)
+			{
+				hits.push_back(static_cast<uint32_t>(chunkFirst + word * 64 + SIMDSupport::FindLowestBit(bits)));
+			}
+		}
+	}
+
+	return hits.size();
+}
+
+BoxOverlapKernel::InstructionSet BoxOverlapKernel::GetInstructionSet()
+{
+	return instructionSet;
+}
+
+void BoxOverlapKernel::SetInstructionSet(InstructionSet instructionSet)
+{
+	BoxOverlapKernel::instructionSet = std::min(instructionSet, SIMDSupport::GetSupportedInstructionSet());
+}
+
+BoxOverlapKernel::OverlapFunction BoxOverlapKernel::GetOverlapFunction(InstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+	case InstructionSet::AVX512:
+		return OverlapAVX512;
+	case InstructionSet::AVX:
+		return OverlapAVX;
+	case InstructionSet::SSE:
+		return OverlapSSE;
+	default:
+		return OverlapScalar;
+	}
+}
+
+void BoxOverlapKernel::OverlapRest(
+	const Boxes& boxes,
+	size_t first,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	uint64_t* hitMask
+)
+{
+	for (size_t i = first; i < boxes.amount; ++i)
+	{
+		bool overlaps =
+			(boxes.minX[i] < boxMax.x) & (boxes.maxX[i] > boxMin.x) &
+			(boxes.minY[i] < boxMax.y) & (boxes.maxY[i] > boxMin.y) &
+			(boxes.minZ[i] < boxMax.z) & (boxes.maxZ[i] > boxMin.z);
+
+		hitMask[i / 64] |= static_cast<uint64_t>(overlaps) << (i % 64);
+	}
+}
+
+void BoxOverlapKernel::OverlapScalar(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask)
+{
+	OverlapRest(boxes, 0, boxMin, boxMax, hitMask);
+}
+
+void BoxOverlapKernel::OverlapSSE(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask)
+{
+	__m128 testMinX = _mm_set1_ps(boxMin.x);
+	__m128 testMinY = _mm_set1_ps(boxMin.y);
+	__m128 testMinZ = _mm_set1_ps(boxMin.z);
+	__m128 testMaxX = _mm_set1_ps(boxMax.x);
+	__m128 testMaxY = _mm_set1_ps(boxMax.y);
+	__m128 testMaxZ = _mm_set1_ps(boxMax.z);
+
+	size_t i = 0;
+
+	for (; i + 4 <= boxes.amount; i += 4)
+	{
+		__m128 overlapsX = _mm_and_ps(
+			_mm_cmplt_ps(_mm_loadu_ps(boxes.minX + i), testMaxX),
+			_mm_cmpgt_ps(_mm_loadu_ps(boxes.maxX + i), testMinX)
+		);
+		__m128 overlapsY = _mm_and_ps(
+			_mm_cmplt_ps(_mm_loadu_ps(boxes.minY + i), testMaxY),
+			_mm_cmpgt_ps(_mm_loadu_ps(boxes.maxY + i), testMinY)
+		);
+		__m128 overlapsZ = _mm_and_ps(
+			_mm_cmplt_ps(_mm_loadu_ps(boxes.minZ + i), testMaxZ),
+			_mm_cmpgt_ps(_mm_loadu_ps(boxes.maxZ + i), testMinZ)
+		);
+
+		// Lanes never straddle two mask words, as 4, 8 and 16 divide 64
+		uint64_t bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_and_ps(overlapsX, _mm_and_ps(overlapsY, overlapsZ))));
+		hitMask[i / 64] |= bits << (i % 64);
+	}
+
+	OverlapRest(boxes, i, boxMin, boxMax, hitMask);
+}
+
+SIMD_TARGET_AVX void BoxOverlapKernel::OverlapAVX(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask)
+{
+	__m256 testMinX = _mm256_set1_ps(boxMin.x);
+	__m256 testMinY = _mm256_set1_ps(boxMin.y);
+	__m256 testMinZ = _mm256_set1_ps(boxMin.z);
+	__m256 testMaxX = _mm256_set1_ps(boxMax.x);
+	__m256 testMaxY = _mm256_set1_ps(boxMax.y);
+	__m256 testMaxZ = _mm256_set1_ps(boxMax.z);
+
+	size_t i = 0;
+
+	for (; i + 8 <= boxes.amount; i += 8)
+	{
+		__m256 overlapsX = _mm256_and_ps(
+			_mm256_cmp_ps(_mm256_loadu_ps(boxes.minX + i), testMaxX, _CMP_LT_OQ),
+			_mm256_cmp_ps(_mm256_loadu_ps(boxes.maxX + i), testMinX, _CMP_GT_OQ)
+		);
+		__m256 overlapsY = _mm256_and_ps(
+			_mm256_cmp_ps(_mm256_loadu_ps(boxes.minY + i), testMaxY, _CMP_LT_OQ),
+			_mm256_cmp_ps(_mm256_loadu_ps(boxes.maxY + i), testMinY, _CMP_GT_OQ)
+		);
+		__m256 overlapsZ = _mm256_and_ps(
+			_mm256_cmp_ps(_mm256_loadu_ps(boxes.minZ + i), testMaxZ, _CMP_LT_OQ),
+			_mm256_cmp_ps(_mm256_loadu_ps(boxes.maxZ + i), testMinZ, _CMP_GT_OQ)
+		);
+
+		uint64_t bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_and_ps(overlapsX, _mm256_and_ps(overlapsY, overlapsZ))));
+		hitMask[i / 64] |= bits << (i % 64);
+	}
+
+	OverlapRest(boxes, i, boxMin, boxMax, hitMask);
+}
+
+SIMD_TARGET_AVX512 void BoxOverlapKernel::OverlapAVX512(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask)
+{
+	__m512 testMinX = _mm512_set1_ps(boxMin.x);
+	__m512 testMinY = _mm512_set1_ps(boxMin.y);
+	__m512 testMinZ = _mm512_set1_ps(boxMin.z);
+	__m512 testMaxX = _mm512_set1_ps(boxMax.x);
+	__m512 testMaxY = _mm512_set1_ps(boxMax.y);
+	__m512 testMaxZ = _mm512_set1_ps(boxMax.z);
+
+	size_t i = 0;
+
+	for (; i + 16 <= boxes.amount; i += 16)
+	{
+		// Each compare only tests lanes still set in the mask of the previous one
+		__mmask16 overlaps = _mm512_cmp_ps_mask(_mm512_loadu_ps(boxes.minX + i), testMaxX, _CMP_LT_OQ);
+		overlaps = _mm512_mask_cmp_ps_mask(overlaps, _mm512_loadu_ps(boxes.maxX + i), testMinX, _CMP_GT_OQ);
+		overlaps = _mm512_mask_cmp_ps_mask(overlaps, _mm512_loadu_ps(boxes.minY + i), testMaxY, _CMP_LT_OQ);
+		overlaps = _mm512_mask_cmp_ps_mask(overlaps, _mm512_loadu_ps(boxes.maxY + i), testMinY, _CMP_GT_OQ);
+		overlaps = _mm512_mask_cmp_ps_mask(overlaps, _mm512_loadu_ps(boxes.minZ + i), testMaxZ, _CMP_LT_OQ);
+		overlaps = _mm512_mask_cmp_ps_mask(overlaps, _mm512_loadu_ps(boxes.maxZ + i), testMinZ, _CMP_GT_OQ);
+
+		hitMask[i / 64] |= static_cast<uint64_t>(overlaps) << (i % 64);
+	}
+
+	OverlapRest(boxes, i, boxMin, boxMax, hitMask);
+}
+
+void BoxOverlapKernel::Benchmark(size_t boxAmount, size_t repeats)
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+
+	std::vector<SolidSim> solids;
+	std::vector<std::vector<float>> components(6, std::vector<float>(boxAmount));
+
+	solids.reserve(boxAmount);
+
+	for (size_t i = 0; i < boxAmount; ++i)
+	{
+		glm::vec3 pos(position(generator), position(generator), position(generator));
+		glm::vec3 size(scale(generator), scale(generator), scale(generator));
+
+		solids.emplace_back(pos, size);
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			components[axis][i] = pos[axis] - size[axis] / 2;
+			components[axis + 3][i] = pos[axis] + size[axis] / 2;
+		}
+	}
+
+	Boxes boxes = {
+		components[0].data(), components[1].data(), components[2].data(),
+		components[3].data(), components[4].data(), components[5].data(),
+		boxAmount
+	};
+
+	glm::vec3 testPos(0.0f, 0.0f, 0.0f);
+	glm::vec3 testSize(40.0f, 40.0f, 40.0f);
+	SolidSim testSolid(testPos, testSize);
+
+	std::vector<uint64_t> referenceMask((boxAmount + 63) / 64);
+	std::vector<uint64_t> hitMask;
+
+	// Fastest of the runs, slower ones are mostly the OS getting in the way
+	auto Time = [repeats](const std::function<void()>& test)
+	{
+		test();
+
+		double fastest = std::numeric_limits<double>::max();
+
+		for (size_t repeat = 0; repeat < std::max<size_t>(repeats, 1); ++repeat)
+		{
+			auto start = std::chrono::steady_clock::now();
+			test();
+			std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+			fastest = std::min(fastest, time.count());
+		}
+
+		return fastest;
+	};
+
+	// Pair at a time, as collisions were tested before
+	double referenceTime = Time([&]()
+	{
+		std::fill(referenceMask.begin(), referenceMask.end(), 0);
+
+		for (size_t i = 0; i < boxAmount; ++i)
+		{
+			if (SolidSim::CheckForCollision(testSolid, solids[i]))
+			{
+				referenceMask[i / 64] |= 1ull << (i % 64);
+			}
+		}
+	});
+
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "Testing a box against " << boxAmount << " boxes, fastest of " << repeats << " run(s)\n";
+	std::cout << "SolidSim: " << referenceTime << " ms\n";
+
+	for (InstructionSet set : { InstructionSet::Scalar, InstructionSet::SSE, InstructionSet::AVX, InstructionSet::AVX512 })
+	{
+		if (set > SIMDSupport::GetSupportedInstructionSet())
+		{
+			std::cout << SIMDSupport::GetInstructionSetName(set) << ": not supported\n";
+			continue;
+		}
+
+		OverlapFunction overlap = GetOverlapFunction(set);
+		double time = Time([&]()
+		{
+			hitMask.assign(referenceMask.size(), 0);
+			overlap(boxes, testPos - testSize / 2.0f, testPos + testSize / 2.0f, hitMask.data());
+		});
+
+		size_t mismatches = 0;
+		for (size_t word = 0; word < hitMask.size(); ++word)
+		{
+			for (uint64_t bits = hitMask[word] ^ referenceMask[word]; bits; bits &= bits - 1)
+			{
+				++mismatches;
+			}
+		}
+
+		std::cout << SIMDSupport::GetInstructionSetName(set) << ": " << time << " ms, " <<
+			referenceTime / std::max(time, 1e-9) << "x, mismatches " << mismatches << '\n';
+	}
+}
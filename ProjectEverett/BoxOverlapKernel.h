@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "SIMDSupport.h"
+
+/*
+	Batch test of one AABB against many, kept as structure of arrays
+
+	Overlap is strict, as in SolidSim::CheckForCollision, touching boxes do not overlap.
+	AVX-512 tests 16 boxes at once, AVX 8, SSE 4, without branches, the rest of the array is
+	tested one by one. The widest instruction set the CPU and OS support is chosen at runtime
+*/
+class BoxOverlapKernel
+{
+public:
+	using InstructionSet = SIMDSupport::InstructionSet;
+
+	struct Boxes
+	{
+		const float* minX;
+		const float* minY;
+		const float* minZ;
+		const float* maxX;
+		const float* maxY;
+		const float* maxZ;
+		size_t amount;
+	};
+
+	// Bit i % 64 of word i / 64 is set if box i overlaps the tested one
+	static void FindOverlaps(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<uint64_t>& hitMask);
+	// Indices of overlapping boxes in ascending order, returns their amount
+	static size_t FindOverlaps(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<uint32_t>& hits);
+
+	static InstructionSet GetInstructionSet();
+	// Clamped to the supported one, meant for benchmarks and debugging
+	static void SetInstructionSet(InstructionSet instructionSet);
+
+	// Times SolidSim::CheckForCollision over every box against every supported instruction set on
+	// random boxes and prints the results
+	static void Benchmark(size_t boxAmount, size_t repeats = 20);
+
+private:
+	// Ors hit bits into a zeroed mask
+	using OverlapFunction = void(*)(const Boxes&, const glm::vec3&, const glm::vec3&, uint64_t*);
+
+	static void OverlapScalar(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask);
+	static void OverlapSSE(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask);
+	static void OverlapAVX(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask);
+	static void OverlapAVX512(const Boxes& boxes, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask);
+
+	// Tests boxes [first, boxes.amount) one by one
+	static void OverlapRest(const Boxes& boxes, size_t first, const glm::vec3& boxMin, const glm::vec3& boxMax, uint64_t* hitMask);
+
+	static OverlapFunction GetOverlapFunction(InstructionSet instructionSet);
+
+	static InstructionSet instructionSet;
+};
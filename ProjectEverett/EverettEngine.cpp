@@ -2,6 +2,8 @@
 #include <time.h>
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
+#include <tuple>
 
 #include "LGL.h"
 #include "LGLUtils.h"
@@ -12,12 +14,17 @@
 #include "MaterialSim.h"
 #include "LightSim.h"
 #include "SolidSim.h"
+#include "SolidRegistry.h"
 #include "CameraSim.h"
 #include "SoundSim.h"
 
 #include "CommandHandler.h"
 
 #include "MazeGen.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
+#include "TriangleBVH.h"
+#include "SceneBVH.h"
 
 #include "stdEx/mapEx.h"
 
@@ -31,7 +38,7 @@ EverettEngine::LightShaderValueNames EverettEngine::lightShaderValueNames =
 		{
 			"position", "diffuse",
 			"specular", "constant", "linear",
-			"quadratic"
+			"quadratic", "shadowIndex"
 		}
 	},
 	{"spotLights",
@@ -56,6 +63,13 @@ EverettEngine::EverettEngine()
 
 	fileLoader = std::make_unique<FileLoader>();
 	cmdHandler = std::make_unique<CommandHandler>();
+	solidCuller = std::make_unique<FrustumCuller>();
+	occlusionCuller = std::make_unique<OcclusionCuller>();
+	sceneBVH = std::make_unique<SceneBVH>();
+
+	occlusionCulling = false;
+	occlusionPending = false;
+	keepMeshData = true;
 }
 
 EverettEngine::~EverettEngine()
@@ -102,7 +116,23 @@ void EverettEngine::CreateAndSetupMainWindow(int windowHeight, int windowWidth,
 	mainLGL->CaptureMouse();
 
 	mainLGLRenderThread = std::make_unique<std::thread>(
-		[this](){ mainLGL->RunRenderingCycle([this](){ camera->SetPosition(CameraSim::Direction::Nowhere); }); }
+		[this]()
+		{ 
+			mainLGL->RunRenderingCycle(
+				[this]()
+				{ 
+					camera->SetPosition(CameraSim::Direction::Nowhere); 
+					mainLGL->SetCullingView(
+						camera->GetProjectionMatrixAddr() * camera->GetViewMatrixAddr(), 
+						camera->GetPositionVectorAddr()
+					);
+					CullingUpdater();
+					SceneUpdater();
+					ShadowUpdater();
+					DebugDrawUpdater();
+				}
+			); 
+		}
 	);
 }
 
@@ -112,29 +142,79 @@ bool EverettEngine::CreateModel(
 	std::function<void()> additionalBehaviour
 )
 {
-	MSM.emplace(name, ModelSolidPair{});
-	LGLStructs::ModelInfo& newModel = MSM[name].first;
-	
-	if (!fileLoader->LoadModel(path, name, newModel))
+	// Model is loaded while frames are rendered, only adding it to the scene waits for the rendering cycle
+	LGLStructs::ModelInfo loadedModel;
+	std::vector<TriangleBVH> loadedBVHs;
+
+	if (!fileLoader->LoadModel(path, name, loadedModel, &loadedBVHs))
 	{
-		MSM.erase(name);
 		return false;
 	}
 
-	newModel.shaderProgram = "lightComb";
-	newModel.render = false;
-	newModel.behaviour = [this, name, additionalBehaviour]()
+	mainLGL->ExecuteBetweenFrames([&]()
 	{
-		if (additionalBehaviour)
+		MSM.emplace(name, ModelSolidPair{});
+		LGLStructs::ModelInfo& newModel = MSM[name].first;
+		newModel = loadedModel;
+		meshBVHs[name] = std::move(loadedBVHs);
+
+		ModelCulling& culling = modelCulling[name];
+		culling = {};
+
+		for (auto& mesh : newModel.meshes)
+		{
+			if (mesh.mesh.boundingSphere.w <= 0.0f)
+			{
+				continue;
+			}
+
+			culling.boundsMin = culling.hasBounds ? glm::min(culling.boundsMin, mesh.mesh.boundsMin) : mesh.mesh.boundsMin;
+			culling.boundsMax = culling.hasBounds ? glm::max(culling.boundsMax, mesh.mesh.boundsMax) : mesh.mesh.boundsMax;
+			culling.hasBounds = true;
+		}
+
+		// Broadphase boxes enclose the meshes so the triangle test sees every contact
+		if (culling.hasBounds)
 		{
-			additionalBehaviour();
+			MSM[name].second.SetCollisionBounds(culling.boundsMin, culling.boundsMax);
 		}
 
-		LightUpdater();
+		if (FindSceneModel(name) == sceneModels.size())
+		{
+			sceneModels.push_back({ name, &MSM[name].second, &MSM[name].first, &meshBVHs[name], {} });
+		}
 
-		if(MSM.find(name) != MSM.end())
+		newModel.shaderProgram = "lightComb";
+		newModel.render = false;
+		newModel.retention = keepMeshData ? LGLStructs::MeshRetention::Keep : LGLStructs::MeshRetention::Drop;
+		newModel.behaviour = [this, name, additionalBehaviour]()
 		{
-			for (auto& solid : MSM.at(name).second)
+			ProfileZone("Behaviour");
+
+			// All solids cast shadows in one instanced draw, ones out of the camera view included
+			if (mainLGL->IsShadowPass())
+			{
+				if (MSM.find(name) != MSM.end())
+				{
+					const SolidRegistry& solids = MSM.at(name).second;
+					mainLGL->RenderInstances(
+						solids.GetModelMatrices(), 
+						solids.GetNormalMatrices(), 
+						LGLStructs::InstanceCulling::None
+					);
+				}
+
+				return;
+			}
+
+			if (additionalBehaviour)
+			{
+				additionalBehaviour();
+			}
+
+			LightUpdater();
+
+			if(MSM.find(name) != MSM.end())
 			{
 				LGLUtils::SetShaderUniformStruct(
 					*mainLGL, 
@@ -145,48 +225,434 @@ bool EverettEngine::CreateModel(
 					0.5f
 				);
 
-				glm::mat4& modelMatrix = solid.second.GetModelMatrixAddr();
-				mainLGL->SetShaderUniformValue("model", modelMatrix);
-				mainLGL->SetShaderUniformValue("inv", glm::inverse(modelMatrix));
-
-				if (SolidSim::CheckForCollision(*camera, solid.second))
+				if (occlusionPending)
 				{
-					camera->SetLastPosition();
+					ResolveOcclusion();
 				}
+
+				// Visible solids of a model are drawn in one instanced draw, they are frustum culled already,
+				// so only meshlets of them out of view are culled on GPU
+				ModelCulling& culling = modelCulling[name];
+				mainLGL->RenderInstances(
+					culling.visibleModelMatrices, 
+					culling.visibleNormalMatrices, 
+					LGLStructs::InstanceCulling::Meshlets
+				);
 			}
-		}
-	};
+		};
 
-	mainLGL->CreateModel(newModel);
+		mainLGL->CreateModel(newModel);
+	});
 
 	fileLoader->FreeTextureData();
 
 	return true;
 }
 
-bool EverettEngine::CreateSolid(const std::string& modelName, const std::string& solidName)
+EverettEngine::SolidHandle EverettEngine::CreateSolid(const std::string& modelName, const std::string& solidName)
 {
-	MSM[modelName].second.emplace(solidName, camera->GetPositionVectorAddr() + camera->GetFrontVectorAddr());
-	MSM[modelName].first.render = true;
+	SolidHandle solid;
+
+	// Solid arrays the frame reads may be reallocated
+	mainLGL->ExecuteBetweenFrames([&]()
+	{
+		size_t sceneModelIndex = FindSceneModel(modelName);
+
+		if (sceneModelIndex == sceneModels.size())
+		{
+			std::cout << "[ERROR] Model " << modelName << " does not exist, solid " << solidName << " is not created\n";
+			return;
+		}
+
+		SceneModel& sceneModel = sceneModels[sceneModelIndex];
+		LGLStructs::ModelInfo& model = MSM.at(modelName).first;
+
+		SolidRegistry::SolidId id = sceneModel.solids->Add(solidName, camera->GetPositionVectorAddr() + camera->GetFrontVectorAddr());
+
+		if (id < sceneModel.solidHandles.size())
+		{
+			solid = sceneModel.solidHandles[id];
+			return;
+		}
+
+		solid = solidSlots.Insert({ static_cast<uint32_t>(sceneModelIndex), id });
+		sceneModel.solidHandles.push_back(solid);
+
+		model.render = true;
+	});
+
+	return solid;
+}
+
+EverettEngine::LightHandle EverettEngine::CreateLight(const std::string& lightName, LightTypes lightType)
+{
+	LightHandle light;
+
+	// Lights are walked by the light and shadow updaters during the frame
+	mainLGL->ExecuteBetweenFrames([&]()
+	{
+		auto lightIter = lights[lightType].emplace(
+			lightName,
+			LightSim{
+				static_cast<LightSim::LightTypes>(lightType),
+				camera->GetPositionVectorAddr(),
+				glm::vec3(1.0f, 1.0f, 1.0f),
+				camera->GetFrontVectorAddr()
+			}
+		);
+
+		if (!lightIter.second)
+		{
+			light = lightHandles[lightType][lightName];
+			return;
+		}
+
+		light = lightSlots.Insert(&lightIter.first->second);
+		lightHandles[lightType][lightName] = light;
+	});
+
+	return light;
+}
+
+EverettEngine::SoundHandle EverettEngine::CreateSound(const std::string& soundName, const std::string& path)
+{
+	auto soundIter = sounds.find(soundName);
+
+	if (soundIter != sounds.end())
+	{
+		return soundHandles[soundName];
+	}
+
+	soundIter = sounds.emplace(
+		std::piecewise_construct,
+		std::forward_as_tuple(soundName),
+		std::forward_as_tuple(path, glm::vec3(camera->GetPositionVectorAddr()))
+	).first;
+
+	SoundHandle sound = soundSlots.Insert({ &soundIter->second, &soundIter->first });
+	soundHandles[soundName] = sound;
+
+	return sound;
+}
+
+bool EverettEngine::RemoveSolid(SolidHandle solid)
+{
+	bool removed = false;
+
+	// Last solid is moved into the freed id, the frame must not read the arrays meanwhile
+	mainLGL->ExecuteBetweenFrames([&]()
+	{
+		SolidSlot* slot = solidSlots.Get(solid);
+
+		if (!slot)
+		{
+			std::cout << "[ERROR] Solid to remove does not exist\n";
+			return;
+		}
+
+		uint32_t sceneModelIndex = slot->sceneModel;
+		SolidRegistry::SolidId id = slot->solidId;
+
+		SceneModel& sceneModel = sceneModels[sceneModelIndex];
+		SolidRegistry::SolidId lastId = static_cast<SolidRegistry::SolidId>(sceneModel.solids->GetSize() - 1);
+
+		if (!sceneModel.model->isDynamic)
+		{
+			glm::vec3 boxMin;
+			glm::vec3 boxMax;
+			sceneModel.solids->GetCollisionBox(id, boxMin, boxMax);
+
+			mainLGL->InvalidateShadowMaps(boxMin, boxMax);
+		}
+
+		sceneModel.solids->Remove(id);
+		solidSlots.Remove(solid);
+
+		if (id != lastId)
+		{
+			sceneModel.solidHandles[id] = sceneModel.solidHandles[lastId];
+			solidSlots.Get(sceneModel.solidHandles[id])->solidId = id;
+		}
+
+		sceneModel.solidHandles.pop_back();
+
+		// Solid moved into the id is refit by SceneUpdater, as the registry lists it as moved
+		sceneBVH->Remove(GetSceneKey(sceneModelIndex, lastId));
+
+		removed = true;
+	});
+
+	return removed;
+}
+
+bool EverettEngine::RemoveLight(LightHandle light)
+{
+	bool removed = false;
+
+	mainLGL->ExecuteBetweenFrames([&]()
+	{
+		if (!lightSlots.Get(light))
+		{
+			std::cout << "[ERROR] Light to remove does not exist\n";
+			return;
+		}
+
+		for (auto& typeHandles : lightHandles)
+		{
+			auto handleIter = std::find_if(typeHandles.second.begin(), typeHandles.second.end(),
+				[&light](const std::pair<const std::string, LightHandle>& lightHandle) { return lightHandle.second == light; });
+
+			if (handleIter == typeHandles.second.end())
+			{
+				continue;
+			}
+
+			// Shadow map of the light is deleted by ShadowUpdater on the render thread
+			lights[typeHandles.first].erase(handleIter->first);
+			typeHandles.second.erase(handleIter);
+			lightSlots.Remove(light);
+
+			removed = true;
+			return;
+		}
+	});
+
+	return removed;
+}
+
+bool EverettEngine::RemoveSound(SoundHandle sound)
+{
+	SoundSlot* slot = soundSlots.Get(sound);
+
+	if (!slot)
+	{
+		std::cout << "[ERROR] Sound to remove does not exist\n";
+		return false;
+	}
+
+	std::string soundName = *slot->name;
+
+	soundSlots.Remove(sound);
+	soundHandles.erase(soundName);
+	sounds.erase(soundName);
 
 	return true;
 }
 
-void EverettEngine::CreateLight(const std::string& lightName, LightTypes lightType)
+bool EverettEngine::IsValid(SolidHandle solid) const
 {
-	lights[lightType].emplace(
-		lightName,
-		LightSim{
-			static_cast<LightSim::LightTypes>(lightType),
-			camera->GetPositionVectorAddr(),
-			glm::vec3(1.0f, 1.0f, 1.0f),
-			camera->GetFrontVectorAddr()
+	return solidSlots.Get(solid) != nullptr;
+}
+
+bool EverettEngine::IsValid(LightHandle light) const
+{
+	return lightSlots.Get(light) != nullptr;
+}
+
+bool EverettEngine::IsValid(SoundHandle sound) const
+{
+	return soundSlots.Get(sound) != nullptr;
+}
+
+std::vector<glm::vec3> EverettEngine::GetSolidParams(SolidHandle solid)
+{
+	const SolidSlot* slot = solidSlots.Get(solid);
+
+	if (!slot)
+	{
+		std::cout << "[ERROR] Solid does not exist\n";
+
+		// Parameters of a newly created solid
+		return { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+	}
+
+	const SolidRegistry& solids = *sceneModels[slot->sceneModel].solids;
+
+	return { solids.GetPosition(slot->solidId), solids.GetScale(slot->solidId), solids.GetFront(slot->solidId) };
+}
+
+void EverettEngine::SetSolidParams(SolidHandle solid, const std::vector<glm::vec3>& params)
+{
+	mainLGL->ExecuteBetweenFrames([&]()
+	{
+		const SolidSlot* slot = solidSlots.Get(solid);
+
+		if (!slot)
+		{
+			std::cout << "[ERROR] Solid does not exist\n";
+			return;
 		}
-	);
+
+		SceneModel& sceneModel = sceneModels[slot->sceneModel];
+
+		// Shadow maps are invalidated by SceneUpdater once the collision box is recomputed
+		sceneModel.solids->SetTransform(slot->solidId, params[0], params[1]);
+		sceneModel.solids->SetFront(slot->solidId, params[2]);
+	});
+}
+
+std::vector<glm::vec3> EverettEngine::GetLightParams(LightHandle light)
+{
+	LightSim** slot = lightSlots.Get(light);
+
+	if (!slot)
+	{
+		std::cout << "[ERROR] Light does not exist\n";
+
+		return { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+	}
+
+	LightSim& lightSim = **slot;
+
+	return { lightSim.GetPositionVectorAddr(), lightSim.GetScaleVectorAddr(), lightSim.GetFrontVectorAddr() };
+}
+
+void EverettEngine::SetLightParams(LightHandle light, const std::vector<glm::vec3>& params)
+{
+	mainLGL->ExecuteBetweenFrames([&]()
+	{
+		LightSim** slot = lightSlots.Get(light);
+
+		if (!slot)
+		{
+			std::cout << "[ERROR] Light does not exist\n";
+			return;
+		}
+
+		LightSim& lightSim = **slot;
+
+		lightSim.GetPositionVectorAddr() = params[0];
+		lightSim.GetScaleVectorAddr() = params[1];
+		lightSim.GetFrontVectorAddr() = params[2];
+
+		for (auto& pointLight : lightHandles[LightTypes::Point])
+		{
+			if (pointLight.second == light)
+			{
+				mainLGL->InvalidateShadowMap(GetShadowMapName(pointLight.first));
+				break;
+			}
+		}
+	});
+}
+
+glm::vec3 EverettEngine::GetSoundPosition(SoundHandle sound)
+{
+	SoundSlot* slot = soundSlots.Get(sound);
+
+	if (!slot)
+	{
+		std::cout << "[ERROR] Sound does not exist\n";
+		return glm::vec3(0.0f, 0.0f, 0.0f);
+	}
+
+	return slot->sound->GetPosition();
+}
+
+void EverettEngine::SetSoundPosition(SoundHandle sound, const glm::vec3& pos)
+{
+	SoundSlot* slot = soundSlots.Get(sound);
+
+	if (!slot)
+	{
+		std::cout << "[ERROR] Sound does not exist\n";
+		return;
+	}
+
+	slot->sound->SetPosition(pos);
+}
+
+void EverettEngine::StartSound(SoundHandle sound)
+{
+	SoundSlot* slot = soundSlots.Get(sound);
+
+	if (!slot)
+	{
+		std::cout << "[ERROR] Sound does not exist\n";
+		return;
+	}
+
+	slot->sound->Play();
+}
+
+void EverettEngine::StopSound(SoundHandle sound)
+{
+	SoundSlot* slot = soundSlots.Get(sound);
+
+	if (!slot)
+	{
+		std::cout << "[ERROR] Sound does not exist\n";
+		return;
+	}
+
+	slot->sound->Stop();
+}
+
+EverettEngine::SolidHandle EverettEngine::FindSolid(const std::string& modelName, const std::string& solidName)
+{
+	size_t sceneModelIndex = FindSceneModel(modelName);
+
+	if (sceneModelIndex == sceneModels.size())
+	{
+		return {};
+	}
+
+	const SceneModel& sceneModel = sceneModels[sceneModelIndex];
+	SolidRegistry::SolidId id = sceneModel.solids->Find(solidName);
+
+	return id == SolidRegistry::invalidId ? SolidHandle() : sceneModel.solidHandles[id];
+}
+
+EverettEngine::LightHandle EverettEngine::FindLight(const std::string& lightName, LightTypes lightType)
+{
+	auto typeIter = lightHandles.find(lightType);
+
+	if (typeIter == lightHandles.end())
+	{
+		return {};
+	}
+
+	auto lightIter = typeIter->second.find(lightName);
+
+	return lightIter == typeIter->second.end() ? LightHandle() : lightIter->second;
+}
+
+EverettEngine::SoundHandle EverettEngine::FindSound(const std::string& soundName)
+{
+	auto soundIter = soundHandles.find(soundName);
+
+	return soundIter == soundHandles.end() ? SoundHandle() : soundIter->second;
+}
+
+bool EverettEngine::GetSolidName(SolidHandle solid, std::string& modelName, std::string& solidName)
+{
+	const SolidSlot* slot = solidSlots.Get(solid);
+
+	if (!slot)
+	{
+		return false;
+	}
+
+	const SceneModel& sceneModel = sceneModels[slot->sceneModel];
+
+	modelName = sceneModel.name;
+	solidName = sceneModel.solids->GetName(slot->solidId);
+
+	return true;
+}
+
+size_t EverettEngine::FindSceneModel(const std::string& modelName) const
+{
+	auto sceneModelIter = std::find_if(sceneModels.begin(), sceneModels.end(),
+		[&modelName](const SceneModel& sceneModel) { return sceneModel.name == modelName; });
+
+	return static_cast<size_t>(sceneModelIter - sceneModels.begin());
 }
 
 void EverettEngine::LightUpdater()
 {
+	ProfileZone("LightUpdate");
+
 	mainLGL->SetShaderUniformValue("proj", camera->GetProjectionMatrixAddr());
 	mainLGL->SetShaderUniformValue("view", camera->GetViewMatrixAddr());
 
@@ -195,11 +661,17 @@ void EverettEngine::LightUpdater()
 	mainLGL->SetShaderUniformValue("spotLightAmount",  static_cast<int>(lights[LightTypes::Spot].size()));
 	mainLGL->SetShaderUniformValue("ambient", glm::vec3(0.4f, 0.4f, 0.4f));
 	
+	mainLGL->SetShaderUniformValue("shadowNear", static_cast<float>(shadowNearPlane));
+	mainLGL->SetShaderUniformValue("shadowFar", static_cast<float>(shadowFarPlane));
+
 	int index = 0;
 	for (auto& light : lights[LightTypes::Point])
 	{
 		LightSim::Attenuation atten = light.second.GetAttenuation();
 
+		// First point lights cast shadows, shadowIndex -1 means no shadow map
+		int shadowIndex = index < maxShadowCasters ? index : -1;
+
 		LGLUtils::SetShaderUniformArrayAt(
 			*mainLGL,
 			lightShaderValueNames[1].first,
@@ -207,7 +679,22 @@ void EverettEngine::LightUpdater()
 			lightShaderValueNames[1].second,
 			light.second.GetPositionVectorAddr(), glm::vec3(0.4f, 0.4f, 0.4f),
 			glm::vec3(1.0f, 1.0f, 1.0f), 1.0f, atten.linear,
-			atten.quadratic
+			atten.quadratic, shadowIndex
+		);
+
+		if (shadowIndex != -1)
+		{
+			LGLUtils::SetShaderUniformArrayAt(
+				*mainLGL, "pointShadowMaps", shadowIndex, mainLGL->GetShadowMapTextureUnit(GetShadowMapName(light.first))
+			);
+		}
+	}
+
+	// Samplers without a shadow map still have to point at a cube map unit
+	for (int shadowIndex = index; shadowIndex < maxShadowCasters; ++shadowIndex)
+	{
+		LGLUtils::SetShaderUniformArrayAt(
+			*mainLGL, "pointShadowMaps", shadowIndex, mainLGL->GetShadowMapTextureUnit("")
 		);
 	}
 
@@ -229,11 +716,420 @@ void EverettEngine::LightUpdater()
 	mainLGL->SetShaderUniformValue("viewPos", camera->GetPositionVectorAddr());
 }
 
+void EverettEngine::ShadowUpdater()
+{
+	ProfileZone("ShadowUpdate");
+
+	std::vector<std::string> casters;
+
+	int shadowIndex = 0;
+	for (auto& light : lights[LightTypes::Point])
+	{
+		if (shadowIndex++ == maxShadowCasters)
+		{
+			break;
+		}
+
+		std::string shadowMapName = GetShadowMapName(light.first);
+
+		if (mainLGL->CreateShadowMap(shadowMapName, shadowMapSize, true))
+		{
+			// Static depth is re-rendered only if the matrices differ from the previous ones
+			mainLGL->SetShadowMapView(shadowMapName, light.second.GetShadowCubeMatrices(shadowNearPlane, shadowFarPlane));
+			casters.push_back(light.first);
+		}
+	}
+
+	// Lights removed or pushed out of the first maxShadowCasters give their shadow maps back
+	for (auto& caster : shadowCasters)
+	{
+		if (std::find(casters.begin(), casters.end(), caster) == casters.end())
+		{
+			mainLGL->DeleteShadowMap(GetShadowMapName(caster));
+		}
+	}
+
+	shadowCasters = std::move(casters);
+}
+
+void EverettEngine::CullingUpdater()
+{
+	ProfileZone("SolidCulling");
+
+	glm::mat4 viewProj = camera->GetProjectionMatrixAddr() * camera->GetViewMatrixAddr();
+
+	solidCuller->SetView(viewProj);
+
+	if (occlusionCulling)
+	{
+		occlusionCuller->BeginFrame(viewProj);
+		occluderSolids.clear();
+	}
+
+	for (auto& model : MSM)
+	{
+		ModelCulling& culling = modelCulling[model.first];
+		culling.visibleModelMatrices.clear();
+		culling.visibleNormalMatrices.clear();
+		culling.occlusionCandidates.clear();
+
+		// Only solids whose transform changed since the last frame get new matrices
+		SolidRegistry& solids = model.second.second;
+		solids.UpdateTransforms();
+
+		// Collisions are checked once per frame against all solids of the model, culled ones included
+		if (!camera->IsGhostMode() && CameraCollides(model.first))
+		{
+			camera->SetLastPosition();
+		}
+
+		const std::vector<glm::mat4>& modelMatrices = solids.GetModelMatrices();
+		const std::vector<glm::mat3>& normalMatrices = solids.GetNormalMatrices();
+
+		if (!culling.hasBounds)
+		{
+			culling.visibleModelMatrices.assign(modelMatrices.begin(), modelMatrices.end());
+			culling.visibleNormalMatrices.assign(normalMatrices.begin(), normalMatrices.end());
+			continue;
+		}
+
+		solidCuller->Clear();
+
+		for (auto& modelMatrix : modelMatrices)
+		{
+			solidCuller->AddBox(culling.boundsMin, culling.boundsMax, modelMatrix);
+		}
+
+		solidCuller->Cull(cullingVisibleSolids);
+
+		// Culler keeps the order boxes were added in, so indices are solid ids
+		for (size_t solidId : cullingVisibleSolids)
+		{
+			const glm::mat4& modelMatrix = modelMatrices[solidId];
+
+			if (!occlusionCulling)
+			{
+				culling.visibleModelMatrices.push_back(modelMatrix);
+				culling.visibleNormalMatrices.push_back(normalMatrices[solidId]);
+				continue;
+			}
+
+			culling.occlusionCandidates.push_back({
+				occlusionCuller->AddCandidate(culling.boundsMin, culling.boundsMax, modelMatrix),
+				solidId
+			});
+
+			glm::vec3 size = (culling.boundsMax - culling.boundsMin) * solids.GetScale(solidId);
+
+			if (culling.isOccluder && std::max(size.x, std::max(size.y, size.z)) >= occluderMinSize)
+			{
+				occluderSolids.push_back({
+					glm::length(solids.GetPosition(solidId) - camera->GetPositionVectorAddr()),
+					&solids,
+					solidId,
+					&culling
+				});
+			}
+		}
+	}
+
+	if (!occlusionCulling)
+	{
+		return;
+	}
+
+	size_t occluderAmount = std::min(occluderSolids.size(), maxOccluders);
+	std::partial_sort(
+		occluderSolids.begin(),
+		occluderSolids.begin() + occluderAmount,
+		occluderSolids.end(),
+		[](const OccluderSolid& left, const OccluderSolid& right) { return left.distance < right.distance; }
+	);
+
+	for (size_t i = 0; i < occluderAmount; ++i)
+	{
+		const ModelCulling& culling = *occluderSolids[i].culling;
+		const glm::mat4& modelMatrix = occluderSolids[i].solids->GetModelMatrix(occluderSolids[i].solidId);
+
+		if (culling.occluderVertices.empty())
+		{
+			occlusionCuller->AddOccluder(culling.boundsMin, culling.boundsMax, modelMatrix);
+		}
+		else
+		{
+			occlusionCuller->AddOccluderMesh(culling.occluderVertices, culling.occluderIndices, modelMatrix);
+		}
+	}
+
+	// Runs while shadow maps are rendered, the first drawn model waits for it
+	occlusionCuller->Start();
+	occlusionPending = true;
+}
+
+bool EverettEngine::CameraCollides(const std::string& modelName)
+{
+	SolidRegistry& solids = MSM.at(modelName).second;
+
+	glm::vec3 position = camera->GetPositionVectorAddr();
+	glm::vec3 halfScale = camera->GetScaleVectorAddr() / 2.0f;
+
+	auto bvhIter = meshBVHs.find(modelName);
+
+	if (bvhIter == meshBVHs.end() || bvhIter->second.empty())
+	{
+		return solids.Overlaps(position - halfScale, position + halfScale);
+	}
+
+	float radius = std::min(halfScale.x, halfScale.z);
+	glm::vec3 halfSegment = glm::vec3(0.0f, std::max(halfScale.y - radius, 0.0f), 0.0f);
+
+	return solids.Overlaps(position - halfScale, position + halfScale, [&](SolidRegistry::SolidId solidId)
+	{
+		const glm::mat4& modelMatrix = solids.GetModelMatrix(solidId);
+
+		for (auto& bvh : bvhIter->second)
+		{
+			if (bvh.OverlapsCapsule(position - halfSegment, position + halfSegment, radius, modelMatrix))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	});
+}
+
+void EverettEngine::SceneUpdater()
+{
+	ProfileZone("SceneBVH");
+
+	// Collision boxes are up to date after CullingUpdater, only the moved ones are refit
+	for (size_t sceneModel = 0; sceneModel < sceneModels.size(); ++sceneModel)
+	{
+		SolidRegistry& solids = *sceneModels[sceneModel].solids;
+
+		bool castsStaticShadows = !sceneModels[sceneModel].model->isDynamic;
+
+		for (SolidRegistry::SolidId solidId : solids.GetMovedSolids())
+		{
+			glm::vec3 boxMin;
+			glm::vec3 boxMax;
+			solids.GetCollisionBox(solidId, boxMin, boxMax);
+
+			uint64_t key = GetSceneKey(sceneModel, solidId);
+
+			// Static depth is re-rendered only in shadow maps the solid left or entered
+			if (castsStaticShadows)
+			{
+				glm::vec3 oldBoxMin;
+				glm::vec3 oldBoxMax;
+
+				if (!sceneBVH->GetBox(key, oldBoxMin, oldBoxMax))
+				{
+					mainLGL->InvalidateShadowMaps(boxMin, boxMax);
+				}
+				else if (oldBoxMin != boxMin || oldBoxMax != boxMax)
+				{
+					mainLGL->InvalidateShadowMaps(oldBoxMin, oldBoxMax);
+					mainLGL->InvalidateShadowMaps(boxMin, boxMax);
+				}
+			}
+
+			sceneBVH->Update(key, boxMin, boxMax);
+		}
+
+		solids.ClearMovedSolids();
+	}
+
+	sceneBVH->Maintain();
+}
+
+uint64_t EverettEngine::GetSceneKey(size_t sceneModel, uint32_t solidId)
+{
+	return (static_cast<uint64_t>(sceneModel) << 32) | solidId;
+}
+
+bool EverettEngine::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, SolidHit& hit)
+{
+	float directionLength = glm::length(direction);
+
+	if (directionLength <= 0.0f)
+	{
+		std::cout << "[WARNING] Raycast direction has zero length\n";
+		return false;
+	}
+
+	glm::vec3 unitDirection = direction / directionLength;
+
+	SceneBVH::LeafKey hitKey;
+	float hitDistance;
+
+	bool hitFound = sceneBVH->Raycast(
+		origin,
+		unitDirection,
+		maxDistance,
+		[&](SceneBVH::LeafKey key, float boxDistance, float closest)
+		{
+			const SceneModel& sceneModel = sceneModels[key >> 32];
+
+			if (sceneModel.meshBVHs->empty())
+			{
+				return boxDistance;
+			}
+
+			const glm::mat4& modelMatrix = sceneModel.solids->GetModelMatrix(static_cast<SolidRegistry::SolidId>(key));
+			float meshDistance = -1.0f;
+
+			for (auto& bvh : *sceneModel.meshBVHs)
+			{
+				float distance;
+
+				if (bvh.Raycast(origin, unitDirection, closest, modelMatrix, distance))
+				{
+					meshDistance = distance;
+					closest = distance;
+				}
+			}
+
+			return meshDistance;
+		},
+		hitKey,
+		hitDistance
+	);
+
+	if (!hitFound)
+	{
+		return false;
+	}
+
+	hit.solid = sceneModels[hitKey >> 32].solidHandles[static_cast<SolidRegistry::SolidId>(hitKey)];
+	hit.distance = hitDistance;
+
+	return true;
+}
+
+std::vector<EverettEngine::SolidHit> EverettEngine::OverlapSphere(const glm::vec3& center, float radius)
+{
+	std::vector<SolidHit> hits;
+
+	sceneBVH->QuerySphere(center, radius, [&](SceneBVH::LeafKey key, float boxDistance)
+	{
+		const SceneModel& sceneModel = sceneModels[key >> 32];
+		SolidRegistry::SolidId solidId = static_cast<SolidRegistry::SolidId>(key);
+
+		bool overlaps = sceneModel.meshBVHs->empty();
+
+		for (auto& bvh : *sceneModel.meshBVHs)
+		{
+			if (bvh.OverlapsCapsule(center, center, radius, sceneModel.solids->GetModelMatrix(solidId)))
+			{
+				overlaps = true;
+				break;
+			}
+		}
+
+		if (overlaps)
+		{
+			hits.push_back({ sceneModel.solidHandles[solidId], boxDistance });
+		}
+
+		return false;
+	});
+
+	return hits;
+}
+
+void EverettEngine::ResolveOcclusion()
+{
+	ProfileZone("OcclusionWait");
+
+	occlusionCuller->Wait();
+	occlusionPending = false;
+
+	for (auto& model : MSM)
+	{
+		const SolidRegistry& solids = model.second.second;
+		ModelCulling& culling = modelCulling[model.first];
+
+		for (auto& candidate : culling.occlusionCandidates)
+		{
+			if (occlusionCuller->IsVisible(candidate.first))
+			{
+				SolidRegistry::SolidId id = static_cast<SolidRegistry::SolidId>(candidate.second);
+
+				culling.visibleModelMatrices.push_back(solids.GetModelMatrix(id));
+				culling.visibleNormalMatrices.push_back(solids.GetNormalMatrix(id));
+			}
+		}
+	}
+}
+
+void EverettEngine::DebugDrawUpdater()
+{
+	if (!mainLGL->IsDebugDrawEnabled())
+	{
+		return;
+	}
+
+	ProfileZone("DebugDrawUpdate");
+
+	// Same axis aligned boxes the camera is tested against
+	for (auto& model : MSM)
+	{
+		const SolidRegistry& solids = model.second.second;
+
+		for (SolidRegistry::SolidId id = 0; id < solids.GetSize(); ++id)
+		{
+			glm::vec3 boxMin;
+			glm::vec3 boxMax;
+			solids.GetCollisionBox(id, boxMin, boxMax);
+
+			mainLGL->DebugBox(
+				boxMin,
+				boxMax,
+				solids.IsGhostMode(id) ? glm::vec3(0.5f, 0.5f, 0.5f) : glm::vec3(0.0f, 1.0f, 0.0f)
+			);
+		}
+	}
+
+	for (auto& lightCollection : lights)
+	{
+		for (auto& light : lightCollection.second)
+		{
+			glm::vec3 lightPos = light.second.GetPositionVectorAddr();
+
+			mainLGL->DebugBox(lightPos - glm::vec3(0.1f), lightPos + glm::vec3(0.1f), glm::vec3(1.0f, 1.0f, 0.0f));
+
+			if (lightCollection.first == LightTypes::Point)
+			{
+				mainLGL->DebugSphere(lightPos, static_cast<float>(light.second.lightRange), glm::vec3(1.0f, 0.8f, 0.0f));
+			}
+			else
+			{
+				mainLGL->DebugLine(lightPos, lightPos + light.second.GetFrontVectorAddr(), glm::vec3(1.0f, 0.8f, 0.0f));
+			}
+		}
+	}
+}
+
+std::string EverettEngine::GetShadowMapName(const std::string& lightName)
+{
+	return "pointLight_" + lightName;
+}
+
 std::vector<glm::vec3> EverettEngine::GetSolidParamsByName(const std::string& modelName, const std::string& solidName)
 {
-	SolidSim& solid = MSM[modelName].second[solidName];
+	SolidHandle solid = FindSolid(modelName, solidName);
+
+	if (!IsValid(solid))
+	{
+		std::cout << "[ERROR] Solid " << solidName << " of model " << modelName << " does not exist\n";
 
-	return { solid.GetPositionVectorAddr(), solid.GetScaleVectorAddr(), solid.GetFrontVectorAddr() };
+		// Parameters of a newly created solid
+		return { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+	}
+
+	return GetSolidParams(solid);
 }
 
 void EverettEngine::SetSolidParamsByName(
@@ -242,13 +1138,15 @@ void EverettEngine::SetSolidParamsByName(
 	const std::vector<glm::vec3>& params
 )
 {
-	SolidSim& solid = MSM[modelName].second[solidName];
+	SolidHandle solid = FindSolid(modelName, solidName);
 
-	solid.GetPositionVectorAddr() = params[0];
-	solid.GetScaleVectorAddr()    = params[1];
-	solid.GetFrontVectorAddr()    = params[2];
+	if (!IsValid(solid))
+	{
+		std::cout << "[ERROR] Solid " << solidName << " of model " << modelName << " does not exist\n";
+		return;
+	}
 
-	solid.ForceModelUpdate();
+	SetSolidParams(solid, params);
 }
 
 std::vector<std::string> EverettEngine::GetModelList(const std::string& path)
@@ -335,7 +1233,7 @@ std::vector<std::string> EverettEngine::GetSolidList()
 	for (auto& model : MSM)
 	{
 		solidNames.push_back('.' + model.first);
-		std::vector<std::string> modelSolidNames = GetNameList(model.second.second);
+		const std::vector<std::string>& modelSolidNames = model.second.second.GetNames();
 		solidNames.insert(solidNames.end(), modelSolidNames.begin(), modelSolidNames.end());
 	}
 
@@ -366,4 +1264,90 @@ std::vector<std::string> EverettEngine::GetSoundList()
 std::vector<std::string> EverettEngine::GetLightTypeList()
 {
 	return LightSim::GetLightTypeNames();
+}
+
+void EverettEngine::SetDebugDraw(bool enabled)
+{
+	mainLGL->SetDebugDraw(enabled);
+}
+
+void EverettEngine::SetOcclusionCulling(bool enabled)
+{
+	occlusionCulling = enabled;
+}
+
+bool EverettEngine::SetModelOccluder(const std::string& modelName, const std::string& occluderPath)
+{
+	auto cullingIter = modelCulling.find(modelName);
+	if (cullingIter == modelCulling.end())
+	{
+		std::cout << "[ERROR] Model " << modelName << " does not exist, it can not be an occluder\n";
+		return false;
+	}
+
+	ModelCulling& culling = cullingIter->second;
+	culling.occluderVertices.clear();
+	culling.occluderIndices.clear();
+
+	if (!occluderPath.empty())
+	{
+		LGLStructs::ModelInfo occluderModel;
+
+		if (!fileLoader->LoadModel(occluderPath, modelName + "Occluder", occluderModel))
+		{
+			return false;
+		}
+		fileLoader->FreeTextureData();
+
+		for (auto& mesh : occluderModel.meshes)
+		{
+			unsigned int firstVertex = static_cast<unsigned int>(culling.occluderVertices.size());
+
+			for (auto& vert : mesh.mesh.vert)
+			{
+				culling.occluderVertices.push_back(vert.Position);
+			}
+			for (unsigned int index : mesh.mesh.indices)
+			{
+				culling.occluderIndices.push_back(firstVertex + index);
+			}
+		}
+	}
+
+	culling.isOccluder = true;
+
+	return true;
+}
+
+void EverettEngine::SetLODConfig(const std::vector<std::pair<float, float>>& levels, float maxPixelError)
+{
+	std::vector<LGLStructs::LODLevel> lodLevels;
+
+	for (auto& level : levels)
+	{
+		lodLevels.push_back({ level.first, level.second });
+	}
+
+	fileLoader->SetLODLevels(lodLevels);
+	mainLGL->SetLODSelection(maxPixelError);
+}
+
+void EverettEngine::SetMemoryBudget(size_t budgetBytes)
+{
+	mainLGL->SetMemoryBudget(budgetBytes);
+}
+
+void EverettEngine::SetModelRetention(bool keep)
+{
+	keepMeshData = keep;
+}
+
+bool EverettEngine::StartCommandCapture(const std::string& path, size_t frameAmount)
+{
+	return mainLGL->StartCommandCapture(path, frameAmount);
+}
+
+void EverettEngine::StopCommandCapture()
+{
+	mainLGL->StopCommandCapture();
 }
\ No newline at end of file
@@ -18,12 +18,19 @@
 #include <thread>
 #include <functional>
 
+#include "SlotMap.h"
+
 class FileLoader;
 class CameraSim;
 class SolidSim;
+class SolidRegistry;
 class LightSim;
 class SoundSim;
 class CommandHandler;
+class FrustumCuller;
+class OcclusionCuller;
+class TriangleBVH;
+class SceneBVH;
 class LGL;
 
 namespace LGLStructs
@@ -61,16 +68,56 @@ public:
 		Sound
 	};
 
+	// Handles stay valid until their object is removed, stale ones resolve to nothing.
+	// Default constructed handles never resolve
+	using SolidHandle = SlotHandle<SolidSim>;
+	using LightHandle = SlotHandle<LightSim>;
+	using SoundHandle = SlotHandle<SoundSim>;
+
+	struct SolidHit
+	{
+		SolidHandle solid;
+		float distance;
+	};
+
 	EVERETT_API EverettEngine();
 	EVERETT_API ~EverettEngine();
 	EVERETT_API void CreateAndSetupMainWindow(int windowWidth, int windowHeight, const std::string& title);
+	// Calls changing models, solids and lights can come from any thread, they wait for the rendered frame to end
 	EVERETT_API bool CreateModel(
 		const std::string& path, 
 		const std::string& name, 
 		std::function<void()> additionalBehaviour = nullptr
 	);
-	EVERETT_API bool CreateSolid(const std::string& modelName, const std::string& solidName);
-	EVERETT_API void CreateLight(const std::string& lightName, LightTypes lightType);
+	// Objects are created at the camera, creating one with a taken name returns the existing one
+	EVERETT_API SolidHandle CreateSolid(const std::string& modelName, const std::string& solidName);
+	EVERETT_API LightHandle CreateLight(const std::string& lightName, LightTypes lightType);
+	EVERETT_API SoundHandle CreateSound(const std::string& soundName, const std::string& path);
+
+	// Last solid of the model takes the id of the removed one, handles to it stay valid
+	EVERETT_API bool RemoveSolid(SolidHandle solid);
+	EVERETT_API bool RemoveLight(LightHandle light);
+	EVERETT_API bool RemoveSound(SoundHandle sound);
+
+	EVERETT_API bool IsValid(SolidHandle solid) const;
+	EVERETT_API bool IsValid(LightHandle light) const;
+	EVERETT_API bool IsValid(SoundHandle sound) const;
+
+	// Params are position, scale and front
+	EVERETT_API std::vector<glm::vec3> GetSolidParams(SolidHandle solid);
+	EVERETT_API void SetSolidParams(SolidHandle solid, const std::vector<glm::vec3>& params);
+	EVERETT_API std::vector<glm::vec3> GetLightParams(LightHandle light);
+	EVERETT_API void SetLightParams(LightHandle light, const std::vector<glm::vec3>& params);
+	EVERETT_API glm::vec3 GetSoundPosition(SoundHandle sound);
+	EVERETT_API void SetSoundPosition(SoundHandle sound, const glm::vec3& pos);
+	EVERETT_API void StartSound(SoundHandle sound);
+	EVERETT_API void StopSound(SoundHandle sound);
+
+	// Slow path for tools, names are hashed and compared. Invalid handle if there is no such object
+	EVERETT_API SolidHandle FindSolid(const std::string& modelName, const std::string& solidName);
+	EVERETT_API LightHandle FindLight(const std::string& lightName, LightTypes lightType);
+	EVERETT_API SoundHandle FindSound(const std::string& soundName);
+	EVERETT_API bool GetSolidName(SolidHandle solid, std::string& modelName, std::string& solidName);
 
 	EVERETT_API std::vector<glm::vec3> GetSolidParamsByName(const std::string& modelName, const std::string& solidName);
 	EVERETT_API void SetSolidParamsByName(
@@ -84,16 +131,107 @@ public:
 	EVERETT_API std::vector<std::string> GetNamesByObject(ObjectTypes objType);
 	EVERETT_API std::vector<std::string> GetLightTypeList();
 
+	// Collision boxes of solids and ranges of point lights are drawn as lines every frame
+	EVERETT_API void SetDebugDraw(bool enabled);
+
+	// Solids hidden behind occluders are not drawn, the test runs on a worker thread
+	// while shadow maps are rendered and is waited for by the first drawn model
+	EVERETT_API void SetOcclusionCulling(bool enabled);
+	// Solids of the model hide other solids, as the meshes of occluderPath (low poly version
+	// of the model) or, if it is empty, as the model bounds, which suits models filling them (walls)
+	EVERETT_API bool SetModelOccluder(const std::string& modelName, const std::string& occluderPath = "");
+
+	// Levels are (triangle ratio, max error relative to the mesh radius) of LODs generated for
+	// models created afterwards, solids are drawn with LODs whose error stays under maxPixelError pixels
+	EVERETT_API void SetLODConfig(const std::vector<std::pair<float, float>>& levels, float maxPixelError);
+
+	// Meshes of models hidden for a while and their textures are released once GPU memory
+	// is over budgetBytes, set it before models are created so their textures can be evicted
+	EVERETT_API void SetMemoryBudget(size_t budgetBytes);
+	// Meshes of models created afterwards free their vertices, indices, LODs and meshlets from system
+	// memory once uploaded unless keep is set (default). Models that free them are never evicted
+	EVERETT_API void SetModelRetention(bool keep);
+
+	// GL calls of the next frameAmount frames (0 until stopped) are written into path for LGLReplay,
+	// the capture starts with the next frame and includes the loaded scene
+	EVERETT_API bool StartCommandCapture(const std::string& path, size_t frameAmount = 0);
+	EVERETT_API void StopCommandCapture();
+
+	// Nearest solid the ray hits within maxDistance. Solids of models with meshes are hit by their
+	// triangles, others by their collision boxes. Ghost solids are hit too
+	EVERETT_API bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, SolidHit& hit);
+	// Solids within radius of center, distance is the one from center to their collision box
+	EVERETT_API std::vector<SolidHit> OverlapSphere(const glm::vec3& center, float radius);
+
 	EVERETT_API static std::vector<std::string> GetObjectTypes();
 private:
-	using ModelSolidPair = std::pair<LGLStructs::ModelInfo, std::map<std::string, SolidSim>>;
+	using ModelSolidPair = std::pair<LGLStructs::ModelInfo, SolidRegistry>;
 	using ModelSolidsMap = std::unordered_map<std::string, ModelSolidPair>;
 
 	using LightShaderValueNames = std::vector<std::pair<std::string, std::vector<std::string>>>;
 	using LightCollection = std::map<LightTypes, std::map<std::string, LightSim>>;
 	using SoundCollection = std::map<std::string, SoundSim>;
 
+	// Model space bounds of all meshes of a model, solids outside of the camera frustum
+	// or behind occluders are left out of visible matrices before the instanced draw
+	struct ModelCulling
+	{
+		bool hasBounds = false;
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+		std::vector<glm::mat4> visibleModelMatrices;
+		std::vector<glm::mat3> visibleNormalMatrices;
+
+		bool isOccluder = false;
+		std::vector<glm::vec3> occluderVertices; // Empty if bounds are the occluder
+		std::vector<unsigned int> occluderIndices;
+		// Solids in the frustum, their index in the occlusion culler and solid id
+		std::vector<std::pair<size_t, size_t>> occlusionCandidates;
+	};
+
+	// Solids of all models are in one SceneBVH, keyed by index of their model here and solid id
+	struct SceneModel
+	{
+		std::string name;
+		SolidRegistry* solids;
+		const LGLStructs::ModelInfo* model;
+		const std::vector<TriangleBVH>* meshBVHs;
+		std::vector<SolidHandle> solidHandles; // Indexed by solid id
+	};
+
+	struct SolidSlot
+	{
+		uint32_t sceneModel = 0;
+		uint32_t solidId = 0;
+	};
+
+	// Sims are kept in maps, which do not move their elements
+	struct SoundSlot
+	{
+		SoundSim* sound = nullptr;
+		const std::string* name = nullptr;
+	};
+
+	struct OccluderSolid
+	{
+		float distance;
+		const SolidRegistry* solids;
+		size_t solidId;
+		const ModelCulling* culling;
+	};
+
 	void LightUpdater();
+	void ShadowUpdater();
+	void DebugDrawUpdater();
+	void CullingUpdater();
+	void SceneUpdater();
+	void ResolveOcclusion();
+	// Camera is a capsule inside its box, tested against triangles of solids whose boxes it overlaps
+	bool CameraCollides(const std::string& modelName);
+	std::string GetShadowMapName(const std::string& lightName);
+	static uint64_t GetSceneKey(size_t sceneModel, uint32_t solidId);
+	// sceneModels.size() if the model is not created
+	size_t FindSceneModel(const std::string& modelName) const;
 
 	template<typename Sim>
 	std::vector<std::string> GetNameList(const std::map<std::string, Sim>& sims);
@@ -109,11 +247,41 @@ private:
 	std::unique_ptr<CommandHandler> cmdHandler;
 
 	ModelSolidsMap MSM;
+	std::unordered_map<std::string, ModelCulling> modelCulling;
+	std::unordered_map<std::string, std::vector<TriangleBVH>> meshBVHs;
+	std::unique_ptr<SceneBVH> sceneBVH;
+	std::vector<SceneModel> sceneModels;
+	std::unique_ptr<FrustumCuller> solidCuller;
+	std::vector<size_t> cullingVisibleSolids;
+
+	std::unique_ptr<OcclusionCuller> occlusionCuller;
+	std::vector<OccluderSolid> occluderSolids;
+	bool occlusionCulling;
+	bool occlusionPending;
+	bool keepMeshData;
 	LightCollection lights;
 	SoundCollection sounds;
 
+	SlotMap<SolidSlot, SolidSim> solidSlots;
+	SlotMap<LightSim*, LightSim> lightSlots;
+	SlotMap<SoundSlot, SoundSim> soundSlots;
+	std::map<LightTypes, std::map<std::string, LightHandle>> lightHandles;
+	std::map<std::string, SoundHandle> soundHandles;
+	// Point lights that had a shadow map created for them last frame
+	std::vector<std::string> shadowCasters;
+
 	static LightShaderValueNames lightShaderValueNames;
 	static std::vector<std::string> objectTypes;
 
+	// Should match SHADOW_MAX_AMOUNT in lightComb.frag
+	constexpr static int maxShadowCasters = 4;
+	constexpr static int shadowMapSize = 1024;
+	constexpr static float shadowNearPlane = 0.1f;
+	constexpr static float shadowFarPlane = 100.0f;
+
+	// Smaller solids are not worth rasterizing as occluders, nearest ones are taken first
+	constexpr static float occluderMinSize = 1.0f;
+	constexpr static size_t maxOccluders = 512;
+
 	std::unique_ptr<CameraSim> camera;
 };
\ No newline at end of file
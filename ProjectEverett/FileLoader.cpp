@@ -1,5 +1,9 @@
 #include <iostream>
 #include <map>
+#include <algorithm>
+#include <cmath>
+
+#define NOMINMAX
 #include <Windows.h>
 
 #include <assimp/Importer.hpp>
@@ -7,6 +11,8 @@
 #include "assimp/postprocess.h"
 
 #include "FileLoader.h"
+#include "MeshSimplifier.h"
+#include "TriangleBVH.h"
 
 #include "stb_image.h"
 
@@ -83,7 +89,10 @@ bool FileLoader::LoadTexture(
 	return false;
 }
 
-FileLoader::FileLoader() {}
+FileLoader::FileLoader()
+{
+	lodLevels = { { 0.5f, 0.01f }, { 0.25f, 0.03f }, { 0.125f, 0.08f } };
+}
 
 FileLoader::~FileLoader()
 {
@@ -262,15 +271,250 @@ LGLStructs::Mesh FileLoader::ProcessMesh(const aiMesh* meshHandle)
 		}
 	};
 
+	auto ProcessOpacity = [this, &meshHandle](LGLStructs::Mesh& mesh)
+	{
+		aiMaterial* material = modelHandle->mMaterials[meshHandle->mMaterialIndex];
+
+		float opacity = 1.0f;
+		aiColor4D diffuseColor;
+
+		if (material->Get(AI_MATKEY_OPACITY, opacity) == aiReturn_SUCCESS)
+		{
+			mesh.opacity = opacity;
+		}
+		else if (material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColor) == aiReturn_SUCCESS)
+		{
+			mesh.opacity = diffuseColor.a;
+		}
+	};
+
 	LGLStructs::Mesh mesh;
 
 	ProcessVerteces(mesh);
 	ProcessFaces(mesh);
 	ProcessTextures(mesh);
+	ProcessOpacity(mesh);
+	ComputeBounds(mesh);
+	BuildLODs(mesh);
+	BuildMeshlets(mesh);
 
 	return mesh;
 }
 
+void FileLoader::ComputeBounds(LGLStructs::Mesh& mesh)
+{
+	if (mesh.vert.empty())
+	{
+		return;
+	}
+
+	mesh.boundsMin = mesh.vert.front().Position;
+	mesh.boundsMax = mesh.boundsMin;
+
+	for (auto& vert : mesh.vert)
+	{
+		mesh.boundsMin = glm::min(mesh.boundsMin, vert.Position);
+		mesh.boundsMax = glm::max(mesh.boundsMax, vert.Position);
+	}
+
+	glm::vec3 center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+	float radius = 0.0f;
+
+	for (auto& vert : mesh.vert)
+	{
+		radius = std::max(radius, glm::length(vert.Position - center));
+	}
+
+	mesh.boundingSphere = glm::vec4(center, radius);
+}
+
+void FileLoader::BuildMeshlets(LGLStructs::Mesh& mesh)
+{
+	size_t triangleAmount = mesh.indices.size() / 3;
+
+	// Small meshes gain nothing from being split
+	if (triangleAmount < meshletMaxTriangles * 2)
+	{
+		return;
+	}
+
+	auto GetTrianglePoint = [&mesh](size_t triangle, size_t corner) -> glm::vec3&
+	{
+		return mesh.vert[mesh.indices[triangle * 3 + corner]].Position;
+	};
+
+	std::vector<glm::vec3> triangleNormals(triangleAmount);
+	std::vector<std::vector<unsigned int>> vertexTriangles(mesh.vert.size());
+
+	for (size_t triangle = 0; triangle < triangleAmount; ++triangle)
+	{
+		glm::vec3 normal = glm::cross(
+			GetTrianglePoint(triangle, 1) - GetTrianglePoint(triangle, 0), 
+			GetTrianglePoint(triangle, 2) - GetTrianglePoint(triangle, 0)
+		);
+		float normalLength = glm::length(normal);
+		triangleNormals[triangle] = normalLength > 0.0f ? normal / normalLength : glm::vec3(0.0f);
+
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			vertexTriangles[mesh.indices[triangle * 3 + corner]].push_back(static_cast<unsigned int>(triangle));
+		}
+	}
+
+	constexpr unsigned int notVisited = static_cast<unsigned int>(-1);
+
+	std::vector<bool> assigned(triangleAmount, false);
+	std::vector<unsigned int> candidateOf(triangleAmount, notVisited); // Meshlet the triangle is a candidate of
+	std::vector<unsigned int> newIndices;
+	newIndices.reserve(mesh.indices.size());
+
+	size_t seed = 0;
+
+	while (true)
+	{
+		while (seed < triangleAmount && assigned[seed])
+		{
+			++seed;
+		}
+
+		if (seed == triangleAmount)
+		{
+			break;
+		}
+
+		unsigned int meshletIndex = static_cast<unsigned int>(mesh.meshlets.size());
+
+		std::vector<unsigned int> meshletTriangles;
+		std::vector<unsigned int> candidates{ static_cast<unsigned int>(seed) };
+		candidateOf[seed] = meshletIndex;
+		glm::vec3 normalSum(0.0f);
+
+		// Growing through shared vertices, candidate closest to the average normal goes first to keep cones narrow
+		while (!candidates.empty() && meshletTriangles.size() < meshletMaxTriangles)
+		{
+			size_t bestCandidate = 0;
+			float bestScore = -2.0f;
+
+			for (size_t i = 0; i < candidates.size(); ++i)
+			{
+				float score = glm::dot(triangleNormals[candidates[i]], normalSum);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestCandidate = i;
+				}
+			}
+
+			unsigned int triangle = candidates[bestCandidate];
+			candidates[bestCandidate] = candidates.back();
+			candidates.pop_back();
+
+			assigned[triangle] = true;
+			meshletTriangles.push_back(triangle);
+			normalSum += triangleNormals[triangle];
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				for (unsigned int neighbour : vertexTriangles[mesh.indices[triangle * 3 + corner]])
+				{
+					if (!assigned[neighbour] && candidateOf[neighbour] != meshletIndex)
+					{
+						candidateOf[neighbour] = meshletIndex;
+						candidates.push_back(neighbour);
+					}
+				}
+			}
+		}
+
+		LGLStructs::Meshlet meshlet;
+		meshlet.indexOffset = static_cast<unsigned int>(newIndices.size());
+		meshlet.indexAmount = static_cast<unsigned int>(meshletTriangles.size() * 3);
+
+		glm::vec3 minPoint = GetTrianglePoint(meshletTriangles.front(), 0);
+		glm::vec3 maxPoint = minPoint;
+
+		for (unsigned int triangle : meshletTriangles)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				newIndices.push_back(mesh.indices[triangle * 3 + corner]);
+				minPoint = glm::min(minPoint, GetTrianglePoint(triangle, corner));
+				maxPoint = glm::max(maxPoint, GetTrianglePoint(triangle, corner));
+			}
+		}
+
+		glm::vec3 center = (minPoint + maxPoint) * 0.5f;
+		float radius = 0.0f;
+		for (unsigned int triangle : meshletTriangles)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				radius = std::max(radius, glm::length(GetTrianglePoint(triangle, corner) - center));
+			}
+		}
+		meshlet.boundingSphere = glm::vec4(center, radius);
+
+		// Cutoff is sine of the widest angle between the axis and a face normal,
+		// cones of 90 degrees and wider can not be back facing as a whole
+		float axisLength = glm::length(normalSum);
+		glm::vec3 axis = axisLength > 0.0f ? normalSum / axisLength : glm::vec3(0.0f);
+		float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+
+		for (unsigned int triangle : meshletTriangles)
+		{
+			if (triangleNormals[triangle] != glm::vec3(0.0f))
+			{
+				minDot = std::min(minDot, glm::dot(axis, triangleNormals[triangle]));
+			}
+		}
+
+		meshlet.cone = glm::vec4(axis, minDot > 0.0f ? std::sqrt(1.0f - minDot * minDot) : 1.0f);
+
+		mesh.meshlets.push_back(meshlet);
+	}
+
+	mesh.indices = std::move(newIndices);
+}
+
+void FileLoader::BuildLODs(LGLStructs::Mesh& mesh)
+{
+	size_t triangleAmount = mesh.indices.size() / 3;
+
+	if (triangleAmount < lodMinTriangles || mesh.boundingSphere.w <= 0.0f)
+	{
+		return;
+	}
+
+	std::vector<glm::vec3> positions;
+	positions.reserve(mesh.vert.size());
+
+	for (auto& vert : mesh.vert)
+	{
+		positions.push_back(vert.Position);
+	}
+
+	MeshSimplifier simplifier(positions, mesh.indices);
+	size_t previousTriangles = triangleAmount;
+
+	for (auto& level : lodLevels)
+	{
+		size_t targetTriangles = static_cast<size_t>(triangleAmount * level.triangleRatio);
+		size_t lodTriangles = simplifier.Simplify(targetTriangles, level.maxError * mesh.boundingSphere.w);
+
+		if (lodTriangles > previousTriangles * (1.0f - lodMinReduction))
+		{
+			break;
+		}
+
+		LGLStructs::MeshLOD lod;
+		simplifier.GetIndices(lod.indices);
+		lod.error = simplifier.GetError();
+
+		mesh.lods.push_back(std::move(lod));
+		previousTriangles = lodTriangles;
+	}
+}
+
 void FileLoader::ProcessNode(const aiNode* nodeHandle, LGLStructs::ModelInfo& model)
 {
 	for (size_t i = 0; i < nodeHandle->mNumMeshes; ++i)
@@ -296,7 +540,17 @@ void FileLoader::FreeTextureData()
 	texturesLoaded.clear();
 }
 
-bool FileLoader::LoadModel(const std::string& file, const std::string& name, LGLStructs::ModelInfo& model)
+void FileLoader::SetLODLevels(const std::vector<LGLStructs::LODLevel>& levels)
+{
+	lodLevels = levels;
+}
+
+bool FileLoader::LoadModel(
+	const std::string& file,
+	const std::string& name,
+	LGLStructs::ModelInfo& model,
+	std::vector<TriangleBVH>* meshBVHs
+)
 {
 	Assimp::Importer importer;
 	modelHandle = importer.ReadFile(file, aiProcess_Triangulate | aiProcess_FlipUVs);
@@ -311,5 +565,25 @@ bool FileLoader::LoadModel(const std::string& file, const std::string& name, LGL
 	GetTextureFilenames(file);
 	ProcessNode(modelHandle->mRootNode, model);
 
+	// Built at import, vertices may be released once meshes are uploaded
+	if (meshBVHs)
+	{
+		meshBVHs->clear();
+		meshBVHs->reserve(model.meshes.size());
+
+		for (auto& meshInfo : model.meshes)
+		{
+			std::vector<glm::vec3> positions;
+			positions.reserve(meshInfo.mesh.vert.size());
+
+			for (auto& vert : meshInfo.mesh.vert)
+			{
+				positions.push_back(vert.Position);
+			}
+
+			meshBVHs->emplace_back(positions, meshInfo.mesh.indices);
+		}
+	}
+
 	return true;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 class aiScene;
 class aiMesh;
 class aiNode;
+class TriangleBVH;
 
 class FileLoader
 {
@@ -20,11 +21,31 @@ class FileLoader
 	void ProcessNode(const aiNode* nodeHandle, LGLStructs::ModelInfo& model);
 	bool GetTextureFilenames(const std::string& path);
 	LGLStructs::Mesh ProcessMesh(const aiMesh* meshHandle);
+	// AABB and a sphere around its center, both in model space
+	void ComputeBounds(LGLStructs::Mesh& mesh);
+	// Reorders indices into meshlets of up to meshletMaxTriangles triangles
+	void BuildMeshlets(LGLStructs::Mesh& mesh);
+	// Simplified index lists by lodLevels, bounds have to be computed first
+	void BuildLODs(LGLStructs::Mesh& mesh);
+
+	std::vector<LGLStructs::LODLevel> lodLevels;
+
+	constexpr static size_t meshletMaxTriangles = 124;
+	// Smaller meshes are cheap at any distance
+	constexpr static size_t lodMinTriangles = 256;
+	// Level that removes less than this part of the previous one ends the chain
+	constexpr static float lodMinReduction = 0.1f;
 public:
 	FileLoader();
 	~FileLoader();
 
-	bool LoadModel(const std::string& file, const std::string& name, LGLStructs::ModelInfo& model);
+	// BVHs of the meshes, in order of model.meshes, are built into meshBVHs if it is given
+	bool LoadModel(
+		const std::string& file,
+		const std::string& name,
+		LGLStructs::ModelInfo& model,
+		std::vector<TriangleBVH>* meshBVHs = nullptr
+	);
 	bool LoadTexture(
 		const std::string& file,
 		LGLStructs::Texture& texture, 
@@ -33,6 +54,8 @@ public:
 	);
 
 	void FreeTextureData();
+	// Levels for models loaded afterwards, empty disables LOD generation
+	void SetLODLevels(const std::vector<LGLStructs::LODLevel>& levels);
 	std::string GetCurrentDir();
 	bool GetFilesInDir(std::vector<std::string>& files, const std::string& dir);
 };
\ No newline at end of file
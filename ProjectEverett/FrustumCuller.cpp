@@ -0,0 +1,114 @@
+#include <emmintrin.h>
+#include <cmath>
+
+#include "FrustumCuller.h"
+
+void FrustumCuller::SetView(const glm::mat4& viewProj)
+{
+	// Gribb and Hartmann, as LGL extracts its culling planes
+	glm::mat4 rows = glm::transpose(viewProj);
+
+	planes = {
+		rows[3] + rows[0], rows[3] - rows[0],
+		rows[3] + rows[1], rows[3] - rows[1],
+		rows[3] + rows[2], rows[3] - rows[2]
+	};
+
+	for (auto& plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+void FrustumCuller::Clear()
+{
+	boxAmount = 0;
+
+	for (auto* soaArray : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ })
+	{
+		soaArray->clear();
+	}
+}
+
+void FrustumCuller::AddBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model)
+{
+	// Padding lanes stay zero sized, they are skipped after the test
+	if (boxAmount % 4 == 0)
+	{
+		for (auto* soaArray : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ })
+		{
+			soaArray->resize(boxAmount + 4, 0.0f);
+		}
+	}
+
+	// Extent of the transformed box along each world axis is the sum of absolute contributions (Arvo)
+	glm::vec3 center = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+	glm::vec3 localExtent = (boundsMax - boundsMin) * 0.5f;
+	glm::vec3 extent(0.0f);
+
+	for (int column = 0; column < 3; ++column)
+	{
+		extent += glm::abs(glm::vec3(model[column])) * localExtent[column];
+	}
+
+	centerX[boxAmount] = center.x;
+	centerY[boxAmount] = center.y;
+	centerZ[boxAmount] = center.z;
+	extentX[boxAmount] = extent.x;
+	extentY[boxAmount] = extent.y;
+	extentZ[boxAmount] = extent.z;
+
+	++boxAmount;
+}
+
+size_t FrustumCuller::Cull(std::vector<size_t>& visible) const
+{
+	visible.clear();
+
+	const __m128 allVisible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+	for (size_t base = 0; base < boxAmount; base += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&centerX[base]);
+		__m128 cy = _mm_loadu_ps(&centerY[base]);
+		__m128 cz = _mm_loadu_ps(&centerZ[base]);
+		__m128 ex = _mm_loadu_ps(&extentX[base]);
+		__m128 ey = _mm_loadu_ps(&extentY[base]);
+		__m128 ez = _mm_loadu_ps(&extentZ[base]);
+
+		__m128 isVisible = allVisible;
+
+		for (const glm::vec4& plane : planes)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w))
+			);
+
+			// Projection of the box extent onto the plane normal
+			__m128 radius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), ex), _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), ey)),
+				_mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), ez)
+			);
+
+			isVisible = _mm_and_ps(isVisible, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+		}
+
+		int visibleMask = _mm_movemask_ps(isVisible);
+
+		for (size_t lane = 0; lane < 4 && base + lane < boxAmount; ++lane)
+		{
+			if (visibleMask & (1 << lane))
+			{
+				visible.push_back(base + lane);
+			}
+		}
+	}
+
+	return visible.size();
+}
+
+size_t FrustumCuller::GetBoxAmount() const
+{
+	return boxAmount;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+/*
+	Culling of solids against the camera frustum
+
+	World space AABBs are kept as structure of arrays padded to a multiple of 4,
+	so 4 boxes are tested against a plane at once with SSE. Box is culled only if
+	it is fully behind one of the planes, boxes near frustum corners are kept
+*/
+class FrustumCuller
+{
+public:
+	// Planes are taken from rows of the matrix
+	void SetView(const glm::mat4& viewProj);
+
+	void Clear();
+	// Model space box is moved by model, the box around the result is tested
+	void AddBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model);
+
+	// Fills indices of visible boxes in the order they were added, returns their amount
+	size_t Cull(std::vector<size_t>& visible) const;
+
+	size_t GetBoxAmount() const;
+
+private:
+	std::array<glm::vec4, 6> planes = {};
+
+	size_t boxAmount = 0;
+
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> extentX;
+	std::vector<float> extentY;
+	std::vector<float> extentZ;
+};
@@ -55,6 +55,31 @@ LightSim::Attenuation LightSim::GetAttenuation()
 	return GetAttenuation(lightRange);
 }
 
+std::vector<glm::mat4> LightSim::GetShadowCubeMatrices(float nearPlane, float farPlane)
+{
+	static const std::vector<std::pair<glm::vec3, glm::vec3>> faceDirections
+	{
+		{ {  1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } },
+		{ { -1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } },
+		{ {  0.0f,  1.0f,  0.0f }, { 0.0f,  0.0f,  1.0f } },
+		{ {  0.0f, -1.0f,  0.0f }, { 0.0f,  0.0f, -1.0f } },
+		{ {  0.0f,  0.0f,  1.0f }, { 0.0f, -1.0f,  0.0f } },
+		{ {  0.0f,  0.0f, -1.0f }, { 0.0f, -1.0f,  0.0f } }
+	};
+
+	glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+	glm::vec3& position = GetPositionVectorAddr();
+
+	std::vector<glm::mat4> shadowMatrices;
+
+	for (auto& faceDirection : faceDirections)
+	{
+		shadowMatrices.push_back(proj * glm::lookAt(position, position + faceDirection.first, faceDirection.second));
+	}
+
+	return shadowMatrices;
+}
+
 std::vector<std::string> LightSim::GetLightTypeNames()
 {
 	std::vector<std::string> lightTypeNamesVect;
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "SolidSim.h"
 
@@ -41,6 +42,9 @@ public:
 
 	static Attenuation GetAttenuation(int range);
 	Attenuation GetAttenuation();
+
+	// Light space matrices for cube shadow map faces, in GL_TEXTURE_CUBE_MAP_POSITIVE_X + i order
+	std::vector<glm::mat4> GetShadowCubeMatrices(float nearPlane, float farPlane);
 private:
 	static std::map<int, Attenuation> attenuationVals;
 	static std::map<LightTypes, std::string> lightTypeNames;
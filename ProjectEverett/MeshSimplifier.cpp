@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+#include <array>
+#include <cmath>
+
+#include "MeshSimplifier.h"
+
+void MeshSimplifier::Quadric::AddPlane(const glm::dvec3& normal, double distance, double planeWeight)
+{
+	a00 += planeWeight * normal.x * normal.x;
+	a01 += planeWeight * normal.x * normal.y;
+	a02 += planeWeight * normal.x * normal.z;
+	a11 += planeWeight * normal.y * normal.y;
+	a12 += planeWeight * normal.y * normal.z;
+	a22 += planeWeight * normal.z * normal.z;
+	b0 += planeWeight * normal.x * distance;
+	b1 += planeWeight * normal.y * distance;
+	b2 += planeWeight * normal.z * distance;
+	c += planeWeight * distance * distance;
+	weight += planeWeight;
+}
+
+void MeshSimplifier::Quadric::Add(const Quadric& quadric)
+{
+	a00 += quadric.a00;
+	a01 += quadric.a01;
+	a02 += quadric.a02;
+	a11 += quadric.a11;
+	a12 += quadric.a12;
+	a22 += quadric.a22;
+	b0 += quadric.b0;
+	b1 += quadric.b1;
+	b2 += quadric.b2;
+	c += quadric.c;
+	weight += quadric.weight;
+}
+
+double MeshSimplifier::Quadric::Evaluate(const glm::dvec3& point) const
+{
+	double x = point.x;
+	double y = point.y;
+	double z = point.z;
+
+	return a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z +
+		a11 * y * y + 2.0 * a12 * y * z + a22 * z * z +
+		2.0 * (b0 * x + b1 * y + b2 * z) + c;
+}
+
+MeshSimplifier::MeshSimplifier(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices)
+	: positions(positions), triangles(indices), removedTriangles(indices.size() / 3, false),
+	triangleAmount(indices.size() / 3), vertexTriangles(positions.size()), quadrics(positions.size()),
+	lockedVertices(positions.size(), false), collapsedVertices(positions.size(), false),
+	versions(positions.size(), 0), maxCost(0.0f)
+{
+	// Vertices with equal positions are one vertex of the surface, with different attributes
+	std::map<std::array<float, 3>, unsigned int> weldedIds;
+	std::vector<unsigned int> welded(positions.size());
+
+	for (size_t vertex = 0; vertex < positions.size(); ++vertex)
+	{
+		const glm::vec3& position = positions[vertex];
+		auto weldedIter = weldedIds.emplace(std::array<float, 3>{ position.x, position.y, position.z }, static_cast<unsigned int>(vertex));
+		welded[vertex] = weldedIter.first->second;
+	}
+
+	std::vector<unsigned int> referencedBy(positions.size(), static_cast<unsigned int>(-1));
+
+	for (unsigned int index : triangles)
+	{
+		unsigned int& firstReference = referencedBy[welded[index]];
+
+		if (firstReference == static_cast<unsigned int>(-1))
+		{
+			firstReference = index;
+		}
+		else if (firstReference != index)
+		{
+			lockedVertices[index] = true;
+			lockedVertices[firstReference] = true;
+		}
+	}
+
+	// Edges used by one triangle are borders, by more than two are not manifold
+	std::unordered_map<unsigned long long, int> edgeUses;
+
+	auto GetEdgeKey = [&welded](unsigned int first, unsigned int second)
+	{
+		unsigned long long low = std::min(welded[first], welded[second]);
+		unsigned long long high = std::max(welded[first], welded[second]);
+		return (high << 32) | low;
+	};
+
+	for (size_t triangle = 0; triangle < triangleAmount; ++triangle)
+	{
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			++edgeUses[GetEdgeKey(triangles[triangle * 3 + corner], triangles[triangle * 3 + (corner + 1) % 3])];
+		}
+	}
+
+	for (size_t triangle = 0; triangle < triangleAmount; ++triangle)
+	{
+		const unsigned int* corners = &triangles[triangle * 3];
+
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			unsigned int first = corners[corner];
+			unsigned int second = corners[(corner + 1) % 3];
+
+			if (edgeUses[GetEdgeKey(first, second)] != 2)
+			{
+				lockedVertices[first] = true;
+				lockedVertices[second] = true;
+			}
+
+			vertexTriangles[first].push_back(static_cast<unsigned int>(triangle));
+		}
+
+		// Area weighted, so small slivers do not outweigh large faces
+		glm::dvec3 p0 = positions[corners[0]];
+		glm::dvec3 normal = glm::cross(glm::dvec3(positions[corners[1]]) - p0, glm::dvec3(positions[corners[2]]) - p0);
+		double doubleArea = glm::length(normal);
+
+		if (doubleArea > 0.0)
+		{
+			normal /= doubleArea;
+
+			Quadric plane;
+			plane.AddPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				quadrics[corners[corner]].Add(plane);
+			}
+		}
+	}
+
+	for (size_t triangle = 0; triangle < triangleAmount; ++triangle)
+	{
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			PushCollapse(triangles[triangle * 3 + corner], triangles[triangle * 3 + (corner + 1) % 3]);
+			PushCollapse(triangles[triangle * 3 + (corner + 1) % 3], triangles[triangle * 3 + corner]);
+		}
+	}
+}
+
+size_t MeshSimplifier::Simplify(size_t targetTriangles, float maxError)
+{
+	float maxAllowedCost = maxError * maxError;
+
+	while (triangleAmount > targetTriangles && !collapseHeap.empty())
+	{
+		std::pop_heap(collapseHeap.begin(), collapseHeap.end());
+		Collapse collapse = collapseHeap.back();
+		collapseHeap.pop_back();
+
+		if (collapsedVertices[collapse.from] || collapsedVertices[collapse.to] ||
+			versions[collapse.from] != collapse.fromVersion || versions[collapse.to] != collapse.toVersion)
+		{
+			continue;
+		}
+
+		if (collapse.cost > maxAllowedCost)
+		{
+			// Kept for a later call with a larger error
+			collapseHeap.push_back(collapse);
+			std::push_heap(collapseHeap.begin(), collapseHeap.end());
+			break;
+		}
+
+		if (FlipsTriangle(collapse.from, collapse.to))
+		{
+			continue;
+		}
+
+		ApplyCollapse(collapse.from, collapse.to);
+		maxCost = std::max(maxCost, collapse.cost);
+	}
+
+	return triangleAmount;
+}
+
+void MeshSimplifier::GetIndices(std::vector<unsigned int>& indices) const
+{
+	indices.clear();
+	indices.reserve(triangleAmount * 3);
+
+	for (size_t triangle = 0; triangle < removedTriangles.size(); ++triangle)
+	{
+		if (!removedTriangles[triangle])
+		{
+			indices.insert(indices.end(), &triangles[triangle * 3], &triangles[triangle * 3] + 3);
+		}
+	}
+}
+
+float MeshSimplifier::GetError() const
+{
+	return std::sqrt(maxCost);
+}
+
+void MeshSimplifier::PushCollapses(unsigned int vertex)
+{
+	for (unsigned int triangle : vertexTriangles[vertex])
+	{
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			unsigned int neighbour = triangles[triangle * 3 + corner];
+
+			if (neighbour != vertex)
+			{
+				PushCollapse(vertex, neighbour);
+				PushCollapse(neighbour, vertex);
+			}
+		}
+	}
+}
+
+void MeshSimplifier::PushCollapse(unsigned int from, unsigned int to)
+{
+	if (lockedVertices[from])
+	{
+		return;
+	}
+
+	Quadric quadric = quadrics[from];
+	quadric.Add(quadrics[to]);
+
+	// Mean squared distance to the planes of both vertices, so the error is a distance
+	double cost = quadric.weight > 0.0 ? std::max(quadric.Evaluate(positions[to]) / quadric.weight, 0.0) : 0.0;
+
+	collapseHeap.push_back({ static_cast<float>(cost), from, to, versions[from], versions[to] });
+	std::push_heap(collapseHeap.begin(), collapseHeap.end());
+}
+
+bool MeshSimplifier::FlipsTriangle(unsigned int from, unsigned int to) const
+{
+	for (unsigned int triangle : vertexTriangles[from])
+	{
+		if (removedTriangles[triangle])
+		{
+			continue;
+		}
+
+		const unsigned int* corners = &triangles[triangle * 3];
+
+		if (corners[0] == to || corners[1] == to || corners[2] == to)
+		{
+			continue;
+		}
+
+		std::array<glm::vec3, 3> points;
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			points[corner] = positions[corners[corner]];
+		}
+
+		glm::vec3 oldNormal = glm::cross(points[1] - points[0], points[2] - points[0]);
+
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			if (corners[corner] == from)
+			{
+				points[corner] = positions[to];
+			}
+		}
+
+		glm::vec3 newNormal = glm::cross(points[1] - points[0], points[2] - points[0]);
+
+		if (glm::dot(oldNormal, newNormal) <= 0.0f)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void MeshSimplifier::ApplyCollapse(unsigned int from, unsigned int to)
+{
+	for (unsigned int triangle : vertexTriangles[from])
+	{
+		if (removedTriangles[triangle])
+		{
+			continue;
+		}
+
+		unsigned int* corners = &triangles[triangle * 3];
+
+		if (corners[0] == to || corners[1] == to || corners[2] == to)
+		{
+			removedTriangles[triangle] = true;
+			--triangleAmount;
+			continue;
+		}
+
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			if (corners[corner] == from)
+			{
+				corners[corner] = to;
+			}
+		}
+
+		vertexTriangles[to].push_back(triangle);
+	}
+
+	std::vector<unsigned int>& toTriangles = vertexTriangles[to];
+	toTriangles.erase(
+		std::remove_if(toTriangles.begin(), toTriangles.end(), [this](unsigned int triangle) { return removedTriangles[triangle]; }),
+		toTriangles.end()
+	);
+
+	vertexTriangles[from].clear();
+	vertexTriangles[from].shrink_to_fit();
+	collapsedVertices[from] = true;
+
+	quadrics[to].Add(quadrics[from]);
+	++versions[to];
+
+	PushCollapses(to);
+}
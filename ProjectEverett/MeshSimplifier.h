@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+/*
+	Quadric error metric simplification (Garland and Heckbert)
+
+	Edges are collapsed cheapest first, one vertex is moved onto the other one, so the
+	result only indexes vertices of the source mesh and keeps their attributes. Vertices
+	on borders and on attribute seams (same position under several indices) are never moved,
+	so the outline and texture seams stay intact. Collapses that flip a triangle are skipped.
+
+	Simplify can be called again with a lower target, it continues from the current state,
+	which is how a LOD chain is built from one simplifier
+*/
+class MeshSimplifier
+{
+public:
+	MeshSimplifier(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices);
+
+	// Collapses until triangle amount is at most targetTriangles or the next collapse
+	// would move the surface by more than maxError, returns the triangle amount
+	size_t Simplify(size_t targetTriangles, float maxError);
+
+	void GetIndices(std::vector<unsigned int>& indices) const;
+	// Largest distance the surface moved by so far, in units of the positions
+	float GetError() const;
+
+private:
+	// Symmetric matrix of (p^T A p + 2 b.p + c) sum of squared distances to planes
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		void AddPlane(const glm::dvec3& normal, double distance, double planeWeight);
+		void Add(const Quadric& quadric);
+		double Evaluate(const glm::dvec3& point) const;
+	};
+
+	struct Collapse
+	{
+		float cost;
+		unsigned int from;
+		unsigned int to;
+		unsigned int fromVersion;
+		unsigned int toVersion;
+
+		bool operator<(const Collapse& collapse) const
+		{
+			// Priority queue pops the largest element
+			return cost > collapse.cost;
+		}
+	};
+
+	void PushCollapses(unsigned int vertex);
+	void PushCollapse(unsigned int from, unsigned int to);
+	bool FlipsTriangle(unsigned int from, unsigned int to) const;
+	void ApplyCollapse(unsigned int from, unsigned int to);
+
+	const std::vector<glm::vec3>& positions;
+
+	std::vector<unsigned int> triangles; // 3 vertex indices each
+	std::vector<char> removedTriangles;
+	size_t triangleAmount;
+
+	std::vector<std::vector<unsigned int>> vertexTriangles;
+	std::vector<Quadric> quadrics;
+	std::vector<char> lockedVertices;
+	std::vector<char> collapsedVertices;
+	std::vector<unsigned int> versions;
+
+	std::vector<Collapse> collapseHeap;
+	float maxCost;
+};
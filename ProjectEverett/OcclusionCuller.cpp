@@ -0,0 +1,444 @@
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "OcclusionCuller.h"
+
+namespace
+{
+	// Box corners are indexed by bits, 1 for x, 2 for y and 4 for z of the max corner
+	const unsigned int boxTriangles[] =
+	{
+		0, 2, 1, 1, 2, 3, // -z
+		4, 5, 6, 5, 7, 6, // +z
+		0, 1, 4, 1, 5, 4, // -y
+		2, 6, 3, 3, 6, 7, // +y
+		0, 4, 2, 2, 4, 6, // -x
+		1, 3, 5, 3, 7, 5  // +x
+	};
+
+	// Coarse level of a candidate is refined this many times at most
+	constexpr int maxRefineLevels = 2;
+}
+
+OcclusionCuller::OcclusionCuller()
+{
+	viewProj = glm::mat4(1.0f);
+	occludedAmount = 0;
+
+	frameStarted = false;
+	frameDone = true;
+	workerStop = false;
+
+	int width = depthWidth;
+	int height = depthHeight;
+
+	while (true)
+	{
+		levelSizes.push_back({ width, height });
+		minDepth.emplace_back(static_cast<size_t>(width) * height, 1.0f);
+		maxDepth.emplace_back(static_cast<size_t>(width) * height, 1.0f);
+
+		if (width == 1 && height == 1)
+		{
+			break;
+		}
+
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+
+	workerThread = std::make_unique<std::thread>([this]() { Worker(); });
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		workerStop = true;
+	}
+	workerCondition.notify_all();
+
+	workerThread->join();
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProj)
+{
+	Wait();
+
+	this->viewProj = viewProj;
+
+	occluders.clear();
+	occluderVertices.clear();
+	candidates.clear();
+	visibility.clear();
+	occludedAmount = 0;
+}
+
+void OcclusionCuller::AddOccluder(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model)
+{
+	occluders.push_back({ occluderVertices.size(), sizeof(boxTriangles) / sizeof(boxTriangles[0]), model });
+
+	for (unsigned int corner : boxTriangles)
+	{
+		occluderVertices.emplace_back(
+			corner & 1 ? boundsMax.x : boundsMin.x,
+			corner & 2 ? boundsMax.y : boundsMin.y,
+			corner & 4 ? boundsMax.z : boundsMin.z
+		);
+	}
+}
+
+void OcclusionCuller::AddOccluderMesh(
+	const std::vector<glm::vec3>& vertices,
+	const std::vector<unsigned int>& indices,
+	const glm::mat4& model
+)
+{
+	occluders.push_back({ occluderVertices.size(), indices.size() / 3 * 3, model });
+
+	for (size_t i = 0; i < indices.size() / 3 * 3; ++i)
+	{
+		occluderVertices.push_back(vertices[indices[i]]);
+	}
+}
+
+size_t OcclusionCuller::AddCandidate(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model)
+{
+	candidates.push_back({ boundsMin, boundsMax, model });
+
+	return candidates.size() - 1;
+}
+
+void OcclusionCuller::Start()
+{
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		frameStarted = true;
+		frameDone = false;
+	}
+	workerCondition.notify_all();
+}
+
+void OcclusionCuller::Wait()
+{
+	std::unique_lock<std::mutex> lock(workerMutex);
+	workerCondition.wait(lock, [this]() { return frameDone; });
+}
+
+bool OcclusionCuller::IsVisible(size_t candidate) const
+{
+	return candidate >= visibility.size() || visibility[candidate];
+}
+
+size_t OcclusionCuller::GetOccludedAmount() const
+{
+	return occludedAmount;
+}
+
+void OcclusionCuller::Worker()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(workerMutex);
+			workerCondition.wait(lock, [this]() { return frameStarted || workerStop; });
+
+			if (workerStop)
+			{
+				frameDone = true;
+				workerCondition.notify_all();
+				return;
+			}
+
+			frameStarted = false;
+		}
+
+		RenderOccluders();
+		BuildPyramid();
+
+		visibility.resize(candidates.size());
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			visibility[i] = TestCandidate(candidates[i]);
+			occludedAmount += !visibility[i];
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(workerMutex);
+			frameDone = true;
+		}
+		workerCondition.notify_all();
+	}
+}
+
+void OcclusionCuller::RenderOccluders()
+{
+	std::fill(minDepth[0].begin(), minDepth[0].end(), 1.0f);
+
+	auto ToScreen = [](const glm::vec4& clip)
+	{
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+		return glm::vec3(
+			(ndc.x * 0.5f + 0.5f) * depthWidth,
+			(ndc.y * 0.5f + 0.5f) * depthHeight,
+			ndc.z * 0.5f + 0.5f
+		);
+	};
+
+	for (const Occluder& occluder : occluders)
+	{
+		glm::mat4 modelViewProj = viewProj * occluder.model;
+
+		for (size_t vertex = occluder.firstVertex; vertex < occluder.firstVertex + occluder.vertexAmount; vertex += 3)
+		{
+			std::array<glm::vec4, 3> triangle;
+			std::array<float, 3> nearDistance;
+			int insideAmount = 0;
+
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				triangle[corner] = modelViewProj * glm::vec4(occluderVertices[vertex + corner], 1.0f);
+				nearDistance[corner] = triangle[corner].z + triangle[corner].w;
+				insideAmount += nearDistance[corner] >= 0.0f;
+			}
+
+			if (insideAmount == 3)
+			{
+				RasterizeTriangle(ToScreen(triangle[0]), ToScreen(triangle[1]), ToScreen(triangle[2]));
+				continue;
+			}
+			else if (!insideAmount)
+			{
+				continue;
+			}
+
+			// Clipped by the near plane into a polygon of up to 4 vertices
+			std::array<glm::vec4, 4> polygon;
+			int polygonSize = 0;
+
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				int next = (corner + 1) % 3;
+
+				if (nearDistance[corner] >= 0.0f)
+				{
+					polygon[polygonSize++] = triangle[corner];
+				}
+				if ((nearDistance[corner] >= 0.0f) != (nearDistance[next] >= 0.0f))
+				{
+					float t = nearDistance[corner] / (nearDistance[corner] - nearDistance[next]);
+					polygon[polygonSize++] = glm::mix(triangle[corner], triangle[next], t);
+				}
+			}
+
+			for (int corner = 2; corner < polygonSize; ++corner)
+			{
+				RasterizeTriangle(ToScreen(polygon[0]), ToScreen(polygon[corner - 1]), ToScreen(polygon[corner]));
+			}
+		}
+	}
+}
+
+void OcclusionCuller::RasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+{
+	auto Edge = [](const glm::vec3& from, const glm::vec3& to, const glm::vec3& point)
+	{
+		return (to.x - from.x) * (point.y - from.y) - (to.y - from.y) * (point.x - from.x);
+	};
+
+	float area = Edge(v0, v1, v2);
+
+	// Both windings are drawn, occluders do not have to be closed or consistently wound
+	if (area < 0.0f)
+	{
+		std::swap(v1, v2);
+		area = -area;
+	}
+	if (area < 1e-6f)
+	{
+		return;
+	}
+
+	int minX = std::max(0, static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))));
+	int maxX = std::min(depthWidth - 1, static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))));
+	int minY = std::max(0, static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))));
+	int maxY = std::min(depthHeight - 1, static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))));
+
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+
+	// Rows are walked 4 pixels at a time from a 4 aligned column, depthWidth is a multiple of 4
+	minX &= ~3;
+
+	// Edge function of the edge opposite to a vertex is a * x + b * y + c, positive inside
+	glm::vec3 a(v1.y - v2.y, v2.y - v0.y, v0.y - v1.y);
+	glm::vec3 b(v2.x - v1.x, v0.x - v2.x, v1.x - v0.x);
+	glm::vec3 c(
+		v1.x * v2.y - v2.x * v1.y,
+		v2.x * v0.y - v0.x * v2.y,
+		v0.x * v1.y - v1.x * v0.y
+	);
+
+	// Depth is interpolated with the edge functions divided by the area
+	glm::vec3 depths(v0.z, v1.z, v2.z);
+	float depthA = glm::dot(a, depths) / area;
+	float depthB = glm::dot(b, depths) / area;
+	float depthC = glm::dot(c, depths) / area;
+
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		float pixelY = y + 0.5f;
+		float* row = &minDepth[0][static_cast<size_t>(y) * depthWidth];
+
+		__m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(minX)), laneOffsets);
+
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			__m128 edge0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.x), pixelX), _mm_set1_ps(b.x * pixelY + c.x));
+			__m128 edge1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.y), pixelX), _mm_set1_ps(b.y * pixelY + c.y));
+			__m128 edge2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.z), pixelX), _mm_set1_ps(b.z * pixelY + c.z));
+
+			__m128 inside = _mm_and_ps(
+				_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)),
+				_mm_cmpge_ps(edge2, zero)
+			);
+
+			if (_mm_movemask_ps(inside))
+			{
+				__m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), pixelX), _mm_set1_ps(depthB * pixelY + depthC));
+				__m128 stored = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(stored, depth);
+
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, stored)));
+			}
+
+			pixelX = _mm_add_ps(pixelX, _mm_set1_ps(4.0f));
+		}
+	}
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+	std::copy(minDepth[0].begin(), minDepth[0].end(), maxDepth[0].begin());
+
+	for (size_t level = 1; level < levelSizes.size(); ++level)
+	{
+		int width = levelSizes[level][0];
+		int height = levelSizes[level][1];
+		int parentWidth = levelSizes[level - 1][0];
+		int parentHeight = levelSizes[level - 1][1];
+
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				float levelMin = 1.0f;
+				float levelMax = 0.0f;
+
+				// Odd parent sizes leave a last column or row which is folded into the last texel
+				int lastX = x == width - 1 ? parentWidth - 1 : x * 2 + 1;
+				int lastY = y == height - 1 ? parentHeight - 1 : y * 2 + 1;
+
+				for (int parentY = y * 2; parentY <= lastY; ++parentY)
+				{
+					for (int parentX = x * 2; parentX <= lastX; ++parentX)
+					{
+						size_t parentIndex = static_cast<size_t>(parentY) * parentWidth + parentX;
+
+						levelMin = std::min(levelMin, minDepth[level - 1][parentIndex]);
+						levelMax = std::max(levelMax, maxDepth[level - 1][parentIndex]);
+					}
+				}
+
+				minDepth[level][static_cast<size_t>(y) * width + x] = levelMin;
+				maxDepth[level][static_cast<size_t>(y) * width + x] = levelMax;
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::TestCandidate(const Candidate& candidate) const
+{
+	glm::mat4 modelViewProj = viewProj * candidate.model;
+
+	glm::vec2 screenMin(std::numeric_limits<float>::max());
+	glm::vec2 screenMax(std::numeric_limits<float>::lowest());
+	float nearestDepth = 1.0f;
+
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		glm::vec4 clip = modelViewProj * glm::vec4(
+			corner & 1 ? candidate.boundsMax.x : candidate.boundsMin.x,
+			corner & 2 ? candidate.boundsMax.y : candidate.boundsMin.y,
+			corner & 4 ? candidate.boundsMax.z : candidate.boundsMin.z,
+			1.0f
+		);
+
+		// Bounds crossing the near plane cover the camera, they are always visible
+		if (clip.z + clip.w < 0.0f || clip.w <= 0.0f)
+		{
+			return true;
+		}
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+		screenMin = glm::min(screenMin, glm::vec2(ndc));
+		screenMax = glm::max(screenMax, glm::vec2(ndc));
+		nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+	}
+
+	int minX = std::max(0, static_cast<int>(std::floor((screenMin.x * 0.5f + 0.5f) * depthWidth)));
+	int maxX = std::min(depthWidth - 1, static_cast<int>(std::floor((screenMax.x * 0.5f + 0.5f) * depthWidth)));
+	int minY = std::max(0, static_cast<int>(std::floor((screenMin.y * 0.5f + 0.5f) * depthHeight)));
+	int maxY = std::min(depthHeight - 1, static_cast<int>(std::floor((screenMax.y * 0.5f + 0.5f) * depthHeight)));
+
+	// Outside of the screen is left to frustum culling
+	if (minX > maxX || minY > maxY)
+	{
+		return true;
+	}
+
+	// Coarsest level to start from covers the bounds with at most 2x2 texels
+	int level = 0;
+	while (level + 1 < static_cast<int>(levelSizes.size()) && std::max(maxX - minX, maxY - minY) >> level > 1)
+	{
+		++level;
+	}
+
+	for (int refineLevel = level; refineLevel >= std::max(0, level - maxRefineLevels); --refineLevel)
+	{
+		int width = levelSizes[refineLevel][0];
+		int height = levelSizes[refineLevel][1];
+
+		float areaMin = 1.0f;
+		float areaMax = 0.0f;
+
+		for (int y = std::min(minY >> refineLevel, height - 1); y <= std::min(maxY >> refineLevel, height - 1); ++y)
+		{
+			for (int x = std::min(minX >> refineLevel, width - 1); x <= std::min(maxX >> refineLevel, width - 1); ++x)
+			{
+				areaMin = std::min(areaMin, minDepth[refineLevel][static_cast<size_t>(y) * width + x]);
+				areaMax = std::max(areaMax, maxDepth[refineLevel][static_cast<size_t>(y) * width + x]);
+			}
+		}
+
+		if (nearestDepth > areaMax)
+		{
+			return false;
+		}
+		if (nearestDepth <= areaMin)
+		{
+			return true;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "glm/glm.hpp"
+
+/*
+	Software hierarchical Z occlusion culling
+
+	Occluders (boxes of solids that fill their bounds, or low poly occluder meshes) are
+	rasterized into a small depth buffer 4 pixels at a time with SSE, then min and max
+	depth mip pyramids are built from it. Candidates are tested by the nearest depth of
+	their screen space bounds: coarse levels decide most of them, finer ones are read
+	only when the candidate is between min and max depth of the area.
+
+	Work of a frame is done on a worker thread between Start and Wait, so it overlaps
+	with whatever the caller submits in the meantime. Everything is added between
+	BeginFrame and Start, results are valid after Wait until the next BeginFrame
+*/
+class OcclusionCuller
+{
+public:
+	constexpr static int depthWidth = 256;
+	constexpr static int depthHeight = 128;
+
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	// Waits for the previous frame if it was not waited for
+	void BeginFrame(const glm::mat4& viewProj);
+
+	void AddOccluder(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model);
+	// Triangle list in model space
+	void AddOccluderMesh(const std::vector<glm::vec3>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& model);
+	// Returns index of the candidate for IsVisible
+	size_t AddCandidate(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model);
+
+	void Start();
+	void Wait();
+
+	bool IsVisible(size_t candidate) const;
+	size_t GetOccludedAmount() const;
+
+private:
+	struct Candidate
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		glm::mat4 model;
+	};
+
+	struct Occluder
+	{
+		size_t firstVertex; // Into occluderVertices, 3 per triangle
+		size_t vertexAmount;
+		glm::mat4 model;
+	};
+
+	void Worker();
+	void RenderOccluders();
+	// Vertices are in pixels, z is depth
+	void RasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2);
+	void BuildPyramid();
+	bool TestCandidate(const Candidate& candidate) const;
+
+	glm::mat4 viewProj;
+
+	std::vector<Occluder> occluders;
+	std::vector<glm::vec3> occluderVertices;
+	std::vector<Candidate> candidates;
+	std::vector<char> visibility;
+	size_t occludedAmount;
+
+	// Depth is NDC z moved into [0, 1], level 0 of both pyramids is the rasterized depth
+	std::vector<std::vector<float>> minDepth;
+	std::vector<std::vector<float>> maxDepth;
+	std::vector<std::array<int, 2>> levelSizes;
+
+	std::unique_ptr<std::thread> workerThread;
+	std::mutex workerMutex;
+	std::condition_variable workerCondition;
+	bool frameStarted;
+	bool frameDone;
+	bool workerStop;
+};
@@ -0,0 +1,104 @@
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include "SIMDSupport.h"
+
+namespace
+{
+	void CPUID(unsigned int leaf, unsigned int registers[4])
+	{
+#ifdef _MSC_VER
+		__cpuidex(reinterpret_cast<int*>(registers), leaf, 0);
+#else
+		__cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+	}
+
+	unsigned long long GetEnabledState()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned int eax;
+		unsigned int edx;
+		__asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+}
+
+SIMDSupport::InstructionSet SIMDSupport::GetSupportedInstructionSet()
+{
+	static InstructionSet supported = DetectInstructionSet();
+
+	return supported;
+}
+
+std::string SIMDSupport::GetInstructionSetName(InstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+	case InstructionSet::Scalar:
+		return "Scalar";
+	case InstructionSet::SSE:
+		return "SSE";
+	case InstructionSet::AVX:
+		return "AVX";
+	case InstructionSet::AVX512:
+		return "AVX-512";
+	default:
+		return "Unknown";
+	}
+}
+
+int SIMDSupport::FindLowestBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
+SIMDSupport::InstructionSet SIMDSupport::DetectInstructionSet()
+{
+	unsigned int registers[4] = {};
+
+	CPUID(0, registers);
+	unsigned int maxLeaf = registers[0];
+
+	CPUID(1, registers);
+
+	bool osxsave = registers[2] & (1u << 27);
+	bool avx = registers[2] & (1u << 28);
+
+	if (!osxsave || !avx)
+	{
+		return InstructionSet::SSE;
+	}
+
+	// OS has to save the upper halves of ymm registers on context switches,
+	// for AVX-512 also the opmask and zmm registers
+	unsigned long long enabledState = GetEnabledState();
+
+	if ((enabledState & 0x6) != 0x6)
+	{
+		return InstructionSet::SSE;
+	}
+
+	if (maxLeaf < 7)
+	{
+		return InstructionSet::AVX;
+	}
+
+	CPUID(7, registers);
+
+	bool avx512f = registers[1] & (1u << 16);
+
+	return avx512f && (enabledState & 0xE6) == 0xE6 ? InstructionSet::AVX512 : InstructionSet::AVX;
+}
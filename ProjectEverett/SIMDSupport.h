@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+// MSVC compiles intrinsics of any instruction set anywhere, GCC and Clang only in functions
+// targeting it. Helpers are forced inline, as a call in the middle of a batch spills all registers
+#ifdef _MSC_VER
+#define SIMD_TARGET_AVX
+#define SIMD_TARGET_AVX512
+#define SIMD_HELPER_AVX __forceinline
+#else
+#define SIMD_TARGET_AVX __attribute__((target("avx")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+#define SIMD_HELPER_AVX inline __attribute__((target("avx"), always_inline))
+#endif
+
+/*
+	Instruction sets SIMD kernels choose between at runtime
+
+	Sets are ordered, each includes the ones before it. SSE2 is a part of x64, so it is always there
+*/
+class SIMDSupport
+{
+public:
+	enum class InstructionSet
+	{
+		Scalar,
+		SSE,
+		AVX,
+		AVX512
+	};
+
+	// Widest set both the CPU and the OS support, detected once
+	static InstructionSet GetSupportedInstructionSet();
+	static std::string GetInstructionSetName(InstructionSet instructionSet);
+
+	// Index of the lowest set bit, bits must not be 0. Walks hit masks of the kernels
+	static int FindLowestBit(uint64_t bits);
+
+private:
+	static InstructionSet DetectInstructionSet();
+};
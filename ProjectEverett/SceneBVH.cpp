@@ -0,0 +1,643 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+#include "SceneBVH.h"
+
+SceneBVH::SceneBVH()
+	: builtCost(0.0f), rebuildRunning(false), rebuildStarted(false), rebuildDone(false), workerStop(false)
+{
+	workerThread = std::make_unique<std::thread>([this]() { Worker(); });
+}
+
+SceneBVH::~SceneBVH()
+{
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		workerStop = true;
+	}
+	workerCondition.notify_all();
+
+	workerThread->join();
+}
+
+void SceneBVH::Update(LeafKey key, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	auto leafIter = tree.leaves.find(key);
+
+	if (leafIter != tree.leaves.end())
+	{
+		Node& leaf = tree.nodes[leafIter->second];
+
+		if (leaf.boundsMin == boxMin && leaf.boundsMax == boxMax)
+		{
+			return;
+		}
+
+		leaf.boundsMin = boxMin;
+		leaf.boundsMax = boxMax;
+
+		Refit(tree, leaf.parent);
+	}
+	else
+	{
+		InsertLeaf(tree, key, boxMin, boxMax);
+	}
+
+	if (rebuildRunning)
+	{
+		changedDuringRebuild.push_back(key);
+	}
+}
+
+void SceneBVH::Remove(LeafKey key)
+{
+	auto leafIter = tree.leaves.find(key);
+
+	if (leafIter == tree.leaves.end())
+	{
+		return;
+	}
+
+	RemoveLeaf(tree, leafIter->second);
+
+	if (rebuildRunning)
+	{
+		changedDuringRebuild.push_back(key);
+	}
+}
+
+void SceneBVH::Clear()
+{
+	if (rebuildRunning)
+	{
+		std::unique_lock<std::mutex> lock(workerMutex);
+		workerCondition.wait(lock, [this]() { return rebuildDone; });
+
+		rebuildDone = false;
+		rebuildRunning = false;
+		changedDuringRebuild.clear();
+	}
+
+	tree = Tree();
+	rebuiltTree = Tree();
+	builtCost = 0.0f;
+}
+
+void SceneBVH::Maintain()
+{
+	if (rebuildRunning)
+	{
+		{
+			std::lock_guard<std::mutex> lock(workerMutex);
+
+			if (!rebuildDone)
+			{
+				return;
+			}
+
+			rebuildDone = false;
+		}
+
+		rebuildRunning = false;
+
+		std::swap(tree, rebuiltTree);
+		builtCost = GetCost(tree);
+
+		// Old tree has the latest boxes of keys changed since the rebuild started
+		for (LeafKey key : changedDuringRebuild)
+		{
+			auto oldLeafIter = rebuiltTree.leaves.find(key);
+
+			if (oldLeafIter == rebuiltTree.leaves.end())
+			{
+				Remove(key);
+			}
+			else
+			{
+				const Node& oldLeaf = rebuiltTree.nodes[oldLeafIter->second];
+				Update(key, oldLeaf.boundsMin, oldLeaf.boundsMax);
+			}
+		}
+
+		changedDuringRebuild.clear();
+		rebuiltTree = Tree();
+
+		return;
+	}
+
+	if (tree.leaves.size() >= rebuildMinLeaves && GetCost(tree) > builtCost * rebuildCostGrowth)
+	{
+		StartRebuild();
+	}
+}
+
+bool SceneBVH::GetBox(LeafKey key, glm::vec3& boxMin, glm::vec3& boxMax) const
+{
+	auto leafIter = tree.leaves.find(key);
+
+	if (leafIter == tree.leaves.end())
+	{
+		return false;
+	}
+
+	const Node& leaf = tree.nodes[leafIter->second];
+	boxMin = leaf.boundsMin;
+	boxMax = leaf.boundsMax;
+
+	return true;
+}
+
+size_t SceneBVH::GetLeafAmount() const
+{
+	return tree.leaves.size();
+}
+
+float SceneBVH::GetCost() const
+{
+	return GetCost(tree);
+}
+
+bool SceneBVH::IsLeaf(const Node& node)
+{
+	return node.children[0] == invalidNode;
+}
+
+float SceneBVH::SurfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	glm::vec3 extent = boundsMax - boundsMin;
+
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+float SceneBVH::GetCost(const Tree& tree)
+{
+	if (tree.root == invalidNode)
+	{
+		return 0.0f;
+	}
+
+	const Node& root = tree.nodes[tree.root];
+	float rootArea = SurfaceArea(root.boundsMin, root.boundsMax);
+
+	return rootArea > 0.0f ? static_cast<float>(tree.innerArea / rootArea) : 0.0f;
+}
+
+float SceneBVH::GetEntryDistance(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+{
+	glm::vec3 toMin = (node.boundsMin - origin) * inverseDirection;
+	glm::vec3 toMax = (node.boundsMax - origin) * inverseDirection;
+	glm::vec3 slabEntry = glm::min(toMin, toMax);
+	glm::vec3 slabExit = glm::max(toMin, toMax);
+
+	float entry = std::max(std::max(slabEntry.x, slabEntry.y), std::max(slabEntry.z, 0.0f));
+	float exit = std::min(std::min(slabExit.x, slabExit.y), std::min(slabExit.z, maxDistance));
+
+	return entry <= exit ? entry : -1.0f;
+}
+
+uint32_t SceneBVH::AllocateNode(Tree& tree)
+{
+	if (!tree.freeNodes.empty())
+	{
+		uint32_t nodeIndex = tree.freeNodes.back();
+		tree.freeNodes.pop_back();
+
+		return nodeIndex;
+	}
+
+	tree.nodes.emplace_back();
+	tree.keys.emplace_back();
+
+	return static_cast<uint32_t>(tree.nodes.size() - 1);
+}
+
+void SceneBVH::InsertLeaf(Tree& tree, LeafKey key, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	uint32_t leaf = AllocateNode(tree);
+
+	tree.nodes[leaf] = { boxMin, invalidNode, boxMax, { invalidNode, invalidNode } };
+	tree.keys[leaf] = key;
+	tree.leaves[key] = leaf;
+
+	if (tree.root == invalidNode)
+	{
+		tree.root = leaf;
+		return;
+	}
+
+	// Pairing with a node adds a parent around both, going down a level grows the node on the way
+	uint32_t sibling = tree.root;
+
+	while (!IsLeaf(tree.nodes[sibling]))
+	{
+		const Node& node = tree.nodes[sibling];
+
+		float area = SurfaceArea(node.boundsMin, node.boundsMax);
+		float combinedArea = SurfaceArea(glm::min(node.boundsMin, boxMin), glm::max(node.boundsMax, boxMax));
+
+		float pairCost = 2.0f * combinedArea;
+		float descendCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+
+		for (int child = 0; child < 2; ++child)
+		{
+			const Node& childNode = tree.nodes[node.children[child]];
+			float grownArea = SurfaceArea(glm::min(childNode.boundsMin, boxMin), glm::max(childNode.boundsMax, boxMax));
+
+			childCosts[child] = descendCost + (IsLeaf(childNode) ? grownArea : grownArea - SurfaceArea(childNode.boundsMin, childNode.boundsMax));
+		}
+
+		if (pairCost < childCosts[0] && pairCost < childCosts[1])
+		{
+			break;
+		}
+
+		sibling = node.children[childCosts[1] < childCosts[0] ? 1 : 0];
+	}
+
+	uint32_t oldParent = tree.nodes[sibling].parent;
+	uint32_t newParent = AllocateNode(tree);
+
+	Node& parentNode = tree.nodes[newParent];
+	parentNode.boundsMin = glm::min(tree.nodes[sibling].boundsMin, boxMin);
+	parentNode.boundsMax = glm::max(tree.nodes[sibling].boundsMax, boxMax);
+	parentNode.parent = oldParent;
+	parentNode.children[0] = sibling;
+	parentNode.children[1] = leaf;
+
+	tree.innerArea += SurfaceArea(parentNode.boundsMin, parentNode.boundsMax);
+
+	tree.nodes[sibling].parent = newParent;
+	tree.nodes[leaf].parent = newParent;
+
+	if (oldParent == invalidNode)
+	{
+		tree.root = newParent;
+		return;
+	}
+
+	Node& oldParentNode = tree.nodes[oldParent];
+	oldParentNode.children[oldParentNode.children[0] == sibling ? 0 : 1] = newParent;
+
+	Refit(tree, oldParent);
+}
+
+void SceneBVH::RemoveLeaf(Tree& tree, uint32_t leaf)
+{
+	tree.leaves.erase(tree.keys[leaf]);
+	tree.freeNodes.push_back(leaf);
+
+	uint32_t parent = tree.nodes[leaf].parent;
+
+	if (parent == invalidNode)
+	{
+		tree.root = invalidNode;
+		return;
+	}
+
+	// Sibling takes the place of the parent
+	const Node& parentNode = tree.nodes[parent];
+	uint32_t sibling = parentNode.children[parentNode.children[0] == leaf ? 1 : 0];
+	uint32_t grandparent = parentNode.parent;
+
+	tree.innerArea -= SurfaceArea(parentNode.boundsMin, parentNode.boundsMax);
+	tree.freeNodes.push_back(parent);
+
+	tree.nodes[sibling].parent = grandparent;
+
+	if (grandparent == invalidNode)
+	{
+		tree.root = sibling;
+		return;
+	}
+
+	Node& grandparentNode = tree.nodes[grandparent];
+	grandparentNode.children[grandparentNode.children[0] == parent ? 0 : 1] = sibling;
+
+	Refit(tree, grandparent);
+}
+
+void SceneBVH::Refit(Tree& tree, uint32_t nodeIndex)
+{
+	while (nodeIndex != invalidNode)
+	{
+		Node& node = tree.nodes[nodeIndex];
+		const Node& left = tree.nodes[node.children[0]];
+		const Node& right = tree.nodes[node.children[1]];
+
+		glm::vec3 newMin = glm::min(left.boundsMin, right.boundsMin);
+		glm::vec3 newMax = glm::max(left.boundsMax, right.boundsMax);
+
+		if (newMin == node.boundsMin && newMax == node.boundsMax)
+		{
+			return;
+		}
+
+		tree.innerArea += SurfaceArea(newMin, newMax) - SurfaceArea(node.boundsMin, node.boundsMax);
+
+		node.boundsMin = newMin;
+		node.boundsMax = newMax;
+
+		nodeIndex = node.parent;
+	}
+}
+
+void SceneBVH::Build(Tree& tree, std::vector<BuildLeaf>& leaves)
+{
+	tree = Tree();
+
+	if (leaves.empty())
+	{
+		return;
+	}
+
+	tree.nodes.reserve(leaves.size() * 2 - 1);
+	tree.keys.reserve(leaves.size() * 2 - 1);
+	tree.leaves.reserve(leaves.size());
+
+	tree.root = BuildNode(tree, leaves, 0, leaves.size(), invalidNode, 0);
+}
+
+uint32_t SceneBVH::BuildNode(Tree& tree, std::vector<BuildLeaf>& leaves, size_t first, size_t amount, uint32_t parent, int depth)
+{
+	uint32_t nodeIndex = AllocateNode(tree);
+
+	glm::vec3 nodeMin = leaves[first].boundsMin;
+	glm::vec3 nodeMax = leaves[first].boundsMax;
+
+	for (size_t i = first + 1; i < first + amount; ++i)
+	{
+		nodeMin = glm::min(nodeMin, leaves[i].boundsMin);
+		nodeMax = glm::max(nodeMax, leaves[i].boundsMax);
+	}
+
+	tree.nodes[nodeIndex] = { nodeMin, parent, nodeMax, { invalidNode, invalidNode } };
+
+	if (amount == 1)
+	{
+		tree.keys[nodeIndex] = leaves[first].key;
+		tree.leaves[leaves[first].key] = nodeIndex;
+
+		return nodeIndex;
+	}
+
+	tree.innerArea += SurfaceArea(nodeMin, nodeMax);
+
+	size_t split = depth < maxSAHDepth ? SplitBySAH(leaves, first, amount) : first + amount / 2;
+
+	uint32_t left = BuildNode(tree, leaves, first, split - first, nodeIndex, depth + 1);
+	uint32_t right = BuildNode(tree, leaves, split, first + amount - split, nodeIndex, depth + 1);
+
+	tree.nodes[nodeIndex].children[0] = left;
+	tree.nodes[nodeIndex].children[1] = right;
+
+	return nodeIndex;
+}
+
+size_t SceneBVH::SplitBySAH(std::vector<BuildLeaf>& leaves, size_t first, size_t amount)
+{
+	size_t end = first + amount;
+
+	glm::vec3 centroidMin = leaves[first].centroid;
+	glm::vec3 centroidMax = centroidMin;
+
+	for (size_t i = first + 1; i < end; ++i)
+	{
+		centroidMin = glm::min(centroidMin, leaves[i].centroid);
+		centroidMax = glm::max(centroidMax, leaves[i].centroid);
+	}
+
+	struct Bin
+	{
+		glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+		size_t amount = 0;
+	};
+
+	float bestCost = std::numeric_limits<float>::max();
+	int bestAxis = -1;
+	int bestBin = 0;
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float extent = centroidMax[axis] - centroidMin[axis];
+
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		Bin bins[sahBins];
+		float binScale = sahBins / extent;
+
+		for (size_t i = first; i < end; ++i)
+		{
+			int bin = std::min(static_cast<int>((leaves[i].centroid[axis] - centroidMin[axis]) * binScale), sahBins - 1);
+
+			bins[bin].boundsMin = glm::min(bins[bin].boundsMin, leaves[i].boundsMin);
+			bins[bin].boundsMax = glm::max(bins[bin].boundsMax, leaves[i].boundsMax);
+			++bins[bin].amount;
+		}
+
+		// Cost of splitting after bin i, left side swept forward and right side backward
+		float leftCosts[sahBins - 1];
+		Bin left;
+
+		for (int i = 0; i < sahBins - 1; ++i)
+		{
+			left.boundsMin = glm::min(left.boundsMin, bins[i].boundsMin);
+			left.boundsMax = glm::max(left.boundsMax, bins[i].boundsMax);
+			left.amount += bins[i].amount;
+
+			leftCosts[i] = left.amount ? SurfaceArea(left.boundsMin, left.boundsMax) * left.amount : -1.0f;
+		}
+
+		Bin right;
+
+		for (int i = sahBins - 1; i > 0; --i)
+		{
+			right.boundsMin = glm::min(right.boundsMin, bins[i].boundsMin);
+			right.boundsMax = glm::max(right.boundsMax, bins[i].boundsMax);
+			right.amount += bins[i].amount;
+
+			if (!right.amount || leftCosts[i - 1] < 0.0f)
+			{
+				continue;
+			}
+
+			float cost = leftCosts[i - 1] + SurfaceArea(right.boundsMin, right.boundsMax) * right.amount;
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = i - 1;
+			}
+		}
+	}
+
+	if (bestAxis == -1)
+	{
+		return first + amount / 2;
+	}
+
+	float binScale = sahBins / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+
+	auto splitIter = std::partition(leaves.begin() + first, leaves.begin() + end, [&](const BuildLeaf& leaf)
+	{
+		int bin = std::min(static_cast<int>((leaf.centroid[bestAxis] - centroidMin[bestAxis]) * binScale), sahBins - 1);
+
+		return bin <= bestBin;
+	});
+
+	return static_cast<size_t>(splitIter - leaves.begin());
+}
+
+void SceneBVH::StartRebuild()
+{
+	rebuildLeaves.clear();
+	rebuildLeaves.reserve(tree.leaves.size());
+
+	for (auto& leaf : tree.leaves)
+	{
+		const Node& node = tree.nodes[leaf.second];
+
+		rebuildLeaves.push_back({ node.boundsMin, node.boundsMax, (node.boundsMin + node.boundsMax) * 0.5f, leaf.first });
+	}
+
+	rebuildRunning = true;
+
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		rebuildStarted = true;
+		rebuildDone = false;
+	}
+	workerCondition.notify_all();
+}
+
+void SceneBVH::Worker()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(workerMutex);
+			workerCondition.wait(lock, [this]() { return rebuildStarted || workerStop; });
+
+			if (workerStop)
+			{
+				return;
+			}
+
+			rebuildStarted = false;
+		}
+
+		Build(rebuiltTree, rebuildLeaves);
+
+		{
+			std::lock_guard<std::mutex> lock(workerMutex);
+			rebuildDone = true;
+		}
+		workerCondition.notify_all();
+	}
+}
+
+void SceneBVH::Benchmark(size_t leafAmount, size_t queryAmount)
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> scale(0.5f, 4.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<glm::vec3> positions(leafAmount);
+	std::vector<glm::vec3> halfSizes(leafAmount);
+
+	for (size_t i = 0; i < leafAmount; ++i)
+	{
+		positions[i] = glm::vec3(position(generator), position(generator) * 0.1f, position(generator));
+		halfSizes[i] = glm::vec3(scale(generator), scale(generator), scale(generator)) * 0.5f;
+	}
+
+	SceneBVH bvh;
+
+	auto Microseconds = [](std::chrono::steady_clock::time_point start, size_t amount)
+	{
+		std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - start;
+
+		return time.count() / std::max<size_t>(amount, 1);
+	};
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < leafAmount; ++i)
+	{
+		bvh.Update(i, positions[i] - halfSizes[i], positions[i] + halfSizes[i]);
+	}
+
+	double insertTime = Microseconds(start, leafAmount);
+	float insertedCost = bvh.GetCost();
+
+	// Waits for the rebuild the insertions started
+	start = std::chrono::steady_clock::now();
+
+	bvh.Maintain();
+
+	while (bvh.rebuildRunning)
+	{
+		std::this_thread::yield();
+		bvh.Maintain();
+	}
+
+	double rebuildTime = Microseconds(start, 1) / 1000.0;
+
+	// Tenth of boxes moves a bit, as solids walking around do
+	start = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < leafAmount; i += 10)
+	{
+		positions[i] += glm::vec3(unit(generator), 0.0f, unit(generator));
+		bvh.Update(i, positions[i] - halfSizes[i], positions[i] + halfSizes[i]);
+	}
+
+	double refitTime = Microseconds(start, leafAmount / 10);
+
+	size_t hits = 0;
+	start = std::chrono::steady_clock::now();
+
+	for (size_t query = 0; query < queryAmount; ++query)
+	{
+		glm::vec3 origin(position(generator), 0.0f, position(generator));
+		glm::vec3 direction = glm::normalize(glm::vec3(unit(generator), unit(generator) * 0.1f, unit(generator)));
+
+		LeafKey hitKey;
+		float hitDistance;
+
+		hits += bvh.Raycast(origin, direction, 1000.0f, [](LeafKey, float boxDistance, float) { return boxDistance; }, hitKey, hitDistance);
+	}
+
+	double raycastTime = Microseconds(start, queryAmount);
+
+	size_t overlaps = 0;
+	start = std::chrono::steady_clock::now();
+
+	for (size_t query = 0; query < queryAmount; ++query)
+	{
+		glm::vec3 center(position(generator), 0.0f, position(generator));
+
+		bvh.QuerySphere(center, 5.0f, [&overlaps](LeafKey, float) { ++overlaps; return false; });
+	}
+
+	double sphereTime = Microseconds(start, queryAmount);
+
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "Scene BVH over " << leafAmount << " boxes\n";
+	std::cout << "Insert: " << insertTime << " us per box, cost " << insertedCost << '\n';
+	std::cout << "Rebuild: " << rebuildTime << " ms, cost " << bvh.GetCost() << '\n';
+	std::cout << "Refit: " << refitTime << " us per moved box\n";
+	std::cout << "Raycast: " << raycastTime << " us, " << hits << " of " << queryAmount << " hit\n";
+	std::cout << "Sphere query: " << sphereTime << " us, " << overlaps << " overlaps\n";
+}
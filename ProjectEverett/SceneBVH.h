@@ -0,0 +1,327 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <unordered_map>
+
+#include "glm/glm.hpp"
+
+/*
+	Dynamic bounding volume hierarchy over boxes of the whole scene, for raycasts and sphere queries
+
+	New boxes are paired with the node that grows the tree least. Moving a box refits its leaf and
+	the ancestors whose bounds change, so boxes that keep still cost nothing. Refits only loosen
+	the tree: once its cost (area of inner nodes over the root one) grows by rebuildCostGrowth
+	over the one of the last build, a binned SAH build of the current boxes runs on a worker
+	thread. Maintain swaps the rebuilt tree in when it is done and replays boxes changed meanwhile.
+
+	Queries visit the tree from the root with an explicit stack, rays go to the nearest child first
+	and skip nodes past the closest hit found so far
+*/
+class SceneBVH
+{
+public:
+	using LeafKey = uint64_t;
+
+	SceneBVH();
+	~SceneBVH();
+
+	// Inserts the box if the key is not in the tree
+	void Update(LeafKey key, const glm::vec3& boxMin, const glm::vec3& boxMax);
+	void Remove(LeafKey key);
+	void Clear();
+	// Swaps in a finished rebuild, starts one if the tree degraded. Meant to be called once a frame
+	void Maintain();
+
+	// Returns false if the key is not in the tree
+	bool GetBox(LeafKey key, glm::vec3& boxMin, glm::vec3& boxMax) const;
+	size_t GetLeafAmount() const;
+	// Surface area of inner nodes over the one of the root, lower is better
+	float GetCost() const;
+
+	// HitTest is called as float(LeafKey, float boxDistance, float maxDistance) for leaves the ray
+	// enters before the closest hit so far, nearest boxes first, and returns the hit distance,
+	// negative if the leaf was missed. Distances are in lengths of direction
+	template<typename HitTest>
+	bool Raycast(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		HitTest hitTest,
+		LeafKey& hitKey,
+		float& hitDistance
+	) const;
+
+	// Visitor is called as bool(LeafKey, float boxDistance) for leaves whose box is within radius
+	// of center, returning true stops the query. Returns true if it was stopped
+	template<typename Visitor>
+	bool QuerySphere(const glm::vec3& center, float radius, Visitor visitor) const;
+
+	// Times refits, raycasts and sphere queries over random boxes and prints the results
+	static void Benchmark(size_t leafAmount, size_t queryAmount = 100000);
+
+	constexpr static float rebuildCostGrowth = 1.5f;
+	// Smaller trees are cheap to query however they degrade
+	constexpr static size_t rebuildMinLeaves = 64;
+
+private:
+	constexpr static uint32_t invalidNode = static_cast<uint32_t>(-1);
+	// Builds split at the median below it, so rebuilt trees stay shallow
+	constexpr static int maxSAHDepth = 40;
+	constexpr static int sahBins = 12;
+
+	struct Node
+	{
+		glm::vec3 boundsMin;
+		uint32_t parent;
+		glm::vec3 boundsMax;
+		uint32_t children[2]; // invalidNode for leaves
+	};
+
+	struct Tree
+	{
+		std::vector<Node> nodes;
+		std::vector<LeafKey> keys; // Indexed by node, set for leaves
+		std::vector<uint32_t> freeNodes;
+		std::unordered_map<LeafKey, uint32_t> leaves;
+		uint32_t root = invalidNode;
+		double innerArea = 0.0;
+	};
+
+	struct BuildLeaf
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		glm::vec3 centroid;
+		LeafKey key;
+	};
+
+	// Insertions can make the tree deeper than the fixed part before a rebuild evens it out
+	template<typename Entry>
+	class TraversalStack
+	{
+	public:
+		void Push(const Entry& entry)
+		{
+			if (size < fixedSize)
+			{
+				fixed[size] = entry;
+			}
+			else
+			{
+				overflow.push_back(entry);
+			}
+
+			++size;
+		}
+
+		Entry Pop()
+		{
+			--size;
+
+			if (size < fixedSize)
+			{
+				return fixed[size];
+			}
+
+			Entry entry = overflow.back();
+			overflow.pop_back();
+
+			return entry;
+		}
+
+		bool IsEmpty() const
+		{
+			return !size;
+		}
+
+	private:
+		constexpr static size_t fixedSize = 64;
+
+		Entry fixed[fixedSize];
+		std::vector<Entry> overflow;
+		size_t size = 0;
+	};
+
+	static bool IsLeaf(const Node& node);
+	static float SurfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	static float GetCost(const Tree& tree);
+	// Distance the ray enters the node at, negative if it misses the node before maxDistance
+	static float GetEntryDistance(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance);
+
+	static uint32_t AllocateNode(Tree& tree);
+	static void InsertLeaf(Tree& tree, LeafKey key, const glm::vec3& boxMin, const glm::vec3& boxMax);
+	static void RemoveLeaf(Tree& tree, uint32_t leaf);
+	// Recomputes bounds from the node up, stops at the first one whose bounds stay the same
+	static void Refit(Tree& tree, uint32_t nodeIndex);
+
+	static void Build(Tree& tree, std::vector<BuildLeaf>& leaves);
+	static uint32_t BuildNode(Tree& tree, std::vector<BuildLeaf>& leaves, size_t first, size_t amount, uint32_t parent, int depth);
+	// Returns the split index, first + amount / 2 if no bin split separates the centroids
+	static size_t SplitBySAH(std::vector<BuildLeaf>& leaves, size_t first, size_t amount);
+
+	void StartRebuild();
+	void Worker();
+
+	Tree tree;
+	float builtCost;
+
+	bool rebuildRunning;
+	std::vector<LeafKey> changedDuringRebuild;
+
+	// Owned by the worker while a rebuild runs
+	std::vector<BuildLeaf> rebuildLeaves;
+	Tree rebuiltTree;
+
+	std::unique_ptr<std::thread> workerThread;
+	std::mutex workerMutex;
+	std::condition_variable workerCondition;
+	bool rebuildStarted;
+	bool rebuildDone;
+	bool workerStop;
+};
+
+template<typename HitTest>
+bool SceneBVH::Raycast(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	HitTest hitTest,
+	LeafKey& hitKey,
+	float& hitDistance
+) const
+{
+	if (tree.root == invalidNode)
+	{
+		return false;
+	}
+
+	// Zero components would give 0 * inf in the slab test
+	glm::vec3 inverseDirection;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		inverseDirection[axis] = 1.0f / (direction[axis] != 0.0f ? direction[axis] : 1e-30f);
+	}
+
+	struct RayEntry
+	{
+		uint32_t node;
+		float distance;
+	};
+
+	float closest = maxDistance;
+	bool hit = false;
+
+	float rootDistance = GetEntryDistance(tree.nodes[tree.root], origin, inverseDirection, closest);
+	if (rootDistance < 0.0f)
+	{
+		return false;
+	}
+
+	TraversalStack<RayEntry> stack;
+	stack.Push({ tree.root, rootDistance });
+
+	while (!stack.IsEmpty())
+	{
+		RayEntry entry = stack.Pop();
+
+		if (entry.distance > closest)
+		{
+			continue;
+		}
+
+		const Node& node = tree.nodes[entry.node];
+
+		if (IsLeaf(node))
+		{
+			float distance = hitTest(tree.keys[entry.node], entry.distance, closest);
+
+			if (distance >= 0.0f && distance <= closest && (!hit || distance < closest))
+			{
+				closest = distance;
+				hitKey = tree.keys[entry.node];
+				hit = true;
+			}
+
+			continue;
+		}
+
+		// Nearer child goes on top, so hits found in it cut the farther one off
+		uint32_t nearChild = node.children[0];
+		uint32_t farChild = node.children[1];
+		float nearDistance = GetEntryDistance(tree.nodes[nearChild], origin, inverseDirection, closest);
+		float farDistance = GetEntryDistance(tree.nodes[farChild], origin, inverseDirection, closest);
+
+		if (farDistance >= 0.0f && (nearDistance < 0.0f || farDistance < nearDistance))
+		{
+			std::swap(nearChild, farChild);
+			std::swap(nearDistance, farDistance);
+		}
+
+		if (farDistance >= 0.0f)
+		{
+			stack.Push({ farChild, farDistance });
+		}
+
+		if (nearDistance >= 0.0f)
+		{
+			stack.Push({ nearChild, nearDistance });
+		}
+	}
+
+	if (hit)
+	{
+		hitDistance = closest;
+	}
+
+	return hit;
+}
+
+template<typename Visitor>
+bool SceneBVH::QuerySphere(const glm::vec3& center, float radius, Visitor visitor) const
+{
+	if (tree.root == invalidNode)
+	{
+		return false;
+	}
+
+	float radiusSquared = radius * radius;
+
+	TraversalStack<uint32_t> stack;
+	stack.Push(tree.root);
+
+	while (!stack.IsEmpty())
+	{
+		uint32_t nodeIndex = stack.Pop();
+		const Node& node = tree.nodes[nodeIndex];
+
+		glm::vec3 toBox = center - glm::clamp(center, node.boundsMin, node.boundsMax);
+		float distanceSquared = glm::dot(toBox, toBox);
+
+		if (distanceSquared > radiusSquared)
+		{
+			continue;
+		}
+
+		if (IsLeaf(node))
+		{
+			if (visitor(tree.keys[nodeIndex], std::sqrt(distanceSquared)))
+			{
+				return true;
+			}
+
+			continue;
+		}
+
+		stack.Push(node.children[1]);
+		stack.Push(node.children[0]);
+	}
+
+	return false;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Index of a slot and the generation it had when the value was inserted, handles of maps
+// with different tags do not convert into each other
+template<typename Tag>
+struct SlotHandle
+{
+	uint32_t index = 0;
+	uint32_t generation = 0;
+
+	bool operator==(const SlotHandle& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const SlotHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+/*
+	Values reached by generational handles in O(1), without hashing
+
+	Removing a value bumps the generation of its slot, so handles to it stop resolving instead of
+	reaching the value that takes the slot next. Free slots are reused, last freed first.
+	Generations start at 1, so a default constructed handle never resolves
+*/
+template<typename Value, typename Tag = Value>
+class SlotMap
+{
+public:
+	using Handle = SlotHandle<Tag>;
+
+	Handle Insert(const Value& value);
+	// Returns false if the handle does not resolve
+	bool Remove(Handle handle);
+	void Clear();
+
+	// nullptr if the handle does not resolve
+	Value* Get(Handle handle);
+	const Value* Get(Handle handle) const;
+
+	size_t GetSize() const;
+
+private:
+	struct Slot
+	{
+		Value value;
+		uint32_t generation = 1;
+		bool occupied = false;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;
+	size_t size = 0;
+};
+
+template<typename Value, typename Tag>
+typename SlotMap<Value, Tag>::Handle SlotMap<Value, Tag>::Insert(const Value& value)
+{
+	uint32_t index;
+
+	if (!freeSlots.empty())
+	{
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(slots.size());
+		slots.emplace_back();
+	}
+
+	Slot& slot = slots[index];
+	slot.value = value;
+	slot.occupied = true;
+	++size;
+
+	return { index, slot.generation };
+}
+
+template<typename Value, typename Tag>
+bool SlotMap<Value, Tag>::Remove(Handle handle)
+{
+	if (!Get(handle))
+	{
+		return false;
+	}
+
+	Slot& slot = slots[handle.index];
+	slot.value = Value();
+	slot.occupied = false;
+
+	// Generation 0 is left to default constructed handles
+	if (!++slot.generation)
+	{
+		slot.generation = 1;
+	}
+
+	freeSlots.push_back(handle.index);
+	--size;
+
+	return true;
+}
+
+template<typename Value, typename Tag>
+void SlotMap<Value, Tag>::Clear()
+{
+	for (uint32_t index = 0; index < slots.size(); ++index)
+	{
+		if (slots[index].occupied)
+		{
+			Remove({ index, slots[index].generation });
+		}
+	}
+}
+
+template<typename Value, typename Tag>
+Value* SlotMap<Value, Tag>::Get(Handle handle)
+{
+	if (handle.index >= slots.size())
+	{
+		return nullptr;
+	}
+
+	Slot& slot = slots[handle.index];
+
+	return slot.occupied && slot.generation == handle.generation ? &slot.value : nullptr;
+}
+
+template<typename Value, typename Tag>
+const Value* SlotMap<Value, Tag>::Get(Handle handle) const
+{
+	return const_cast<SlotMap*>(this)->Get(handle);
+}
+
+template<typename Value, typename Tag>
+size_t SlotMap<Value, Tag>::GetSize() const
+{
+	return size;
+}
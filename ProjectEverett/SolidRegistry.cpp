@@ -0,0 +1,434 @@
+#include <algorithm>
+
+#include "SolidRegistry.h"
+#include "TransformKernel.h"
+#include "BoxOverlapKernel.h"
+
+SolidRegistry::SolidId SolidRegistry::Add(
+	const std::string& name,
+	const glm::vec3& pos,
+	const glm::vec3& scale,
+	const glm::vec3& front
+)
+{
+	auto idIter = ids.find(name);
+
+	if (idIter != ids.end())
+	{
+		return idIter->second;
+	}
+
+	SolidId id = static_cast<SolidId>(names.size());
+
+	for (auto* soaArray : {
+		&posX, &posY, &posZ, &rotX, &rotY, &rotZ, &rotW, &scaleX, &scaleY, &scaleZ,
+		&boxMinX, &boxMinY, &boxMinZ, &boxMaxX, &boxMaxY, &boxMaxZ
+	})
+	{
+		soaArray->push_back(0.0f);
+	}
+
+	rotW.back() = 1.0f;
+	StoreTransform(id, pos, scale);
+
+	modelMatrices.emplace_back(1.0f);
+	normalMatrices.emplace_back(1.0f);
+
+	ghostModes.push_back(false);
+	dirtyFlags.push_back(false);
+
+	names.push_back(name);
+	fronts.push_back(front);
+	rotations.push_back({ 0.0f, 0.0f, 0.0f });
+	rotationLimits.push_back({
+		{ 0.0f, 0.0f, 0.0f },
+		{ SolidSim::fullRotation, SolidSim::fullRotation, SolidSim::fullRotation }
+	});
+	disabledDirs.push_back(0);
+	ids.emplace(name, id);
+
+	UpdateTransform(id);
+
+	return id;
+}
+
+template<typename Type>
+void SolidRegistry::MoveLastInto(std::vector<Type>& soaArray, SolidId id)
+{
+	soaArray[id] = std::move(soaArray.back());
+	soaArray.pop_back();
+}
+
+void SolidRegistry::Remove(SolidId id)
+{
+	if (id >= names.size())
+	{
+		return;
+	}
+
+	ids.erase(names[id]);
+	grid.Remove(id);
+
+	SolidId lastId = static_cast<SolidId>(names.size() - 1);
+
+	if (id != lastId)
+	{
+		ids[names.back()] = id;
+		grid.Move(lastId, id);
+	}
+
+	MoveLastInto(modelMatrices, id);
+	MoveLastInto(normalMatrices, id);
+
+	for (auto* soaArray : {
+		&posX, &posY, &posZ, &rotX, &rotY, &rotZ, &rotW, &scaleX, &scaleY, &scaleZ,
+		&boxMinX, &boxMinY, &boxMinZ, &boxMaxX, &boxMaxY, &boxMaxZ
+	})
+	{
+		MoveLastInto(*soaArray, id);
+	}
+
+	MoveLastInto(ghostModes, id);
+	MoveLastInto(dirtyFlags, id);
+
+	movedSolids.erase(
+		std::remove(movedSolids.begin(), movedSolids.end(), lastId),
+		movedSolids.end()
+	);
+
+	if (id != lastId)
+	{
+		movedSolids.push_back(id);
+	}
+
+	// Moved solid may be listed as dirty under its old id, which is dropped on update
+	if (id < dirtyFlags.size() && dirtyFlags[id])
+	{
+		dirtySolids.push_back(id);
+	}
+
+	MoveLastInto(names, id);
+	MoveLastInto(fronts, id);
+	MoveLastInto(rotations, id);
+	MoveLastInto(rotationLimits, id);
+	MoveLastInto(disabledDirs, id);
+}
+
+SolidRegistry::SolidId SolidRegistry::Find(const std::string& name) const
+{
+	auto idIter = ids.find(name);
+
+	return idIter == ids.end() ? invalidId : idIter->second;
+}
+
+size_t SolidRegistry::GetSize() const
+{
+	return names.size();
+}
+
+const std::string& SolidRegistry::GetName(SolidId id) const
+{
+	return names[id];
+}
+
+const std::vector<std::string>& SolidRegistry::GetNames() const
+{
+	return names;
+}
+
+void SolidRegistry::SetTransform(SolidId id, const glm::vec3& pos, const glm::vec3& scale)
+{
+	StoreTransform(id, pos, scale);
+
+	MarkDirty(id);
+}
+
+void SolidRegistry::Rotate(SolidId id, const SolidSim::Rotation& toRotate)
+{
+	rotations[id] += toRotate;
+	SolidSim::ClampRotation(rotations[id], rotationLimits[id]);
+
+	glm::quat orientation = SolidSim::ToQuaternion(rotations[id]);
+
+	rotX[id] = orientation.x;
+	rotY[id] = orientation.y;
+	rotZ[id] = orientation.z;
+	rotW[id] = orientation.w;
+
+	MarkDirty(id);
+}
+
+void SolidRegistry::LimitRotations(SolidId id, const SolidSim::Rotation& min, const SolidSim::Rotation& max)
+{
+	rotationLimits[id] = { min, max };
+}
+
+void SolidRegistry::UpdateTransforms()
+{
+	size_t solidAmount = names.size();
+
+	// With many solids dirty, one batch over all of them beats composing them one by one
+	if (solidAmount >= batchUpdateMinSize && dirtySolids.size() * batchUpdateDirtyShare >= solidAmount)
+	{
+		TransformKernel::Compose(
+			{
+				posX.data(), posY.data(), posZ.data(),
+				rotX.data(), rotY.data(), rotZ.data(), rotW.data(),
+				scaleX.data(), scaleY.data(), scaleZ.data()
+			},
+			0, solidAmount, modelMatrices.data(), normalMatrices.data()
+		);
+
+		for (SolidId id = 0; id < solidAmount; ++id)
+		{
+			dirtyFlags[id] = false;
+			UpdateCollisionBox(id);
+		}
+	}
+	else
+	{
+		for (SolidId id : dirtySolids)
+		{
+			if (id < dirtyFlags.size() && dirtyFlags[id])
+			{
+				UpdateTransform(id);
+			}
+		}
+	}
+
+	dirtySolids.clear();
+}
+
+glm::vec3 SolidRegistry::GetPosition(SolidId id) const
+{
+	return { posX[id], posY[id], posZ[id] };
+}
+
+glm::vec3 SolidRegistry::GetScale(SolidId id) const
+{
+	return { scaleX[id], scaleY[id], scaleZ[id] };
+}
+
+glm::quat SolidRegistry::GetOrientation(SolidId id) const
+{
+	return { rotW[id], rotX[id], rotY[id], rotZ[id] };
+}
+
+const SolidSim::Rotation& SolidRegistry::GetRotation(SolidId id) const
+{
+	return rotations[id];
+}
+
+const glm::mat4& SolidRegistry::GetModelMatrix(SolidId id) const
+{
+	return modelMatrices[id];
+}
+
+const glm::mat3& SolidRegistry::GetNormalMatrix(SolidId id) const
+{
+	return normalMatrices[id];
+}
+
+const std::vector<glm::mat4>& SolidRegistry::GetModelMatrices() const
+{
+	return modelMatrices;
+}
+
+const std::vector<glm::mat3>& SolidRegistry::GetNormalMatrices() const
+{
+	return normalMatrices;
+}
+
+const glm::vec3& SolidRegistry::GetFront(SolidId id) const
+{
+	return fronts[id];
+}
+
+void SolidRegistry::SetFront(SolidId id, const glm::vec3& front)
+{
+	fronts[id] = front;
+}
+
+void SolidRegistry::DisableDirection(SolidId id, SolidSim::Direction dir)
+{
+	disabledDirs[id] |= 1 << static_cast<int>(dir);
+}
+
+void SolidRegistry::EnableDirection(SolidId id, SolidSim::Direction dir)
+{
+	disabledDirs[id] &= ~(1 << static_cast<int>(dir));
+}
+
+bool SolidRegistry::IsDirectionDisabled(SolidId id, SolidSim::Direction dir) const
+{
+	return disabledDirs[id] & (1 << static_cast<int>(dir));
+}
+
+void SolidRegistry::SetGhostMode(SolidId id, bool val)
+{
+	ghostModes[id] = val;
+}
+
+bool SolidRegistry::IsGhostMode(SolidId id) const
+{
+	return ghostModes[id];
+}
+
+void SolidRegistry::GetCollisionBox(SolidId id, glm::vec3& boxMin, glm::vec3& boxMax) const
+{
+	boxMin = { boxMinX[id], boxMinY[id], boxMinZ[id] };
+	boxMax = { boxMaxX[id], boxMaxY[id], boxMaxZ[id] };
+}
+
+void SolidRegistry::SetCollisionBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	hasCollisionBounds = true;
+	collisionBoundsMin = boundsMin;
+	collisionBoundsMax = boundsMax;
+
+	for (SolidId id = 0; id < names.size(); ++id)
+	{
+		MarkDirty(id);
+	}
+}
+
+bool SolidRegistry::Overlaps(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	if (grid.IsOversized(boxMin, boxMax))
+	{
+		std::vector<SolidId> overlaps;
+		return FindOverlaps(boxMin, boxMax, overlaps) > 0;
+	}
+
+	// Strict, as SolidSim::CheckForCollision, touching boxes do not collide
+	return grid.Query(boxMin, boxMax, [&](SolidId id)
+	{
+		bool overlaps =
+			boxMax.x > boxMinX[id] && boxMin.x < boxMaxX[id] &&
+			boxMax.y > boxMinY[id] && boxMin.y < boxMaxY[id] &&
+			boxMax.z > boxMinZ[id] && boxMin.z < boxMaxZ[id];
+
+		return overlaps && !ghostModes[id];
+	});
+}
+
+bool SolidRegistry::Overlaps(
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	const std::function<bool(SolidId)>& narrowPhase
+) const
+{
+	if (grid.IsOversized(boxMin, boxMax))
+	{
+		std::vector<SolidId> overlaps;
+		FindOverlaps(boxMin, boxMax, overlaps);
+
+		return std::any_of(overlaps.begin(), overlaps.end(), narrowPhase);
+	}
+
+	return grid.Query(boxMin, boxMax, [&](SolidId id)
+	{
+		bool overlaps =
+			boxMax.x > boxMinX[id] && boxMin.x < boxMaxX[id] &&
+			boxMax.y > boxMinY[id] && boxMin.y < boxMaxY[id] &&
+			boxMax.z > boxMinZ[id] && boxMin.z < boxMaxZ[id];
+
+		return overlaps && !ghostModes[id] && narrowPhase(id);
+	});
+}
+
+size_t SolidRegistry::FindOverlaps(const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<SolidId>& overlaps) const
+{
+	BoxOverlapKernel::FindOverlaps(
+		{ boxMinX.data(), boxMinY.data(), boxMinZ.data(), boxMaxX.data(), boxMaxY.data(), boxMaxZ.data(), names.size() },
+		boxMin, boxMax, overlaps
+	);
+
+	overlaps.erase(
+		std::remove_if(overlaps.begin(), overlaps.end(), [this](SolidId id) { return ghostModes[id]; }),
+		overlaps.end()
+	);
+
+	return overlaps.size();
+}
+
+const std::vector<SolidRegistry::SolidId>& SolidRegistry::GetMovedSolids() const
+{
+	return movedSolids;
+}
+
+void SolidRegistry::ClearMovedSolids()
+{
+	movedSolids.clear();
+}
+
+void SolidRegistry::MarkDirty(SolidId id)
+{
+	if (!dirtyFlags[id])
+	{
+		dirtyFlags[id] = true;
+		dirtySolids.push_back(id);
+	}
+}
+
+void SolidRegistry::StoreTransform(SolidId id, const glm::vec3& pos, const glm::vec3& scale)
+{
+	posX[id] = pos.x;
+	posY[id] = pos.y;
+	posZ[id] = pos.z;
+	scaleX[id] = scale.x;
+	scaleY[id] = scale.y;
+	scaleZ[id] = scale.z;
+}
+
+void SolidRegistry::UpdateTransform(SolidId id)
+{
+	dirtyFlags[id] = false;
+
+	glm::vec3 pos = GetPosition(id);
+	glm::vec3 scale = GetScale(id);
+	glm::quat orientation = GetOrientation(id);
+
+	modelMatrices[id] = SolidSim::ComposeModelMatrix(pos, scale, orientation);
+	normalMatrices[id] = SolidSim::ComposeNormalMatrix(scale, orientation);
+
+	UpdateCollisionBox(id);
+}
+
+void SolidRegistry::UpdateCollisionBox(SolidId id)
+{
+	movedSolids.push_back(id);
+
+	if (hasCollisionBounds)
+	{
+		// Box around the bounds moved by the model matrix
+		const glm::mat4& model = modelMatrices[id];
+		glm::mat3 modelAbs = glm::mat3(glm::abs(model[0]), glm::abs(model[1]), glm::abs(model[2]));
+
+		glm::vec3 center = glm::vec3(model * glm::vec4((collisionBoundsMin + collisionBoundsMax) * 0.5f, 1.0f));
+		glm::vec3 halfSize = modelAbs * ((collisionBoundsMax - collisionBoundsMin) * 0.5f);
+
+		boxMinX[id] = center.x - halfSize.x;
+		boxMinY[id] = center.y - halfSize.y;
+		boxMinZ[id] = center.z - halfSize.z;
+		boxMaxX[id] = center.x + halfSize.x;
+		boxMaxY[id] = center.y + halfSize.y;
+		boxMaxZ[id] = center.z + halfSize.z;
+
+		grid.Update(id, center - halfSize, center + halfSize);
+		return;
+	}
+
+	float halfX = scaleX[id] / 2.0f;
+	float halfY = scaleY[id] / 2.0f;
+	float halfZ = scaleZ[id] / 2.0f;
+
+	boxMinX[id] = posX[id] - halfX;
+	boxMinY[id] = posY[id] - halfY;
+	boxMinZ[id] = posZ[id] - halfZ;
+	boxMaxX[id] = posX[id] + halfX;
+	boxMaxY[id] = posY[id] + halfY;
+	boxMaxZ[id] = posZ[id] + halfZ;
+
+	grid.Update(id, { boxMinX[id], boxMinY[id], boxMinZ[id] }, { boxMaxX[id], boxMaxY[id], boxMaxZ[id] });
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+#include <functional>
+
+#include "glm/glm.hpp"
+
+#include "SolidSim.h"
+#include "SpatialHashGrid.h"
+
+/*
+	Solids of a model, stored by dense ids
+
+	Data used every frame (position, orientation, scale, model and normal matrices,
+	collision box) is kept in contiguous arrays, one per field, so culling, drawing and
+	collision are linear scans over them. Transforms and collision boxes are split per component. Data only tools
+	and movement need (names, front vectors, Euler angles with their limits, disabled
+	directions) is kept apart, so it does not take cache lines of the per frame scans.
+
+	Changing a transform only marks the solid dirty, matrices and collision box of dirty
+	solids are recomputed by UpdateTransforms, once per frame however often they changed.
+	When a large share of solids is dirty, all of them are recomputed in one SIMD batch.
+
+	Collision boxes are also kept in a SpatialHashGrid, so overlap tests only check solids near
+	the tested box. Solids that do not move are never touched again after they are placed.
+
+	Removing a solid moves the last one into its id, ids stay dense but change on removal
+*/
+class SolidRegistry
+{
+public:
+	using SolidId = uint32_t;
+	constexpr static SolidId invalidId = static_cast<SolidId>(-1);
+
+	// Returns id of the existing solid if the name is taken
+	SolidId Add(
+		const std::string& name,
+		const glm::vec3& pos,
+		const glm::vec3& scale = glm::vec3(1.0f, 1.0f, 1.0f),
+		const glm::vec3& front = glm::vec3(0.0f, 0.0f, 1.0f)
+	);
+	void Remove(SolidId id);
+	SolidId Find(const std::string& name) const;
+	size_t GetSize() const;
+	const std::string& GetName(SolidId id) const;
+	const std::vector<std::string>& GetNames() const;
+
+	void SetTransform(SolidId id, const glm::vec3& pos, const glm::vec3& scale);
+	// Euler angles are clamped to the limits, then converted to the orientation
+	void Rotate(SolidId id, const SolidSim::Rotation& toRotate);
+	void LimitRotations(SolidId id, const SolidSim::Rotation& min, const SolidSim::Rotation& max);
+	void UpdateTransforms();
+
+	glm::vec3 GetPosition(SolidId id) const;
+	glm::vec3 GetScale(SolidId id) const;
+	glm::quat GetOrientation(SolidId id) const;
+	const SolidSim::Rotation& GetRotation(SolidId id) const;
+	// Matrices and collision boxes are the ones of the last UpdateTransforms
+	const glm::mat4& GetModelMatrix(SolidId id) const;
+	const glm::mat3& GetNormalMatrix(SolidId id) const;
+	// Indexed by id
+	const std::vector<glm::mat4>& GetModelMatrices() const;
+	const std::vector<glm::mat3>& GetNormalMatrices() const;
+
+	const glm::vec3& GetFront(SolidId id) const;
+	void SetFront(SolidId id, const glm::vec3& front);
+
+	void DisableDirection(SolidId id, SolidSim::Direction dir);
+	void EnableDirection(SolidId id, SolidSim::Direction dir);
+	bool IsDirectionDisabled(SolidId id, SolidSim::Direction dir) const;
+
+	void SetGhostMode(SolidId id, bool val);
+	bool IsGhostMode(SolidId id) const;
+
+	// Box of size scale around position, the one SolidSim::CheckForCollision tests,
+	// or the world space box around the collision bounds if they are set
+	void GetCollisionBox(SolidId id, glm::vec3& boxMin, glm::vec3& boxMax) const;
+	// Model space bounds of the mesh, for collision tested against the mesh itself
+	void SetCollisionBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	// True if the box overlaps collision box of any solid not in ghost mode. Boxes too large for
+	// the grid to narrow down are tested against every solid with FindOverlaps instead
+	bool Overlaps(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+	// Same, but a solid whose collision box overlaps only counts if narrowPhase(id) is true
+	bool Overlaps(const glm::vec3& boxMin, const glm::vec3& boxMax, const std::function<bool(SolidId)>& narrowPhase) const;
+	// Ids of all solids not in ghost mode whose collision boxes overlap the box, in ascending order.
+	// Tests every solid in SIMD batches
+	size_t FindOverlaps(const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<SolidId>& overlaps) const;
+
+	// Solids whose collision box was recomputed since the last ClearMovedSolids, may repeat.
+	// Removing a solid lists its id if the last solid moved into it
+	const std::vector<SolidId>& GetMovedSolids() const;
+	void ClearMovedSolids();
+
+private:
+	void MarkDirty(SolidId id);
+	void StoreTransform(SolidId id, const glm::vec3& pos, const glm::vec3& scale);
+	void UpdateTransform(SolidId id);
+	void UpdateCollisionBox(SolidId id);
+
+	template<typename Type>
+	static void MoveLastInto(std::vector<Type>& soaArray, SolidId id);
+
+	// UpdateTransforms composes all solids in one batch from this size and dirty share on
+	constexpr static size_t batchUpdateMinSize = 64;
+	constexpr static size_t batchUpdateDirtyShare = 4;
+
+	// Hot, read every frame. Transforms are split per component for TransformKernel
+	std::vector<float> posX;
+	std::vector<float> posY;
+	std::vector<float> posZ;
+	std::vector<float> rotX;
+	std::vector<float> rotY;
+	std::vector<float> rotZ;
+	std::vector<float> rotW;
+	std::vector<float> scaleX;
+	std::vector<float> scaleY;
+	std::vector<float> scaleZ;
+	std::vector<glm::mat4> modelMatrices;
+	std::vector<glm::mat3> normalMatrices;
+	std::vector<float> boxMinX;
+	std::vector<float> boxMinY;
+	std::vector<float> boxMinZ;
+	std::vector<float> boxMaxX;
+	std::vector<float> boxMaxY;
+	std::vector<float> boxMaxZ;
+	std::vector<char> ghostModes;
+	std::vector<char> dirtyFlags;
+	std::vector<SolidId> dirtySolids;
+	SpatialHashGrid grid;
+	std::vector<SolidId> movedSolids;
+	bool hasCollisionBounds = false;
+	glm::vec3 collisionBoundsMin = glm::vec3(-0.5f);
+	glm::vec3 collisionBoundsMax = glm::vec3(0.5f);
+
+	// Cold
+	std::vector<std::string> names;
+	std::vector<glm::vec3> fronts;
+	std::vector<SolidSim::Rotation> rotations;
+	std::vector<std::pair<SolidSim::Rotation, SolidSim::Rotation>> rotationLimits;
+	std::vector<uint8_t> disabledDirs; // Bit per SolidSim::Direction
+	std::unordered_map<std::string, SolidId> ids;
+};
@@ -1,6 +1,11 @@
 #include "SolidSim.h"
 
 void SolidSim::CheckRotationLimits()
+{
+	ClampRotation(rotate, rotationLimits);
+}
+
+void SolidSim::ClampRotation(Rotation& rotate, const std::pair<Rotation, Rotation>& rotationLimits)
 {
 	auto CheckRotation = [](float& toCheck, float min, float max)
 	{
@@ -38,14 +43,42 @@ void SolidSim::ResetModelMatrix(const Rotation& toRotate)
 {
 	rotate += toRotate;
 
-	model = glm::mat4(1.0f);
-	model = glm::translate(model, pos);
-	model = glm::scale(model, scale);
-	// gimbal lock will happen, will rewrite to use quaternions later
-	for (int i = 0; i <3; ++i)
+	model = ComposeModelMatrix(pos, scale, ToQuaternion(rotate));
+}
+
+glm::quat SolidSim::ToQuaternion(const Rotation& rotate)
+{
+	return
+		glm::angleAxis(rotate.x, glm::vec3(1.0f, 0.0f, 0.0f)) *
+		glm::angleAxis(rotate.y, glm::vec3(0.0f, 1.0f, 0.0f)) *
+		glm::angleAxis(rotate.z, glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+glm::mat4 SolidSim::ComposeModelMatrix(const glm::vec3& pos, const glm::vec3& scale, const glm::quat& orientation)
+{
+	glm::mat3 rotation = glm::mat3_cast(orientation);
+	glm::mat4 model;
+
+	for (int column = 0; column < 3; ++column)
+	{
+		model[column] = glm::vec4(rotation[column] * scale[column], 0.0f);
+	}
+	model[3] = glm::vec4(pos, 1.0f);
+
+	return model;
+}
+
+glm::mat3 SolidSim::ComposeNormalMatrix(const glm::vec3& scale, const glm::quat& orientation)
+{
+	// (R * S)^-T = R * S^-1, as R^-T = R for a rotation
+	glm::mat3 normalMatrix = glm::mat3_cast(orientation);
+
+	for (int column = 0; column < 3; ++column)
 	{
-		model = glm::rotate(model, rotate[i], { i == 0, i == 1, i == 2 });
+		normalMatrix[column] *= 1.0f / scale[column];
 	}
+
+	return normalMatrix;
 }
 
 SolidSim::SolidSim(
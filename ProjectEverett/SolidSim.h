@@ -6,6 +6,7 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "glm/gtc/quaternion.hpp"
 
 class SolidSim
 {
@@ -110,4 +111,13 @@ public:
 	void Rotate(const Rotation& toRotate);
 
 	static bool CheckForCollision(const SolidSim& solid1, const SolidSim& solid2);
+
+	// Shared with SolidRegistry, which keeps the same transforms outside of SolidSim.
+	// Rotations are applied around x, then y, then z axis of the solid
+	static glm::quat ToQuaternion(const Rotation& rotate);
+	// Scaled, rotated and then moved
+	static glm::mat4 ComposeModelMatrix(const glm::vec3& pos, const glm::vec3& scale, const glm::quat& orientation);
+	// Inverse transpose of the model matrix without translation, built without an inverse
+	static glm::mat3 ComposeNormalMatrix(const glm::vec3& scale, const glm::quat& orientation);
+	static void ClampRotation(Rotation& rotate, const std::pair<Rotation, Rotation>& rotationLimits);
 };
\ No newline at end of file
@@ -133,6 +133,18 @@ void SoundSim::UpdatePositions()
 	alListenerfv(AL_ORIENTATION, cameraOrientation.data());
 }
 
+void SoundSim::SetPosition(const glm::vec3& pos)
+{
+	sound.pos = glm::vec3(pos);
+
+	UpdatePositions();
+}
+
+glm::vec3 SoundSim::GetPosition()
+{
+	return sound.pos;
+}
+
 SoundSim::SoundSim(const std::string& file, glm::vec3& pos)
 {
 	sound.pos = std::move(pos);
@@ -53,5 +53,7 @@ public:
 	bool IsPlaying();
 	void Stop();
 	void UpdatePositions();
+	void SetPosition(const glm::vec3& pos);
+	glm::vec3 GetPosition();
 	~SoundSim();
 };
\ No newline at end of file
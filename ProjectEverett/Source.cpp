@@ -15,6 +15,9 @@
 #include "SolidSim.h"
 #include "CameraSim.h"
 #include "SoundSim.h"
+#include "TransformKernel.h"
+#include "BoxOverlapKernel.h"
+#include "SceneBVH.h"
 
 #include "CommandHandler.h"
 
@@ -303,9 +306,62 @@ int main()
 		camera.SetGhostMode(arg == "1");
 	};
 
+	auto BenchmarkTransformsCommand = [](const std::string& arg)
+	{
+		try
+		{
+			TransformKernel::Benchmark(std::stoul(arg));
+		}
+		catch (std::logic_error&)
+		{
+			std::cerr << "Expected amount of transforms, got " + arg + '\n';
+		}
+	};
+
+	auto BenchmarkOverlapsCommand = [](const std::string& arg)
+	{
+		try
+		{
+			BoxOverlapKernel::Benchmark(std::stoul(arg));
+		}
+		catch (std::logic_error&)
+		{
+			std::cerr << "Expected amount of boxes, got " + arg + '\n';
+		}
+	};
+
+	auto BenchmarkSceneCommand = [](const std::string& arg)
+	{
+		try
+		{
+			SceneBVH::Benchmark(std::stoul(arg));
+		}
+		catch (std::logic_error&)
+		{
+			std::cerr << "Expected amount of boxes, got " + arg + '\n';
+		}
+	};
+
+	// "stop" stops the capture, anything else is the path of a new one
+	auto CaptureCommandsCommand = [&lgl](const std::string& arg)
+	{
+		if (arg == "stop")
+		{
+			lgl.StopCommandCapture();
+		}
+		else if (!lgl.StartCommandCapture(arg))
+		{
+			std::cerr << "Failed to start GL command capture into " + arg + '\n';
+		}
+	};
+
 	CommandHandler commandHandler;
 	commandHandler.AddCommandLambda("spawnSolid", SpawnSolidCommand);
 	commandHandler.AddCommandLambda("ghostMode", GhostModeToggleCommand);
+	commandHandler.AddCommandLambda("benchmarkTransforms", BenchmarkTransformsCommand);
+	commandHandler.AddCommandLambda("benchmarkOverlaps", BenchmarkOverlapsCommand);
+	commandHandler.AddCommandLambda("benchmarkScene", BenchmarkSceneCommand);
+	commandHandler.AddCommandLambda("captureCommands", CaptureCommandsCommand);
 
 	std::string walkingDirections = "wsad";
 	std::vector<SoundSim> walkingSounds;
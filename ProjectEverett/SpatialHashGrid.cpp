@@ -0,0 +1,205 @@
+#include <cmath>
+#include <algorithm>
+
+#include "SpatialHashGrid.h"
+
+namespace
+{
+	// Cell coordinates are packed by 21 bits per axis
+	constexpr int cellCoordLimit = (1 << 20) - 1;
+
+	int ToCellCoord(float coord)
+	{
+		float clamped = std::max(std::min(std::floor(coord), static_cast<float>(cellCoordLimit)), static_cast<float>(-cellCoordLimit));
+
+		return static_cast<int>(clamped);
+	}
+}
+
+SpatialHashGrid::SpatialHashGrid(float cellSize)
+	: cellSize(cellSize), inverseCellSize(1.0f / cellSize)
+{}
+
+void SpatialHashGrid::Update(BoxId id, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	if (id >= ranges.size())
+	{
+		ranges.resize(id + 1);
+	}
+
+	CellRange newRange = GetCellRange(boxMin, boxMax);
+	CellRange& range = ranges[id];
+
+	if (range.inGrid && range.min == newRange.min && range.max == newRange.max)
+	{
+		return;
+	}
+
+	if (range.inGrid)
+	{
+		Erase(id, range);
+	}
+
+	Insert(id, newRange);
+	range = newRange;
+}
+
+void SpatialHashGrid::Remove(BoxId id)
+{
+	if (id >= ranges.size() || !ranges[id].inGrid)
+	{
+		return;
+	}
+
+	Erase(id, ranges[id]);
+	ranges[id].inGrid = false;
+}
+
+void SpatialHashGrid::Move(BoxId from, BoxId to)
+{
+	if (from >= ranges.size() || !ranges[from].inGrid || from == to)
+	{
+		return;
+	}
+
+	if (to >= ranges.size())
+	{
+		ranges.resize(to + 1);
+	}
+
+	Rename(from, to, ranges[from]);
+
+	ranges[to] = ranges[from];
+	ranges[from].inGrid = false;
+}
+
+void SpatialHashGrid::Clear()
+{
+	cells.clear();
+	oversizedBoxes.clear();
+	ranges.clear();
+}
+
+float SpatialHashGrid::GetCellSize() const
+{
+	return cellSize;
+}
+
+bool SpatialHashGrid::IsOversized(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	return GetCellRange(boxMin, boxMax).oversized;
+}
+
+SpatialHashGrid::CellRange SpatialHashGrid::GetCellRange(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	CellRange range;
+
+	range.min = { ToCellCoord(boxMin.x * inverseCellSize), ToCellCoord(boxMin.y * inverseCellSize), ToCellCoord(boxMin.z * inverseCellSize) };
+	range.max = { ToCellCoord(boxMax.x * inverseCellSize), ToCellCoord(boxMax.y * inverseCellSize), ToCellCoord(boxMax.z * inverseCellSize) };
+	range.inGrid = true;
+
+	glm::ivec3 cellAmount = range.max - range.min + 1;
+	range.oversized = static_cast<int64_t>(cellAmount.x) * cellAmount.y * cellAmount.z > maxCellsPerBox;
+
+	return range;
+}
+
+uint64_t SpatialHashGrid::GetKey(int x, int y, int z)
+{
+	constexpr uint64_t mask = (1 << 21) - 1;
+
+	return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21) | ((static_cast<uint64_t>(z) & mask) << 42);
+}
+
+void SpatialHashGrid::Insert(BoxId id, const CellRange& range)
+{
+	if (range.oversized)
+	{
+		oversizedBoxes.push_back(id);
+		return;
+	}
+
+	for (int x = range.min.x; x <= range.max.x; ++x)
+	{
+		for (int y = range.min.y; y <= range.max.y; ++y)
+		{
+			for (int z = range.min.z; z <= range.max.z; ++z)
+			{
+				cells[GetKey(x, y, z)].push_back(id);
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::Erase(BoxId id, const CellRange& range)
+{
+	auto EraseFrom = [id](std::vector<BoxId>& boxes)
+	{
+		auto boxIter = std::find(boxes.begin(), boxes.end(), id);
+
+		if (boxIter != boxes.end())
+		{
+			*boxIter = boxes.back();
+			boxes.pop_back();
+		}
+	};
+
+	if (range.oversized)
+	{
+		EraseFrom(oversizedBoxes);
+		return;
+	}
+
+	for (int x = range.min.x; x <= range.max.x; ++x)
+	{
+		for (int y = range.min.y; y <= range.max.y; ++y)
+		{
+			for (int z = range.min.z; z <= range.max.z; ++z)
+			{
+				auto cellIter = cells.find(GetKey(x, y, z));
+
+				if (cellIter == cells.end())
+				{
+					continue;
+				}
+
+				EraseFrom(cellIter->second);
+
+				if (cellIter->second.empty())
+				{
+					cells.erase(cellIter);
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::Rename(BoxId from, BoxId to, const CellRange& range)
+{
+	auto RenameIn = [from, to](std::vector<BoxId>& boxes)
+	{
+		std::replace(boxes.begin(), boxes.end(), from, to);
+	};
+
+	if (range.oversized)
+	{
+		RenameIn(oversizedBoxes);
+		return;
+	}
+
+	for (int x = range.min.x; x <= range.max.x; ++x)
+	{
+		for (int y = range.min.y; y <= range.max.y; ++y)
+		{
+			for (int z = range.min.z; z <= range.max.z; ++z)
+			{
+				auto cellIter = cells.find(GetKey(x, y, z));
+
+				if (cellIter != cells.end())
+				{
+					RenameIn(cellIter->second);
+				}
+			}
+		}
+	}
+}
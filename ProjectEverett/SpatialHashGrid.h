@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include "glm/glm.hpp"
+
+/*
+	Broadphase over AABBs by a uniform grid of cubic cells, stored sparsely in a hash map
+
+	Box is listed in every cell it overlaps, moving it only touches the cells it entered or left,
+	boxes that stay in their cells cost nothing. Queries visit the cells overlapping the query box
+	and report each box once, in the first cell the query and the box share.
+
+	Boxes spanning more than maxCellsPerBox cells are kept in a separate list checked by every query,
+	so one large floor does not fill thousands of cells
+*/
+class SpatialHashGrid
+{
+public:
+	using BoxId = uint32_t;
+
+	SpatialHashGrid(float cellSize = 2.0f);
+
+	// Inserts the box if the id is not in the grid
+	void Update(BoxId id, const glm::vec3& boxMin, const glm::vec3& boxMax);
+	void Remove(BoxId id);
+	// Box of "from" takes id "to", which must not be in the grid
+	void Move(BoxId from, BoxId to);
+	void Clear();
+
+	// Visitor is called as bool(BoxId) for each box possibly overlapping the query one, returning
+	// true stops the query. Returns true if it was stopped
+	template<typename Visitor>
+	bool Query(const glm::vec3& boxMin, const glm::vec3& boxMax, Visitor visitor) const;
+
+	float GetCellSize() const;
+	// True if the box spans more than maxCellsPerBox cells, so a query of it would visit all of them
+	bool IsOversized(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+
+	constexpr static int maxCellsPerBox = 64;
+
+private:
+	struct CellRange
+	{
+		glm::ivec3 min;
+		glm::ivec3 max;
+		bool inGrid = false;
+		bool oversized = false;
+	};
+
+	CellRange GetCellRange(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+	static uint64_t GetKey(int x, int y, int z);
+
+	void Insert(BoxId id, const CellRange& range);
+	void Erase(BoxId id, const CellRange& range);
+	void Rename(BoxId from, BoxId to, const CellRange& range);
+
+	float cellSize;
+	float inverseCellSize;
+
+	std::unordered_map<uint64_t, std::vector<BoxId>> cells;
+	std::vector<BoxId> oversizedBoxes;
+	std::vector<CellRange> ranges; // Indexed by id
+};
+
+template<typename Visitor>
+bool SpatialHashGrid::Query(const glm::vec3& boxMin, const glm::vec3& boxMax, Visitor visitor) const
+{
+	for (BoxId id : oversizedBoxes)
+	{
+		if (visitor(id))
+		{
+			return true;
+		}
+	}
+
+	CellRange queryRange = GetCellRange(boxMin, boxMax);
+
+	for (int x = queryRange.min.x; x <= queryRange.max.x; ++x)
+	{
+		for (int y = queryRange.min.y; y <= queryRange.max.y; ++y)
+		{
+			for (int z = queryRange.min.z; z <= queryRange.max.z; ++z)
+			{
+				auto cellIter = cells.find(GetKey(x, y, z));
+
+				if (cellIter == cells.end())
+				{
+					continue;
+				}
+
+				for (BoxId id : cellIter->second)
+				{
+					// Box spanning several of the visited cells is reported only in the first of them
+					const glm::ivec3& boxMinCell = ranges[id].min;
+					glm::ivec3 firstShared = glm::max(boxMinCell, queryRange.min);
+
+					if (firstShared != glm::ivec3(x, y, z))
+					{
+						continue;
+					}
+
+					if (visitor(id))
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
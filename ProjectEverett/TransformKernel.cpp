@@ -0,0 +1,412 @@
+#include <immintrin.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "glm/gtc/quaternion.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "SolidSim.h"
+#include "TransformKernel.h"
+
+TransformKernel::InstructionSet TransformKernel::instructionSet = SIMDSupport::GetSupportedInstructionSet();
+
+namespace
+{
+	// Elements of rotation matrix columns in order, as glm::mat3_cast computes them
+	void RotationFromQuaternion(__m128 x, __m128 y, __m128 z, __m128 w, __m128 rotation[9])
+	{
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 two = _mm_set1_ps(2.0f);
+
+		__m128 qxx = _mm_mul_ps(x, x);
+		__m128 qyy = _mm_mul_ps(y, y);
+		__m128 qzz = _mm_mul_ps(z, z);
+		__m128 qxz = _mm_mul_ps(x, z);
+		__m128 qxy = _mm_mul_ps(x, y);
+		__m128 qyz = _mm_mul_ps(y, z);
+		__m128 qwx = _mm_mul_ps(w, x);
+		__m128 qwy = _mm_mul_ps(w, y);
+		__m128 qwz = _mm_mul_ps(w, z);
+
+		rotation[0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz)));
+		rotation[1] = _mm_mul_ps(two, _mm_add_ps(qxy, qwz));
+		rotation[2] = _mm_mul_ps(two, _mm_sub_ps(qxz, qwy));
+		rotation[3] = _mm_mul_ps(two, _mm_sub_ps(qxy, qwz));
+		rotation[4] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz)));
+		rotation[5] = _mm_mul_ps(two, _mm_add_ps(qyz, qwx));
+		rotation[6] = _mm_mul_ps(two, _mm_add_ps(qxz, qwy));
+		rotation[7] = _mm_mul_ps(two, _mm_sub_ps(qyz, qwx));
+		rotation[8] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy)));
+	}
+
+	SIMD_HELPER_AVX void RotationFromQuaternion(__m256 x, __m256 y, __m256 z, __m256 w, __m256 rotation[9])
+	{
+		__m256 one = _mm256_set1_ps(1.0f);
+		__m256 two = _mm256_set1_ps(2.0f);
+
+		__m256 qxx = _mm256_mul_ps(x, x);
+		__m256 qyy = _mm256_mul_ps(y, y);
+		__m256 qzz = _mm256_mul_ps(z, z);
+		__m256 qxz = _mm256_mul_ps(x, z);
+		__m256 qxy = _mm256_mul_ps(x, y);
+		__m256 qyz = _mm256_mul_ps(y, z);
+		__m256 qwx = _mm256_mul_ps(w, x);
+		__m256 qwy = _mm256_mul_ps(w, y);
+		__m256 qwz = _mm256_mul_ps(w, z);
+
+		rotation[0] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qyy, qzz)));
+		rotation[1] = _mm256_mul_ps(two, _mm256_add_ps(qxy, qwz));
+		rotation[2] = _mm256_mul_ps(two, _mm256_sub_ps(qxz, qwy));
+		rotation[3] = _mm256_mul_ps(two, _mm256_sub_ps(qxy, qwz));
+		rotation[4] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qzz)));
+		rotation[5] = _mm256_mul_ps(two, _mm256_add_ps(qyz, qwx));
+		rotation[6] = _mm256_mul_ps(two, _mm256_add_ps(qxz, qwy));
+		rotation[7] = _mm256_mul_ps(two, _mm256_sub_ps(qyz, qwx));
+		rotation[8] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qyy)));
+	}
+
+	// Transposes 4 rows, each holding one element of 4 matrices, and stores each matrix with the stride
+	void StoreTransposed(float* destination, size_t stride, __m128 row0, __m128 row1, __m128 row2, __m128 row3)
+	{
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		_mm_storeu_ps(destination, row0);
+		_mm_storeu_ps(destination + stride, row1);
+		_mm_storeu_ps(destination + stride * 2, row2);
+		_mm_storeu_ps(destination + stride * 3, row3);
+	}
+
+	// Same for 8 rows of 8 matrices. Written out, as GCC keeps loops over register arrays rolled and
+	// spills them to the stack
+	SIMD_HELPER_AVX void StoreTransposed(
+		float* destination,
+		size_t stride,
+		__m256 row0, __m256 row1, __m256 row2, __m256 row3,
+		__m256 row4, __m256 row5, __m256 row6, __m256 row7
+	)
+	{
+		__m256 pair0 = _mm256_unpacklo_ps(row0, row1);
+		__m256 pair1 = _mm256_unpackhi_ps(row0, row1);
+		__m256 pair2 = _mm256_unpacklo_ps(row2, row3);
+		__m256 pair3 = _mm256_unpackhi_ps(row2, row3);
+		__m256 pair4 = _mm256_unpacklo_ps(row4, row5);
+		__m256 pair5 = _mm256_unpackhi_ps(row4, row5);
+		__m256 pair6 = _mm256_unpacklo_ps(row6, row7);
+		__m256 pair7 = _mm256_unpackhi_ps(row6, row7);
+
+		__m256 quad0 = _mm256_shuffle_ps(pair0, pair2, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 quad1 = _mm256_shuffle_ps(pair0, pair2, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 quad2 = _mm256_shuffle_ps(pair1, pair3, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 quad3 = _mm256_shuffle_ps(pair1, pair3, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 quad4 = _mm256_shuffle_ps(pair4, pair6, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 quad5 = _mm256_shuffle_ps(pair4, pair6, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 quad6 = _mm256_shuffle_ps(pair5, pair7, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 quad7 = _mm256_shuffle_ps(pair5, pair7, _MM_SHUFFLE(3, 2, 3, 2));
+
+		_mm256_storeu_ps(destination, _mm256_permute2f128_ps(quad0, quad4, 0x20));
+		_mm256_storeu_ps(destination + stride, _mm256_permute2f128_ps(quad1, quad5, 0x20));
+		_mm256_storeu_ps(destination + stride * 2, _mm256_permute2f128_ps(quad2, quad6, 0x20));
+		_mm256_storeu_ps(destination + stride * 3, _mm256_permute2f128_ps(quad3, quad7, 0x20));
+		_mm256_storeu_ps(destination + stride * 4, _mm256_permute2f128_ps(quad0, quad4, 0x31));
+		_mm256_storeu_ps(destination + stride * 5, _mm256_permute2f128_ps(quad1, quad5, 0x31));
+		_mm256_storeu_ps(destination + stride * 6, _mm256_permute2f128_ps(quad2, quad6, 0x31));
+		_mm256_storeu_ps(destination + stride * 7, _mm256_permute2f128_ps(quad3, quad7, 0x31));
+	}
+}
+
+void TransformKernel::Compose(
+	const Transforms& transforms,
+	size_t first,
+	size_t amount,
+	glm::mat4* modelMatrices,
+	glm::mat3* normalMatrices
+)
+{
+	GetComposeFunction(instructionSet)(transforms, first, amount, modelMatrices, normalMatrices);
+}
+
+TransformKernel::InstructionSet TransformKernel::GetInstructionSet()
+{
+	return instructionSet;
+}
+
+void TransformKernel::SetInstructionSet(InstructionSet instructionSet)
+{
+	TransformKernel::instructionSet = std::min(instructionSet, SIMDSupport::GetSupportedInstructionSet());
+}
+
+TransformKernel::ComposeFunction TransformKernel::GetComposeFunction(InstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+	case InstructionSet::AVX512:
+	case InstructionSet::AVX:
+		return ComposeAVX;
+	case InstructionSet::SSE:
+		return ComposeSSE;
+	default:
+		return ComposeScalar;
+	}
+}
+
+void TransformKernel::ComposeScalar(
+	const Transforms& transforms,
+	size_t first,
+	size_t amount,
+	glm::mat4* modelMatrices,
+	glm::mat3* normalMatrices
+)
+{
+	for (size_t i = first; i < first + amount; ++i)
+	{
+		glm::vec3 pos(transforms.posX[i], transforms.posY[i], transforms.posZ[i]);
+		glm::quat orientation(transforms.rotW[i], transforms.rotX[i], transforms.rotY[i], transforms.rotZ[i]);
+		glm::vec3 scale(transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i]);
+
+		modelMatrices[i] = SolidSim::ComposeModelMatrix(pos, scale, orientation);
+		normalMatrices[i] = SolidSim::ComposeNormalMatrix(scale, orientation);
+	}
+}
+
+void TransformKernel::ComposeSSE(
+	const Transforms& transforms,
+	size_t first,
+	size_t amount,
+	glm::mat4* modelMatrices,
+	glm::mat3* normalMatrices
+)
+{
+	size_t end = first + amount;
+	size_t i = first;
+
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 rotation[9];
+		RotationFromQuaternion(
+			_mm_loadu_ps(transforms.rotX + i),
+			_mm_loadu_ps(transforms.rotY + i),
+			_mm_loadu_ps(transforms.rotZ + i),
+			_mm_loadu_ps(transforms.rotW + i),
+			rotation
+		);
+
+		__m128 scaleX = _mm_loadu_ps(transforms.scaleX + i);
+		__m128 scaleY = _mm_loadu_ps(transforms.scaleY + i);
+		__m128 scaleZ = _mm_loadu_ps(transforms.scaleZ + i);
+
+		// Column of 4 matrices at a time
+		float* model = glm::value_ptr(modelMatrices[i]);
+
+		StoreTransposed(model, 16,
+			_mm_mul_ps(rotation[0], scaleX), _mm_mul_ps(rotation[1], scaleX), _mm_mul_ps(rotation[2], scaleX), zero);
+		StoreTransposed(model + 4, 16,
+			_mm_mul_ps(rotation[3], scaleY), _mm_mul_ps(rotation[4], scaleY), _mm_mul_ps(rotation[5], scaleY), zero);
+		StoreTransposed(model + 8, 16,
+			_mm_mul_ps(rotation[6], scaleZ), _mm_mul_ps(rotation[7], scaleZ), _mm_mul_ps(rotation[8], scaleZ), zero);
+		StoreTransposed(model + 12, 16,
+			_mm_loadu_ps(transforms.posX + i), _mm_loadu_ps(transforms.posY + i), _mm_loadu_ps(transforms.posZ + i), one);
+
+		// 9 elements per matrix, first 8 go as two transposed groups of 4, the last one alone
+		__m128 inverseScaleX = _mm_div_ps(one, scaleX);
+		__m128 inverseScaleY = _mm_div_ps(one, scaleY);
+		__m128 inverseScaleZ = _mm_div_ps(one, scaleZ);
+
+		float* normal = glm::value_ptr(normalMatrices[i]);
+
+		StoreTransposed(normal, 9,
+			_mm_mul_ps(rotation[0], inverseScaleX), _mm_mul_ps(rotation[1], inverseScaleX),
+			_mm_mul_ps(rotation[2], inverseScaleX), _mm_mul_ps(rotation[3], inverseScaleY));
+		StoreTransposed(normal + 4, 9,
+			_mm_mul_ps(rotation[4], inverseScaleY), _mm_mul_ps(rotation[5], inverseScaleY),
+			_mm_mul_ps(rotation[6], inverseScaleZ), _mm_mul_ps(rotation[7], inverseScaleZ));
+
+		alignas(16) float last[4];
+		_mm_store_ps(last, _mm_mul_ps(rotation[8], inverseScaleZ));
+
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			normal[lane * 9 + 8] = last[lane];
+		}
+	}
+
+	ComposeScalar(transforms, i, end - i, modelMatrices, normalMatrices);
+}
+
+SIMD_TARGET_AVX void TransformKernel::ComposeAVX(
+	const Transforms& transforms,
+	size_t first,
+	size_t amount,
+	glm::mat4* modelMatrices,
+	glm::mat3* normalMatrices
+)
+{
+	size_t end = first + amount;
+	size_t i = first;
+
+	__m256 zero = _mm256_setzero_ps();
+	__m256 one = _mm256_set1_ps(1.0f);
+
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 rotation[9];
+		RotationFromQuaternion(
+			_mm256_loadu_ps(transforms.rotX + i),
+			_mm256_loadu_ps(transforms.rotY + i),
+			_mm256_loadu_ps(transforms.rotZ + i),
+			_mm256_loadu_ps(transforms.rotW + i),
+			rotation
+		);
+
+		__m256 scaleX = _mm256_loadu_ps(transforms.scaleX + i);
+		__m256 scaleY = _mm256_loadu_ps(transforms.scaleY + i);
+		__m256 scaleZ = _mm256_loadu_ps(transforms.scaleZ + i);
+
+		// Two columns of 8 matrices at a time
+		float* model = glm::value_ptr(modelMatrices[i]);
+
+		StoreTransposed(model, 16,
+			_mm256_mul_ps(rotation[0], scaleX), _mm256_mul_ps(rotation[1], scaleX), _mm256_mul_ps(rotation[2], scaleX), zero,
+			_mm256_mul_ps(rotation[3], scaleY), _mm256_mul_ps(rotation[4], scaleY), _mm256_mul_ps(rotation[5], scaleY), zero);
+		StoreTransposed(model + 8, 16,
+			_mm256_mul_ps(rotation[6], scaleZ), _mm256_mul_ps(rotation[7], scaleZ), _mm256_mul_ps(rotation[8], scaleZ), zero,
+			_mm256_loadu_ps(transforms.posX + i), _mm256_loadu_ps(transforms.posY + i), _mm256_loadu_ps(transforms.posZ + i), one);
+
+		// 9 elements per matrix, first 8 are transposed, the last one is stored alone
+		__m256 inverseScaleX = _mm256_div_ps(one, scaleX);
+		__m256 inverseScaleY = _mm256_div_ps(one, scaleY);
+		__m256 inverseScaleZ = _mm256_div_ps(one, scaleZ);
+
+		float* normal = glm::value_ptr(normalMatrices[i]);
+
+		StoreTransposed(normal, 9,
+			_mm256_mul_ps(rotation[0], inverseScaleX), _mm256_mul_ps(rotation[1], inverseScaleX),
+			_mm256_mul_ps(rotation[2], inverseScaleX), _mm256_mul_ps(rotation[3], inverseScaleY),
+			_mm256_mul_ps(rotation[4], inverseScaleY), _mm256_mul_ps(rotation[5], inverseScaleY),
+			_mm256_mul_ps(rotation[6], inverseScaleZ), _mm256_mul_ps(rotation[7], inverseScaleZ));
+
+		alignas(32) float last[8];
+		_mm256_store_ps(last, _mm256_mul_ps(rotation[8], inverseScaleZ));
+
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			normal[lane * 9 + 8] = last[lane];
+		}
+	}
+
+	ComposeScalar(transforms, i, end - i, modelMatrices, normalMatrices);
+}
+
+void TransformKernel::Benchmark(size_t transformAmount, size_t repeats)
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+	std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+	std::vector<std::vector<float>> components(10, std::vector<float>(transformAmount));
+	std::vector<glm::vec3> positions(transformAmount);
+	std::vector<glm::quat> orientations(transformAmount);
+	std::vector<glm::vec3> scales(transformAmount);
+
+	for (size_t i = 0; i < transformAmount; ++i)
+	{
+		positions[i] = { position(generator), position(generator), position(generator) };
+		orientations[i] = SolidSim::ToQuaternion({ angle(generator), angle(generator), angle(generator) });
+		scales[i] = { scale(generator), scale(generator), scale(generator) };
+
+		float values[10] = {
+			positions[i].x, positions[i].y, positions[i].z,
+			orientations[i].x, orientations[i].y, orientations[i].z, orientations[i].w,
+			scales[i].x, scales[i].y, scales[i].z
+		};
+
+		for (size_t component = 0; component < 10; ++component)
+		{
+			components[component][i] = values[component];
+		}
+	}
+
+	Transforms transforms = {
+		components[0].data(), components[1].data(), components[2].data(),
+		components[3].data(), components[4].data(), components[5].data(), components[6].data(),
+		components[7].data(), components[8].data(), components[9].data()
+	};
+
+	std::vector<glm::mat4> referenceModels(transformAmount);
+	std::vector<glm::mat3> referenceNormals(transformAmount);
+	std::vector<glm::mat4> modelMatrices(transformAmount);
+	std::vector<glm::mat3> normalMatrices(transformAmount);
+
+	// Fastest of the runs, slower ones are mostly the OS getting in the way
+	auto Time = [repeats](const std::function<void()>& compose)
+	{
+		compose();
+
+		double fastest = std::numeric_limits<double>::max();
+
+		for (size_t repeat = 0; repeat < std::max<size_t>(repeats, 1); ++repeat)
+		{
+			auto start = std::chrono::steady_clock::now();
+			compose();
+			std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+			fastest = std::min(fastest, time.count());
+		}
+
+		return fastest;
+	};
+
+	// Path solids took before, one SolidSim call per matrix from glm types
+	double referenceTime = Time([&]()
+	{
+		for (size_t i = 0; i < transformAmount; ++i)
+		{
+			referenceModels[i] = SolidSim::ComposeModelMatrix(positions[i], scales[i], orientations[i]);
+			referenceNormals[i] = SolidSim::ComposeNormalMatrix(scales[i], orientations[i]);
+		}
+	});
+
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "Composing " << transformAmount << " model and normal matrices, fastest of " << repeats << " run(s)\n";
+	std::cout << "SolidSim: " << referenceTime << " ms\n";
+
+	for (InstructionSet set : { InstructionSet::Scalar, InstructionSet::SSE, InstructionSet::AVX })
+	{
+		if (set > SIMDSupport::GetSupportedInstructionSet())
+		{
+			std::cout << SIMDSupport::GetInstructionSetName(set) << ": not supported\n";
+			continue;
+		}
+
+		ComposeFunction compose = GetComposeFunction(set);
+		double time = Time([&]() { compose(transforms, 0, transformAmount, modelMatrices.data(), normalMatrices.data()); });
+
+		float maxDifference = 0.0f;
+		for (size_t i = 0; i < transformAmount; ++i)
+		{
+			for (int element = 0; element < 16; ++element)
+			{
+				float difference = glm::value_ptr(modelMatrices[i])[element] - glm::value_ptr(referenceModels[i])[element];
+				maxDifference = std::max(maxDifference, std::abs(difference));
+			}
+			for (int element = 0; element < 9; ++element)
+			{
+				float difference = glm::value_ptr(normalMatrices[i])[element] - glm::value_ptr(referenceNormals[i])[element];
+				maxDifference = std::max(maxDifference, std::abs(difference));
+			}
+		}
+
+		std::cout << SIMDSupport::GetInstructionSetName(set) << ": " << time << " ms, " <<
+			referenceTime / std::max(time, 1e-9) << "x, max difference " << maxDifference << '\n';
+	}
+}
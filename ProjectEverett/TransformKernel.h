@@ -0,0 +1,62 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "SIMDSupport.h"
+
+/*
+	Batch composition of model and normal matrices from transforms kept as structure of arrays
+
+	Model matrix is T * R * S and normal matrix R * S^-1, as SolidSim::ComposeModelMatrix and
+	SolidSim::ComposeNormalMatrix build them, with the same operations in the same order, so all
+	paths give the same results. AVX composes 8 transforms at once, SSE 4, the rest of a batch is
+	composed one by one. The widest instruction set the CPU and OS support is chosen at runtime
+*/
+class TransformKernel
+{
+public:
+	using InstructionSet = SIMDSupport::InstructionSet;
+
+	// Orientation is a unit quaternion
+	struct Transforms
+	{
+		const float* posX;
+		const float* posY;
+		const float* posZ;
+		const float* rotX;
+		const float* rotY;
+		const float* rotZ;
+		const float* rotW;
+		const float* scaleX;
+		const float* scaleY;
+		const float* scaleZ;
+	};
+
+	// Composes transforms [first, first + amount) into the same indices of the outputs
+	static void Compose(
+		const Transforms& transforms,
+		size_t first,
+		size_t amount,
+		glm::mat4* modelMatrices,
+		glm::mat3* normalMatrices
+	);
+
+	static InstructionSet GetInstructionSet();
+	// Clamped to the supported one, meant for benchmarks and debugging. AVX-512 runs the AVX path
+	static void SetInstructionSet(InstructionSet instructionSet);
+
+	// Times the per solid SolidSim path against every supported instruction set on random
+	// transforms and prints the results
+	static void Benchmark(size_t transformAmount, size_t repeats = 20);
+
+private:
+	using ComposeFunction = void(*)(const Transforms&, size_t, size_t, glm::mat4*, glm::mat3*);
+
+	static void ComposeScalar(const Transforms& transforms, size_t first, size_t amount, glm::mat4* modelMatrices, glm::mat3* normalMatrices);
+	static void ComposeSSE(const Transforms& transforms, size_t first, size_t amount, glm::mat4* modelMatrices, glm::mat3* normalMatrices);
+	static void ComposeAVX(const Transforms& transforms, size_t first, size_t amount, glm::mat4* modelMatrices, glm::mat3* normalMatrices);
+
+	static ComposeFunction GetComposeFunction(InstructionSet instructionSet);
+
+	static InstructionSet instructionSet;
+};
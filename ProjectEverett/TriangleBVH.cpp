@@ -0,0 +1,720 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "TriangleBVH.h"
+
+namespace
+{
+	float SurfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		glm::vec3 extent = boundsMax - boundsMin;
+
+		return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+
+	// Separating axis test of Akenine-Moller, box is centered at the origin
+	bool TriangleOverlapsBox(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& halfSize)
+	{
+		auto SeparatedBy = [&](const glm::vec3& axis)
+		{
+			// Parallel edges give no axis
+			if (glm::dot(axis, axis) < 1e-12f)
+			{
+				return false;
+			}
+
+			float p0 = glm::dot(v0, axis);
+			float p1 = glm::dot(v1, axis);
+			float p2 = glm::dot(v2, axis);
+			float radius = glm::dot(halfSize, glm::abs(axis));
+
+			return std::min({ p0, p1, p2 }) >= radius || std::max({ p0, p1, p2 }) <= -radius;
+		};
+
+		glm::vec3 edges[3] = { v1 - v0, v2 - v1, v0 - v2 };
+		glm::vec3 boxAxes[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+
+		for (auto& boxAxis : boxAxes)
+		{
+			if (SeparatedBy(boxAxis))
+			{
+				return false;
+			}
+		}
+
+		if (SeparatedBy(glm::cross(edges[0], edges[1])))
+		{
+			return false;
+		}
+
+		for (auto& edge : edges)
+		{
+			for (auto& boxAxis : boxAxes)
+			{
+				if (SeparatedBy(glm::cross(edge, boxAxis)))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Closest points of Ericson, Real-Time Collision Detection 5.1.5 and 5.1.9
+	glm::vec3 ClosestPointOnTriangle(const glm::vec3& point, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+	{
+		glm::vec3 ab = b - a;
+		glm::vec3 ac = c - a;
+		glm::vec3 ap = point - a;
+
+		float d1 = glm::dot(ab, ap);
+		float d2 = glm::dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+		{
+			return a;
+		}
+
+		glm::vec3 bp = point - b;
+		float d3 = glm::dot(ab, bp);
+		float d4 = glm::dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3)
+		{
+			return b;
+		}
+
+		float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		{
+			return a + ab * (d1 / (d1 - d3));
+		}
+
+		glm::vec3 cp = point - c;
+		float d5 = glm::dot(ab, cp);
+		float d6 = glm::dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6)
+		{
+			return c;
+		}
+
+		float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		{
+			return a + ac * (d2 / (d2 - d6));
+		}
+
+		float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		{
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		}
+
+		float denominator = 1.0f / (va + vb + vc);
+
+		return a + ab * (vb * denominator) + ac * (vc * denominator);
+	}
+
+	float SquaredDistanceSegmentSegment(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2)
+	{
+		constexpr float epsilon = 1e-12f;
+
+		glm::vec3 d1 = q1 - p1;
+		glm::vec3 d2 = q2 - p2;
+		glm::vec3 r = p1 - p2;
+
+		float a = glm::dot(d1, d1);
+		float e = glm::dot(d2, d2);
+		float f = glm::dot(d2, r);
+
+		float s = 0.0f;
+		float t = 0.0f;
+
+		if (a <= epsilon && e <= epsilon)
+		{
+			return glm::dot(r, r);
+		}
+
+		if (a <= epsilon)
+		{
+			t = glm::clamp(f / e, 0.0f, 1.0f);
+		}
+		else
+		{
+			float c = glm::dot(d1, r);
+
+			if (e <= epsilon)
+			{
+				s = glm::clamp(-c / a, 0.0f, 1.0f);
+			}
+			else
+			{
+				float b = glm::dot(d1, d2);
+				float denominator = a * e - b * b;
+
+				s = denominator != 0.0f ? glm::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+				t = (b * s + f) / e;
+
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = glm::clamp(-c / a, 0.0f, 1.0f);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+				}
+			}
+		}
+
+		glm::vec3 difference = (p1 + d1 * s) - (p2 + d2 * t);
+
+		return glm::dot(difference, difference);
+	}
+
+	bool SegmentCrossesTriangle(const glm::vec3& start, const glm::vec3& end, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+	{
+		glm::vec3 direction = end - start;
+		glm::vec3 ab = b - a;
+		glm::vec3 ac = c - a;
+
+		glm::vec3 p = glm::cross(direction, ac);
+		float determinant = glm::dot(ab, p);
+
+		// Parallel segments are left to the edge distances
+		if (std::abs(determinant) < 1e-12f)
+		{
+			return false;
+		}
+
+		float inverseDeterminant = 1.0f / determinant;
+		glm::vec3 fromA = start - a;
+
+		float u = glm::dot(fromA, p) * inverseDeterminant;
+		if (u < 0.0f || u > 1.0f)
+		{
+			return false;
+		}
+
+		glm::vec3 q = glm::cross(fromA, ab);
+
+		float v = glm::dot(direction, q) * inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f)
+		{
+			return false;
+		}
+
+		float t = glm::dot(ac, q) * inverseDeterminant;
+
+		return t >= 0.0f && t <= 1.0f;
+	}
+
+	// Moller-Trumbore, both sides of the triangle are hit
+	bool RayHitsTriangle(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		const glm::vec3& a,
+		const glm::vec3& b,
+		const glm::vec3& c,
+		float& distance
+	)
+	{
+		glm::vec3 ab = b - a;
+		glm::vec3 ac = c - a;
+
+		glm::vec3 p = glm::cross(direction, ac);
+		float determinant = glm::dot(ab, p);
+
+		if (std::abs(determinant) < 1e-12f)
+		{
+			return false;
+		}
+
+		float inverseDeterminant = 1.0f / determinant;
+		glm::vec3 fromA = origin - a;
+
+		float u = glm::dot(fromA, p) * inverseDeterminant;
+		if (u < 0.0f || u > 1.0f)
+		{
+			return false;
+		}
+
+		glm::vec3 q = glm::cross(fromA, ab);
+
+		float v = glm::dot(direction, q) * inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f)
+		{
+			return false;
+		}
+
+		distance = glm::dot(ac, q) * inverseDeterminant;
+
+		return distance >= 0.0f;
+	}
+
+	float SquaredDistanceSegmentTriangle(const glm::vec3& start, const glm::vec3& end, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+	{
+		if (SegmentCrossesTriangle(start, end, a, b, c))
+		{
+			return 0.0f;
+		}
+
+		// Otherwise the closest points are at an end of the segment or on an edge of the triangle
+		glm::vec3 toStart = start - ClosestPointOnTriangle(start, a, b, c);
+		glm::vec3 toEnd = end - ClosestPointOnTriangle(end, a, b, c);
+
+		return std::min({
+			glm::dot(toStart, toStart),
+			glm::dot(toEnd, toEnd),
+			SquaredDistanceSegmentSegment(start, end, a, b),
+			SquaredDistanceSegmentSegment(start, end, b, c),
+			SquaredDistanceSegmentSegment(start, end, c, a)
+		});
+	}
+}
+
+TriangleBVH::TriangleBVH(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices)
+	: positions(positions)
+{
+	size_t triangleAmount = indices.size() / 3;
+
+	if (!triangleAmount)
+	{
+		return;
+	}
+
+	std::vector<BuildTriangle> triangles(triangleAmount);
+
+	boundsMin = positions[indices[0]];
+	boundsMax = boundsMin;
+
+	for (size_t i = 0; i < triangleAmount; ++i)
+	{
+		const glm::vec3& v0 = positions[indices[i * 3]];
+		const glm::vec3& v1 = positions[indices[i * 3 + 1]];
+		const glm::vec3& v2 = positions[indices[i * 3 + 2]];
+
+		BuildTriangle& triangle = triangles[i];
+		triangle.boundsMin = glm::min(glm::min(v0, v1), v2);
+		triangle.boundsMax = glm::max(glm::max(v0, v1), v2);
+		triangle.centroid = (triangle.boundsMin + triangle.boundsMax) * 0.5f;
+		triangle.index = static_cast<uint32_t>(i);
+
+		boundsMin = glm::min(boundsMin, triangle.boundsMin);
+		boundsMax = glm::max(boundsMax, triangle.boundsMax);
+	}
+
+	quantizeScale = 65535.0f / glm::max(boundsMax - boundsMin, glm::vec3(1e-6f));
+
+	nodes.reserve(triangleAmount / maxLeafTriangles * 2 + 1);
+	nodes.emplace_back();
+
+	BuildNode(0, triangles, 0, triangleAmount, 0);
+
+	this->indices.reserve(triangleAmount * 3);
+
+	for (auto& triangle : triangles)
+	{
+		for (size_t vertex = 0; vertex < 3; ++vertex)
+		{
+			this->indices.push_back(indices[triangle.index * 3 + vertex]);
+		}
+	}
+}
+
+bool TriangleBVH::IsEmpty() const
+{
+	return nodes.empty();
+}
+
+size_t TriangleBVH::GetNodeAmount() const
+{
+	return nodes.size();
+}
+
+size_t TriangleBVH::GetTriangleAmount() const
+{
+	return indices.size() / 3;
+}
+
+template<typename TriangleTest>
+bool TriangleBVH::Traverse(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& model, TriangleTest triangleTest) const
+{
+	if (nodes.empty())
+	{
+		return false;
+	}
+
+	// Box around the world space box moved to model space
+	glm::mat4 toModel = glm::inverse(model);
+	glm::mat3 toModelAbs = glm::mat3(glm::abs(toModel[0]), glm::abs(toModel[1]), glm::abs(toModel[2]));
+
+	glm::vec3 localCenter = glm::vec3(toModel * glm::vec4((boxMin + boxMax) * 0.5f, 1.0f));
+	glm::vec3 localHalfSize = toModelAbs * ((boxMax - boxMin) * 0.5f);
+
+	glm::vec3 localMin = localCenter - localHalfSize;
+	glm::vec3 localMax = localCenter + localHalfSize;
+
+	if (glm::any(glm::greaterThan(localMin, boundsMax)) || glm::any(glm::lessThan(localMax, boundsMin)))
+	{
+		return false;
+	}
+
+	uint16_t queryMin[3];
+	uint16_t queryMax[3];
+	Quantize(localMin, localMax, queryMin, queryMax);
+
+	// Each visited inner node replaces itself with 2 children, so depth + 2 entries are enough
+	uint32_t stack[maxDepth + 2];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		const Node& node = nodes[stack[--stackSize]];
+
+		bool overlaps =
+			queryMin[0] <= node.boundsMax[0] && queryMax[0] >= node.boundsMin[0] &&
+			queryMin[1] <= node.boundsMax[1] && queryMax[1] >= node.boundsMin[1] &&
+			queryMin[2] <= node.boundsMax[2] && queryMax[2] >= node.boundsMin[2];
+
+		if (!overlaps)
+		{
+			continue;
+		}
+
+		if (node.triangleAmount)
+		{
+			for (uint32_t triangle = node.offset; triangle < node.offset + node.triangleAmount; ++triangle)
+			{
+				glm::vec3 v0 = glm::vec3(model * glm::vec4(positions[indices[triangle * 3]], 1.0f));
+				glm::vec3 v1 = glm::vec3(model * glm::vec4(positions[indices[triangle * 3 + 1]], 1.0f));
+				glm::vec3 v2 = glm::vec3(model * glm::vec4(positions[indices[triangle * 3 + 2]], 1.0f));
+
+				if (triangleTest(v0, v1, v2))
+				{
+					return true;
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.offset + 1;
+			stack[stackSize++] = node.offset;
+		}
+	}
+
+	return false;
+}
+
+bool TriangleBVH::OverlapsBox(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& model) const
+{
+	glm::vec3 center = (boxMin + boxMax) * 0.5f;
+	glm::vec3 halfSize = (boxMax - boxMin) * 0.5f;
+
+	return Traverse(boxMin, boxMax, model, [&](const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+	{
+		return TriangleOverlapsBox(v0 - center, v1 - center, v2 - center, halfSize);
+	});
+}
+
+bool TriangleBVH::OverlapsCapsule(const glm::vec3& segmentStart, const glm::vec3& segmentEnd, float radius, const glm::mat4& model) const
+{
+	glm::vec3 boxMin = glm::min(segmentStart, segmentEnd) - radius;
+	glm::vec3 boxMax = glm::max(segmentStart, segmentEnd) + radius;
+
+	return Traverse(boxMin, boxMax, model, [&](const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+	{
+		return SquaredDistanceSegmentTriangle(segmentStart, segmentEnd, v0, v1, v2) < radius * radius;
+	});
+}
+
+bool TriangleBVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const glm::mat4& model, float& distance) const
+{
+	if (nodes.empty())
+	{
+		return false;
+	}
+
+	glm::mat4 toModel = glm::inverse(model);
+	glm::vec3 localOrigin = glm::vec3(toModel * glm::vec4(origin, 1.0f));
+	glm::vec3 localDirection = glm::mat3(toModel) * direction;
+
+	// Zero components would give 0 * inf in the slab test
+	glm::vec3 inverseDirection;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		inverseDirection[axis] = 1.0f / (localDirection[axis] != 0.0f ? localDirection[axis] : 1e-30f);
+	}
+
+	glm::vec3 dequantizeScale = 1.0f / quantizeScale;
+	float closest = maxDistance;
+
+	// Distance the ray enters the node at, negative if it misses it before the closest hit
+	auto GetEntryDistance = [&](const Node& node)
+	{
+		glm::vec3 nodeMin = boundsMin + glm::vec3(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2]) * dequantizeScale;
+		glm::vec3 nodeMax = boundsMin + glm::vec3(node.boundsMax[0], node.boundsMax[1], node.boundsMax[2]) * dequantizeScale;
+
+		glm::vec3 toMin = (nodeMin - localOrigin) * inverseDirection;
+		glm::vec3 toMax = (nodeMax - localOrigin) * inverseDirection;
+		glm::vec3 slabEntry = glm::min(toMin, toMax);
+		glm::vec3 slabExit = glm::max(toMin, toMax);
+
+		float entry = std::max(std::max(slabEntry.x, slabEntry.y), std::max(slabEntry.z, 0.0f));
+		float exit = std::min(std::min(slabExit.x, slabExit.y), std::min(slabExit.z, closest));
+
+		return entry <= exit ? entry : -1.0f;
+	};
+
+	struct StackEntry
+	{
+		uint32_t node;
+		float distance;
+	};
+
+	StackEntry stack[maxDepth + 2];
+	int stackSize = 0;
+
+	float rootDistance = GetEntryDistance(nodes[0]);
+	if (rootDistance < 0.0f)
+	{
+		return false;
+	}
+
+	stack[stackSize++] = { 0, rootDistance };
+	bool hit = false;
+
+	while (stackSize)
+	{
+		StackEntry entry = stack[--stackSize];
+
+		if (entry.distance > closest)
+		{
+			continue;
+		}
+
+		const Node& node = nodes[entry.node];
+
+		if (node.triangleAmount)
+		{
+			for (uint32_t triangle = node.offset; triangle < node.offset + node.triangleAmount; ++triangle)
+			{
+				float triangleDistance;
+
+				bool triangleHit = RayHitsTriangle(
+					localOrigin,
+					localDirection,
+					positions[indices[triangle * 3]],
+					positions[indices[triangle * 3 + 1]],
+					positions[indices[triangle * 3 + 2]],
+					triangleDistance
+				);
+
+				if (triangleHit && triangleDistance < closest)
+				{
+					closest = triangleDistance;
+					hit = true;
+				}
+			}
+
+			continue;
+		}
+
+		// Nearer child goes on top, so hits found in it cut the farther one off
+		float nearDistance = GetEntryDistance(nodes[node.offset]);
+		float farDistance = GetEntryDistance(nodes[node.offset + 1]);
+		uint32_t nearChild = node.offset;
+		uint32_t farChild = node.offset + 1;
+
+		if (farDistance >= 0.0f && (nearDistance < 0.0f || farDistance < nearDistance))
+		{
+			std::swap(nearDistance, farDistance);
+			std::swap(nearChild, farChild);
+		}
+
+		if (farDistance >= 0.0f)
+		{
+			stack[stackSize++] = { farChild, farDistance };
+		}
+
+		if (nearDistance >= 0.0f)
+		{
+			stack[stackSize++] = { nearChild, nearDistance };
+		}
+	}
+
+	if (hit)
+	{
+		distance = closest;
+	}
+
+	return hit;
+}
+
+void TriangleBVH::BuildNode(uint32_t nodeIndex, std::vector<BuildTriangle>& triangles, size_t first, size_t amount, int depth)
+{
+	glm::vec3 nodeMin = triangles[first].boundsMin;
+	glm::vec3 nodeMax = triangles[first].boundsMax;
+
+	for (size_t i = first + 1; i < first + amount; ++i)
+	{
+		nodeMin = glm::min(nodeMin, triangles[i].boundsMin);
+		nodeMax = glm::max(nodeMax, triangles[i].boundsMax);
+	}
+
+	Quantize(nodeMin, nodeMax, nodes[nodeIndex].boundsMin, nodes[nodeIndex].boundsMax);
+
+	size_t split = depth < maxDepth ? SplitBySAH(triangles, first, amount, nodeMin, nodeMax) : first + amount;
+
+	if (split == first + amount)
+	{
+		nodes[nodeIndex].offset = static_cast<uint32_t>(first);
+		nodes[nodeIndex].triangleAmount = static_cast<uint32_t>(amount);
+		return;
+	}
+
+	// Children are allocated together before either is built, so they stay next to each other
+	uint32_t childIndex = static_cast<uint32_t>(nodes.size());
+	nodes.resize(nodes.size() + 2);
+
+	nodes[nodeIndex].offset = childIndex;
+	nodes[nodeIndex].triangleAmount = 0;
+
+	BuildNode(childIndex, triangles, first, split - first, depth + 1);
+	BuildNode(childIndex + 1, triangles, split, first + amount - split, depth + 1);
+}
+
+size_t TriangleBVH::SplitBySAH(
+	std::vector<BuildTriangle>& triangles,
+	size_t first,
+	size_t amount,
+	const glm::vec3& nodeMin,
+	const glm::vec3& nodeMax
+) const
+{
+	size_t end = first + amount;
+
+	if (amount <= 1)
+	{
+		return end;
+	}
+
+	glm::vec3 centroidMin = triangles[first].centroid;
+	glm::vec3 centroidMax = centroidMin;
+
+	for (size_t i = first + 1; i < end; ++i)
+	{
+		centroidMin = glm::min(centroidMin, triangles[i].centroid);
+		centroidMax = glm::max(centroidMax, triangles[i].centroid);
+	}
+
+	struct Bin
+	{
+		glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+		size_t amount = 0;
+	};
+
+	float bestCost = std::numeric_limits<float>::max();
+	int bestAxis = -1;
+	int bestBin = 0;
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float extent = centroidMax[axis] - centroidMin[axis];
+
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		Bin bins[sahBins];
+		float binScale = sahBins / extent;
+
+		for (size_t i = first; i < end; ++i)
+		{
+			int bin = std::min(static_cast<int>((triangles[i].centroid[axis] - centroidMin[axis]) * binScale), sahBins - 1);
+
+			bins[bin].boundsMin = glm::min(bins[bin].boundsMin, triangles[i].boundsMin);
+			bins[bin].boundsMax = glm::max(bins[bin].boundsMax, triangles[i].boundsMax);
+			++bins[bin].amount;
+		}
+
+		// Cost of splitting after bin i, left side swept forward and right side backward
+		float leftCosts[sahBins - 1];
+		Bin left;
+
+		for (int i = 0; i < sahBins - 1; ++i)
+		{
+			left.boundsMin = glm::min(left.boundsMin, bins[i].boundsMin);
+			left.boundsMax = glm::max(left.boundsMax, bins[i].boundsMax);
+			left.amount += bins[i].amount;
+
+			leftCosts[i] = left.amount ? SurfaceArea(left.boundsMin, left.boundsMax) * left.amount : -1.0f;
+		}
+
+		Bin right;
+
+		for (int i = sahBins - 1; i > 0; --i)
+		{
+			right.boundsMin = glm::min(right.boundsMin, bins[i].boundsMin);
+			right.boundsMax = glm::max(right.boundsMax, bins[i].boundsMax);
+			right.amount += bins[i].amount;
+
+			if (!right.amount || leftCosts[i - 1] < 0.0f)
+			{
+				continue;
+			}
+
+			float cost = leftCosts[i - 1] + SurfaceArea(right.boundsMin, right.boundsMax) * right.amount;
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = i - 1;
+			}
+		}
+	}
+
+	// All centroids in one point, halves are as good as any split
+	if (bestAxis == -1)
+	{
+		return amount > maxLeafTriangles ? first + amount / 2 : end;
+	}
+
+	// Traversal step costs as much as one triangle test
+	float parentArea = std::max(SurfaceArea(nodeMin, nodeMax), std::numeric_limits<float>::min());
+	float splitCost = 1.0f + bestCost / parentArea;
+
+	if (amount <= maxLeafTriangles && splitCost >= static_cast<float>(amount))
+	{
+		return end;
+	}
+
+	float binScale = sahBins / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+
+	auto splitIter = std::partition(triangles.begin() + first, triangles.begin() + end, [&](const BuildTriangle& triangle)
+	{
+		int bin = std::min(static_cast<int>((triangle.centroid[bestAxis] - centroidMin[bestAxis]) * binScale), sahBins - 1);
+
+		return bin <= bestBin;
+	});
+
+	return static_cast<size_t>(splitIter - triangles.begin());
+}
+
+void TriangleBVH::Quantize(const glm::vec3& quantizedBoundsMin, const glm::vec3& quantizedBoundsMax, uint16_t quantizedMin[3], uint16_t quantizedMax[3]) const
+{
+	// One step of padding covers rounding of the float math on both sides
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float low = std::floor((quantizedBoundsMin[axis] - boundsMin[axis]) * quantizeScale[axis]) - 1.0f;
+		float high = std::ceil((quantizedBoundsMax[axis] - boundsMin[axis]) * quantizeScale[axis]) + 1.0f;
+
+		quantizedMin[axis] = static_cast<uint16_t>(glm::clamp(low, 0.0f, 65535.0f));
+		quantizedMax[axis] = static_cast<uint16_t>(glm::clamp(high, 0.0f, 65535.0f));
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+/*
+	Bounding volume hierarchy over triangles of a mesh, for mesh accurate collision
+
+	Built top down with the surface area heuristic over binned centroids. Node bounds are
+	quantized to 16 bits within the mesh bounds, rounded outwards, so a node takes 20 bytes.
+	Children of a node are stored next to each other. The BVH keeps its own copy of positions
+	and of indices reordered by leaves, so it outlives vertex data released after upload.
+
+	Queries take the mesh to world space by a model matrix and are given in world space.
+	Nodes are tested against the query bounds moved to model space, triangles are moved to
+	world space and tested exactly, so non uniform scale is handled. Touching does not overlap,
+	as in SolidSim::CheckForCollision. Rays are moved to model space whole, as that keeps
+	distances along them, and visit nodes nearest first
+*/
+class TriangleBVH
+{
+public:
+	TriangleBVH() = default;
+	TriangleBVH(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices);
+
+	bool IsEmpty() const;
+	size_t GetNodeAmount() const;
+	size_t GetTriangleAmount() const;
+
+	bool OverlapsBox(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& model) const;
+	// Capsule is a segment with a radius around it
+	bool OverlapsCapsule(const glm::vec3& segmentStart, const glm::vec3& segmentEnd, float radius, const glm::mat4& model) const;
+	// Nearest triangle the ray hits before maxDistance, distance is in lengths of direction
+	bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const glm::mat4& model, float& distance) const;
+
+	constexpr static size_t maxLeafTriangles = 4;
+
+private:
+	struct Node
+	{
+		uint16_t boundsMin[3];
+		uint16_t boundsMax[3];
+		uint32_t offset;         // First child for inner nodes, first triangle for leaves
+		uint32_t triangleAmount; // 0 for inner nodes
+	};
+
+	struct BuildTriangle
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		glm::vec3 centroid;
+		uint32_t index;
+	};
+
+	void BuildNode(uint32_t nodeIndex, std::vector<BuildTriangle>& triangles, size_t first, size_t amount, int depth);
+	// Returns the split index, or first + amount if a leaf is cheaper
+	size_t SplitBySAH(std::vector<BuildTriangle>& triangles, size_t first, size_t amount, const glm::vec3& nodeMin, const glm::vec3& nodeMax) const;
+	// Rounds outwards, clamped to the mesh bounds
+	void Quantize(const glm::vec3& quantizedBoundsMin, const glm::vec3& quantizedBoundsMax, uint16_t quantizedMin[3], uint16_t quantizedMax[3]) const;
+
+	// Calls triangleTest(v0, v1, v2) with world space vertices of triangles in nodes overlapping
+	// the world space box, stops once it returns true
+	template<typename TriangleTest>
+	bool Traverse(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& model, TriangleTest triangleTest) const;
+
+	constexpr static int maxDepth = 48;
+	constexpr static int sahBins = 12;
+
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+	glm::vec3 quantizeScale = glm::vec3(0.0f);
+
+	std::vector<Node> nodes;
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices; // 3 per triangle, in leaf order
+};
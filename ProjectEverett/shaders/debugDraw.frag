@@ -0,0 +1,9 @@
+#version 330 core
+in vec4 lineColor;
+
+out vec4 FragColor;
+
+void main()
+{
+	FragColor = lineColor;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+
+out vec4 lineColor;
+
+uniform mat4 viewProj;
+
+void main()
+{
+	lineColor = aColor;
+	gl_Position = viewProj * vec4(aPos, 1.0f);
+}
\ No newline at end of file
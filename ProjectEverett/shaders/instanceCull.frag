@@ -0,0 +1,6 @@
+#version 330 core
+
+void main()
+{
+    // Rasterizer is disabled during culling, shader exists for the program to be complete
+}
\ No newline at end of file
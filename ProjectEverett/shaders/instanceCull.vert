@@ -0,0 +1,47 @@
+#version 330 core
+layout (location = 0) in vec4 aModel0;
+layout (location = 1) in vec4 aModel1;
+layout (location = 2) in vec4 aModel2;
+layout (location = 3) in vec4 aModel3;
+layout (location = 4) in vec3 aNormal0;
+layout (location = 5) in vec3 aNormal1;
+layout (location = 6) in vec3 aNormal2;
+
+out vec4 model0;
+out vec4 model1;
+out vec4 model2;
+out vec4 model3;
+out vec3 normal0;
+out vec3 normal1;
+out vec3 normal2;
+flat out int visible;
+
+uniform vec4 frustumPlanes[6];
+uniform vec4 boundingSphere;
+
+void main()
+{
+	mat4 model = mat4(aModel0, aModel1, aModel2, aModel3);
+
+	// Sphere is moved to world space, radius is scaled by the biggest axis scale
+	vec3 center = vec3(model * vec4(boundingSphere.xyz, 1.0f));
+	float scale = max(length(aModel0.xyz), max(length(aModel1.xyz), length(aModel2.xyz)));
+	float radius = boundingSphere.w * scale;
+
+	visible = 1;
+	for (int i = 0; i < 6; ++i)
+	{
+		if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+		{
+			visible = 0;
+		}
+	}
+
+	model0 = aModel0;
+	model1 = aModel1;
+	model2 = aModel2;
+	model3 = aModel3;
+	normal0 = aNormal0;
+	normal1 = aNormal1;
+	normal2 = aNormal2;
+}
\ No newline at end of file
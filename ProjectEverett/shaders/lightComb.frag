@@ -24,6 +24,8 @@ struct PointLight
     float constant;
     float linear;
     float quadratic;
+
+    int shadowIndex;
 };
 
 struct SpotLight
@@ -42,7 +44,14 @@ struct SpotLight
     float quadratic;
 };
 
+#ifdef OIT
+layout (location = 0) out vec4 AccumColor;
+layout (location = 1) out vec4 AccumWeight;
+
+uniform float opacity;
+#else
 out vec4 FragColor;
+#endif
 
 in vec3 Normal;
 in vec3 FragPos;
@@ -66,6 +75,39 @@ uniform PointLight pointLights[LIGHT_MAX_AMOUNT];
 uniform int spotLightAmount;
 uniform SpotLight spotLights[LIGHT_MAX_AMOUNT];
 
+#define SHADOW_MAX_AMOUNT 4
+#define SHADOW_BIAS 0.0005
+
+uniform samplerCubeShadow pointShadowMaps[SHADOW_MAX_AMOUNT];
+uniform float shadowNear;
+uniform float shadowFar;
+
+float CubeFaceDepth(vec3 lightToFrag)
+{
+    // Depth the fragment would have in the cube face it falls into
+    vec3 absVec = abs(lightToFrag);
+    float faceZ = max(absVec.x, max(absVec.y, absVec.z));
+
+    float ndcDepth = (shadowFar + shadowNear) / (shadowFar - shadowNear) - 
+        (2.0 * shadowFar * shadowNear) / ((shadowFar - shadowNear) * faceZ);
+
+    return ndcDepth * 0.5 + 0.5;
+}
+
+float CalcPointShadow(PointLight light, vec3 fragPos)
+{
+    vec3 lightToFrag = fragPos - light.position;
+    vec4 shadowCoords = vec4(lightToFrag, CubeFaceDepth(lightToFrag) - SHADOW_BIAS);
+
+    // Sampler arrays can only be indexed with constant expressions in 330
+    if (light.shadowIndex == 0) return texture(pointShadowMaps[0], shadowCoords);
+    if (light.shadowIndex == 1) return texture(pointShadowMaps[1], shadowCoords);
+    if (light.shadowIndex == 2) return texture(pointShadowMaps[2], shadowCoords);
+    if (light.shadowIndex == 3) return texture(pointShadowMaps[3], shadowCoords);
+
+    return 1.0;
+}
+
 vec3 AmbientLight(vec3 normal)
 {
     vec3 amb = (ambient * vec3(texture(material.diffuse, TexCoords)));
@@ -105,8 +147,10 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     
     diffuse *= attenuation;
     specular *= attenuation;
+
+    float shadow = CalcPointShadow(light, fragPos);
     
-    return (diffuse + specular);    
+    return (diffuse + specular) * shadow;    
 }
 
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
@@ -159,5 +203,19 @@ void main()
         res += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);
     }
 
+#ifdef OIT
+    float alpha = opacity * texture(material.diffuse, TexCoords).a;
+
+    // Weight function from McGuire and Bavoil, closer and more opaque surfaces dominate
+    float weight = clamp(
+        pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 
+        1e-2, 
+        3e3
+    );
+
+    AccumColor = vec4(res * alpha * weight, alpha);
+    AccumWeight = vec4(alpha * weight);
+#else
     FragColor = vec4(res, 1.0);
+#endif
 }
\ No newline at end of file
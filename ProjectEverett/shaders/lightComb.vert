@@ -2,6 +2,8 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec3 aTexCoords;
+layout (location = 5) in mat4 aInstanceModel;
+layout (location = 9) in mat3 aInstanceNormal;
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -11,11 +13,15 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 proj;
 uniform mat4 inv;
+uniform bool instanced;
 
 void main()
 {
-	FragPos = vec3(model * vec4(aPos, 1.0f));
-	Normal = mat3(transpose(inv)) * aNormal;
+	mat4 currentModel = instanced ? aInstanceModel : model;
+	mat3 normalMatrix = instanced ? aInstanceNormal : mat3(transpose(inv));
+
+	FragPos = vec3(currentModel * vec4(aPos, 1.0f));
+	Normal = normalMatrix * aNormal;
 	TexCoords = vec2(aTexCoords.x, aTexCoords.y);
 
 	gl_Position = proj * view * vec4(FragPos, 1.0f);
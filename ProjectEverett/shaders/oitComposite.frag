@@ -0,0 +1,26 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform sampler2D accumTexture;
+uniform sampler2D weightTexture;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+
+    vec4 accum = texelFetch(accumTexture, texel, 0);
+    float revealage = accum.a;
+
+    // Nothing transparent covers this pixel
+    if (revealage >= 0.999f)
+    {
+        discard;
+    }
+
+    float weight = texelFetch(weightTexture, texel, 0).r;
+    vec3 averageColor = accum.rgb / max(weight, 0.00001f);
+
+    // Blended as averageColor * (1 - revealage) + opaque * revealage
+    FragColor = vec4(averageColor, revealage);
+}
\ No newline at end of file
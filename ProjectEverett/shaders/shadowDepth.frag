@@ -0,0 +1,6 @@
+#version 330 core
+
+void main()
+{
+    // Only depth is written
+}
\ No newline at end of file
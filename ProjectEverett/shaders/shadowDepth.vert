@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 5) in mat4 aInstanceModel;
+
+uniform mat4 model;
+uniform mat4 lightSpace;
+uniform bool instanced;
+
+void main()
+{
+	mat4 currentModel = instanced ? aInstanceModel : model;
+
+	gl_Position = lightSpace * currentModel * vec4(aPos, 1.0f);
+}
\ No newline at end of file
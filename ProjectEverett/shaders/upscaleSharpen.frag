@@ -0,0 +1,30 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D sceneColor;
+uniform vec2 uvScale;
+uniform vec2 texelSize;
+uniform float sharpness;
+
+void main()
+{
+    // Sampling in output space, scene is stored in a sub rect of the texture
+    vec2 maxCoords = uvScale - texelSize * 0.5f;
+
+    vec3 center = texture(sceneColor, min(TexCoords, maxCoords)).rgb;
+    vec3 north  = texture(sceneColor, min(TexCoords + vec2(0.0f, texelSize.y), maxCoords)).rgb;
+    vec3 south  = texture(sceneColor, max(TexCoords - vec2(0.0f, texelSize.y), vec2(0.0f))).rgb;
+    vec3 east   = texture(sceneColor, min(TexCoords + vec2(texelSize.x, 0.0f), maxCoords)).rgb;
+    vec3 west   = texture(sceneColor, max(TexCoords - vec2(texelSize.x, 0.0f), vec2(0.0f))).rgb;
+
+    vec3 sharpened = center * (1.0f + 4.0f * sharpness) - (north + south + east + west) * sharpness;
+
+    // Clamping to the neighbourhood keeps the unsharp mask from ringing
+    vec3 minColor = min(center, min(min(north, south), min(east, west)));
+    vec3 maxColor = max(center, max(max(north, south), max(east, west)));
+
+    FragColor = vec4(clamp(sharpened, minColor, maxColor), 1.0f);
+}
\ No newline at end of file
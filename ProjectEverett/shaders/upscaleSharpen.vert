@@ -0,0 +1,14 @@
+#version 330 core
+
+out vec2 TexCoords;
+
+uniform vec2 uvScale;
+
+void main()
+{
+	// Full screen triangle without vertex buffers
+	vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+	TexCoords = pos * uvScale;
+	gl_Position = vec4(pos * 2.0f - 1.0f, 0.0f, 1.0f);
+}
\ No newline at end of file